@@ -2,11 +2,12 @@
 # ============================================================================
 # Music Player - Master Build Script
 # Builds both C++ DLL backend and C# WinForms frontend
+# -Target tests / bench build and run the programs in cpp_backend\tests / cpp_backend\bench
 # ============================================================================
 
 param(
     [Parameter(Mandatory=$false)]
-    [ValidateSet("cpp", "csharp", "both", "clean", "run")]
+    [ValidateSet("cpp", "csharp", "both", "clean", "run", "tests", "bench")]
     [string]$Target = "both"
 )
 
@@ -71,6 +72,14 @@ function Build-CppDll {
         return $false
     }
 
+    # Regenerate the built-in catalog header from its CSV
+    try {
+        & (Join-Path $CppBackend "tools\generate-default-catalog.ps1")
+    } catch {
+        Write-Error-Message "Failed to generate DefaultCatalog.hpp: $_"
+        return $false
+    }
+
     # Collect source files
     $Headers = Get-ChildItem -Path "$CppBackend\headers" -Filter "*.hpp" | Select-Object -ExpandProperty FullName
     $Sources = Get-ChildItem -Path "$CppBackend\src" -Filter "*.cpp" | Select-Object -ExpandProperty FullName
@@ -111,6 +120,57 @@ function Build-CppDll {
     }
 }
 
+# ============================================================================
+# BUILD AND RUN STANDALONE PROGRAMS (tests, bench)
+# ============================================================================
+function Invoke-CppPrograms {
+    param([string]$Folder, [string]$Title)
+    Write-Title $Title
+
+    $env:Path = "C:\msys64\ucrt64\bin;" + $env:Path
+
+    # Every backend source but the console entry point; each program brings its own main()
+    $Sources = Get-ChildItem -Path "$CppBackend\src" -Filter "*.cpp" |
+        Where-Object { $_.Name -ne "main.cpp" } | Select-Object -ExpandProperty FullName
+    $Programs = Get-ChildItem -Path (Join-Path $CppBackend $Folder) -Filter "*.cpp"
+
+    $Failed = @()
+    foreach ($Program in $Programs) {
+        $ExeOutput = Join-Path $BuildDir "$($Program.BaseName).exe"
+        $Args = @(
+            "-I$($CppBackend)\headers",
+            "-I$(Join-Path $CppBackend $Folder)",
+            "-std=c++17",
+            "-O2",
+            "-Wall",
+            $Program.FullName,
+            $Sources,
+            "-o", $ExeOutput
+        )
+
+        Write-Host "$Yellow▶ $($Program.BaseName)$Reset"
+        & g++ $Args 2>&1
+        if (-not $? -or -not (Test-Path $ExeOutput)) {
+            Write-Error-Message "Failed to build $($Program.Name)"
+            $Failed += $Program.BaseName
+            continue
+        }
+
+        & $ExeOutput
+        if ($LASTEXITCODE -ne 0) {
+            Write-Error-Message "$($Program.BaseName) exited with code $LASTEXITCODE"
+            $Failed += $Program.BaseName
+        }
+    }
+
+    if ($Failed.Count -gt 0) {
+        Write-Error-Message "$($Failed.Count) of $($Programs.Count) failed: $($Failed -join ', ')"
+        return $false
+    }
+    Write-Status "✅ $($Programs.Count) programs passed"
+    return $true
+}
+
 # ============================================================================
 # BUILD C# UI
 # ============================================================================
@@ -224,9 +284,20 @@ try {
         "run" {
             Run-Application
         }
+        "tests" {
+            $Success = Invoke-CppPrograms -Folder "tests" -Title "🧪 Running Tests"
+        }
+        "bench" {
+            $Success = Invoke-CppPrograms -Folder "bench" -Title "⏱️  Running Benchmarks"
+        }
+    }
+
+    # Benchmarks and tests report failure through the exit code
+    if ($Target -in @("tests", "bench") -and -not $Success) {
+        exit 1
     }
 
-    if ($Success -and $Target -ne "clean") {
+    if ($Success -and $Target -notin @("clean", "tests", "bench")) {
         Write-Host "`n$Green━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━$Reset"
         Write-Status "✅ BUILD COMPLETE!"
         Write-Host "$Green━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━$Reset"
@@ -0,0 +1,92 @@
+#include "Bench.hpp"
+#include "AudioEngine.hpp"
+#include "AudioMixer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+/**
+ * AudioMixerBench - Cost of mixing one crossfade block on the render thread
+ * Times AudioMixer::crossfade on AudioEngine::BLOCK_FRAMES-frame blocks at
+ * 192 kHz stereo, the highest rate the engine is used at, with a stereo
+ * and a mono incoming track (the latter remixed first), and reports it
+ * against the time the block lasts. Fails if a block takes more than 10%
+ * of that or the output is off the equal-power curve.
+ */
+
+namespace {
+    const size_t FRAMES = AudioEngine::BLOCK_FRAMES;
+    const int CHANNELS = 2;
+    const double RATE = 192000.0;
+    const double MAX_SHARE = 0.10;
+    const double PI = 3.14159265358979323846;
+
+    std::vector<float> noise(size_t count, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> sample(-1.0f, 1.0f);
+        std::vector<float> result(count);
+        for (auto& value : result) value = sample(rng);
+        return result;
+    }
+
+    // Largest difference from the formula in AudioMixer.hpp, computed in double
+    double worstError(const std::vector<float>& from, const std::vector<float>& to, int toChannels,
+                      const std::vector<float>& out, float start, float step) {
+        double worst = 0.0;
+        for (size_t i = 0; i < FRAMES; ++i) {
+            double t = std::min(1.0, std::max(0.0, (double)start + i * (double)step));
+            for (int c = 0; c < CHANNELS; ++c) {
+                double incoming = toChannels == CHANNELS ? to[i * CHANNELS + c] : to[i];
+                double expected = from[i * CHANNELS + c] * std::cos(t * PI / 2) + incoming * std::sin(t * PI / 2);
+                worst = std::max(worst, std::fabs(expected - out[i * CHANNELS + c]));
+            }
+        }
+        return worst;
+    }
+}
+
+int main() {
+    int failures = 0;
+    const double blockNs = FRAMES / RATE * 1e9;
+    const float step = 1.0f / (float)(AudioEngine::MAX_CROSSFADE_MS / 1000.0 * RATE);
+
+    std::vector<float> from = noise(FRAMES * CHANNELS, 1);
+    std::vector<float> stereo = noise(FRAMES * CHANNELS, 2);
+    std::vector<float> mono = noise(FRAMES, 3);
+    std::vector<float> out(FRAMES * CHANNELS);
+    std::vector<float> scratch(FRAMES * AudioEngine::MAX_CHANNELS);
+
+    struct Case {
+        const char* name;
+        const std::vector<float>& to;
+        int toChannels;
+    };
+    const Case cases[] = {{"stereo into stereo", stereo, 2}, {"mono into stereo", mono, 1}};
+
+    for (const Case& mix : cases) {
+        AudioMixer::crossfade(from.data(), mix.to.data(), mix.toChannels, out.data(), CHANNELS, FRAMES,
+                              0.3f, step, scratch.data());
+        if (worstError(from, mix.to, mix.toChannels, out, 0.3f, step) > 1e-5) {
+            failures += Bench::fail("crossfade output is off the equal-power curve");
+        }
+
+        // Walk t through the whole fade the way the render thread does
+        float t = 0.0f;
+        double seconds = Bench::secondsPerCall([&] {
+            for (int i = 0; i < 1000; ++i) {
+                AudioMixer::crossfade(from.data(), mix.to.data(), mix.toChannels, out.data(), CHANNELS, FRAMES,
+                                      t, step, scratch.data());
+                t += FRAMES * step;
+                if (t > 1.0f) t = 0.0f;
+                Bench::keep((size_t)(out[i % (FRAMES * CHANNELS)] > 0.0f));
+            }
+        });
+        double ns = seconds / 1000 * 1e9;
+        std::printf("%s: %.0f ns per %zu-frame block, %.3f%% of the %.2f ms it lasts at 192 kHz\n",
+                    mix.name, ns, FRAMES, 100 * ns / blockNs, blockNs / 1e6);
+        if (ns > MAX_SHARE * blockNs) failures += Bench::fail("crossfade block over 10% of its real-time budget");
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+#include "Bench.hpp"
+#include "AudioRing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * AudioRingBench - Cost of handing PCM from the decoder to the render thread
+ * Reports the bare handover cost per block, throughput with two threads
+ * copying real 1024-frame stereo blocks, and how long single producer
+ * calls take while the consumer is running against while it is stalled
+ * on a block. A wait-free ring shows the same figures in both cases.
+ */
+
+namespace {
+    const size_t BLOCK_FRAMES = 1024;
+    const int CHANNELS = 2;
+    const size_t RING_FRAMES = 16384;
+    const double RATE = 48000.0;
+
+    AudioRing::BlockInfo infoFor(uint64_t block) {
+        return AudioRing::BlockInfo{block, 0, block * BLOCK_FRAMES, 0, {(int)RATE, CHANNELS},
+                                    (uint32_t)BLOCK_FRAMES, false, 0, 0, 0};
+    }
+
+    struct Percentiles {
+        double median;
+        double p999;
+        double worst;
+    };
+
+    // Time calls producer calls (beginWrite + commitWrite when there is room) one by one, in ns
+    Percentiles producerCalls(AudioRing& ring, int calls) {
+        std::vector<double> times;
+        times.reserve(calls);
+        uint64_t block = 0;
+        for (int i = 0; i < calls; ++i) {
+            Bench::Clock::time_point start = Bench::Clock::now();
+            if (ring.beginWrite()) ring.commitWrite(infoFor(block++));
+            times.push_back(std::chrono::duration<double, std::nano>(Bench::Clock::now() - start).count());
+        }
+        std::sort(times.begin(), times.end());
+        return Percentiles{times[times.size() / 2], times[times.size() * 999 / 1000], times.back()};
+    }
+}
+
+int main() {
+    int failures = 0;
+    const double blockNs = BLOCK_FRAMES / RATE * 1e9;
+
+    // One thread, metadata only: the pure cost of the indices and the info copy
+    {
+        AudioRing ring(RING_FRAMES, BLOCK_FRAMES, CHANNELS);
+        uint64_t block = 0;
+        double seconds = Bench::secondsPerCall([&ring, &block] {
+            for (int i = 0; i < 1000; ++i) {
+                ring.beginWrite();
+                ring.commitWrite(infoFor(block++));
+                AudioRing::BlockInfo info;
+                if (ring.beginRead(info)) Bench::keep(info.track);
+                ring.commitRead();
+            }
+        });
+        double ns = seconds / 1000 * 1e9;
+        std::printf("handover: %.1f ns per block (write + read); a %zu-frame block lasts %.1f ms at 48 kHz\n",
+                    ns, BLOCK_FRAMES, blockNs / 1e6);
+    }
+
+    // Two threads moving real samples; either side yields when it cannot proceed
+    {
+        const uint64_t blocks = 200000;
+        AudioRing ring(RING_FRAMES, BLOCK_FRAMES, CHANNELS);
+        std::atomic<uint64_t> wrongBlocks(0);
+        Bench::Clock::time_point start = Bench::Clock::now();
+        std::thread producer([&ring, blocks] {
+            for (uint64_t block = 0; block < blocks; ) {
+                float* slot = ring.beginWrite();
+                if (!slot) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                std::fill(slot, slot + BLOCK_FRAMES * CHANNELS, (float)(block % 4096));
+                ring.commitWrite(infoFor(block++));
+            }
+        });
+        for (uint64_t block = 0; block < blocks; ) {
+            AudioRing::BlockInfo info;
+            const float* slot = ring.beginRead(info);
+            if (!slot) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (info.track != block || slot[0] != (float)(block % 4096) ||
+                slot[BLOCK_FRAMES * CHANNELS - 1] != (float)(block % 4096)) {
+                wrongBlocks++;
+            }
+            ring.commitRead();
+            block++;
+        }
+        producer.join();
+        double seconds = Bench::secondsSince(start);
+        std::printf("threaded: %.2f M blocks/s, %.0f M frames/s (%.0fx real time at 48 kHz stereo)\n",
+                    blocks / seconds / 1e6, blocks * BLOCK_FRAMES / seconds / 1e6,
+                    blocks * BLOCK_FRAMES / seconds / RATE);
+        if (wrongBlocks) failures += Bench::fail("blocks arrived corrupt or out of order");
+    }
+
+    // Producer call times with the consumer draining as fast as it can,
+    // then with the consumer parked on a block it does not release
+    {
+        const int calls = 1000000;
+        AudioRing ring(RING_FRAMES, BLOCK_FRAMES, CHANNELS);
+        std::atomic<bool> stop(false);
+        std::thread consumer([&ring, &stop] {
+            AudioRing::BlockInfo info;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (ring.beginRead(info)) ring.commitRead();
+            }
+        });
+        Percentiles running = producerCalls(ring, calls);
+        stop = true;
+        consumer.join();
+
+        AudioRing::BlockInfo info;
+        while (ring.beginRead(info)) ring.commitRead();
+        std::atomic<int> phase(0);
+        std::thread stalled([&ring, &phase] {
+            AudioRing::BlockInfo held;
+            while (!ring.beginRead(held)) std::this_thread::yield();
+            phase = 1;
+            while (phase.load() != 2) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            ring.commitRead();
+        });
+        ring.beginWrite();
+        ring.commitWrite(infoFor(0));
+        while (phase.load() != 1) std::this_thread::yield();
+        Percentiles parked = producerCalls(ring, calls);
+        if (ring.beginWrite() != nullptr) failures += Bench::fail("ring not full behind a stalled consumer");
+        phase = 2;
+        stalled.join();
+
+        std::printf("producer call, consumer running: median %.0f ns, 99.9%% %.0f ns, worst %.0f ns\n",
+                    running.median, running.p999, running.worst);
+        std::printf("producer call, consumer stalled: median %.0f ns, 99.9%% %.0f ns, worst %.0f ns\n",
+                    parked.median, parked.p999, parked.worst);
+        std::printf("(worst cases include preemption by the OS)\n");
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <iostream>
+
+/**
+ * Bench - Timing helpers shared by the programs in bench/
+ * Each benchmark is a standalone program built by `build.ps1 -Target bench`.
+ * It prints its figures and exits non-zero if a sanity check on the
+ * results fails.
+ */
+namespace Bench {
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * Seconds elapsed since start
+     */
+    inline double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    /**
+     * Call fn once to warm up, then repeatedly for at least minSeconds
+     * Returns the average seconds per call
+     */
+    template <typename Fn>
+    double secondsPerCall(Fn fn, double minSeconds = 1.0) {
+        fn();
+        size_t calls = 0;
+        Clock::time_point start = Clock::now();
+        double elapsed;
+        do {
+            fn();
+            ++calls;
+            elapsed = secondsSince(start);
+        } while (elapsed < minSeconds);
+        return elapsed / calls;
+    }
+
+    /**
+     * Fold a result into a global so the optimizer cannot drop the work
+     */
+    inline void keep(size_t value) {
+        static volatile size_t sink = 0;
+        sink = sink + value;
+    }
+
+    /**
+     * Drops SystemManager's console logging while in scope, so per-call
+     * log lines neither flood the output nor dominate the timings
+     */
+    class QuietLog {
+    public:
+        QuietLog() : saved(std::cout.rdbuf(nullptr)) {}
+        ~QuietLog() { std::cout.rdbuf(saved); }
+        QuietLog(const QuietLog&) = delete;
+        QuietLog& operator=(const QuietLog&) = delete;
+
+    private:
+        std::streambuf* saved;
+    };
+
+    /**
+     * Print a failed check; returns 1 so callers can add up failures
+     */
+    inline int fail(const char* what) {
+        std::printf("FAILED: %s\n", what);
+        return 1;
+    }
+}
+
+#endif // BENCH_HPP
@@ -0,0 +1,104 @@
+#include "Bench.hpp"
+#include "LastFMManager.hpp"
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * LastFMParseBench - parseTracksFromJson throughput on chart payloads
+ * Generates chart.gettoptracks responses of 1000 tracks shaped like the
+ * real API (image arrays, streamable objects, @attr, quoted counters,
+ * escapes in a few titles) and reports MB/s and tracks/s.
+ */
+
+namespace {
+    const int TRACKS = 1000;
+    const int PAYLOADS = 8;
+
+    const char* const WORDS[] = {
+        "Love", "Night", "Fire", "Dream", "Heart", "City", "Rain", "Gold", "Summer", "Blue",
+        "Light", "Shadow", "River", "Ghost", "Wild", "Electric", "Paper", "Velvet", "Echo", "Stone"
+    };
+    const size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+    std::string words(std::mt19937& rng, int count) {
+        std::string text;
+        for (int i = 0; i < count; ++i) {
+            if (i) text += ' ';
+            text += WORDS[rng() % WORD_COUNT];
+        }
+        return text;
+    }
+
+    std::string mbid(std::mt19937& rng) {
+        static const char HEX[] = "0123456789abcdef";
+        std::string id;
+        for (int i = 0; i < 36; ++i) {
+            id += (i == 8 || i == 13 || i == 18 || i == 23) ? '-' : HEX[rng() % 16];
+        }
+        return id;
+    }
+
+    /**
+     * One chart.gettoptracks response; distinct title/artist per track
+     */
+    std::string chartPayload(unsigned seed) {
+        std::mt19937 rng(seed);
+        std::string json = "{\"tracks\":{\"track\":[";
+        for (int i = 0; i < TRACKS; ++i) {
+            std::string title = words(rng, 1 + (int)(rng() % 4)) + " " + std::to_string(i);
+            if (i % 50 == 7) title += " (feat. \\\"Caf\\u00e9\\\")";
+            std::string artist = words(rng, 1 + (int)(rng() % 2));
+            std::string slug = "https://www.last.fm/music/" + std::to_string(rng() % 100000);
+            std::string art = "https://lastfm.freetls.fastly.net/i/u/34s/" + mbid(rng) + ".png";
+
+            if (i) json += ',';
+            json += "{\"name\":\"" + title + "\",\"duration\":\"" + std::to_string(120 + rng() % 300) +
+                    "\",\"playcount\":\"" + std::to_string(rng() % 50000000) +
+                    "\",\"listeners\":\"" + std::to_string(rng() % 2000000) +
+                    "\",\"mbid\":\"" + (i % 3 ? mbid(rng) : std::string()) +
+                    "\",\"url\":\"" + slug + "/_/" + std::to_string(i) +
+                    "\",\"streamable\":{\"#text\":\"0\",\"fulltrack\":\"0\"}" +
+                    ",\"artist\":{\"name\":\"" + artist + "\",\"mbid\":\"" + mbid(rng) +
+                    "\",\"url\":\"" + slug + "\"},\"image\":[";
+            const char* const SIZES[] = {"small", "medium", "large", "extralarge"};
+            for (int s = 0; s < 4; ++s) {
+                if (s) json += ',';
+                json += "{\"#text\":\"" + art + "\",\"size\":\"" + SIZES[s] + "\"}";
+            }
+            json += "],\"@attr\":{\"rank\":\"" + std::to_string(i) + "\"}}";
+        }
+        json += "],\"@attr\":{\"page\":\"1\",\"perPage\":\"1000\",\"totalPages\":\"5000\","
+                "\"total\":\"5000000\"}}}";
+        return json;
+    }
+}
+
+int main() {
+    std::vector<std::string> payloads;
+    size_t totalBytes = 0;
+    for (int i = 0; i < PAYLOADS; ++i) {
+        payloads.push_back(chartPayload(1000 + i));
+        totalBytes += payloads.back().size();
+    }
+
+    Bench::QuietLog quiet;
+    int failures = 0;
+    for (const auto& payload : payloads) {
+        std::vector<LastFMTrack> tracks = LastFMManager::parseTracksFromJson(payload);
+        if (tracks.size() != (size_t)TRACKS) failures += Bench::fail("track count");
+        else if (tracks[7].title.find("\"Caf\xc3\xa9\"") == std::string::npos) failures += Bench::fail("escapes");
+        else if (tracks[0].duration < 120 || tracks[0].artist.empty()) failures += Bench::fail("fields");
+    }
+
+    double seconds = Bench::secondsPerCall([&payloads] {
+        for (const auto& payload : payloads) {
+            Bench::keep(LastFMManager::parseTracksFromJson(payload).size());
+        }
+    });
+
+    std::printf("chart payload: %d tracks, %.0f KB average\n", TRACKS, totalBytes / 1024.0 / PAYLOADS);
+    std::printf("parseTracksFromJson: %.1f MB/s, %.2f M tracks/s, %.1f us per payload\n",
+                totalBytes / seconds / 1e6, (double)PAYLOADS * TRACKS / seconds / 1e6, seconds / PAYLOADS * 1e6);
+    return failures ? 1 : 0;
+}
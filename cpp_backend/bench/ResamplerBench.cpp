@@ -0,0 +1,250 @@
+#include "Bench.hpp"
+#include "Resampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * ResamplerBench - Quality and speed of Resampler
+ * Feeds sines through common rate pairs and reports THD+N (1 kHz at
+ * -6 dBFS, everything that is not the tone, relative to it), passband
+ * ripple from 20 Hz to 20 kHz, how far tones above the output Nyquist
+ * are suppressed, and output frames/s per core for stereo.
+ * Fails if THD+N is above -100 dB, the passband deviates by more than
+ * 0.002 dB, the stopband is above -90 dB, a seek does not land on the
+ * continuous output, the length is off after a change of speed or a
+ * conversion runs below 5M frames/s.
+ */
+
+namespace {
+    const double PI = 3.14159265358979323846;
+    const double AMPLITUDE = 0.5;          // -6 dBFS
+    const size_t SETTLE = 2000;            // frames left out at each end (filter warm-up / tail)
+    const double MAX_THDN_DB = -100.0;
+    const double MAX_RIPPLE_DB = 0.002;
+    const double MAX_STOPBAND_DB = -90.0;
+    const double MIN_FRAMES_PER_SECOND = 5e6;
+
+    // A sine on every channel (the second ones at half level)
+    class SineSource : public AudioSource {
+    public:
+        SineSource(int rate, int channels, uint64_t length, double frequency)
+            : rate(rate), channels(channels), length(length), frequency(frequency), position(0) {}
+
+        AudioFormat getFormat() const override { return {rate, channels}; }
+        uint64_t getLength() const override { return length; }
+
+        size_t read(float* out, size_t frames) override {
+            size_t count = (size_t)std::min<uint64_t>(frames, length - position);
+            for (size_t i = 0; i < count; ++i) {
+                double value = AMPLITUDE * std::sin(2 * PI * frequency * (double)(position + i) / rate);
+                for (int c = 0; c < channels; ++c) out[i * channels + c] = (float)(c ? value * 0.5 : value);
+            }
+            position += count;
+            return count;
+        }
+
+        bool seek(uint64_t frame) override {
+            position = std::min(frame, length);
+            return true;
+        }
+
+    private:
+        int rate;
+        int channels;
+        uint64_t length;
+        double frequency;
+        uint64_t position;
+    };
+
+    // Precomputed samples, so the throughput figures time the filter alone
+    class TableSource : public AudioSource {
+    public:
+        TableSource(int rate, uint64_t length) : rate(rate), length(length), position(0), table(2 * 48000) {
+            for (size_t i = 0; i < table.size(); ++i) table[i] = (float)std::sin(i * 0.01);
+        }
+
+        AudioFormat getFormat() const override { return {rate, 2}; }
+        uint64_t getLength() const override { return length; }
+
+        size_t read(float* out, size_t frames) override {
+            size_t count = (size_t)std::min<uint64_t>(frames, length - position);
+            size_t offset = (size_t)(position % 40000) * 2;
+            std::copy(table.begin() + offset, table.begin() + offset + count * 2, out);
+            position += count;
+            return count;
+        }
+
+        bool seek(uint64_t frame) override {
+            position = std::min(frame, length);
+            return true;
+        }
+
+    private:
+        int rate;
+        uint64_t length;
+        uint64_t position;
+        std::vector<float> table;
+    };
+
+    std::vector<float> readAll(Resampler& resampler) {
+        int channels = resampler.getFormat().channels;
+        std::vector<float> result;
+        std::vector<float> block(1024 * channels);
+        size_t frames;
+        while ((frames = resampler.read(block.data(), 1024)) > 0) {
+            result.insert(result.end(), block.begin(), block.begin() + frames * channels);
+        }
+        return result;
+    }
+
+    /**
+     * Least-squares fit of a sine at frequency to the first channel
+     * Returns its amplitude and the residual relative to it in dB (THD+N)
+     */
+    std::pair<double, double> analyse(const std::vector<float>& samples, int channels, int rate, double frequency) {
+        size_t frames = samples.size() / channels;
+        double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+        for (size_t i = SETTLE; i < frames - SETTLE; ++i) {
+            double s = std::sin(2 * PI * frequency * i / rate), c = std::cos(2 * PI * frequency * i / rate);
+            double y = samples[i * channels];
+            ss += s * s;
+            sc += s * c;
+            cc += c * c;
+            ys += y * s;
+            yc += y * c;
+        }
+        double det = ss * cc - sc * sc;
+        double a = (ys * cc - yc * sc) / det, b = (yc * ss - ys * sc) / det;
+        double residual = 0, signal = 0;
+        for (size_t i = SETTLE; i < frames - SETTLE; ++i) {
+            double fit = a * std::sin(2 * PI * frequency * i / rate) + b * std::cos(2 * PI * frequency * i / rate);
+            residual += (samples[i * channels] - fit) * (samples[i * channels] - fit);
+            signal += fit * fit;
+        }
+        return std::make_pair(std::sqrt(a * a + b * b), 10 * std::log10(residual / signal));
+    }
+
+    std::unique_ptr<AudioSource> sine(int rate, int channels, uint64_t length, double frequency) {
+        return std::unique_ptr<AudioSource>(new SineSource(rate, channels, length, frequency));
+    }
+
+    // Largest difference between a read after seek(frame) and the continuous output
+    double seekError(double speed) {
+        Resampler resampler(sine(44100, 2, 100000, 440), 48000);
+        resampler.setSpeed(speed);
+        std::vector<float> all = readAll(resampler);
+        const uint64_t frame = 30000;
+        resampler.seek(frame);
+        std::vector<float> block(2000 * 2);
+        size_t frames = resampler.read(block.data(), 2000);
+        double worst = frames == 2000 ? 0.0 : 1.0;
+        for (size_t i = 0; i < frames * 2; ++i) {
+            worst = std::max(worst, (double)std::fabs(block[i] - all[frame * 2 + i]));
+        }
+        return worst;
+    }
+
+    // Frames actually produced minus getLength(), after reading a second at
+    // speed and switching back to 1x (pass-through when from == to)
+    long long lengthError(int from, int to, double speed) {
+        Resampler resampler(sine(from, 2, (uint64_t)from * 10, 440), to);
+        resampler.setSpeed(speed);
+        std::vector<float> block(1024 * 2);
+        uint64_t produced = 0;
+        while (produced < (uint64_t)to) produced += resampler.read(block.data(), 1024);
+        resampler.setSpeed(1.0);
+        uint64_t reported = resampler.getLength();
+        size_t frames;
+        while ((frames = resampler.read(block.data(), 1024)) > 0) produced += frames;
+        return (long long)produced - (long long)reported;
+    }
+
+    struct Conversion {
+        int from;
+        int to;
+        double speed;
+    };
+}
+
+int main() {
+    int failures = 0;
+
+    std::printf("THD+N, 1 kHz at -6 dBFS:\n");
+    const Conversion conversions[] = {{44100, 48000, 1.0}, {48000, 44100, 1.0}, {96000, 44100, 1.0},
+                                      {88200, 48000, 1.0}, {44100, 96000, 1.0}, {44100, 44100, 1.1},
+                                      {48000, 48000, 0.8}};
+    for (const Conversion& conversion : conversions) {
+        Resampler resampler(sine(conversion.from, 2, (uint64_t)conversion.from * 3, 1000), conversion.to);
+        resampler.setSpeed(conversion.speed);
+        std::vector<float> output = readAll(resampler);
+        std::pair<double, double> fit = analyse(output, 2, conversion.to, 1000 * conversion.speed);
+        std::printf("  %6d -> %6d, speed %.1f: %.1f dB (gain %+.4f dB)\n", conversion.from, conversion.to,
+                    conversion.speed, fit.second, 20 * std::log10(fit.first / AMPLITUDE));
+        if (fit.second > MAX_THDN_DB) failures += Bench::fail("THD+N above -100 dB");
+    }
+
+    const Conversion bands[] = {{44100, 48000, 1.0}, {96000, 44100, 1.0}};
+    for (const Conversion& band : bands) {
+        double worst = 0.0;
+        for (double frequency : {20.0, 100.0, 1000.0, 5000.0, 10000.0, 15000.0, 18000.0, 19000.0, 20000.0}) {
+            Resampler resampler(sine(band.from, 1, (uint64_t)band.from, frequency), band.to);
+            std::pair<double, double> fit = analyse(readAll(resampler), 1, band.to, frequency);
+            worst = std::max(worst, std::fabs(20 * std::log10(fit.first / AMPLITUDE)));
+        }
+        std::printf("passband %d -> %d, 20 Hz - 20 kHz: within %.4f dB\n", band.from, band.to, worst);
+        if (worst > MAX_RIPPLE_DB) failures += Bench::fail("passband ripple above 0.002 dB");
+    }
+
+    std::printf("stopband 96000 -> 44100 (tone above the output Nyquist, level out):");
+    for (double frequency : {23000.0, 25000.0, 30000.0, 40000.0}) {
+        Resampler resampler(sine(96000, 1, 96000, frequency), 44100);
+        std::vector<float> output = readAll(resampler);
+        double energy = 0.0;
+        for (size_t i = SETTLE; i < output.size() - SETTLE; ++i) energy += output[i] * output[i];
+        double level = 10 * std::log10(energy / (output.size() - 2 * SETTLE) / (AMPLITUDE * AMPLITUDE / 2));
+        std::printf(" %.0f Hz %.1f dB", frequency, level);
+        if (level > MAX_STOPBAND_DB) failures += Bench::fail("stopband above -90 dB");
+    }
+    std::printf("\n");
+
+    double seekFixed = seekError(1.0), seekVarispeed = seekError(1.3);
+    std::printf("seek vs continuous output: max difference %.3g, %.3g under varispeed\n", seekFixed, seekVarispeed);
+    if (seekFixed > 0.0 || seekVarispeed > 0.0) failures += Bench::fail("seek does not match continuous output");
+
+    long long worstLength = 0;
+    for (double speed : {2.0, 0.5}) {
+        for (const Conversion& conversion : {Conversion{44100, 44100, speed}, Conversion{44100, 48000, speed}}) {
+            long long error = lengthError(conversion.from, conversion.to, conversion.speed);
+            if (std::llabs(error) > std::llabs(worstLength)) worstLength = error;
+        }
+    }
+    std::printf("length after 2x / 0.5x and back to 1x: off by %lld frames\n", worstLength);
+    if (worstLength != 0) failures += Bench::fail("length wrong after a change of speed");
+
+    std::printf("throughput, stereo, output frames per second:\n");
+    const Conversion speeds[] = {{44100, 48000, 1.0}, {48000, 44100, 1.0}, {96000, 44100, 1.0}, {44100, 48000, 1.07}};
+    for (const Conversion& conversion : speeds) {
+        Resampler resampler(std::unique_ptr<AudioSource>(new TableSource(conversion.from, (uint64_t)conversion.from * 600)),
+                            conversion.to);
+        resampler.setSpeed(conversion.speed);
+        std::vector<float> block(1024 * 2);
+        size_t total = 0;
+        Bench::Clock::time_point start = Bench::Clock::now();
+        while (total < 20000000) {
+            size_t frames = resampler.read(block.data(), 1024);
+            if (frames == 0) break;
+            total += frames;
+        }
+        double seconds = Bench::secondsSince(start);
+        Bench::keep((size_t)(block[0] > 0.0f));
+        std::printf("  %6d -> %6d, speed %.2f: %.1f M frames/s (%.0fx real time)\n", conversion.from,
+                    conversion.to, conversion.speed, total / seconds / 1e6, total / seconds / conversion.to);
+        if (total / seconds < MIN_FRAMES_PER_SECOND) failures += Bench::fail("below 5M frames/s");
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,99 @@
+#include "Bench.hpp"
+#include "Catalog.hpp"
+#include "CatalogGenerator.hpp"
+#include "TextSearch.hpp"
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <vector>
+
+/**
+ * SubstringSearchBench - TextSearch::find over a catalog's folded text
+ * Lays out synthetic tracks the way Catalog keeps them ("title\x1fartist\n",
+ * folded) and scans the whole buffer for needles that occur nowhere, rarely
+ * and often. Reports tracks/s per core for the kernel find() picks and for
+ * the scalar one, next to the old per-query copy + tolower + find.
+ * Fails below 10M tracks/s or if a kernel disagrees with the scalar one.
+ */
+
+namespace {
+    const size_t TRACKS = 2000000;
+    const double MIN_TRACKS_PER_SECOND = 10e6;
+
+    typedef size_t (*FindFn)(const char*, size_t, const char*, size_t);
+
+    // Every occurrence, the way substringSearch walks the buffer
+    size_t countHits(FindFn find, const std::string& text, const std::string& needle) {
+        size_t hits = 0;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t hit = find(text.data() + pos, text.size() - pos, needle.data(), needle.size());
+            if (hit == TextSearch::npos) break;
+            hits++;
+            pos += hit + 1;
+        }
+        return hits;
+    }
+}
+
+int main() {
+    CatalogGenerator::Options options;
+    options.trackCount = TRACKS;
+    CatalogGenerator generator(options);
+
+    std::string text;
+    std::vector<std::string> titles;
+    titles.reserve(TRACKS);
+    {
+        Bench::QuietLog quiet;
+        for (size_t i = 0; i < TRACKS; ++i) {
+            CatalogGenerator::Track track = generator.track(i);
+            text += Catalog::fold(track.title);
+            text += '\x1f';
+            text += Catalog::fold(track.artist);
+            text += '\n';
+            titles.push_back(track.title);
+        }
+    }
+    std::printf("%zu tracks, %.1f MB of folded text, kernel: %s\n",
+                TRACKS, text.size() / 1e6, TextSearch::kernelName());
+
+    int failures = 0;
+    const char* const needles[] = {"zqxjv", "ight", "love", "e"};
+    for (const char* needle : needles) {
+        if (countHits(TextSearch::find, text, needle) != countHits(TextSearch::findScalar, text, needle)) {
+            failures += Bench::fail("find() disagrees with findScalar()");
+        }
+    }
+
+    // An absent needle scans everything, which is the cost of a miss
+    const std::string absent = "zqxjv";
+    double fast = Bench::secondsPerCall([&] {
+        Bench::keep(TextSearch::find(text.data(), text.size(), absent.data(), absent.size()));
+    });
+    double scalar = Bench::secondsPerCall([&] {
+        Bench::keep(TextSearch::findScalar(text.data(), text.size(), absent.data(), absent.size()));
+    });
+    double rare = Bench::secondsPerCall([&] { Bench::keep(countHits(TextSearch::find, text, "ight")); });
+
+    // What APIManager used to do per title and query
+    double copying = Bench::secondsPerCall([&] {
+        size_t hits = 0;
+        for (const auto& title : titles) {
+            std::string lower = title;
+            std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+            hits += lower.find(absent) != std::string::npos;
+        }
+        Bench::keep(hits);
+    });
+
+    double tracksPerSecond = TRACKS / fast;
+    std::printf("find (%s), needle absent: %.0f M tracks/s, %.1f GB/s, %.2f ms per scan\n",
+                TextSearch::kernelName(), tracksPerSecond / 1e6, text.size() / fast / 1e9, fast * 1e3);
+    std::printf("find (%s), \"ight\" everywhere: %.0f M tracks/s\n", TextSearch::kernelName(), TRACKS / rare / 1e6);
+    std::printf("findScalar, needle absent: %.0f M tracks/s\n", TRACKS / scalar / 1e6);
+    std::printf("copy + tolower + find per title: %.0f M titles/s\n", TRACKS / copying / 1e6);
+
+    if (tracksPerSecond < MIN_TRACKS_PER_SECOND) failures += Bench::fail("below 10M tracks/s");
+    return failures ? 1 : 0;
+}
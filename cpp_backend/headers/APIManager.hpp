@@ -2,17 +2,22 @@
 #define APIMANAGER_HPP
 
 #include "Song.hpp"
+#include "Catalog.hpp"
+#include "Playlist.hpp"
+#include "TrendingTracker.hpp"
+#include "FederatedSearch.hpp"
+#include <memory>
 #include <vector>
 #include <string>
 
 /**
  * APIManager class - Handles API calls and data fetching
- * Currently uses mock data; can be extended for real APIs
+ * Currently serves the built-in catalog; can be extended for real APIs
  */
 class APIManager {
 public:
     /**
-     * Fetch songs from API (currently mock data)
+     * Fetch songs from API (currently the built-in catalog)
      * Can be extended to call real APIs like Spotify, LastFM, etc.
      */
     static std::vector<Song*> fetchPopularSongs();
@@ -22,26 +27,50 @@ public:
      */
     static std::vector<Song*> searchSongs(const std::string& query);
 
+    typedef std::shared_ptr<FederatedSearch> SearchHandle;
+
+    /**
+     * Search the playlist, the catalog and Last.fm at once
+     * Local matches are in the handle when this returns; Last.fm results
+     * are merged in when they arrive, if that is before deadlineMs.
+     * onUpdate fires after each source (on the thread that delivered it).
+     */
+    static SearchHandle federatedSearch(const std::string& query, const Playlist& library,
+                                        int deadlineMs = DEFAULT_SEARCH_DEADLINE_MS,
+                                        FederatedSearch::UpdateCallback onUpdate = nullptr);
+
     /**
      * Search songs by artist
      */
     static std::vector<Song*> searchByArtist(const std::string& artist);
 
     /**
-     * Get trending songs
+     * Get the most played songs in a window (popular songs until anything is played)
      */
-    static std::vector<Song*> getTrendingSongs();
+    static std::vector<Song*> getTrendingSongs(TrendingTracker::Window window = TrendingTracker::DAY);
 
     /**
-     * Get recommended songs based on genre
+     * Get songs that often share saved playlists with this playlist's songs
+     * Falls back to popular songs when the saved playlists say nothing
      */
-    static std::vector<Song*> getRecommendations(const std::string& genre);
+    static std::vector<Song*> getRecommendations(const Playlist& playlist);
 
-private:
     /**
-     * Generate mock song database
+     * Get songs that often share saved playlists with one song
      */
-    static std::vector<Song*> getMockDatabase();
+    static std::vector<Song*> getSimilarSongs(const std::string& title, const std::string& artist);
+
+    /**
+     * Shared catalog behind every lookup (loaded once, on first use)
+     */
+    static Catalog& catalog();
+
+    static const int DEFAULT_SEARCH_DEADLINE_MS = 3000;
+
+private:
+    static const size_t MAX_SEARCH_RESULTS = 50;
+    static const size_t MAX_RECOMMENDATIONS = 10;
+    static const size_t MAX_TRENDING = 10;
 };
 
 #endif // APIMANAGER_HPP
@@ -0,0 +1,248 @@
+#ifndef AUDIOENGINE_HPP
+#define AUDIOENGINE_HPP
+
+#include "AudioSource.hpp"
+#include "AudioSink.hpp"
+#include "AudioRing.hpp"
+#include "Resampler.hpp"
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/**
+ * AudioEngine - Native playback: decodes on one thread, renders on another
+ * The decoder thread runs up to RING_FRAMES ahead, decoding BLOCK_FRAMES
+ * frames at a time straight into an AudioRing. The render thread takes
+ * blocks off the ring and hands them to the sink, which sets the pace.
+ * The render thread never locks or allocates (only the sink may block),
+ * so slow control calls, file I/O or UI work cannot starve the output.
+ * Blocks carry the track they belong to, their position in it and an
+ * epoch: a new track or a seek just bumps the epoch and the render thread
+ * drops older blocks. The playback position is the end of the last block
+ * the sink accepted, so it never runs ahead of the audio.
+ * Gapless: a track queued with queueNext() is prefetched and its first
+ * block pre-decoded while the current one plays; when the current source
+ * runs dry the decoder continues with the next one inside the same block
+ * stream, so the two splice sample-exactly, and the render thread moves
+ * the track, position and length over when it reaches the first block.
+ * Crossfade: with setCrossfade() above zero the last seconds of a track
+ * overlap the start of the queued one. The decoder fills each of those
+ * blocks with both (the incoming track in the slot's second half) and
+ * the render thread blends them with AudioMixer's equal-power curves
+ * into a buffer allocated up front. A track queued (or a seek landing)
+ * inside that window fades over whatever is left of the current one,
+ * from its own first frame. Tracks of different sample rates only splice
+ * gaplessly, unless an output rate is set.
+ * Every source is wrapped in a Resampler on the decoder side: with an
+ * output rate set (setOutputRate() or MUSICPLAYER_OUTPUT_RATE) all tracks
+ * reach the sink at that one rate, and setSpeed() plays faster or slower
+ * (varispeed, pitch included). Otherwise samples pass through untouched.
+ */
+class AudioEngine {
+public:
+    enum State {
+        STOPPED,
+        PLAYING,
+        PAUSED,
+        ENDED       // the source ran out; position is at the end
+    };
+
+    static constexpr size_t BLOCK_FRAMES = 1024;
+    static constexpr size_t RING_FRAMES = 16384;   // ~0.35 s at 44.1 kHz
+    static constexpr int MAX_CHANNELS = 8;
+    static constexpr int MAX_CROSSFADE_MS = 12000;
+
+    /**
+     * Constructor - starts the decoder and render threads; a null sink means
+     * the one named by MUSICPLAYER_AUDIO_SINK (a real-time NullSink by default).
+     * The output rate starts as MUSICPLAYER_OUTPUT_RATE, if set
+     */
+    explicit AudioEngine(std::unique_ptr<AudioSink> sink = nullptr);
+
+    /**
+     * Destructor - stops playback and joins both threads
+     */
+    ~AudioEngine();
+
+    AudioEngine(const AudioEngine&) = delete;
+    AudioEngine& operator=(const AudioEngine&) = delete;
+
+    /**
+     * Start playing source from the beginning, replacing the current one
+     * (at most MAX_CHANNELS channels)
+     * Returns the track's id (> 0), or 0 if it cannot be played
+     */
+    uint64_t play(std::unique_ptr<AudioSource> source);
+
+    /**
+     * Continue with source, without a gap, when the current track ends;
+     * replaces anything queued before (null just clears the queue)
+     * Returns the id the track will have, or 0 if it is too late: the
+     * current track has already been decoded to its end
+     */
+    uint64_t queueNext(std::unique_ptr<AudioSource> source);
+
+    /**
+     * Overlap consecutive tracks by this long (clamped to 0 - 12 s; 0 is
+     * plain gapless). Takes effect from the next block decoded
+     */
+    void setCrossfade(double seconds);
+    double getCrossfade() const { return crossfadeMillis.load(std::memory_order_relaxed) / 1000.0; }
+
+    /**
+     * Resample tracks started from now on to rate (0: play each at its own rate)
+     */
+    void setOutputRate(int rate);
+    int getOutputRate() const { return outputRate.load(std::memory_order_relaxed); }
+
+    /**
+     * Playback speed, pitch included (clamped to 0.5 - 2; 1 is normal).
+     * Takes effect from the next block decoded
+     */
+    void setSpeed(double speed);
+    double getSpeed() const { return speed.load(std::memory_order_relaxed); }
+
+    void pause();
+    void resume();
+
+    /**
+     * Stop and release the source
+     */
+    void stop();
+
+    /**
+     * Move the current source to frame (clamped to its length)
+     */
+    bool seek(uint64_t frame);
+
+    State getState() const { return (State)state.load(std::memory_order_acquire); }
+
+    /**
+     * Id of the track being rendered (0 when stopped)
+     */
+    uint64_t getTrack() const { return track.load(std::memory_order_acquire); }
+
+    /**
+     * Frames of the current source rendered so far
+     */
+    uint64_t getPosition() const { return position.load(std::memory_order_acquire); }
+
+    /**
+     * Length of the current source in frames (0 when stopped)
+     */
+    uint64_t getLength() const { return length.load(std::memory_order_acquire); }
+
+    /**
+     * Sample rate of the current source (0 when stopped)
+     */
+    int getSampleRate() const { return sampleRate.load(std::memory_order_acquire); }
+
+    /**
+     * Position / length in seconds
+     */
+    double getPositionSeconds() const;
+    double getLengthSeconds() const;
+
+    /**
+     * Times the render thread found the ring empty mid-track
+     */
+    uint64_t getUnderruns() const { return underruns.load(std::memory_order_relaxed); }
+
+private:
+    // Where a slot's second half, the incoming track of a crossfade, starts
+    static constexpr size_t OVERLAY_OFFSET = BLOCK_FRAMES * MAX_CHANNELS;
+
+    AudioRing ring;
+
+    // Decoder side, guarded by mutex
+    std::unique_ptr<Resampler> source;
+    uint64_t decodeTrack;
+    uint64_t decodePosition;
+    bool sourceDone;
+    std::unique_ptr<Resampler> previous;     // spliced away from, until the render thread catches up
+    std::unique_ptr<Resampler> next;
+    uint64_t nextTrack;
+    bool nextPrepared;
+    std::vector<float> preroll;              // first block of next (decoder thread only)
+    size_t prerollFrames;
+    uint64_t nextPosition;                   // frame next's own reads continue from
+    uint64_t fadeStart;                      // frame of source the crossfade under way began at
+    uint64_t fadeFrames;                     // its length; 0 when none is under way
+    uint64_t lastTrack;                      // last id handed out
+    std::mutex mutex;
+    std::condition_variable decoderWake;
+    std::atomic<bool> decoderWaiting;   // parked on a full ring
+
+    // Render side, touched only by the render thread
+    std::unique_ptr<AudioSink> sink;
+    AudioFormat sinkFormat;
+    bool sinkOpen;
+    std::vector<float> mixBuffer;     // crossfaded block
+    std::vector<float> remixBuffer;   // incoming track in the outgoing one's channel layout
+
+    // Shared
+    std::atomic<int> state;
+    std::atomic<uint64_t> track;     // being rendered
+    std::atomic<uint64_t> epoch;     // bumped whenever the source or its position changes
+    std::atomic<bool> quitting;
+    std::atomic<uint64_t> position;
+    std::atomic<uint64_t> length;
+    std::atomic<int> sampleRate;
+    std::atomic<uint64_t> underruns;
+    std::atomic<int> crossfadeMillis;
+    std::atomic<int> outputRate;
+    std::atomic<double> speed;
+
+    // Only for parking the render thread while nothing plays
+    std::mutex idleMutex;
+    std::condition_variable renderWake;
+
+    std::thread decoderThread;
+    std::thread renderThread;
+
+    /**
+     * Change state and wake the render thread if it now has work
+     */
+    void setState(State newState);
+
+    /**
+     * From the render thread: let a parked decoder refill once the ring is half empty
+     */
+    void wakeDecoder();
+
+    /**
+     * Prefetch and pre-decode the queued track, with the lock released
+     */
+    void prepareNext(std::unique_lock<std::mutex>& lock);
+
+    /**
+     * Wrap source for the current output rate and speed; null if it cannot be played
+     */
+    std::unique_ptr<Resampler> prepareSource(std::unique_ptr<AudioSource> source) const;
+
+    /**
+     * Frames the current track and the queued one overlap by (lock held);
+     * 0 until the queued track is prepared, or when the rates differ
+     */
+    uint64_t fadeLength() const;
+
+    /**
+     * Frames [frame, frame + frames) of the queued track, from the preroll
+     * where it has them (lock held). Returns how many were read
+     */
+    size_t readNext(float* out, uint64_t frame, size_t frames);
+
+    /**
+     * Make the queued track the one being decoded, continuing from
+     * position (> 0 after a crossfade) (lock held)
+     */
+    void spliceNext(uint64_t position);
+
+    void decodeLoop();
+    void renderLoop();
+};
+
+#endif // AUDIOENGINE_HPP
@@ -0,0 +1,40 @@
+#ifndef AUDIOMIXER_HPP
+#define AUDIOMIXER_HPP
+
+#include <cstddef>
+
+/**
+ * AudioMixer - Blends two streams of interleaved float frames
+ * Used by the render thread for crossfades, so nothing here locks or
+ * allocates. The equal-power gain curves are evaluated per frame with
+ * a polynomial (no sin/cos calls) and, like the mixing itself, four
+ * frames at a time with SSE2 where available; other targets get the
+ * same arithmetic in plain loops.
+ */
+class AudioMixer {
+public:
+    /**
+     * Equal-power crossfade over frames frames of channels channels:
+     *   out = from * cos(t * pi/2) + to * sin(t * pi/2),  t = start + i * step
+     * (t is clamped to [0, 1]). to has toChannels channels; when that
+     * differs it is remixed into scratch (frames * channels floats) first.
+     * out may be the same buffer as from.
+     */
+    static void crossfade(const float* from, const float* to, int toChannels, float* out, int channels,
+                          size_t frames, float start, float step, float* scratch);
+
+    /**
+     * Convert frames frames from inChannels to outChannels channels:
+     * mono is copied to every channel, anything to mono is averaged,
+     * otherwise channels are matched up by index (extra ones dropped,
+     * missing ones silent)
+     */
+    static void remix(const float* in, int inChannels, float* out, int outChannels, size_t frames);
+
+    /**
+     * sin(x * pi/2) for x in [0, 1], to within 2e-7
+     */
+    static float equalPowerGain(float x);
+};
+
+#endif // AUDIOMIXER_HPP
@@ -0,0 +1,128 @@
+#ifndef AUDIORING_HPP
+#define AUDIORING_HPP
+
+#include "AudioSource.hpp"
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * AudioRing - Wait-free single-producer/single-consumer queue of PCM blocks
+ * Hands decoded audio from the decoder thread to the render thread with
+ * no locks and no allocation after construction. Storage is a ring of
+ * fixed-size slots (blockFrames frames of up to maxChannels channels);
+ * the producer decodes straight into a slot and publishes it with its
+ * metadata, the consumer reads it in place and releases it.
+ * Every call finishes in a bounded number of steps: a full or empty ring
+ * returns null and the caller decides whether to wait.
+ * The two indices live on their own cache lines, and each side keeps a
+ * private copy of the other's index so the common case touches no shared
+ * line at all.
+ */
+class AudioRing {
+public:
+    static const size_t CACHE_LINE = 64;
+
+    /**
+     * What the producer says about a block
+     */
+    struct BlockInfo {
+        uint64_t track;       // identifies the source
+        uint64_t epoch;       // bumped by seeks and track changes; older blocks are stale
+        uint64_t position;    // frame of the source the block starts at
+        uint64_t length;      // frames in the whole source
+        AudioFormat format;
+        uint32_t frames;
+        bool endOfTrack;      // no samples; the source is exhausted
+        int mixChannels;      // > 0: the slot also holds the incoming track of a crossfade
+        uint64_t fadePosition; // frame of the crossfade the block starts at
+        uint64_t fadeLength;  // frames in the whole crossfade
+    };
+
+    /**
+     * Ring of at least capacityFrames frames, in blocks of blockFrames
+     * (the block count is rounded up to a power of two)
+     */
+    AudioRing(size_t capacityFrames, size_t blockFrames, int maxChannels);
+
+    AudioRing(const AudioRing&) = delete;
+    AudioRing& operator=(const AudioRing&) = delete;
+
+    // ---- Producer side (one thread) ----
+
+    /**
+     * Slot to fill (blockFrames * maxChannels floats), or null if the ring is full
+     */
+    float* beginWrite() {
+        size_t head = writeIndex.load(std::memory_order_relaxed);
+        if (head - cachedReadIndex == slots) {
+            cachedReadIndex = readIndex.load(std::memory_order_acquire);
+            if (head - cachedReadIndex == slots) return nullptr;
+        }
+        return base + (head & mask) * slotSamples;
+    }
+
+    /**
+     * Publish the slot from beginWrite()
+     */
+    void commitWrite(const BlockInfo& info) {
+        size_t head = writeIndex.load(std::memory_order_relaxed);
+        infos[head & mask] = info;
+        writeIndex.store(head + 1, std::memory_order_release);
+    }
+
+    // ---- Consumer side (one thread) ----
+
+    /**
+     * Oldest published block and its metadata, or null if the ring is empty
+     */
+    const float* beginRead(BlockInfo& info) {
+        size_t tail = readIndex.load(std::memory_order_relaxed);
+        if (tail == cachedWriteIndex) {
+            cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+            if (tail == cachedWriteIndex) return nullptr;
+        }
+        info = infos[tail & mask];
+        return base + (tail & mask) * slotSamples;
+    }
+
+    /**
+     * Release the block from beginRead() back to the producer
+     */
+    void commitRead() {
+        readIndex.store(readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // ---- Either side ----
+
+    /**
+     * Blocks published and not yet released (a snapshot)
+     */
+    size_t size() const {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+
+    size_t getBlockCount() const { return slots; }
+    size_t getBlockFrames() const { return blockFrames; }
+    size_t getCapacityFrames() const { return slots * blockFrames; }
+    int getMaxChannels() const { return maxChannels; }
+
+private:
+    size_t blockFrames;
+    int maxChannels;
+    size_t slots;
+    size_t mask;
+    size_t slotSamples;
+    std::vector<float> samples;
+    float* base;                // first slot, cache-line aligned within samples
+    std::vector<BlockInfo> infos;
+
+    alignas(CACHE_LINE) std::atomic<size_t> writeIndex;   // next slot to fill
+    alignas(CACHE_LINE) size_t cachedReadIndex;           // producer's view of readIndex
+    alignas(CACHE_LINE) std::atomic<size_t> readIndex;    // next slot to drain
+    alignas(CACHE_LINE) size_t cachedWriteIndex;          // consumer's view of writeIndex
+    char padding[CACHE_LINE - sizeof(size_t)];            // keep whatever follows off that line
+};
+
+#endif // AUDIORING_HPP
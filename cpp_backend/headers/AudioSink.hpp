@@ -0,0 +1,94 @@
+#ifndef AUDIOSINK_HPP
+#define AUDIOSINK_HPP
+
+#include "AudioSource.hpp"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <memory>
+#include <chrono>
+
+/**
+ * AudioSink - Where the render thread sends finished PCM
+ * A sink consumes interleaved float frames at its own pace: a device
+ * blocks in write() until it has room, a file takes everything at once.
+ * Only the render thread calls open/write/close.
+ */
+class AudioSink {
+public:
+    virtual ~AudioSink() {}
+
+    /**
+     * Prepare for frames of this format (called again when the format changes)
+     */
+    virtual bool open(const AudioFormat& format) = 0;
+
+    /**
+     * Consume frames frames; false on an unrecoverable error
+     */
+    virtual bool write(const float* frames, size_t count) = 0;
+
+    /**
+     * Flush and release; open() may be called again afterwards
+     */
+    virtual void close() = 0;
+
+    /**
+     * Sink from a spec (as in MUSICPLAYER_AUDIO_SINK):
+     *   "null"           discard, paced like a real-time device (default)
+     *   "null:fast"      discard as fast as the engine renders
+     *   "wav:<path>"     16-bit PCM WAV file, as fast as the engine renders
+     *   "wavf:<path>"    32-bit float WAV file
+     * Returns null if the spec is not understood
+     */
+    static std::unique_ptr<AudioSink> create(const std::string& spec);
+};
+
+/**
+ * NullSink - Discards audio, optionally at the speed a device would play it
+ */
+class NullSink : public AudioSink {
+public:
+    explicit NullSink(bool realTime = true);
+
+    bool open(const AudioFormat& format) override;
+    bool write(const float* frames, size_t count) override;
+    void close() override {}
+
+private:
+    bool realTime;
+    AudioFormat format;
+    std::chrono::steady_clock::time_point deadline;   // when the frames written so far have "played"
+};
+
+/**
+ * WavFileSink - Records the rendered stream to a WAV file
+ * A WAV file holds one format, so the first open() fixes it. Tracks with
+ * another channel count are remixed to it (AudioMixer::remix); a later
+ * open() at another sample rate is refused, keeping what was recorded
+ * (set an output rate to record tracks of mixed rates). The header sizes
+ * are filled in on close().
+ */
+class WavFileSink : public AudioSink {
+public:
+    explicit WavFileSink(const std::string& path, bool floatSamples = false);
+    ~WavFileSink() override;
+
+    bool open(const AudioFormat& format) override;
+    bool write(const float* frames, size_t count) override;
+    void close() override;
+
+private:
+    std::string path;
+    bool floatSamples;
+    AudioFormat format;         // of the file
+    int inputChannels;          // of the stream being written
+    std::ofstream file;
+    uint64_t dataBytes;
+    std::vector<float> remixed;
+    std::vector<int16_t> converted;
+
+    void writeHeader();
+};
+
+#endif // AUDIOSINK_HPP
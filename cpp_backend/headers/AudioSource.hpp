@@ -0,0 +1,76 @@
+#ifndef AUDIOSOURCE_HPP
+#define AUDIOSOURCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Sample rate and channel count of a stream of interleaved float frames
+ */
+struct AudioFormat {
+    int sampleRate;
+    int channels;
+
+    bool operator==(const AudioFormat& other) const {
+        return sampleRate == other.sampleRate && channels == other.channels;
+    }
+    bool operator!=(const AudioFormat& other) const { return !(*this == other); }
+};
+
+/**
+ * AudioSource - Something the audio engine can pull PCM from
+ * Produces interleaved float frames in [-1, 1]. Once handed to the
+ * engine a source is only used under the engine's lock: the decoder
+ * thread reads from it and control calls seek it, so it needs no locking
+ * of its own.
+ */
+class AudioSource {
+public:
+    virtual ~AudioSource() {}
+
+    virtual AudioFormat getFormat() const = 0;
+
+    /**
+     * Length in frames
+     */
+    virtual uint64_t getLength() const = 0;
+
+    /**
+     * Read up to frames frames into out (frames * channels floats)
+     * Returns how many were read; 0 at the end
+     */
+    virtual size_t read(float* out, size_t frames) = 0;
+
+    /**
+     * Continue reading from frame (clamped to the length)
+     */
+    virtual bool seek(uint64_t frame) = 0;
+
+    /**
+     * Warm whatever the first read() needs (e.g. pull the start of the file
+     * into the page cache); called on the decoder thread ahead of playback
+     */
+    virtual void prefetch() {}
+};
+
+/**
+ * SilenceSource - Digital silence of a given length
+ * Stands in for songs that have no audio file, so their playback clock
+ * still comes from rendered samples.
+ */
+class SilenceSource : public AudioSource {
+public:
+    SilenceSource(const AudioFormat& format, uint64_t length);
+
+    AudioFormat getFormat() const override { return format; }
+    uint64_t getLength() const override { return length; }
+    size_t read(float* out, size_t frames) override;
+    bool seek(uint64_t frame) override;
+
+private:
+    AudioFormat format;
+    uint64_t length;
+    uint64_t position;
+};
+
+#endif // AUDIOSOURCE_HPP
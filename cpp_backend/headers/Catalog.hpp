@@ -0,0 +1,242 @@
+#ifndef CATALOG_HPP
+#define CATALOG_HPP
+
+#include "Song.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <shared_mutex>
+#include <cstdint>
+
+/**
+ * Catalog - Long-lived in-memory track catalog
+ * Titles and artists are folded once at insert time (Unicode case
+ * folding, NFKC, diacritics stripped) and split into words; each word
+ * maps to a sorted posting list of track ids, so a query only touches
+ * the tracks that contain its words.
+ * Distinct words are also indexed by trigram for typo-tolerant lookups.
+ * Ranked search scores matches with BM25 per field (plus an optional
+ * popularity prior) and keeps only the best k in a heap.
+ * The folded fields are also kept back to back in one buffer so
+ * substring queries the word index cannot answer scan it with the
+ * vectorised TextSearch kernel.
+ * Safe for concurrent searches; inserts take an exclusive lock.
+ */
+class Catalog {
+public:
+    typedef uint32_t TrackId;
+
+    enum Field {
+        TITLE,
+        ARTIST,
+        ANY     // title or artist
+    };
+
+    struct Track {
+        std::string title;
+        std::string artist;
+        int duration;
+        long long popularity;   // listeners / plays; ranks otherwise equal matches
+        std::string foldedTitle;
+        std::string foldedArtist;
+    };
+
+    Catalog();
+
+    Catalog(const Catalog&) = delete;
+    Catalog& operator=(const Catalog&) = delete;
+
+    /**
+     * Fuzzy match: edit distance summed over the query's words
+     */
+    struct FuzzyMatch {
+        TrackId id;
+        int distance;
+    };
+
+    /**
+     * Ranked match: BM25 relevance plus the popularity prior
+     */
+    struct ScoredMatch {
+        TrackId id;
+        float score;
+        bool allWords;      // the track has every query word (false for partial matches)
+    };
+
+    // Popularity weight for rankedSearch that orders near-equal matches
+    // without outranking a clearly better title
+    static constexpr float POPULARITY_PRIOR = 0.2f;
+
+    /**
+     * Add a track and index it; returns its id
+     */
+    TrackId add(const std::string& title, const std::string& artist, int duration, long long popularity = 0);
+
+    /**
+     * Number of tracks
+     */
+    size_t size() const;
+
+    /**
+     * Drop every track and the index
+     */
+    void clear();
+
+    /**
+     * Find tracks whose field contains every word of the query
+     * The last word also matches as a prefix ("blind" finds "Blinding
+     * Lights") unless the query ends with a space. Ids come back in
+     * insertion order, at most limit of them.
+     */
+    std::vector<TrackId> search(const std::string& query, Field field, size_t limit = 50) const;
+
+    /**
+     * Relevance-ranked search: tracks containing any query word, scored
+     * with BM25 per field (title words count more than artist words for
+     * ANY). Tracks with every word come first (allWords); partial matches
+     * fill the rest of limit. A query word the catalog lacks makes every
+     * match partial. popularityWeight is a fraction of what a query word
+     * scores as a one-word field: the most popular track gets that much on
+     * top (log scale), so a small weight only breaks near-ties.
+     */
+    std::vector<ScoredMatch> rankedSearch(const std::string& query, Field field, size_t limit = 50,
+                                          float popularityWeight = 0.0f) const;
+
+    /**
+     * Substring search: tracks whose field contains the query anywhere
+     * (case-insensitive, "ight" finds "Blinding Lights"). Scans every
+     * track, so it is the fallback when no word matches. Ids come back in
+     * insertion order, at most limit of them.
+     */
+    std::vector<TrackId> substringSearch(const std::string& query, Field field, size_t limit = 50) const;
+
+    /**
+     * Typo-tolerant search: every query word must match a word of the
+     * field within a small edit distance (1 for 3-5 letters, 2 for longer
+     * words, exact for shorter). Best matches first: lowest total
+     * distance, then most popular.
+     */
+    std::vector<FuzzyMatch> fuzzySearch(const std::string& query, Field field, size_t limit = 50) const;
+
+    /**
+     * Levenshtein distance, bit-parallel (Myers) when a is at most 64 bytes
+     * Returns maxDistance + 1 as soon as the distance must exceed maxDistance
+     */
+    static int editDistance(const std::string& a, const std::string& b, int maxDistance);
+
+    /**
+     * Get a track by id (id must come from this catalog)
+     */
+    Track get(TrackId id) const;
+
+    /**
+     * Copy a track into a caller-owned Song
+     */
+    Song* toSong(TrackId id) const;
+
+    /**
+     * Fold text for matching: the search key every catalog and library
+     * lookup compares (TextFold with diacritics stripped, so "beyonce"
+     * finds "Beyoncé")
+     */
+    static std::string fold(const std::string& text);
+
+    /**
+     * Split folded text into words (runs of letters, digits and non-ASCII bytes)
+     */
+    static std::vector<std::string> tokenize(const std::string& folded);
+
+private:
+    // Per-track numbers read while scoring, kept apart from the strings
+    struct TrackStats {
+        uint8_t titleLength;    // words, capped at 255
+        uint8_t artistLength;
+        uint8_t repeats;        // bit per field (1 << TITLE, 1 << ARTIST) with a repeated word
+        float logPopularity;
+    };
+
+    static constexpr size_t POSTING_BLOCK = 128;
+
+    // Summary of POSTING_BLOCK consecutive postings of one word
+    struct PostingBlock {
+        uint8_t titleLength;    // shortest fields in the block
+        uint8_t artistLength;
+        uint8_t uses;           // most times a track has the word
+        float titlePerUse;      // fewest field words per use of the word
+        float artistPerUse;
+        float logPopularity;    // highest
+    };
+
+    /**
+     * Sorted track ids, how often each track has the word (capped at 255)
+     * and a summary of every block of them, so ranked search can bound a
+     * whole block and skip it without scoring its tracks
+     */
+    struct Postings : std::vector<TrackId> {
+        std::vector<uint8_t> uses;
+        std::vector<PostingBlock> blocks;
+    };
+    typedef std::map<std::string, Postings> Index; // ordered for prefix ranges
+
+    std::vector<Track> tracks;
+    std::vector<TrackStats> stats;
+    uint64_t titleWordTotal;
+    uint64_t artistWordTotal;
+    std::unordered_map<std::string, int> titleRepeats;  // words used more than once in a title: most uses
+    std::unordered_map<std::string, int> artistRepeats;
+    float maxLogPopularity;
+
+    // Every track as "title\x1fartist\n" (folded), and where each starts
+    std::string foldedText;
+    std::vector<size_t> textOffsets;
+
+    Index titleIndex;
+    Index artistIndex;
+    Index anyIndex;
+
+    // Distinct words (keys of anyIndex, stable map nodes) and the ids of
+    // the words containing each padded trigram
+    std::vector<const std::string*> vocabulary;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigramIndex;
+
+    mutable std::shared_mutex mutex;
+
+    const Index& indexFor(Field field) const;
+
+    /**
+     * Append id to the posting list of every word (ids only grow, so lists stay sorted)
+     */
+    void indexWords(Index& index, const std::vector<std::string>& words, TrackId id);
+
+    /**
+     * Append id to one list (or count another use if it is already last),
+     * updating the block summary
+     */
+    void appendPosting(Postings& list, TrackId id);
+
+    /**
+     * Add a new distinct word to the trigram index
+     */
+    void indexVocabulary(const std::string& word);
+
+    /**
+     * Vocabulary words within maxDistance of word (trigram candidates,
+     * then verified), with their distances
+     */
+    std::vector<std::pair<const std::string*, int>> similarWords(const std::string& word, int maxDistance) const;
+
+    /**
+     * Merge the posting lists of every word starting with prefix
+     * (sorted, no duplicates, at most limit ids)
+     */
+    static void prefixMerge(const Index& index, const std::string& prefix, size_t limit,
+                            std::vector<TrackId>& results);
+
+    /**
+     * Check a folded field for a word starting with prefix
+     */
+    static bool hasWordWithPrefix(const std::string& folded, const std::string& prefix);
+};
+
+#endif // CATALOG_HPP
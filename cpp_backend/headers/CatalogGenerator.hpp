@@ -0,0 +1,141 @@
+#ifndef CATALOGGENERATOR_HPP
+#define CATALOGGENERATOR_HPP
+
+#include "Catalog.hpp"
+#include "Playlist.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * CatalogGenerator - Deterministic synthetic catalogs and playlists
+ * Track i is a pure function of (seed, i), so any prefix of a catalog
+ * can be regenerated and millions of tracks streamed without a table.
+ * Tracks come out in popularity order (listeners fall off as a power
+ * law). Each track's artist is drawn from a Zipf distribution, and its
+ * title is 1-8 words drawn Zipfian from the artist's language, plus
+ * made-up names for a long tail of rare words.
+ * Some artists sing in accented Latin, Cyrillic, Greek, Japanese or
+ * Korean. Playlists are themed: each mostly draws popular tracks of
+ * one genre, so co-occurrence has structure to learn from.
+ * Same seed, same output (on the same platform's libm).
+ */
+class CatalogGenerator {
+public:
+    struct Options {
+        uint64_t seed;
+        size_t trackCount;
+        size_t artistCount;     // 0: one artist per TRACKS_PER_ARTIST tracks
+        double artistSkew;      // Zipf exponent of artist popularity
+        double trackSkew;       // Zipf exponent of track popularity (and playlist picks)
+        double unicodeShare;    // share of artists outside plain English
+        int genres;
+
+        Options();
+    };
+
+    struct Track {
+        std::string title;
+        std::string artist;
+        int duration;           // seconds
+        long long popularity;   // listeners
+    };
+
+    static const size_t TRACKS_PER_ARTIST = 8;
+
+    explicit CatalogGenerator(const Options& options = Options());
+
+    const Options& getOptions() const { return options; }
+
+    /**
+     * Track index (0 is the most popular; index must be < trackCount)
+     */
+    Track track(size_t index) const;
+
+    /**
+     * Add every track to catalog, most popular first
+     */
+    void fillCatalog(Catalog& catalog) const;
+
+    /**
+     * Track indices of playlist number `playlist` (distinct, at most length)
+     */
+    std::vector<size_t> playlistTracks(size_t playlist, size_t length) const;
+
+    /**
+     * Same as a Playlist of new Songs (caller owns)
+     */
+    Playlist* buildPlaylist(size_t playlist, size_t length) const;
+
+    /**
+     * Write tracks in the saved-playlist JSON format (FileManager)
+     */
+    bool writeJson(const std::string& path, const std::string& name, const std::vector<size_t>& tracks) const;
+
+    /**
+     * Write the whole catalog in the saved-playlist JSON format, streaming
+     */
+    bool writeJson(const std::string& path, const std::string& name) const;
+
+    /**
+     * Write tracks / the whole catalog as an extended M3U playlist
+     */
+    bool writeM3U(const std::string& path, const std::vector<size_t>& tracks) const;
+    bool writeM3U(const std::string& path) const;
+
+    /**
+     * Options from a "tracks[:seed]" spec (as in MUSICPLAYER_SYNTHETIC_CATALOG)
+     * Returns false if the spec is not understood
+     */
+    static bool parseSpec(const std::string& spec, Options& options);
+
+private:
+    /**
+     * Rejection-inversion Zipf sampler over 1..n (Hörmann & Derflinger):
+     * constant time per draw, no table
+     */
+    class ZipfSampler {
+    public:
+        ZipfSampler(size_t n, double exponent);
+        size_t sample(uint64_t& state) const;
+
+    private:
+        double n;
+        double exponent;
+        double hIntegralX1;
+        double hIntegralN;
+        double s;
+
+        double h(double x) const;
+        double hIntegral(double x) const;
+        double hIntegralInverse(double x) const;
+    };
+
+    enum Format {
+        JSON,
+        M3U
+    };
+
+    struct Artist {
+        std::string name;
+        int language;
+        int genre;
+    };
+
+    Options options;
+    ZipfSampler artists;
+    ZipfSampler tracks;
+    std::vector<ZipfSampler> vocabularies;   // per language
+
+    Artist artist(size_t rank) const;
+    size_t artistRank(size_t index) const;
+    std::string title(int language, uint64_t& state) const;
+
+    /**
+     * Write the given tracks (or the whole catalog if indices is null)
+     */
+    bool write(const std::string& path, Format format, const std::string& name,
+               const std::vector<size_t>* indices) const;
+};
+
+#endif // CATALOGGENERATOR_HPP
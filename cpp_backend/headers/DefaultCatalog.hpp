@@ -0,0 +1,38 @@
+// Generated by tools/generate-default-catalog.ps1 from data/default_catalog.csv.
+// Do not edit; change the CSV and rebuild.
+#ifndef DEFAULTCATALOG_HPP
+#define DEFAULTCATALOG_HPP
+
+#include <string_view>
+#include <cstddef>
+
+/**
+ * DefaultCatalog - Built-in songs, most popular first
+ * Constant tables in read-only data: nothing is constructed or
+ * allocated until a caller copies an entry out.
+ */
+namespace DefaultCatalog {
+    struct Entry {
+        std::string_view title;
+        std::string_view artist;
+        int duration;       // seconds
+        bool inLibrary;     // part of the starting playlist
+    };
+
+    inline constexpr Entry ENTRIES[] = {
+        {"Blinding Lights", "The Weeknd", 200, true},
+        {"Shape of You", "Ed Sheeran", 233, true},
+        {"Someone Like You", "Adele", 285, true},
+        {"Bad Guy", "Billie Eilish", 194, true},
+        {"Perfect", "Ed Sheeran", 263, true},
+        {"Uptown Funk", "Bruno Mars", 269, false},
+        {"Levitating", "Dua Lipa", 203, false},
+        {"Anti-Hero", "Taylor Swift", 228, false},
+        {"Heat Waves", "Glass Animals", 239, false},
+        {"As It Was", "Harry Styles", 183, false},
+    };
+
+    inline constexpr size_t SIZE = sizeof(ENTRIES) / sizeof(ENTRIES[0]);
+}
+
+#endif // DEFAULTCATALOG_HPP
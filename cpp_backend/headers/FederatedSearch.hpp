@@ -0,0 +1,150 @@
+#ifndef FEDERATEDSEARCH_HPP
+#define FEDERATEDSEARCH_HPP
+
+#include "Song.hpp"
+#include <vector>
+#include <string>
+#include <functional>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/**
+ * FederatedSearch - Handle to one search across several sources
+ * Each source delivers its ranked list once; lists are merged by
+ * normalized title + artist and ranked by reciprocal rank fusion (a song
+ * several sources agree on rises to the top). Results can be read at any
+ * time; sources that have not answered by the deadline are dropped.
+ */
+class FederatedSearch {
+public:
+    enum Source {
+        LIBRARY,    // the user's playlist
+        CATALOG,    // built-in catalog
+        LASTFM,
+        SOURCE_COUNT
+    };
+
+    enum SourceStatus {
+        PENDING,
+        COMPLETED,
+        FAILED,
+        TIMED_OUT   // not answered by the deadline (or cancelled)
+    };
+
+    /**
+     * One merged song
+     */
+    struct Result {
+        std::string title;
+        std::string artist;
+        int duration;
+        unsigned sources;   // bit (1 << Source) per source that returned it
+        double score;
+    };
+
+    /**
+     * Called after each source delivers (on the thread that delivered it)
+     */
+    typedef std::function<void(FederatedSearch& search, Source source)> UpdateCallback;
+
+    FederatedSearch(const std::string& query, int deadlineMs, UpdateCallback onUpdate = nullptr);
+
+    /**
+     * Destructor - runs the cancel hook if sources are still pending
+     */
+    ~FederatedSearch();
+
+    FederatedSearch(const FederatedSearch&) = delete;
+    FederatedSearch& operator=(const FederatedSearch&) = delete;
+
+    /**
+     * Block until every source answered or the deadline passed
+     * Returns true if every source answered
+     */
+    bool wait();
+
+    /**
+     * Stop waiting for pending sources
+     */
+    void cancel();
+
+    /**
+     * Check if nothing is left to wait for
+     */
+    bool isDone() const;
+
+    /**
+     * Ranked snapshot of everything merged so far (at most limit results)
+     */
+    std::vector<Result> getResults(size_t limit = 50) const;
+
+    /**
+     * Get status of one source / its error message
+     */
+    SourceStatus getStatus(Source source) const;
+    std::string getError(Source source) const;
+
+    const std::string& getQuery() const { return query; }
+
+    /**
+     * Deliver a source's results, best first (ignored after the deadline)
+     * The songs stay owned by the caller
+     */
+    void deliver(Source source, const std::vector<Song*>& songs);
+
+    /**
+     * Report a failed source
+     */
+    void fail(Source source, const std::string& message);
+
+    /**
+     * Set the hook that aborts outstanding work on cancel or timeout
+     */
+    void setCancelHook(std::function<void()> hook);
+
+    /**
+     * Normalize folded text (Catalog::fold) for matching across sources:
+     * words separated by single spaces, punctuation dropped
+     */
+    static std::string normalize(const std::string& text);
+
+private:
+    struct Entry {
+        std::string title;
+        std::string artist;
+        int duration;
+        unsigned sources;
+        double score;
+        size_t arrival;     // breaks score ties: earlier sources first
+    };
+
+    std::string query;
+    std::chrono::steady_clock::time_point deadline;
+    UpdateCallback onUpdate;
+    std::function<void()> cancelHook;
+
+    SourceStatus status[SOURCE_COUNT];
+    std::string errors[SOURCE_COUNT];
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, size_t> entryIndex; // normalized title \x1f artist
+
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+
+    bool allAnsweredLocked() const;
+
+    /**
+     * Close pending sources as TIMED_OUT once the deadline passed
+     * Returns true if something was closed
+     */
+    bool expireLocked();
+
+    /**
+     * Run the cancel hook outside the lock (at most once)
+     */
+    void runCancelHook();
+};
+
+#endif // FEDERATEDSEARCH_HPP
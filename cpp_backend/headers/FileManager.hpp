@@ -38,9 +38,21 @@ public:
 
     /**
      * Get default playlists directory
+     * The data directories live under <home>/Music/MusicPlayer, where home
+     * is USERPROFILE, else HOME, else the working directory
      */
     static std::string getPlaylistsDirectory();
 
+    /**
+     * Get directory for cached API responses
+     */
+    static std::string getCacheDirectory();
+
+    /**
+     * Get directory for the scrobble journal
+     */
+    static std::string getScrobbleDirectory();
+
 private:
     /**
      * Ensure playlists directory exists
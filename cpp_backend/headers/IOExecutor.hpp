@@ -0,0 +1,82 @@
+#ifndef IOEXECUTOR_HPP
+#define IOEXECUTOR_HPP
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * IOExecutor - Small fixed pool of worker threads for blocking I/O
+ * Used to run network requests off the caller's (UI) thread
+ */
+class IOExecutor {
+public:
+    typedef std::function<void()> Task;
+
+    /**
+     * LOW tasks only run when no NORMAL task is waiting
+     */
+    enum Priority {
+        NORMAL,
+        LOW
+    };
+
+    /**
+     * Constructor - starts the worker threads
+     */
+    explicit IOExecutor(int threadCount);
+
+    /**
+     * Destructor - stops and joins workers
+     */
+    ~IOExecutor();
+
+    IOExecutor(const IOExecutor&) = delete;
+    IOExecutor& operator=(const IOExecutor&) = delete;
+
+    /**
+     * Queue a task; returns false once shutdown has started
+     * onDropped runs instead of the task if shutdown() discards it
+     * while it is still queued (on the thread calling shutdown())
+     */
+    bool submit(Task task, Priority priority = NORMAL, Task onDropped = nullptr);
+
+    /**
+     * Stop accepting tasks, drop queued ones and join workers
+     */
+    void shutdown();
+
+    /**
+     * Number of worker threads
+     */
+    int getThreadCount() const { return threadCount; }
+
+    /**
+     * Number of tasks waiting for a worker
+     */
+    size_t getQueuedCount() const;
+
+private:
+    struct Job {
+        Task run;
+        Task onDropped;
+    };
+
+    std::vector<std::thread> workers;
+    int threadCount;
+    std::deque<Job> queue;
+    std::deque<Job> lowQueue;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    /**
+     * Worker thread main loop
+     */
+    void workerLoop();
+};
+
+#endif // IOEXECUTOR_HPP
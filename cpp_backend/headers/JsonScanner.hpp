@@ -0,0 +1,97 @@
+#ifndef JSONSCANNER_HPP
+#define JSONSCANNER_HPP
+
+#include <string>
+#include <string_view>
+
+/**
+ * JsonScanner - On-demand (pull) JSON reader
+ * Walks the input once, left to right, without building a DOM. The caller
+ * navigates objects/arrays and either reads or skips each value.
+ * String scanning uses SSE2 when available.
+ */
+class JsonScanner {
+public:
+    JsonScanner(const char* data, size_t length);
+    explicit JsonScanner(const std::string& json);
+
+    /**
+     * Get next non-whitespace character without consuming it (0 at end)
+     */
+    char peek();
+
+    /**
+     * Consume '{' - returns false if the next value is not an object
+     */
+    bool enterObject();
+
+    /**
+     * Read the next key of the current object and consume the ':'
+     * Returns false once '}' is consumed (or on error)
+     * The view stays valid until the next call that reads a key or string
+     */
+    bool nextKey(std::string_view& key);
+
+    /**
+     * Consume '[' - returns false if the next value is not an array
+     */
+    bool enterArray();
+
+    /**
+     * Move to the next element of the current array
+     * Returns false once ']' is consumed (or on error)
+     */
+    bool nextElement();
+
+    /**
+     * Read a string value (escapes decoded)
+     */
+    bool readString(std::string& out);
+
+    /**
+     * Read an integer; quoted numbers ("200") are accepted too since
+     * Last.fm sends most counters as strings. Fractions are truncated.
+     */
+    bool readInteger(long long& out);
+
+    /**
+     * Skip the next value whatever its type
+     */
+    bool skipValue();
+
+    /**
+     * Check if a syntax error was hit
+     */
+    bool failed() const { return error; }
+
+    /**
+     * Bytes consumed so far
+     */
+    size_t position() const { return (size_t)(cur - begin); }
+
+private:
+    const char* begin;
+    const char* cur;
+    const char* end;
+    bool error;
+    std::string scratch; // decoded keys that contained escapes
+
+    void skipWhitespace();
+    bool fail();
+
+    /**
+     * Scan a string starting at the opening quote; leaves cur after the
+     * closing quote. Sets hasEscapes if a backslash was seen.
+     */
+    bool scanString(const char*& contentStart, const char*& contentEnd, bool& hasEscapes);
+
+    /**
+     * Decode escape sequences of [start, finish) into out
+     */
+    bool decodeString(const char* start, const char* finish, std::string& out);
+
+    bool skipNumber();
+    bool skipLiteral();
+};
+
+#endif // JSONSCANNER_HPP
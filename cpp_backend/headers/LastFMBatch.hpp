@@ -0,0 +1,123 @@
+#ifndef LASTFMBATCH_HPP
+#define LASTFMBATCH_HPP
+
+#include "Song.hpp"
+#include <vector>
+#include <string>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/**
+ * LastFMBatch - Handle to a fan-out of Last.fm lookups
+ * One lookup per query (country, artist, track name ...) runs with
+ * bounded parallelism; results stream back as each one completes and
+ * whatever finished before the deadline can be collected
+ */
+class LastFMBatch {
+public:
+    enum ItemStatus {
+        PENDING,
+        COMPLETED,
+        FAILED,
+        TIMED_OUT,  // not finished by the deadline
+        CANCELLED
+    };
+
+    /**
+     * Result for one query of the batch
+     */
+    struct Item {
+        std::string query;
+        ItemStatus status;
+        std::vector<Song*> songs;
+        std::string error;
+        long long elapsedMs;
+    };
+
+    /**
+     * Called once per finished query, on the worker thread that ran it
+     * The songs are still owned by the batch (copy what you need)
+     */
+    typedef std::function<void(size_t index, const Item& item)> ItemCallback;
+
+    LastFMBatch(const std::vector<std::string>& queries, int deadlineMs, ItemCallback onItem = nullptr);
+
+    /**
+     * Destructor - deletes results that were never collected
+     */
+    ~LastFMBatch();
+
+    LastFMBatch(const LastFMBatch&) = delete;
+    LastFMBatch& operator=(const LastFMBatch&) = delete;
+
+    /**
+     * Block until every query finished or the deadline passed
+     * (timeoutMs < 0 waits up to the deadline only)
+     * Returns true if every query finished
+     */
+    bool wait(int timeoutMs = -1);
+
+    /**
+     * Stop starting new queries; finished results stay collectable
+     */
+    void cancel();
+
+    /**
+     * Check if nothing is left to wait for (all finished, deadline passed or cancelled)
+     */
+    bool isDone() const;
+
+    /**
+     * Number of queries in the batch / number already finished
+     */
+    size_t size() const;
+    size_t getFinishedCount() const;
+
+    /**
+     * Take ownership of the results, one Item per query in input order
+     * Unfinished queries are reported as TIMED_OUT or CANCELLED;
+     * caller must delete the returned songs
+     */
+    std::vector<Item> takeResults();
+
+    /**
+     * Claim the next query to run; false once none are left, the
+     * deadline passed or the batch was cancelled
+     */
+    bool claimNext(size_t& index, std::string& query);
+
+    /**
+     * Report a query's outcome (results after the deadline are discarded)
+     */
+    void complete(size_t index, std::vector<Song*> songs, long long elapsedMs);
+    void fail(size_t index, const std::string& message, long long elapsedMs);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<Item> items;
+    size_t nextIndex;
+    size_t finishedCount;
+    bool closed;
+    Clock::time_point deadline;
+    ItemCallback callback;
+    mutable std::mutex mutex;
+    std::condition_variable progress;
+
+    /**
+     * Mark the batch closed once the deadline has passed (lock held)
+     */
+    bool checkDeadlineLocked();
+
+    /**
+     * Close the batch and mark unfinished items (lock held)
+     */
+    void closeLocked(ItemStatus reason);
+
+    void finish(size_t index, ItemStatus finalStatus, std::vector<Song*>& songs,
+                const std::string& message, long long elapsedMs);
+};
+
+#endif // LASTFMBATCH_HPP
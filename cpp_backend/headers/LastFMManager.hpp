@@ -2,9 +2,40 @@
 #define LASTFMMANAGER_HPP
 
 #include "Song.hpp"
+#include "ResponseCache.hpp"
+#include "LastFMRequest.hpp"
+#include "LastFMBatch.hpp"
+#include "IOExecutor.hpp"
+#include "RateLimiter.hpp"
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * One track entry of a Last.fm track list response
+ * duration is in seconds (0 when Last.fm does not report it)
+ */
+struct LastFMTrack {
+    std::string title;
+    std::string artist;
+    std::string mbid;
+    int duration;
+    long long listeners;
+};
+
+/**
+ * One play to report through track.scrobble
+ * timestamp is the UTC unix time the track started playing
+ */
+struct Scrobble {
+    std::string artist;
+    std::string track;
+    long long timestamp;
+    int duration;
+};
 
 /**
  * LastFMManager - Integrates with Last.fm API
@@ -13,6 +44,52 @@
  */
 class LastFMManager {
 public:
+    /**
+     * Counters for request coalescing (single-flight)
+     * requests = every track lookup, upstreamCalls = lookups that did the work,
+     * coalesced = lookups that joined an identical in-flight request
+     */
+    struct CoalescingStats {
+        uint64_t requests;
+        uint64_t upstreamCalls;
+        uint64_t coalesced;
+
+        double ratio() const { return requests ? (double)coalesced / requests : 0.0; }
+    };
+
+    /**
+     * Raw result of one HTTP attempt (status 0 = network failure)
+     */
+    struct HttpResponse {
+        int status;
+        std::string body;
+    };
+
+    /**
+     * Retry/hedging settings for upstream requests
+     * Retries use exponential backoff with full jitter; hedgeAfterMs > 0
+     * sends a second copy of a request that has not answered by then
+     */
+    struct RetryPolicy {
+        int maxAttempts;
+        int baseDelayMs;
+        int maxDelayMs;
+        int hedgeAfterMs;
+    };
+
+    /**
+     * Rate limiter state plus retry/hedge counters
+     */
+    struct RequestMetrics {
+        RateLimiter::Stats limiter;
+        uint64_t attempts;
+        uint64_t retries;
+        uint64_t failures;      // requests that ran out of attempts
+        uint64_t throttled;     // 429 / Last.fm error 29 responses
+        uint64_t hedgesFired;
+        uint64_t hedgesWon;     // hedge answered before the original
+    };
+
     /**
      * Initialize LastFM API (set API key)
      */
@@ -48,11 +125,109 @@ public:
      */
     static std::vector<Song*> getTrendingTracks(int limit = 10);
 
+    enum SubmitResult {
+        SUBMIT_ACCEPTED,
+        SUBMIT_FAILED,      // no session, offline, throttled, server or auth trouble: resend later
+        SUBMIT_REJECTED     // Last.fm refused the batch itself; resending it cannot succeed
+    };
+
+    /**
+     * Submit up to 50 scrobbles in one signed track.scrobble POST (order preserved)
+     * Sent once, never retried or hedged: a timed-out write may still have
+     * been applied, so resending is left to the caller's backoff.
+     */
+    static SubmitResult submitScrobbles(const std::vector<Scrobble>& batch);
+
+    /**
+     * Set the authenticated session key used for scrobbling
+     */
+    static void setSessionKey(const std::string& key);
+
+    /**
+     * Set the shared secret that signs write requests (api_sig)
+     */
+    static void setApiSecret(const std::string& secret);
+
+    /**
+     * Check if both a session key and the API secret are set;
+     * scrobbles stay journaled until they are
+     */
+    static bool hasSession();
+
     /**
      * Get track info including play count
      */
     static std::string getTrackInfo(const std::string& trackName, const std::string& artistName);
 
+    /**
+     * Asynchronous variants - return immediately with a request handle;
+     * the lookup runs on the Last.fm I/O executor
+     */
+    typedef std::shared_ptr<LastFMRequest> RequestHandle;
+
+    static RequestHandle searchTracksAsync(const std::string& trackName, LastFMRequest::Callback onDone = nullptr);
+    static RequestHandle getTopTracksAsync(int limit = 10, LastFMRequest::Callback onDone = nullptr);
+    static RequestHandle getTopTracksByCountryAsync(const std::string& country, int limit = 10,
+                                                    LastFMRequest::Callback onDone = nullptr);
+    static RequestHandle getTracksByArtistAsync(const std::string& artistName, int limit = 10,
+                                                LastFMRequest::Callback onDone = nullptr);
+    static RequestHandle getSimilarTracksAsync(const std::string& trackName, const std::string& artistName,
+                                               LastFMRequest::Callback onDone = nullptr);
+
+    /**
+     * Fan-out variants - one lookup per query, at most maxConcurrency at a
+     * time (capped by the I/O executor's threads). Each finished query is
+     * streamed to onItem; after deadlineMs no new lookups start and the
+     * batch returns whatever has completed.
+     */
+    typedef std::shared_ptr<LastFMBatch> BatchHandle;
+
+    static BatchHandle getTopTracksByCountries(const std::vector<std::string>& countries, int limit = 10,
+                                               int deadlineMs = 15000, int maxConcurrency = 4,
+                                               LastFMBatch::ItemCallback onItem = nullptr);
+    static BatchHandle getTracksByArtists(const std::vector<std::string>& artistNames, int limit = 10,
+                                          int deadlineMs = 15000, int maxConcurrency = 4,
+                                          LastFMBatch::ItemCallback onItem = nullptr);
+    static BatchHandle searchTracksBatch(const std::vector<std::string>& trackNames,
+                                         int deadlineMs = 15000, int maxConcurrency = 4,
+                                         LastFMBatch::ItemCallback onItem = nullptr);
+
+    /**
+     * Counters for speculative prefetching
+     */
+    struct PrefetchStats {
+        uint64_t requested;
+        uint64_t issued;
+        uint64_t alreadyCached;    // fresh in cache or already being fetched
+        uint64_t skippedBudget;    // over the prefetch budget or queue limit
+        uint64_t skippedRateLimit; // no rate-limiter token free right now
+        uint64_t failed;
+    };
+
+    /**
+     * Warm the cache for the likely next browse after picking a track:
+     * similar tracks and the artist's top tracks. Runs at low priority,
+     * never waits for a rate-limiter token and is capped by the budget.
+     */
+    static void prefetchRelated(const std::string& trackName, const std::string& artistName);
+
+    /**
+     * Set the prefetch budget in requests per minute (0 disables prefetching)
+     */
+    static void setPrefetchBudget(int requestsPerMinute);
+
+    /**
+     * Get prefetch counters
+     */
+    static PrefetchStats getPrefetchStats();
+
+    /**
+     * Stop background workers (call before unloading the backend)
+     * Queued lookups fail; later ones are refused until initialize(), and
+     * isInitialized() is false until then so callers know to call it
+     */
+    static void shutdown();
+
     /**
      * Check if API is initialized
      */
@@ -63,21 +238,163 @@ public:
      */
     static std::string buildApiUrl(const std::map<std::string, std::string>& params);
 
+    /**
+     * Parse every track[] entry of a Last.fm response in one pass
+     * (tracks.track, toptracks.track, similartracks.track, results.trackmatches.track, ...)
+     * Duplicate title/artist pairs are dropped
+     */
+    static std::vector<LastFMTrack> parseTracksFromJson(const std::string& jsonResponse);
+
+    /**
+     * Build the cache key for a request (method + sorted, normalized params)
+     * The API key and format are left out so keys survive key rotation
+     */
+    static std::string buildCacheKey(const std::map<std::string, std::string>& params);
+
+    /**
+     * Override TTL / stale-while-revalidate window for one API method
+     */
+    static void setCachePolicy(const std::string& method, int ttlSeconds, int staleSeconds);
+
+    /**
+     * Set memory budget of the response cache (bytes)
+     */
+    static void setCacheMemoryLimit(size_t maxBytes);
+
+    /**
+     * Drop all cached responses (memory and disk)
+     */
+    static void clearCache();
+
+    /**
+     * Get response cache counters
+     */
+    static ResponseCache::Stats getCacheStats();
+
+    /**
+     * Get single-flight counters
+     */
+    static CoalescingStats getCoalescingStats();
+
+    /**
+     * Configure the token bucket shared by every Last.fm call
+     * (Last.fm allows about 5 requests per second per key)
+     * Returns false, keeping the current limit, unless requestsPerSecond > 0
+     * and burst >= 1
+     */
+    static bool setRateLimit(double requestsPerSecond, double burst);
+
+    /**
+     * Set / get retry and hedging behaviour
+     */
+    static void setRetryPolicy(const RetryPolicy& policy);
+    static RetryPolicy getRetryPolicy();
+
+    /**
+     * Get rate limiter state and retry/hedge counters
+     */
+    static RequestMetrics getRequestMetrics();
+
+    /**
+     * Shared rate limiter (also used by background work that must
+     * stay within the same budget)
+     */
+    static RateLimiter& limiter();
+
 private:
     static std::string apiKey;
-    static bool initialized;
+    static std::string sessionKey;
+    static std::string apiSecret;
+    static std::atomic<bool> initialized;   // read by the I/O threads
     static const std::string API_BASE_URL;
     static const std::string API_FORMAT;
 
     /**
-     * Make HTTP GET request
+     * Make HTTP request: GET, or a form POST of postBody when it is set
+     */
+    static HttpResponse makeRequest(const std::string& url, const std::string& postBody = "");
+
+    /**
+     * Send a signed write (form body) once through the rate limiter
+     */
+    static HttpResponse executeWrite(const std::string& body);
+
+    /**
+     * Add api_key and sk to params and build the signed form body
+     * Returns false if there is no session to sign with
+     */
+    static bool buildSignedBody(std::map<std::string, std::string> params, std::string& body);
+
+    /**
+     * Send a request through the rate limiter, retrying throttled and
+     * server errors; returns the body (empty if every attempt failed)
+     */
+    static std::string executeRequest(const std::string& url);
+
+    /**
+     * One attempt, hedged when the policy asks for it
+     */
+    static HttpResponse attemptRequest(const std::string& url, const RetryPolicy& policy);
+
+    /**
+     * Get response for a request, going through the response cache
+     * Stale hits are returned immediately and refreshed in the background
+     */
+    static std::string fetch(const std::map<std::string, std::string>& params);
+
+    /**
+     * Fetch and parse a track list; concurrent identical requests share
+     * one upstream call and all receive its parsed result
+     */
+    static std::shared_ptr<const std::vector<Song>> fetchTracks(const std::map<std::string, std::string>& params);
+
+    /**
+     * Copy a shared track list into caller-owned songs
+     */
+    static std::vector<Song*> toSongs(const std::shared_ptr<const std::vector<Song>>& tracks);
+
+    /**
+     * Re-fetch a stale entry without blocking the caller
+     */
+    static void revalidate(const std::map<std::string, std::string>& params, const std::string& key);
+
+    /**
+     * Queue one low-priority cache warm-up
+     */
+    static void prefetch(const std::map<std::string, std::string>& params);
+
+    /**
+     * Run a blocking lookup on the I/O executor and report it through a handle
+     */
+    static RequestHandle runAsync(std::function<std::vector<Song*>()> work, LastFMRequest::Callback onDone);
+
+    typedef std::function<std::vector<Song*>(const std::string&)> BatchWork;
+
+    /**
+     * Start a fan-out: queue one lane per allowed concurrent lookup
+     */
+    static BatchHandle runBatch(const std::vector<std::string>& queries, BatchWork work,
+                                int deadlineMs, int maxConcurrency, LastFMBatch::ItemCallback onItem);
+
+    /**
+     * Run the batch's next query, then requeue the lane so other
+     * executor work can interleave between lookups
+     */
+    static void runBatchStep(const BatchHandle& batch, const BatchWork& work);
+
+    /**
+     * Queue a task on the shared I/O executor (created on first use)
+     * Submits under the executor lock so shutdown() cannot free the pool
+     * mid-call. Returns false after shutdown() until initialize() runs
+     * again; onDropped runs if shutdown() discards the queued task
      */
-    static std::string makeRequest(const std::string& url);
+    static bool submitIO(IOExecutor::Task task, IOExecutor::Priority priority = IOExecutor::NORMAL,
+                         IOExecutor::Task onDropped = nullptr);
 
     /**
-     * Parse JSON response
+     * Shared response cache (created on first use)
      */
-    static std::vector<Song*> parseTracksFromJson(const std::string& jsonResponse);
+    static ResponseCache& cache();
 
     /**
      * Extract value from simple JSON
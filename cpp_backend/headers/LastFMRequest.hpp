@@ -0,0 +1,104 @@
+#ifndef LASTFMREQUEST_HPP
+#define LASTFMREQUEST_HPP
+
+#include "Song.hpp"
+#include <vector>
+#include <string>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * LastFMRequest - Handle to an asynchronous Last.fm lookup
+ * Returned by the LastFMManager *Async methods; the caller can poll,
+ * wait, cancel or collect the results once they are ready
+ */
+class LastFMRequest {
+public:
+    enum Status {
+        PENDING,
+        COMPLETED,
+        CANCELLED,
+        FAILED
+    };
+
+    /**
+     * Completion callback, invoked exactly once when the request
+     * completes, fails or is cancelled (on the thread that finished it)
+     */
+    typedef std::function<void(LastFMRequest&)> Callback;
+
+    explicit LastFMRequest(Callback onDone = nullptr);
+
+    /**
+     * Destructor - deletes results that were never collected
+     */
+    ~LastFMRequest();
+
+    LastFMRequest(const LastFMRequest&) = delete;
+    LastFMRequest& operator=(const LastFMRequest&) = delete;
+
+    /**
+     * Get current status
+     */
+    Status getStatus() const;
+
+    /**
+     * Check if the request has finished (any status but PENDING)
+     */
+    bool isDone() const;
+
+    /**
+     * Check if cancel() was called before completion
+     */
+    bool isCancelled() const;
+
+    /**
+     * Block until finished; timeoutMs < 0 waits forever
+     * Returns true if the request finished in time
+     */
+    bool wait(int timeoutMs = -1);
+
+    /**
+     * Cancel the request; results arriving later are discarded
+     */
+    void cancel();
+
+    /**
+     * Take ownership of the results (empty unless COMPLETED)
+     * Caller must delete the returned songs
+     */
+    std::vector<Song*> takeResults();
+
+    /**
+     * Get error message of a FAILED request
+     */
+    std::string getError() const;
+
+    /**
+     * Finish with results (ignored if already cancelled)
+     */
+    void complete(std::vector<Song*> songs);
+
+    /**
+     * Finish with an error (ignored if already cancelled)
+     */
+    void fail(const std::string& message);
+
+private:
+    Status status;
+    std::vector<Song*> results;
+    std::string error;
+    Callback callback;
+    mutable std::mutex mutex;
+    std::condition_variable done;
+
+    /**
+     * Move to a final status and fire the callback
+     * Returns false if the request had already finished
+     */
+    bool finish(Status finalStatus, std::vector<Song*>* songs, const std::string& message);
+};
+
+#endif // LASTFMREQUEST_HPP
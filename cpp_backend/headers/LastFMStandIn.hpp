@@ -0,0 +1,151 @@
+#ifndef LASTFMSTANDIN_HPP
+#define LASTFMSTANDIN_HPP
+
+#include "LastFMManager.hpp"
+#include <string>
+#include <map>
+#include <cstdint>
+
+/**
+ * LastFMStandIn - Local replacement for the Last.fm web service
+ * When enabled, every LastFMManager request is answered from recorded
+ * fixtures (or a synthesized track page) with configurable latency and
+ * injected faults, so all code paths can be exercised offline.
+ * Random choices are seeded from the request key, so a run is
+ * reproducible no matter how requests interleave across threads.
+ *
+ * Also enabled at start-up by setting MUSICPLAYER_LASTFM_STANDIN to a
+ * fixture directory.
+ */
+class LastFMStandIn {
+public:
+    enum Distribution {
+        NONE,
+        FIXED,       // always medianMs
+        UNIFORM,     // between minMs and maxMs
+        LOG_NORMAL   // median medianMs, shape sigma, clamped to [minMs, maxMs]
+    };
+
+    struct LatencyProfile {
+        Distribution distribution;
+        int minMs;
+        int medianMs;
+        int maxMs;
+        double sigma;
+    };
+
+    /**
+     * Probability (0-1) of each injected fault per request
+     */
+    struct FaultProfile {
+        double throttleRate;     // HTTP 429 + Last.fm error 29
+        double serverErrorRate;  // HTTP 503
+        double timeoutRate;      // status 0 after the latency
+        double truncateRate;     // status 200 with the body cut short
+    };
+
+    struct Stats {
+        uint64_t requests;
+        uint64_t fixtureHits;
+        uint64_t synthesized;
+        uint64_t notFound;
+        uint64_t recorded;
+        uint64_t throttled;
+        uint64_t serverErrors;
+        uint64_t timeouts;
+        uint64_t truncated;
+        uint64_t totalLatencyMs;
+    };
+
+    /**
+     * Serve requests from fixtureDirectory instead of the network
+     */
+    static void enable(const std::string& fixtureDirectory);
+
+    /**
+     * Go back to the real transport
+     */
+    static void disable();
+
+    /**
+     * Check if requests are being served locally
+     */
+    static bool isEnabled();
+
+    /**
+     * Save real responses as fixtures (works with the stand-in disabled)
+     */
+    static void setRecording(bool record, const std::string& fixtureDirectory);
+
+    /**
+     * Check if real responses are being recorded
+     */
+    static bool isRecording();
+
+    /**
+     * Latency for every method / for one method (e.g. "geo.gettoptracks")
+     */
+    static void setLatency(const LatencyProfile& profile);
+    static void setMethodLatency(const std::string& method, const LatencyProfile& profile);
+
+    /**
+     * Set fault injection rates
+     */
+    static void setFaults(const FaultProfile& faults);
+
+    /**
+     * Answer requests without a fixture with a generated track page
+     * (size taken from the request's limit); otherwise they get a 404
+     */
+    static void setSynthesizeMissing(bool synthesize);
+
+    /**
+     * Seed for latency and fault draws; also restarts the per-key sequences
+     */
+    static void setSeed(uint64_t seed);
+
+    /**
+     * Answer one request (sleeps for the drawn latency)
+     * postBody holds the form parameters of a POST. track.scrobble is
+     * refused unless it is POSTed with sk and api_sig, like the real API
+     */
+    static LastFMManager::HttpResponse serve(const std::string& url, const std::string& postBody = "");
+
+    /**
+     * Store a real response as the fixture for its request
+     */
+    static void record(const std::string& url, const LastFMManager::HttpResponse& response);
+
+    /**
+     * Get counters / reset them
+     */
+    static Stats getStats();
+    static void resetStats();
+
+private:
+    /**
+     * Split a request URL into its query parameters
+     */
+    static std::map<std::string, std::string> parseUrl(const std::string& url);
+
+    /**
+     * Split a form-encoded POST body into its (decoded) parameters
+     */
+    static std::map<std::string, std::string> parseForm(const std::string& body);
+
+    /**
+     * Fixture file for a canonical request key
+     */
+    static std::string fixturePath(const std::string& directory, const std::string& key);
+
+    static bool loadFixture(const std::string& key, const std::string& method, LastFMManager::HttpResponse& response);
+
+    /**
+     * Generated response shaped like the method's real one
+     */
+    static std::string synthesize(const std::map<std::string, std::string>& params, uint64_t seed);
+
+    static int drawLatency(const LatencyProfile& profile, uint64_t& state);
+};
+
+#endif // LASTFMSTANDIN_HPP
@@ -0,0 +1,19 @@
+#ifndef MD5_HPP
+#define MD5_HPP
+
+#include <string>
+
+/**
+ * Md5 - RFC 1321 message digest
+ * Only used for Last.fm's api_sig, which the API defines as an MD5 hex
+ * digest; not for anything that needs to resist collisions.
+ */
+class Md5 {
+public:
+    /**
+     * Lower-case hex digest of data (32 characters)
+     */
+    static std::string hex(const std::string& data);
+};
+
+#endif // MD5_HPP
@@ -86,7 +86,7 @@ private:
     void clearAllSongs();
 
     /**
-     * Search songs from API
+     * Search the playlist, catalog and Last.fm in one go
      */
     void searchSongsFromAPI();
 
@@ -22,6 +22,9 @@ namespace MusicPlayerAPI
         // Playlist operations
         __declspec(dllexport) int GetPlaylistSize();
         __declspec(dllexport) int AddSongToPlaylist(const char* title, const char* artist, int duration);
+        // Song backed by a WAV file (UTF-8 path) the native engine plays; duration comes
+        // from the file. Returns the new playlist size, or -1 if the file cannot be decoded
+        __declspec(dllexport) int AddSongFileToPlaylist(const char* title, const char* artist, const char* filePath);
         __declspec(dllexport) int RemoveSongFromPlaylist(int index);
         __declspec(dllexport) int GetPlaylistSong(int index, SongData* outSong);
         __declspec(dllexport) void ClearPlaylist();
@@ -32,14 +35,42 @@ namespace MusicPlayerAPI
         __declspec(dllexport) void PauseSong();
         __declspec(dllexport) void ResumeSong();
         __declspec(dllexport) void StopSong();
+        __declspec(dllexport) void NotifyTrackFinished(); // song played to the end
         __declspec(dllexport) int GetCurrentSongIndex();
         __declspec(dllexport) int GetPlaybackState(); // 0=STOPPED, 1=PLAYING, 2=PAUSED
         __declspec(dllexport) float GetProgress(); // 0.0 - 1.0
+        // Overlap of consecutive playlist songs in seconds (0 - 12; 0 plays them gaplessly)
+        __declspec(dllexport) void SetCrossfade(float seconds);
+        __declspec(dllexport) float GetCrossfade();
+        // Rate every song is resampled to before output (0 = each song's own rate)
+        __declspec(dllexport) void SetOutputRate(int sampleRate);
+        // Varispeed, pitch included: 0.5 - 2.0, 1.0 is normal
+        __declspec(dllexport) void SetPlaybackSpeed(float speed);
+        __declspec(dllexport) float GetPlaybackSpeed();
 
         // Last.fm API Search
         __declspec(dllexport) int SearchFromLastFM(const char* query, SongData* outArray, int maxResults);
         __declspec(dllexport) int GetTopTracks(SongData* outArray, int maxResults);
 
+        // Asynchronous Last.fm requests: Begin* returns a handle (> 0, or -1 on error),
+        // poll GetRequestStatus and call CollectRequestResults once it is no longer pending
+        __declspec(dllexport) int BeginSearchFromLastFM(const char* query);
+        __declspec(dllexport) int BeginGetTopTracks(int maxResults);
+        __declspec(dllexport) int GetRequestStatus(int handle); // 0=PENDING, 1=COMPLETED, 2=CANCELLED, 3=FAILED, -1=unknown
+        __declspec(dllexport) int CollectRequestResults(int handle, SongData* outArray, int maxResults); // -1 while pending; releases handle
+        __declspec(dllexport) void CancelRequest(int handle); // releases handle
+
+        // Warm similar-track / artist-top-track lookups after the user picks a Last.fm result
+        __declspec(dllexport) void PrefetchRelatedTracks(const char* title, const char* artist);
+
+        // Sign in for scrobbling (API shared secret + session key from auth.getSession);
+        // plays are kept in the scrobble journal until this is called
+        __declspec(dllexport) void SetLastFMSession(const char* apiSecret, const char* sessionKey);
+
+        // Type-ahead: up to k (max 10) playlist/catalog songs matching a typed prefix,
+        // best first; answered from a prebuilt index without blocking
+        __declspec(dllexport) int Suggest(const char* prefix, int k, SongData* outArray);
+
         // File operations
         __declspec(dllexport) int SavePlaylist(const char* filename);
         __declspec(dllexport) int LoadPlaylist(const char* filename);
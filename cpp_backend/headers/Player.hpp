@@ -2,12 +2,20 @@
 #define PLAYER_HPP
 
 #include "Song.hpp"
+#include "Playlist.hpp"
+#include "AudioEngine.hpp"
 #include <string>
-#include <chrono>
+#include <memory>
+#include <cstdint>
 
 /**
  * Player - Manages playback state and now-playing info
- * Tracks current song, play status, elapsed time, etc.
+ * Plays the current song through the native AudioEngine (its WAV file,
+ * or silence of the song's length when it has none), so state, elapsed
+ * time and progress all come from the samples actually rendered.
+ * While a song plays, the one after it in the playlist is queued on the
+ * engine, which moves on to it without a gap; update() notices the
+ * change and makes it the current song.
  */
 class Player {
 public:
@@ -47,6 +55,23 @@ public:
      */
     void stop();
 
+    /**
+     * Current song reached its end (scrobbles it and stops)
+     */
+    void finish();
+
+    /**
+     * Playlist to take the next song from (not owned; null disables gapless)
+     */
+    void setPlaylist(Playlist* playlist);
+
+    /**
+     * Catch up with the engine: follow a gapless move to the next song and
+     * (re)queue the song after the current one. Call before reading state
+     * (the frontend's polling does)
+     */
+    void update();
+
     /**
      * Get current playback state
      */
@@ -97,13 +122,49 @@ public:
      */
     void displayNowPlaying() const;
 
+    /**
+     * The engine playing the current song
+     */
+    AudioEngine& getEngine() { return engine; }
+
 private:
+    AudioEngine engine;
+    Playlist* playlist;
     Song* currentSong;
-    PlaybackState state;
-    int elapsedSeconds;
-    std::chrono::steady_clock::time_point startTime;
-    bool wasPaused;
-    int pausedTime;
+    Song* queuedSong;      // queued on the engine to follow currentSong
+    uint64_t queuedTrack;  // its engine track id
+    int64_t startedAt; // unix seconds, reported with the scrobble
+
+    /**
+     * Decoder for the song's file, or silence if it has no playable file
+     */
+    std::unique_ptr<AudioSource> openSource(Song* song) const;
+
+    /**
+     * Length of the current song in seconds (of its audio, once loaded)
+     */
+    int getTotalTime() const;
+
+    /**
+     * Queue the current song for scrobbling if it was played long enough
+     * (half its length or 4 minutes, and the track is over 30 seconds)
+     */
+    void scrobbleCurrent(int played);
+
+    /**
+     * Song after the current one in the playlist, or null
+     */
+    Song* predictNext() const;
+
+    /**
+     * Whether song is (still) one of the playlist's
+     */
+    bool inPlaylist(const Song* song) const;
+
+    /**
+     * Bookkeeping for a song that just became audible
+     */
+    void startSong(Song* song);
 
     /**
      * Format seconds to MM:SS
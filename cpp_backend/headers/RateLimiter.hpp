@@ -0,0 +1,81 @@
+#ifndef RATELIMITER_HPP
+#define RATELIMITER_HPP
+
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * RateLimiter - Thread-safe token bucket
+ * Tokens refill continuously at ratePerSecond up to burst; each request
+ * spends one token.
+ */
+class RateLimiter {
+public:
+    struct Stats {
+        double tokensAvailable;
+        double ratePerSecond;
+        double burst;
+        uint64_t acquired;       // tokens handed out
+        uint64_t throttled;      // acquisitions that had to wait
+        uint64_t rejected;       // tryAcquire/timeouts that got nothing
+        uint64_t totalWaitMs;    // time spent waiting for tokens
+        int64_t penaltyRemainingMs;
+    };
+
+    /**
+     * Constructor - a rate that is not above 0 or a burst below 1 would
+     * never yield a token, so those fall back to 1 per second / 1
+     */
+    RateLimiter(double ratePerSecond, double burst);
+
+    /**
+     * Take a token, waiting up to timeoutMs for one (timeoutMs < 0 waits forever)
+     * Returns false if no token became available in time
+     */
+    bool acquire(int timeoutMs = -1);
+
+    /**
+     * Take a token only if one is available right now
+     */
+    bool tryAcquire();
+
+    /**
+     * Stop handing out tokens for a while (e.g. after the server throttled us)
+     */
+    void penalize(int milliseconds);
+
+    /**
+     * Change rate and burst size
+     * Returns false, changing nothing, unless ratePerSecond > 0 and burst >= 1
+     */
+    bool configure(double ratePerSecond, double burst);
+
+    /**
+     * Get current state and counters
+     */
+    Stats getStats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    double rate;
+    double capacity;
+    double tokens;
+    Clock::time_point lastRefill;
+    Clock::time_point blockedUntil;
+    Stats stats;
+    mutable std::mutex mutex;
+
+    /**
+     * Add tokens earned since the last refill (caller holds the lock)
+     */
+    void refillLocked(Clock::time_point now);
+
+    /**
+     * Time until a token is available (caller holds the lock)
+     */
+    Clock::duration waitTimeLocked(Clock::time_point now) const;
+};
+
+#endif // RATELIMITER_HPP
@@ -0,0 +1,138 @@
+#ifndef RECOMMENDER_HPP
+#define RECOMMENDER_HPP
+
+#include "Playlist.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <shared_mutex>
+#include <cstdint>
+
+/**
+ * Recommender - Item-to-item recommendations from saved playlists
+ * Tracks that share playlists are counted in a sparse co-occurrence
+ * matrix; a pair's count is the dot product of the two tracks' playlist
+ * vectors, so cosine similarity is count / sqrt(n_i * n_j). The top
+ * neighbours of every track are precomputed, and saving a playlist only
+ * recomputes the rows it touched. Lookups read the table under a shared
+ * lock.
+ */
+class Recommender {
+public:
+    static constexpr size_t NEIGHBOURS = 20; // neighbours kept per track
+
+    typedef uint32_t TrackId;
+
+    struct Track {
+        std::string title;
+        std::string artist;
+        int duration;
+    };
+
+    struct Recommendation {
+        Track track;
+        float score;        // cosine similarity (summed over seeds for a playlist)
+    };
+
+    /**
+     * Shared recommender, built from the saved playlists on first use
+     */
+    static Recommender& instance();
+
+    Recommender(const Recommender&) = delete;
+    Recommender& operator=(const Recommender&) = delete;
+
+    /**
+     * Replace a playlist's contents (adds it if new) and update the table
+     */
+    void updatePlaylist(const std::string& name, const Playlist& playlist);
+
+    /**
+     * Forget a playlist and update the table
+     */
+    void removePlaylist(const std::string& name);
+
+    /**
+     * Tracks most similar to one track, best first
+     */
+    std::vector<Recommendation> recommendForTrack(const std::string& title, const std::string& artist,
+                                                  size_t limit) const;
+
+    /**
+     * Tracks most similar to a whole playlist (similarities summed over
+     * its tracks), best first; tracks already in the playlist are skipped
+     */
+    std::vector<Recommendation> recommendForPlaylist(const Playlist& playlist, size_t limit) const;
+
+    /**
+     * Number of distinct tracks seen in playlists
+     */
+    size_t getTrackCount() const;
+
+    /**
+     * Number of playlists counted
+     */
+    size_t getPlaylistCount() const;
+
+private:
+    struct Neighbour {
+        TrackId id;
+        float similarity;
+    };
+
+    std::unordered_map<std::string, TrackId> ids;   // folded "title \x1f artist"
+    std::vector<Track> tracks;
+    std::vector<uint32_t> occurrences;              // playlists containing each track
+    std::vector<float> inverseNorms;                // 1 / sqrt(occurrences), 0 if unused
+    std::vector<std::unordered_map<TrackId, uint32_t>> coCounts; // sparse, symmetric
+    std::vector<std::vector<Neighbour>> neighbours; // top NEIGHBOURS by similarity
+    std::unordered_map<std::string, std::vector<TrackId>> playlists; // sorted, distinct ids
+
+    mutable std::shared_mutex mutex;
+
+    Recommender();
+
+    /**
+     * Read every saved playlist and build the table from scratch
+     */
+    void loadSavedPlaylists();
+
+    /**
+     * Identity key of a track (case-insensitive title and artist)
+     */
+    static std::string keyOf(const std::string& title, const std::string& artist);
+
+    /**
+     * Look up a track's id; returns false if it was never seen
+     */
+    bool findTrack(const std::string& title, const std::string& artist, TrackId& id) const;
+
+    /**
+     * Distinct ids of a playlist's tracks (new tracks get an id)
+     */
+    std::vector<TrackId> internPlaylist(const Playlist& playlist);
+
+    /**
+     * Swap a playlist's track set and adjust the counts; collects the
+     * tracks whose similarities may have changed into dirty
+     */
+    void applyPlaylist(const std::string& name, std::vector<TrackId> trackIds, std::vector<TrackId>& dirty);
+
+    /**
+     * Add delta to the co-occurrence of every pair in a track set
+     */
+    void countPairs(const std::vector<TrackId>& trackIds, int delta);
+
+    /**
+     * Recompute the neighbour list of one track from its co-occurrence row
+     */
+    void rebuildNeighbours(TrackId id);
+
+    /**
+     * Recompute the neighbour lists of the dirty tracks and of everything
+     * they co-occur with (their norms changed)
+     */
+    void refresh(std::vector<TrackId>& dirty);
+};
+
+#endif // RECOMMENDER_HPP
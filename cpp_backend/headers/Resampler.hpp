@@ -0,0 +1,117 @@
+#ifndef RESAMPLER_HPP
+#define RESAMPLER_HPP
+
+#include "AudioSource.hpp"
+#include <memory>
+#include <vector>
+
+/**
+ * Resampler - Converts another source to a fixed output rate
+ * A windowed-sinc (Kaiser) polyphase filter. When the two rates have a
+ * small rational ratio L/M (44.1 <-> 48 kHz is 147/160) every output
+ * sample falls on one of L phases and uses that phase's precomputed
+ * taps exactly. Varispeed (setSpeed() other than 1) switches to an
+ * arbitrary-ratio mode: 512 phases with linear interpolation between
+ * neighbouring ones. When downsampling the cutoff follows the lower rate
+ * and the filter gets longer to match.
+ * Coefficient tables are built once per rate pair (or speed step) and
+ * shared. The inner product runs 8 taps at a time with AVX2/FMA when
+ * the CPU has them (checked at run time), otherwise with SSE2.
+ * Lengths and positions are in output frames. With varispeed, position
+ * counts the frames produced so far, and the length is the position
+ * plus what is left at the current speed.
+ * Rates and speed equal: samples pass straight through.
+ */
+class Resampler : public AudioSource {
+public:
+    static const int MAX_RATIONAL_PHASES = 1024;
+    static const int ARBITRARY_PHASES = 512;
+
+    /**
+     * Wrap source, producing outputRate frames per second (0 keeps the source's rate)
+     */
+    Resampler(std::unique_ptr<AudioSource> source, int outputRate);
+
+    AudioFormat getFormat() const override { return {outputRate, channels}; }
+    uint64_t getLength() const override;
+    size_t read(float* out, size_t frames) override;
+    bool seek(uint64_t frame) override;
+    void prefetch() override { source->prefetch(); }
+
+    /**
+     * Play faster (> 1) or slower (< 1), pitch included; carries on from
+     * the same point of the source. Clamped to 0.5 - 2
+     */
+    void setSpeed(double speed);
+    double getSpeed() const { return speed; }
+
+    /**
+     * Rate of the wrapped source
+     */
+    int getSourceRate() const { return sourceRate; }
+
+    /**
+     * Whether samples are filtered at all (false: rates and speed equal)
+     */
+    bool isResampling() const { return mode != PASS_THROUGH; }
+
+    struct FilterTable;
+
+private:
+    enum Mode {
+        PASS_THROUGH,
+        RATIONAL,      // phase = (n * M) mod L, exact
+        ARBITRARY      // fractional phase, interpolated
+    };
+
+    std::unique_ptr<AudioSource> source;
+    int sourceRate;
+    int outputRate;
+    int channels;
+    double speed;
+    Mode mode;
+    std::shared_ptr<const FilterTable> table;
+
+    // Rational mode: output frame n sits at source frame (n * step) / up
+    uint64_t up;      // L
+    uint64_t step;    // M
+    // Arbitrary mode: source frames per output frame
+    double increment;
+
+    // Time of the next output frame in the source: whole frames + phase
+    int64_t inIndex;
+    uint64_t phase;       // rational: 0 .. L-1
+    double fraction;      // arbitrary: [0, 1)
+    uint64_t position;    // output frames produced
+
+    // Source frames [bufferStart, bufferStart + bufferFrames), one plane per channel
+    std::vector<float> planes;
+    size_t capacity;       // frames per plane
+    int64_t bufferStart;
+    size_t bufferFrames;
+    int64_t sourceFrames;  // source length (shrinks if the source ends early)
+    bool sourceEnded;
+    std::vector<float> interleaved;
+
+    /**
+     * Choose the mode and filter for the current rates and speed
+     */
+    void configure();
+
+    /**
+     * Continue from source frame index (phase / fraction already set)
+     */
+    void moveTo(int64_t index);
+
+    /**
+     * Make source frames [first, end) available in the planes
+     */
+    void fill(int64_t first, int64_t end);
+
+    /**
+     * Source time of the next output frame, in frames
+     */
+    double sourceTime() const;
+};
+
+#endif // RESAMPLER_HPP
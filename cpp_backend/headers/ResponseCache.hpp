@@ -0,0 +1,163 @@
+#ifndef RESPONSECACHE_HPP
+#define RESPONSECACHE_HPP
+
+#include <string>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+/**
+ * ResponseCache - Two-tier cache for API responses
+ * Keeps recently used bodies in a byte-bounded LRU and mirrors every
+ * entry to disk so warm lookups survive restarts. The disk tier has its
+ * own byte cap; past it the oldest files are deleted first
+ */
+class ResponseCache {
+public:
+    enum Freshness {
+        MISS,
+        FRESH,
+        STALE
+    };
+
+    /**
+     * Result of a cache lookup
+     * STALE bodies are still usable but should be revalidated
+     */
+    struct Lookup {
+        Freshness freshness;
+        std::string body;
+    };
+
+    /**
+     * Time-to-live and stale-while-revalidate window (seconds)
+     */
+    struct Policy {
+        int ttlSeconds;
+        int staleSeconds;
+    };
+
+    struct Stats {
+        uint64_t memoryHits;
+        uint64_t diskHits;
+        uint64_t staleHits;
+        uint64_t misses;
+        size_t entries;
+        size_t bytes;
+        size_t diskBytes;
+    };
+
+    static const size_t DEFAULT_MAX_DISK_BYTES = 64 * 1024 * 1024;
+
+    /**
+     * Constructor
+     * An empty directory disables the disk tier. Files left over from an
+     * earlier run count towards maxDiskBytes and are trimmed straight away
+     */
+    ResponseCache(size_t maxMemoryBytes, const std::string& directory,
+                  size_t maxDiskBytes = DEFAULT_MAX_DISK_BYTES);
+
+    /**
+     * Set policy for one API method (e.g. "chart.gettoptracks")
+     */
+    void setPolicy(const std::string& method, int ttlSeconds, int staleSeconds);
+
+    /**
+     * Policy used for methods without their own entry
+     */
+    void setDefaultPolicy(int ttlSeconds, int staleSeconds);
+
+    /**
+     * Get policy for a method
+     */
+    Policy getPolicy(const std::string& method) const;
+
+    /**
+     * Look up a canonical request key (memory first, then disk)
+     */
+    Lookup get(const std::string& method, const std::string& key);
+
+    /**
+     * Check freshness of a key without touching LRU order or counters
+     */
+    Freshness peek(const std::string& method, const std::string& key) const;
+
+    /**
+     * Store a response body under a canonical request key
+     */
+    void put(const std::string& key, const std::string& body);
+
+    /**
+     * Drop every entry from memory and disk
+     */
+    void clear();
+
+    /**
+     * Change the memory budget, evicting if needed
+     */
+    void setMaxMemoryBytes(size_t maxBytes);
+
+    /**
+     * Change the disk budget, deleting the oldest files if needed
+     */
+    void setMaxDiskBytes(size_t maxBytes);
+
+    /**
+     * Get hit/miss counters and current memory usage
+     */
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::string body;
+        int64_t storedAt; // unix seconds
+    };
+
+    std::list<Entry> lru; // front = most recently used
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    std::map<std::string, Policy> policies;
+    Policy defaultPolicy;
+    size_t maxBytes;
+    size_t usedBytes;
+    std::string directory;
+    Stats stats;
+    mutable std::mutex mutex;
+
+    // Disk tier accounting, apart from mutex so file I/O never holds it
+    size_t maxDiskBytes;
+    size_t diskBytes;
+    mutable std::mutex diskMutex;
+
+    /**
+     * Classify an entry's age under a policy
+     */
+    static Freshness classify(int64_t storedAt, const Policy& policy);
+
+    /**
+     * Insert at the LRU front and evict from the back to fit the budget
+     */
+    void insertLocked(const std::string& key, const std::string& body, int64_t storedAt);
+
+    void evictLocked();
+
+    /**
+     * Disk tier helpers
+     */
+    std::string pathFor(const std::string& key) const;
+    bool readFromDisk(const std::string& key, std::string& body, int64_t& storedAt) const;
+    void writeToDisk(const std::string& key, const std::string& body, int64_t storedAt);
+    void removeFromDisk(const std::string& key);
+
+    /**
+     * Recount the files on disk and delete the oldest until they fit
+     * maxDiskBytes (diskMutex held). Also removes abandoned temp files
+     */
+    void trimDiskLocked();
+
+    static int64_t now();
+};
+
+#endif // RESPONSECACHE_HPP
@@ -0,0 +1,148 @@
+#ifndef SCROBBLEQUEUE_HPP
+#define SCROBBLEQUEUE_HPP
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * ScrobbleQueue - Durable, batched scrobble submission
+ * enqueue() copies into a fixed lock-free ring (no allocation, never
+ * blocks playback). A background thread appends ring entries to an
+ * on-disk journal and submits the journal in order, 50 per request,
+ * retrying with backoff while offline. Nothing is submitted (or dropped)
+ * until LastFMManager has a session to sign the requests with. A batch
+ * Last.fm refuses outright (invalid parameters, not a connection, server
+ * or sign-in problem) is moved to scrobbles.rejected next to the journal
+ * so it cannot hold up later plays.
+ */
+class ScrobbleQueue {
+public:
+    static const int BATCH_SIZE = 50;       // Last.fm limit per track.scrobble call
+    static const int RING_CAPACITY = 256;   // must be a power of two
+    static const int FIELD_SIZE = 128;
+
+    struct Stats {
+        uint64_t enqueued;
+        uint64_t dropped;       // ring was full
+        uint64_t journaled;
+        uint64_t submitted;
+        uint64_t batchesSent;
+        uint64_t batchesFailed;
+        uint64_t rejected;      // scrobbles Last.fm refused, moved to scrobbles.rejected
+        uint64_t pending;       // journaled but not yet accepted by Last.fm
+    };
+
+    /**
+     * Shared queue used by Player
+     */
+    static ScrobbleQueue& instance();
+
+    /**
+     * Start the background writer/submitter (journal lives in directory)
+     */
+    void start(const std::string& directory);
+
+    /**
+     * Flush the ring to disk and stop the background thread
+     */
+    void stop();
+
+    /**
+     * Record a finished play; returns false if the ring is full
+     * Safe to call from any thread; does not allocate or lock
+     */
+    bool enqueue(const std::string& artist, const std::string& track, int64_t startedAt, int duration);
+
+    /**
+     * Ask the background thread to submit now (skipping any backoff)
+     */
+    void flush();
+
+    /**
+     * Get counters
+     */
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        char artist[FIELD_SIZE];
+        char track[FIELD_SIZE];
+        int64_t timestamp;
+        int duration;
+    };
+
+    // Bounded multi-producer ring (sequence-numbered cells); one consumer
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Entry entry;
+    };
+
+    Cell ring[RING_CAPACITY];
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) size_t dequeuePos;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool running;
+    bool flushRequested;
+    std::string journalPath;
+    std::string cursorPath;
+    std::string rejectedPath;
+
+    int retryDelaySeconds;
+    std::chrono::steady_clock::time_point nextAttempt;
+    std::chrono::steady_clock::time_point lastSubmit;
+
+    std::atomic<uint64_t> enqueuedCount;
+    std::atomic<uint64_t> droppedCount;
+    std::atomic<uint64_t> journaledCount;
+    std::atomic<uint64_t> submittedCount;
+    std::atomic<uint64_t> batchesSent;
+    std::atomic<uint64_t> batchesFailed;
+    std::atomic<uint64_t> rejectedCount;
+    std::atomic<uint64_t> pendingCount;
+
+    ScrobbleQueue();
+    ~ScrobbleQueue();
+
+    bool tryPop(Entry& out);
+
+    /**
+     * Background thread main loop
+     */
+    void run();
+
+    /**
+     * Append everything in the ring to the journal
+     */
+    void drainToJournal();
+
+    /**
+     * Submit journaled entries after the cursor, oldest first; batches
+     * Last.fm rejects are appended to the rejected file and skipped
+     * Returns false if a batch failed (caller backs off)
+     */
+    bool submitPending();
+
+    /**
+     * Journal cursor (byte offset of the first unsubmitted line)
+     * A cursor past the end of the journal (a crash between compacting
+     * the journal and resetting the cursor) reads, and is rewritten, as 0
+     */
+    uint64_t readCursor() const;
+    void writeCursor(uint64_t offset) const;
+
+    /**
+     * Count journal lines after the cursor (on start-up)
+     */
+    void recountPending();
+};
+
+#endif // SCROBBLEQUEUE_HPP
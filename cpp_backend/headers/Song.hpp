@@ -7,17 +7,23 @@ class Song
 {
 private:
     std::string title, artist;
+    std::string foldedTitle, foldedArtist; // search keys, kept in step with title / artist
     int duration; // seconds
+    std::string filePath; // audio file (UTF-8), empty if the song has none
 public:
     Song() {};
-    Song(std::string title, std::string artist, int duration);
+    Song(std::string title, std::string artist, int duration, std::string filePath = "");
     void setTitle(std::string title);
     void setArtist(std::string artist);
     void setDuration(int duration);
+    void setFilePath(std::string filePath);
 
     std::string getTitle();
     std::string getArtist();
     int getDuration();
+    const std::string& getFilePath();
+    const std::string& getFoldedTitle();
+    const std::string& getFoldedArtist();
 
     std::string toString();
 };
@@ -0,0 +1,86 @@
+#ifndef SUGGESTINDEX_HPP
+#define SUGGESTINDEX_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * SuggestIndex - Immutable prefix index for type-ahead suggestions
+ * A radix trie over normalized "title artist" keys (plus every suffix
+ * starting at a later word, so "weeknd" finds The Weeknd). Nodes, edge
+ * labels and each node's precomputed top-k entries by popularity live
+ * in flat arrays; a lookup walks the prefix and returns the node's list
+ * without allocating.
+ */
+class SuggestIndex {
+public:
+    static const int MAX_K = 10;            // suggestions stored per node
+    static const size_t MAX_KEY_LENGTH = 48; // longer keys/prefixes are cut here
+
+    struct Entry {
+        std::string title;
+        std::string artist;
+        int duration;
+        long long popularity;
+    };
+
+    /**
+     * Build from entries (duplicates by title + artist keep the most popular)
+     */
+    explicit SuggestIndex(const std::vector<Entry>& entries);
+
+    SuggestIndex(const SuggestIndex&) = delete;
+    SuggestIndex& operator=(const SuggestIndex&) = delete;
+
+    /**
+     * Best entries for a typed prefix, most popular first
+     * Writes up to k entry indices into out and returns how many
+     */
+    int suggest(const char* prefix, int k, uint32_t* out) const;
+
+    /**
+     * Get an entry by index
+     */
+    const Entry& getEntry(uint32_t index) const { return entries[index]; }
+
+    /**
+     * Check if two entries are the same song (title and artist equal once normalized)
+     * Does not allocate, so results of two indexes can be merged per keystroke
+     */
+    static bool sameSong(const Entry& a, const Entry& b);
+
+    size_t getEntryCount() const { return entries.size(); }
+    size_t getNodeCount() const { return nodes.size(); }
+
+private:
+    struct Node {
+        uint32_t labelStart;  // edge label into labels
+        uint32_t labelLength;
+        uint32_t firstChild;  // children are contiguous, sorted by first label byte
+        uint32_t childCount;
+        uint32_t topStart;    // into tops
+        uint32_t topCount;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<Node> nodes;
+    std::string labels;
+    std::vector<uint32_t> tops;
+
+    /**
+     * Fold like Catalog::fold, collapse separators to one space, cut at
+     * MAX_KEY_LENGTH (without allocating)
+     * Writes into out (at least MAX_KEY_LENGTH + 1 bytes); returns length
+     */
+    static size_t normalize(const char* text, char* out);
+
+    typedef std::pair<std::string, uint32_t> Key;
+
+    /**
+     * Fill node index from keys[lo, hi), which share their first depth bytes
+     */
+    void buildNode(uint32_t index, const std::vector<Key>& keys, size_t lo, size_t hi, size_t depth);
+};
+
+#endif // SUGGESTINDEX_HPP
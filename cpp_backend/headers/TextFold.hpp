@@ -0,0 +1,32 @@
+#ifndef TEXTFOLD_HPP
+#define TEXTFOLD_HPP
+
+#include <string>
+#include <cstddef>
+
+/**
+ * TextFold - Unicode-aware folding of UTF-8 text into search keys
+ * Applies NFKC with full case folding (NFKC_Casefold) for Latin, Greek,
+ * Cyrillic, Armenian, Georgian, Cherokee, the letterlike and enclosed
+ * symbols and the full/halfwidth forms; other scripts (CJK, Hangul, ...)
+ * pass through unchanged. Typographic quotes and dashes become their ASCII
+ * forms. Optionally strips diacritics ("Beyoncé" -> "beyonce").
+ * Fold once when text enters the catalog or library and compare the
+ * folded bytes afterwards; folding is idempotent.
+ */
+class TextFold {
+public:
+    /**
+     * Fold text; invalid UTF-8 bytes are kept as they are
+     */
+    static std::string fold(const std::string& text, bool stripDiacritics = false);
+
+    /**
+     * Fold into a caller buffer without allocating
+     * Writes at most capacity bytes (never part of a character) and
+     * returns how many
+     */
+    static size_t fold(const char* text, size_t length, char* out, size_t capacity, bool stripDiacritics = false);
+};
+
+#endif // TEXTFOLD_HPP
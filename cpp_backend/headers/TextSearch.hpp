@@ -0,0 +1,34 @@
+#ifndef TEXTSEARCH_HPP
+#define TEXTSEARCH_HPP
+
+#include <cstddef>
+
+/**
+ * TextSearch - Substring search over pre-folded text
+ * Callers fold both sides once (Catalog::fold) so matching is a plain
+ * byte compare. The kernel compares the needle's first and last byte
+ * against 16 (SSE2) or 32 (AVX2) haystack positions at a time and only
+ * verifies the candidates; the widest kernel the CPU supports is picked
+ * at first use, with a scalar fallback elsewhere.
+ */
+class TextSearch {
+public:
+    static const size_t npos = (size_t)-1;
+
+    /**
+     * Position of the first occurrence of needle in haystack, or npos
+     */
+    static size_t find(const char* haystack, size_t length, const char* needle, size_t needleLength);
+
+    /**
+     * Same, with the scalar kernel only (reference for the vector kernels)
+     */
+    static size_t findScalar(const char* haystack, size_t length, const char* needle, size_t needleLength);
+
+    /**
+     * Name of the kernel find() uses ("avx2", "sse2" or "scalar")
+     */
+    static const char* kernelName();
+};
+
+#endif // TEXTSEARCH_HPP
@@ -0,0 +1,127 @@
+#ifndef TRENDINGTRACKER_HPP
+#define TRENDINGTRACKER_HPP
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+/**
+ * TrendingTracker - Streaming top-k of played tracks
+ * One Space-Saving summary per window: CAPACITY counters in fixed arrays,
+ * a min-heap over their counts and an open-addressing table from track
+ * to counter. A play of a tracked song bumps its counter; an untracked
+ * song takes over the smallest counter (inheriting its count as error).
+ * Memory is fixed and an update costs O(log CAPACITY), however many
+ * distinct tracks are played.
+ * Windows decay exponentially (forward decay: later plays get larger
+ * weights, scores are scaled back at query time), with the window
+ * length as the mean lifetime of a play.
+ */
+class TrendingTracker {
+public:
+    enum Window {
+        HOUR,
+        DAY,
+        WEEK
+    };
+
+    static const int WINDOW_COUNT = 3;
+    static const int CAPACITY = 256;        // counters per window
+    static const int FIELD_SIZE = 128;      // longer titles/artists are cut
+
+    struct Entry {
+        std::string title;
+        std::string artist;
+        int duration;
+        double plays;       // decayed play count (may overestimate by up to error)
+        double error;
+    };
+
+    /**
+     * Shared tracker fed by Player
+     */
+    static TrendingTracker& instance();
+
+    TrendingTracker(const TrendingTracker&) = delete;
+    TrendingTracker& operator=(const TrendingTracker&) = delete;
+
+    /**
+     * Count a play that started at timestamp (unix seconds)
+     * Does not allocate; matching ignores ASCII case
+     */
+    void record(const std::string& title, const std::string& artist, int duration, int64_t timestamp);
+
+    /**
+     * Most played tracks in a window as of now (unix seconds), best first
+     */
+    std::vector<Entry> top(Window window, size_t limit, int64_t now) const;
+
+    /**
+     * Plays recorded since start
+     */
+    uint64_t getPlayCount() const;
+
+    /**
+     * Forget every play
+     */
+    void clear();
+
+private:
+    static const int TABLE_SIZE = CAPACITY * 2;  // power of two, at most half full
+
+    struct Counter {
+        char title[FIELD_SIZE];
+        char artist[FIELD_SIZE];
+        int duration;
+        uint64_t hash;
+        double count;       // forward-decayed weight relative to landmark
+        double error;
+    };
+
+    struct Summary {
+        double lifetime;            // seconds
+        int64_t landmark;           // forward decay origin
+        int used;
+        Counter counters[CAPACITY];
+        int heap[CAPACITY];         // counter indices, smallest count first
+        int position[CAPACITY];     // counter index -> heap index
+        int table[TABLE_SIZE];      // counter index or -1
+    };
+
+    Summary summaries[WINDOW_COUNT];
+    uint64_t plays;
+    mutable std::mutex mutex;
+
+    TrendingTracker();
+
+    void reset(Summary& summary);
+
+    /**
+     * Hash of the case-folded, field-truncated title and artist
+     */
+    static uint64_t hashOf(const std::string& title, const std::string& artist);
+
+    /**
+     * Counter holding this track, or -1
+     */
+    static int find(const Summary& summary, uint64_t hash, const std::string& title, const std::string& artist);
+
+    static void tableInsert(Summary& summary, int slot);
+    static void tableErase(Summary& summary, int slot);
+
+    /**
+     * Restore heap order after the counter at heap index i grew
+     */
+    static void siftDown(Summary& summary, int i);
+
+    /**
+     * Restore heap order after a counter was appended at heap index i
+     */
+    static void siftUp(Summary& summary, int i);
+
+    static void add(Summary& summary, const std::string& title, const std::string& artist, int duration,
+                    uint64_t hash, int64_t timestamp);
+};
+
+#endif // TRENDINGTRACKER_HPP
@@ -0,0 +1,88 @@
+#ifndef WAVDECODER_HPP
+#define WAVDECODER_HPP
+
+#include "AudioSource.hpp"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <memory>
+
+/**
+ * WavDecoder - Streams PCM out of a RIFF/WAVE file
+ * Reads 8/16/24/32-bit integer and 32/64-bit float samples, including
+ * WAVE_FORMAT_EXTENSIBLE headers, and converts them to interleaved float
+ * frames. Decodes straight from the file in whatever block size the
+ * caller asks for; nothing is loaded up front.
+ * Files made from lossy sources may carry an iTunes gapless tag
+ * (iTunSMPB in an ID3 chunk); its encoder delay and padding are cut
+ * off, so the stream holds exactly the original samples.
+ */
+class WavDecoder : public AudioSource {
+public:
+    /**
+     * Open path (UTF-8); logs and returns null if it is not a WAV file we can read
+     */
+    static std::unique_ptr<WavDecoder> open(const std::string& path);
+
+    AudioFormat getFormat() const override { return format; }
+    uint64_t getLength() const override { return length; }
+    size_t read(float* out, size_t frames) override;
+    bool seek(uint64_t frame) override;
+
+    /**
+     * Read the first PREFETCH_BYTES of sample data so they are in the page cache
+     */
+    void prefetch() override;
+
+    /**
+     * Bits per sample as stored in the file
+     */
+    int getBitsPerSample() const { return bitsPerSample; }
+
+    /**
+     * Frames of encoder delay / padding skipped at the start / end
+     */
+    uint64_t getEncoderDelay() const { return delay; }
+    uint64_t getPadding() const { return padding; }
+
+    static const size_t PREFETCH_BYTES = 2 << 20;
+
+private:
+    enum Encoding {
+        INTEGER,
+        FLOAT
+    };
+
+    std::string path;
+    std::ifstream file;
+    AudioFormat format;
+    Encoding encoding;
+    int bitsPerSample;
+    int blockAlign;          // bytes per frame
+    uint64_t dataOffset;
+    uint64_t delay;
+    uint64_t padding;
+    uint64_t length;         // after trimming delay and padding
+    uint64_t position;
+    std::vector<unsigned char> raw;
+
+    WavDecoder();
+
+    /**
+     * Read the header and find the sample data; throws SystemException
+     */
+    void parse();
+
+    /**
+     * Pick up encoder delay / padding from an ID3v2 tag's iTunSMPB comment
+     * (" 00000000 <delay> <padding> <original length> ..." in hex)
+     */
+    void parseGaplessTag(const std::vector<unsigned char>& tag, uint64_t frames);
+
+    /**
+     * Convert count raw samples to float
+     */
+    void convert(const unsigned char* in, float* out, size_t count) const;
+};
+
+#endif // WAVDECODER_HPP
@@ -1,11 +1,122 @@
 #include "APIManager.hpp"
 #include "SystemManager.hpp"
+#include "Recommender.hpp"
+#include "LastFMManager.hpp"
+#include "CatalogGenerator.hpp"
+#include "DefaultCatalog.hpp"
 #include <algorithm>
+#include <mutex>
+#include <chrono>
+#include <cstdlib>
+
+namespace {
+    // Copy catalog entries into caller-owned songs
+    std::vector<Song*> toSongs(const Catalog& catalog, const std::vector<Catalog::TrackId>& ids) {
+        std::vector<Song*> songs;
+        songs.reserve(ids.size());
+        for (auto id : ids) {
+            songs.push_back(catalog.toSong(id));
+        }
+        return songs;
+    }
+
+    // Tracks with every query word first: relevance-ranked whole words,
+    // else the last word as a prefix, else a substring, else typo-tolerant
+    // matching ("blindng lights"). Tracks with only some of the words fill
+    // what is left of the limit
+    std::vector<Song*> searchField(const Catalog& catalog, const std::string& query, Catalog::Field field,
+                                   size_t limit) {
+        std::vector<Catalog::ScoredMatch> ranked = catalog.rankedSearch(query, field, limit, Catalog::POPULARITY_PRIOR);
+        std::vector<Catalog::TrackId> ids;
+        for (const auto& match : ranked) {
+            if (match.allWords) ids.push_back(match.id);
+        }
+        if (ids.empty()) {
+            ids = catalog.search(query, field, limit);
+        }
+        if (ids.empty()) {
+            ids = catalog.substringSearch(query, field, limit);
+        }
+        if (ids.empty()) {
+            for (const auto& match : catalog.fuzzySearch(query, field, limit)) {
+                ids.push_back(match.id);
+            }
+            if (!ids.empty()) SystemManager::logInfo("No exact match, showing closest results");
+        }
+        for (const auto& match : ranked) {
+            if (ids.size() >= limit) break;
+            if (!match.allWords && std::find(ids.begin(), ids.end(), match.id) == ids.end()) {
+                ids.push_back(match.id);
+            }
+        }
+        return toSongs(catalog, ids);
+    }
+
+    std::vector<Song*> toSongs(const std::vector<Recommender::Recommendation>& recommendations) {
+        std::vector<Song*> songs;
+        songs.reserve(recommendations.size());
+        for (const auto& recommendation : recommendations) {
+            const Recommender::Track& track = recommendation.track;
+            songs.push_back(new Song(track.title, track.artist, track.duration));
+        }
+        return songs;
+    }
+
+    // Every query word starts a word of the song's title or artist
+    bool matchesAllWords(Song* song, const std::vector<std::string>& queryWords) {
+        std::vector<std::string> words = Catalog::tokenize(song->getFoldedTitle() + " " + song->getFoldedArtist());
+        for (const auto& queryWord : queryWords) {
+            bool found = false;
+            for (const auto& word : words) {
+                if (word.compare(0, queryWord.size(), queryWord) == 0) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) return false;
+        }
+        return true;
+    }
+
+    std::vector<Song*> firstSongs(const Catalog& catalog, size_t count) {
+        std::vector<Catalog::TrackId> ids;
+        for (size_t i = 0; i < count && i < catalog.size(); ++i) {
+            ids.push_back((Catalog::TrackId)i);
+        }
+        return toSongs(catalog, ids);
+    }
+}
+
+Catalog& APIManager::catalog() {
+    static Catalog instance;
+    static std::once_flag loaded;
+    std::call_once(loaded, [] {
+        // MUSICPLAYER_SYNTHETIC_CATALOG="tracks[:seed]" swaps the built-in
+        // catalog for a generated one of that size
+        const char* synthetic = std::getenv("MUSICPLAYER_SYNTHETIC_CATALOG");
+        if (synthetic && *synthetic) {
+            CatalogGenerator::Options options;
+            if (CatalogGenerator::parseSpec(synthetic, options)) {
+                CatalogGenerator(options).fillCatalog(instance);
+                return;
+            }
+            SystemManager::logWarning("Ignoring MUSICPLAYER_SYNTHETIC_CATALOG='" + std::string(synthetic) +
+                                      "' (expected tracks[:seed])");
+        }
+
+        // The built-in catalog is ordered by popularity
+        long long popularity = (long long)DefaultCatalog::SIZE;
+        for (const auto& entry : DefaultCatalog::ENTRIES) {
+            instance.add(std::string(entry.title), std::string(entry.artist), entry.duration, popularity--);
+        }
+    });
+    return instance;
+}
 
 std::vector<Song*> APIManager::fetchPopularSongs() {
     try {
         SystemManager::logInfo("Fetching popular songs from database...");
-        auto songs = getMockDatabase();
+        auto songs = firstSongs(catalog(), catalog().size());
         SystemManager::logSuccess("Popular songs fetched successfully!");
         return songs;
     } catch (const std::exception& e) {
@@ -17,20 +128,7 @@ std::vector<Song*> APIManager::fetchPopularSongs() {
 std::vector<Song*> APIManager::searchSongs(const std::string& query) {
     try {
         SystemManager::logInfo("Searching songs: '" + query + "'");
-        auto allSongs = getMockDatabase();
-        std::vector<Song*> results;
-        
-        for (auto song : allSongs) {
-            std::string title = song->getTitle();
-            // Convert to lowercase for case-insensitive search
-            std::transform(title.begin(), title.end(), title.begin(), ::tolower);
-            std::string searchQuery = query;
-            std::transform(searchQuery.begin(), searchQuery.end(), searchQuery.begin(), ::tolower);
-            
-            if (title.find(searchQuery) != std::string::npos) {
-                results.push_back(new Song(*song));
-            }
-        }
+        auto results = searchField(catalog(), query, Catalog::TITLE, MAX_SEARCH_RESULTS);
         
         if (!results.empty()) {
             SystemManager::logSuccess("Found " + std::to_string(results.size()) + " songs!");
@@ -38,11 +136,6 @@ std::vector<Song*> APIManager::searchSongs(const std::string& query) {
             SystemManager::logWarning("No songs found matching: '" + query + "'");
         }
         
-        // Clean up allSongs
-        for (auto s : allSongs) {
-            delete s;
-        }
-        
         return results;
     } catch (const std::exception& e) {
         SystemManager::logError("Search error!");
@@ -50,22 +143,64 @@ std::vector<Song*> APIManager::searchSongs(const std::string& query) {
     }
 }
 
+APIManager::SearchHandle APIManager::federatedSearch(const std::string& query, const Playlist& library,
+                                                    int deadlineMs, FederatedSearch::UpdateCallback onUpdate) {
+    SearchHandle search = std::make_shared<FederatedSearch>(query, deadlineMs, onUpdate);
+
+    // Start the network lookup first so it overlaps the local ones
+    try {
+        if (LastFMManager::isInitialized()) {
+            std::weak_ptr<FederatedSearch> weak = search;
+            auto request = LastFMManager::searchTracksAsync(query, [weak](LastFMRequest& request) {
+                SearchHandle owner = weak.lock();
+                if (!owner) return;
+                if (request.getStatus() == LastFMRequest::COMPLETED) {
+                    std::vector<Song*> songs = request.takeResults();
+                    owner->deliver(FederatedSearch::LASTFM, songs);
+                    for (auto song : songs) {
+                        delete song;
+                    }
+                } else {
+                    owner->fail(FederatedSearch::LASTFM, request.getError());
+                }
+            });
+            search->setCancelHook([request] { request->cancel(); });
+        } else {
+            search->fail(FederatedSearch::LASTFM, "Last.fm is not initialized");
+        }
+    } catch (const std::exception& e) {
+        search->fail(FederatedSearch::LASTFM, e.what());
+    }
+
+    try {
+        std::vector<std::string> words = Catalog::tokenize(Catalog::fold(query));
+        std::vector<Song*> matches;
+        for (int i = 0; i < library.getSize() && !words.empty(); ++i) {
+            Song* song = library.getAt(i);
+            if (song && matchesAllWords(song, words)) matches.push_back(song);
+        }
+        search->deliver(FederatedSearch::LIBRARY, matches);
+    } catch (const std::exception& e) {
+        search->fail(FederatedSearch::LIBRARY, e.what());
+    }
+
+    try {
+        std::vector<Song*> songs = searchField(catalog(), query, Catalog::ANY, MAX_SEARCH_RESULTS);
+        search->deliver(FederatedSearch::CATALOG, songs);
+        for (auto song : songs) {
+            delete song;
+        }
+    } catch (const std::exception& e) {
+        search->fail(FederatedSearch::CATALOG, e.what());
+    }
+
+    return search;
+}
+
 std::vector<Song*> APIManager::searchByArtist(const std::string& artist) {
     try {
         SystemManager::logInfo("Searching songs by artist: '" + artist + "'");
-        auto allSongs = getMockDatabase();
-        std::vector<Song*> results;
-        
-        for (auto song : allSongs) {
-            std::string songArtist = song->getArtist();
-            std::transform(songArtist.begin(), songArtist.end(), songArtist.begin(), ::tolower);
-            std::string searchArtist = artist;
-            std::transform(searchArtist.begin(), searchArtist.end(), searchArtist.begin(), ::tolower);
-            
-            if (songArtist.find(searchArtist) != std::string::npos) {
-                results.push_back(new Song(*song));
-            }
-        }
+        auto results = searchField(catalog(), artist, Catalog::ARTIST, MAX_SEARCH_RESULTS);
         
         if (!results.empty()) {
             SystemManager::logSuccess("Found " + std::to_string(results.size()) + " songs by artist!");
@@ -73,10 +208,6 @@ std::vector<Song*> APIManager::searchByArtist(const std::string& artist) {
             SystemManager::logWarning("No songs found by artist: '" + artist + "'");
         }
         
-        for (auto s : allSongs) {
-            delete s;
-        }
-        
         return results;
     } catch (const std::exception& e) {
         SystemManager::logError("Artist search error!");
@@ -84,13 +215,21 @@ std::vector<Song*> APIManager::searchByArtist(const std::string& artist) {
     }
 }
 
-std::vector<Song*> APIManager::getTrendingSongs() {
+std::vector<Song*> APIManager::getTrendingSongs(TrendingTracker::Window window) {
     try {
         SystemManager::logInfo("Fetching trending songs...");
-        auto songs = getMockDatabase();
         
-        // Return top 5 trending (mock: first 5)
-        std::vector<Song*> trending(songs.begin(), songs.begin() + std::min(5, (int)songs.size()));
+        int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        std::vector<Song*> trending;
+        for (const auto& entry : TrendingTracker::instance().top(window, MAX_TRENDING, now)) {
+            trending.push_back(new Song(entry.title, entry.artist, entry.duration));
+        }
+        
+        // Nothing played yet: fall back to the catalog's most popular songs
+        if (trending.empty()) {
+            trending = firstSongs(catalog(), 5);
+        }
         
         SystemManager::logSuccess("Trending songs fetched!");
         return trending;
@@ -100,14 +239,29 @@ std::vector<Song*> APIManager::getTrendingSongs() {
     }
 }
 
-std::vector<Song*> APIManager::getRecommendations(const std::string& genre) {
+std::vector<Song*> APIManager::getRecommendations(const Playlist& playlist) {
     try {
-        SystemManager::logInfo("Getting recommendations for genre: '" + genre + "'");
-        auto allSongs = getMockDatabase();
-        
-        // Mock: return random 3 songs (in real implementation, filter by genre)
-        std::vector<Song*> recommendations(allSongs.begin(), allSongs.begin() + std::min(3, (int)allSongs.size()));
-        
+        SystemManager::logInfo("Getting recommendations for " + std::to_string(playlist.getSize()) + " songs...");
+
+        auto recommendations = toSongs(Recommender::instance().recommendForPlaylist(playlist, MAX_RECOMMENDATIONS));
+        if (recommendations.empty()) {
+            // Nothing co-occurs yet: suggest popular songs the playlist lacks
+            const Catalog& songs = catalog();
+            std::vector<Catalog::TrackId> ids;
+            for (size_t i = 0; i < songs.size() && ids.size() < MAX_RECOMMENDATIONS; ++i) {
+                Catalog::Track track = songs.get((Catalog::TrackId)i);
+                bool present = false;
+                for (int j = 0; j < playlist.getSize() && !present; ++j) {
+                    Song* song = playlist.getAt(j);
+                    present = song && song->getFoldedTitle() == track.foldedTitle &&
+                              song->getFoldedArtist() == track.foldedArtist;
+                }
+                if (!present) ids.push_back((Catalog::TrackId)i);
+            }
+            recommendations = toSongs(songs, ids);
+            SystemManager::logInfo("No saved playlists to learn from yet, showing popular songs");
+        }
+
         SystemManager::logSuccess("Recommendations fetched!");
         return recommendations;
     } catch (const std::exception& e) {
@@ -116,20 +270,19 @@ std::vector<Song*> APIManager::getRecommendations(const std::string& genre) {
     }
 }
 
-std::vector<Song*> APIManager::getMockDatabase() {
-    std::vector<Song*> songs;
-    
-    // Popular songs database
-    songs.push_back(new Song("Blinding Lights", "The Weeknd", 200));
-    songs.push_back(new Song("Shape of You", "Ed Sheeran", 233));
-    songs.push_back(new Song("Someone Like You", "Adele", 285));
-    songs.push_back(new Song("Bad Guy", "Billie Eilish", 194));
-    songs.push_back(new Song("Perfect", "Ed Sheeran", 263));
-    songs.push_back(new Song("Uptown Funk", "Bruno Mars", 269));
-    songs.push_back(new Song("Levitating", "Dua Lipa", 203));
-    songs.push_back(new Song("Anti-Hero", "Taylor Swift", 228));
-    songs.push_back(new Song("Heat Waves", "Glass Animals", 239));
-    songs.push_back(new Song("As It Was", "Harry Styles", 183));
-    
-    return songs;
+std::vector<Song*> APIManager::getSimilarSongs(const std::string& title, const std::string& artist) {
+    try {
+        SystemManager::logInfo("Getting songs similar to '" + title + "' by " + artist);
+        auto similar = toSongs(Recommender::instance().recommendForTrack(title, artist, MAX_RECOMMENDATIONS));
+
+        if (!similar.empty()) {
+            SystemManager::logSuccess("Found " + std::to_string(similar.size()) + " similar songs!");
+        } else {
+            SystemManager::logWarning("No saved playlist contains '" + title + "' with other songs");
+        }
+        return similar;
+    } catch (const std::exception& e) {
+        SystemManager::logError("Failed to fetch similar songs!");
+        return std::vector<Song*>();
+    }
 }
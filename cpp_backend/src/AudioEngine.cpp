@@ -0,0 +1,489 @@
+#include "AudioEngine.hpp"
+#include "AudioMixer.hpp"
+#include "SystemManager.hpp"
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+AudioEngine::AudioEngine(std::unique_ptr<AudioSink> outputSink)
+    : ring(RING_FRAMES, BLOCK_FRAMES, 2 * MAX_CHANNELS), decodeTrack(0), decodePosition(0), sourceDone(true),
+      nextTrack(0), nextPrepared(false), preroll(BLOCK_FRAMES * MAX_CHANNELS), prerollFrames(0), nextPosition(0),
+      fadeStart(0), fadeFrames(0),
+      lastTrack(0), decoderWaiting(false), sink(std::move(outputSink)), sinkFormat{0, 0}, sinkOpen(false),
+      mixBuffer(BLOCK_FRAMES * MAX_CHANNELS), remixBuffer(BLOCK_FRAMES * MAX_CHANNELS),
+      state(STOPPED), track(0), epoch(0), quitting(false), position(0), length(0), sampleRate(0), underruns(0),
+      crossfadeMillis(0), outputRate(0), speed(1.0) {
+    if (!sink) {
+        const char* spec = std::getenv("MUSICPLAYER_AUDIO_SINK");
+        if (spec && *spec) {
+            sink = AudioSink::create(spec);
+            if (!sink) {
+                SystemManager::logWarning("Ignoring MUSICPLAYER_AUDIO_SINK='" + std::string(spec) +
+                                          "' (expected null, null:fast, wav:<path> or wavf:<path>)");
+            }
+        }
+        if (!sink) sink = AudioSink::create("null");
+    }
+    const char* rate = std::getenv("MUSICPLAYER_OUTPUT_RATE");
+    if (rate && *rate) setOutputRate(std::atoi(rate));
+    decoderThread = std::thread(&AudioEngine::decodeLoop, this);
+    renderThread = std::thread(&AudioEngine::renderLoop, this);
+}
+
+AudioEngine::~AudioEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::lock_guard<std::mutex> idle(idleMutex);
+        quitting.store(true);
+    }
+    decoderWake.notify_all();
+    renderWake.notify_all();
+    if (decoderThread.joinable()) decoderThread.join();
+    if (renderThread.joinable()) renderThread.join();
+}
+
+// Sources the ring's slots can hold
+static bool playable(const AudioSource& source) {
+    AudioFormat format = source.getFormat();
+    if (format.sampleRate > 0 && format.channels > 0 && format.channels <= AudioEngine::MAX_CHANNELS) {
+        return true;
+    }
+    SystemManager::logError("Cannot play " + std::to_string(format.sampleRate) + " Hz / " +
+                            std::to_string(format.channels) + " channel audio");
+    return false;
+}
+
+std::unique_ptr<Resampler> AudioEngine::prepareSource(std::unique_ptr<AudioSource> newSource) const {
+    if (!newSource || !playable(*newSource)) return nullptr;
+    std::unique_ptr<Resampler> resampler(new Resampler(std::move(newSource), getOutputRate()));
+    resampler->setSpeed(getSpeed());
+    return resampler;
+}
+
+uint64_t AudioEngine::play(std::unique_ptr<AudioSource> newSource) {
+    std::unique_ptr<Resampler> prepared = prepareSource(std::move(newSource));
+    if (!prepared) return 0;
+
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        source = std::move(prepared);
+        id = decodeTrack = ++lastTrack;
+        decodePosition = 0;
+        sourceDone = false;
+        fadeFrames = 0;
+        previous.reset();
+        next.reset();
+        nextTrack = 0;
+        nextPrepared = false;
+        prerollFrames = 0;
+        epoch.fetch_add(1, std::memory_order_acq_rel);
+        track.store(id, std::memory_order_release);
+        position.store(0, std::memory_order_release);
+        length.store(source->getLength(), std::memory_order_release);
+        sampleRate.store(source->getFormat().sampleRate, std::memory_order_release);
+    }
+    decoderWake.notify_one();
+    setState(PLAYING);
+    return id;
+}
+
+uint64_t AudioEngine::queueNext(std::unique_ptr<AudioSource> nextSource) {
+    bool clearing = !nextSource;
+    std::unique_ptr<Resampler> prepared = prepareSource(std::move(nextSource));
+    if (!clearing && !prepared) return 0;
+
+    uint64_t id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        next.reset();
+        nextTrack = 0;
+        nextPrepared = false;
+        prerollFrames = 0;
+        nextPosition = 0;
+        fadeFrames = 0;
+        // Too late once the current track is fully decoded, or once the
+        // decoder has already moved on to a track that is not audible yet
+        if (!prepared || !source || sourceDone || decodeTrack != track.load(std::memory_order_acquire)) {
+            return 0;
+        }
+        next = std::move(prepared);
+        id = nextTrack = ++lastTrack;
+    }
+    decoderWake.notify_one();
+    return id;
+}
+
+void AudioEngine::setCrossfade(double seconds) {
+    int millis = (int)(seconds * 1000 + 0.5);
+    crossfadeMillis.store(std::min(std::max(millis, 0), MAX_CROSSFADE_MS), std::memory_order_relaxed);
+}
+
+void AudioEngine::setOutputRate(int rate) {
+    outputRate.store(std::max(rate, 0), std::memory_order_relaxed);
+}
+
+void AudioEngine::setSpeed(double newSpeed) {
+    speed.store(std::min(std::max(newSpeed, 0.5), 2.0), std::memory_order_relaxed);
+}
+
+void AudioEngine::pause() {
+    int expected = PLAYING;
+    state.compare_exchange_strong(expected, PAUSED, std::memory_order_acq_rel);
+}
+
+void AudioEngine::resume() {
+    if (getState() == PAUSED) setState(PLAYING);
+}
+
+void AudioEngine::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        source.reset();
+        previous.reset();
+        next.reset();
+        nextTrack = 0;
+        nextPrepared = false;
+        sourceDone = true;
+        fadeFrames = 0;
+        epoch.fetch_add(1, std::memory_order_acq_rel);
+        track.store(0, std::memory_order_release);
+        position.store(0, std::memory_order_release);
+        length.store(0, std::memory_order_release);
+        sampleRate.store(0, std::memory_order_release);
+    }
+    setState(STOPPED);
+}
+
+bool AudioEngine::seek(uint64_t frame) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!source) return false;
+
+        uint64_t rendering = track.load(std::memory_order_acquire);
+        if (decodeTrack != rendering && previous) {
+            // The decoder already moved on to the queued track: go back to
+            // the one being heard and queue the other again
+            source->seek(0);
+            next = std::move(source);
+            nextTrack = decodeTrack;
+            nextPrepared = false;
+            nextPosition = 0;
+            source = std::move(previous);
+            decodeTrack = rendering;
+        }
+
+        frame = std::min(frame, source->getLength());
+        if (!source->seek(frame)) return false;
+        decodePosition = frame;
+        sourceDone = false;
+        fadeFrames = 0;
+        epoch.fetch_add(1, std::memory_order_acq_rel);
+        position.store(frame, std::memory_order_release);
+    }
+    decoderWake.notify_one();
+    if (getState() == ENDED && frame < getLength()) {
+        setState(PLAYING); // seeking back from the end plays on
+    }
+    return true;
+}
+
+void AudioEngine::setState(State newState) {
+    {
+        // Under idleMutex so the render thread cannot miss the change
+        // between checking the state and parking
+        std::lock_guard<std::mutex> idle(idleMutex);
+        state.store(newState, std::memory_order_release);
+    }
+    if (newState == PLAYING) renderWake.notify_one();
+}
+
+double AudioEngine::getPositionSeconds() const {
+    int rate = getSampleRate();
+    return rate > 0 ? (double)getPosition() / rate : 0.0;
+}
+
+double AudioEngine::getLengthSeconds() const {
+    int rate = getSampleRate();
+    return rate > 0 ? (double)getLength() / rate : 0.0;
+}
+
+void AudioEngine::wakeDecoder() {
+    if (decoderWaiting.load(std::memory_order_relaxed) &&
+        ring.size() <= ring.getBlockCount() / 2 &&
+        decoderWaiting.exchange(false, std::memory_order_acq_rel)) {
+        decoderWake.notify_one();
+    }
+}
+
+void AudioEngine::prepareNext(std::unique_lock<std::mutex>& lock) {
+    std::unique_ptr<Resampler> pending = std::move(next);
+    uint64_t id = nextTrack;
+    lock.unlock();
+
+    // File I/O, so without the lock: control calls stay quick meanwhile
+    size_t frames = 0;
+    try {
+        pending->setSpeed(getSpeed());
+        pending->prefetch();
+        frames = pending->read(preroll.data(), BLOCK_FRAMES);
+    } catch (const std::exception& e) {
+        SystemManager::handleException(e);
+        frames = 0;
+        pending->seek(0);
+    }
+
+    lock.lock();
+    // Unless it was replaced or cleared in the meantime
+    if (!next && nextTrack == id) {
+        next = std::move(pending);
+        prerollFrames = frames;
+        nextPosition = frames;
+        nextPrepared = true;
+    }
+}
+
+uint64_t AudioEngine::fadeLength() const {
+    int millis = crossfadeMillis.load(std::memory_order_relaxed);
+    if (millis == 0 || !next || !nextPrepared) return 0;
+
+    int rate = source->getFormat().sampleRate;
+    if (next->getFormat().sampleRate != rate) return 0;
+    uint64_t frames = (uint64_t)millis * rate / 1000;
+    return std::min(frames, std::min(source->getLength(), next->getLength()));
+}
+
+size_t AudioEngine::readNext(float* out, uint64_t frame, size_t frames) {
+    int channels = next->getFormat().channels;
+    size_t done = 0;
+    if (frame < prerollFrames) {
+        done = (size_t)std::min<uint64_t>(frames, prerollFrames - frame);
+        std::memcpy(out, preroll.data() + frame * channels, done * channels * sizeof(float));
+    }
+    if (done < frames) {
+        uint64_t at = frame + done;
+        if (nextPosition != at && next->seek(at)) nextPosition = at;
+        size_t got = next->read(out + done * channels, frames - done);
+        nextPosition += got;
+        done += got;
+    }
+    return done;
+}
+
+void AudioEngine::spliceNext(uint64_t position) {
+    // Reads carry on after the preroll, or from position once a crossfade
+    // has used part of the track
+    bool usePreroll = position == 0 && nextPrepared;
+    if (!usePreroll) prerollFrames = 0;
+    uint64_t resume = usePreroll ? prerollFrames : position;
+    if (nextPosition != resume) next->seek(resume);
+
+    previous = std::move(source);
+    source = std::move(next);
+    decodeTrack = nextTrack;
+    decodePosition = position;
+    sourceDone = false;
+    fadeFrames = 0;
+    nextTrack = 0;
+    nextPrepared = false;
+    nextPosition = 0;
+}
+
+void AudioEngine::decodeLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        decoderWake.wait(lock, [this] {
+            return quitting.load() || (source && !sourceDone) || (next && !nextPrepared);
+        });
+        if (quitting.load()) break;
+
+        // The render thread is past the splice, so the old track can go
+        if (previous && track.load(std::memory_order_acquire) == decodeTrack) previous.reset();
+
+        if (next && !nextPrepared) {
+            prepareNext(lock);
+            continue;
+        }
+        if (!source || sourceDone) continue;
+
+        float* slot = ring.beginWrite();
+        if (!slot) {
+            // Full: park until the render thread has drained half the ring.
+            // The timeout covers a wake-up that raced with parking.
+            decoderWaiting.store(true, std::memory_order_release);
+            int rate = std::max(1, source->getFormat().sampleRate);
+            decoderWake.wait_for(lock, std::chrono::microseconds(
+                (long long)ring.getCapacityFrames() * 250000 / rate));
+            decoderWaiting.store(false, std::memory_order_relaxed);
+            continue;
+        }
+
+        try {
+            // Varispeed: the resampler carries on from the same point, so
+            // positions stay continuous and only the length changes
+            double targetSpeed = getSpeed();
+            if (source->getSpeed() != targetSpeed) source->setSpeed(targetSpeed);
+
+            AudioRing::BlockInfo info = {};
+            uint64_t trackLength = source->getLength();
+            uint64_t fade = fadeFrames > 0 ? 0 : fadeLength();
+            if (fade > 0 && decodePosition < trackLength && trackLength - decodePosition <= fade) {
+                // The fade starts here even when next was prepared late or a
+                // seek landed inside the fade: the incoming track then plays
+                // from its start over what is left, rather than joining part
+                // way through with the outgoing gain jumping down
+                fadeStart = decodePosition;
+                fadeFrames = trackLength - decodePosition;
+            }
+            size_t frames;
+
+            if (fadeFrames > 0) {
+                // Crossfade: the outgoing track in the slot, the incoming one in its second half
+                uint64_t into = decodePosition - fadeStart;
+                size_t count = (size_t)std::min<uint64_t>(BLOCK_FRAMES, fadeFrames - into);
+                int channels = source->getFormat().channels;
+                int nextChannels = next->getFormat().channels;
+                float* overlay = slot + OVERLAY_OFFSET;
+
+                // Either side may end early (a truncated file): pad with silence
+                frames = source->read(slot, count);
+                std::fill(slot + frames * channels, slot + count * channels, 0.0f);
+                size_t incoming = readNext(overlay, into, count);
+                std::fill(overlay + incoming * nextChannels, overlay + count * nextChannels, 0.0f);
+
+                frames = count;
+                info.mixChannels = nextChannels;
+                info.fadePosition = into;
+                info.fadeLength = fadeFrames;
+            } else {
+                // Blocks end where a crossfade starts, so it begins exactly on time
+                size_t count = fade > 0 && decodePosition < trackLength - fade
+                    ? (size_t)std::min<uint64_t>(BLOCK_FRAMES, trackLength - fade - decodePosition)
+                    : BLOCK_FRAMES;
+                frames = source->read(slot, count);
+                if (frames == 0 && next) {
+                    // Gapless: the next track's first frames follow in the very next block
+                    spliceNext(0);
+                    if (prerollFrames > 0) {
+                        std::memcpy(slot, preroll.data(), prerollFrames * source->getFormat().channels * sizeof(float));
+                        frames = prerollFrames;
+                        prerollFrames = 0;
+                    } else {
+                        frames = source->read(slot, BLOCK_FRAMES);
+                    }
+                }
+            }
+
+            info.track = decodeTrack;
+            info.epoch = epoch.load(std::memory_order_acquire);
+            info.position = decodePosition;
+            info.length = source->getLength();
+            info.format = source->getFormat();
+            info.frames = (uint32_t)frames;
+            info.endOfTrack = frames == 0;
+            decodePosition += frames;
+            sourceDone = info.endOfTrack;
+            ring.commitWrite(info);
+
+            if (info.mixChannels > 0 && info.fadePosition + frames >= fadeFrames) {
+                // Faded all the way: the incoming track goes on from where the fade left it
+                spliceNext(fadeFrames);
+            }
+        } catch (const std::exception& e) {
+            SystemManager::handleException(e);
+            sourceDone = true;
+        }
+    }
+}
+
+void AudioEngine::renderLoop() {
+    uint64_t renderedTrack = 0;   // track of the last block sent to the sink
+
+    while (!quitting.load(std::memory_order_acquire)) {
+        if (getState() != PLAYING) {
+            std::unique_lock<std::mutex> idle(idleMutex);
+            renderWake.wait(idle, [this] { return quitting.load() || getState() == PLAYING; });
+            continue;
+        }
+
+        AudioRing::BlockInfo info;
+        const float* samples = ring.beginRead(info);
+        uint64_t current = track.load(std::memory_order_acquire);
+        if (!samples) {
+            if (renderedTrack == current) underruns.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        if (info.epoch != epoch.load(std::memory_order_acquire)) {
+            // Left over from before a seek, stop or track change
+            ring.commitRead();
+            wakeDecoder();
+            continue;
+        }
+
+        if (info.track != current) {
+            // First block of the queued track: it is audible from here on.
+            // Fails only if a control call just changed track; look again then.
+            if (!track.compare_exchange_strong(current, info.track, std::memory_order_acq_rel)) continue;
+            length.store(info.length, std::memory_order_release);
+            sampleRate.store(info.format.sampleRate, std::memory_order_release);
+            position.store(info.position, std::memory_order_release);
+        }
+
+        if (info.endOfTrack) {
+            ring.commitRead();
+            renderedTrack = 0;
+            // A truncated file ends before the length its header promised
+            length.store(info.position, std::memory_order_release);
+            int expected = PLAYING;
+            state.compare_exchange_strong(expected, ENDED, std::memory_order_acq_rel);
+            continue;
+        }
+
+        try {
+            if (!sinkOpen || info.format != sinkFormat) {
+                sinkFormat = info.format;
+                sinkOpen = sink->open(info.format);
+                if (!sinkOpen) {
+                    SystemManager::logError("Audio output rejected " + std::to_string(info.format.sampleRate) +
+                                            " Hz / " + std::to_string(info.format.channels) + " channels");
+                    ring.commitRead();
+                    setState(STOPPED);
+                    continue;
+                }
+            }
+
+            const float* output = samples;
+            if (info.mixChannels > 0) {
+                double step = 1.0 / info.fadeLength;
+                AudioMixer::crossfade(samples, samples + OVERLAY_OFFSET, info.mixChannels, mixBuffer.data(),
+                                      info.format.channels, info.frames, (float)(info.fadePosition * step),
+                                      (float)step, remixBuffer.data());
+                output = mixBuffer.data();
+            }
+
+            bool written = sink->write(output, info.frames);
+            ring.commitRead();
+            wakeDecoder();
+            if (!written) {
+                setState(STOPPED);
+                continue;
+            }
+        } catch (const std::exception& e) {
+            SystemManager::handleException(e);
+            setState(STOPPED);
+            continue;
+        }
+
+        // A seek or new track while the sink had the block already reset the position
+        if (info.epoch == epoch.load(std::memory_order_acquire) && info.track == track.load(std::memory_order_acquire)) {
+            position.store(info.position + info.frames, std::memory_order_release);
+            length.store(info.length, std::memory_order_release);   // changes with the speed
+        }
+        renderedTrack = info.track;
+    }
+
+    if (sinkOpen) sink->close();
+}
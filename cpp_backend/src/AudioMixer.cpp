@@ -0,0 +1,136 @@
+#include "AudioMixer.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define AUDIOMIXER_SSE2 1
+#endif
+
+namespace {
+    // Gains are worked out for this many frames at a time, on the stack
+    const size_t CHUNK = 64;
+
+    // Taylor series of sin(x * pi/2): the first omitted term is below 6e-8 on [0, 1]
+    const float C1 = 1.5707963268f;
+    const float C3 = -0.6459640975f;
+    const float C5 = 0.0796926262f;
+    const float C7 = -0.0046817541f;
+    const float C9 = 0.0001604411f;
+    const float C11 = -0.0000035988f;
+
+#ifdef AUDIOMIXER_SSE2
+    __m128 gain4(__m128 x) {
+        __m128 x2 = _mm_mul_ps(x, x);
+        __m128 p = _mm_set1_ps(C11);
+        p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(C9));
+        p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(C7));
+        p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(C5));
+        p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(C3));
+        p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(C1));
+        return _mm_mul_ps(p, x);
+    }
+#endif
+
+    // Fade-out and fade-in gains of frames [0, count) of a chunk
+    void rampGains(float* fadeOut, float* fadeIn, size_t count, float start, float step) {
+        size_t i = 0;
+#ifdef AUDIOMIXER_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 offsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+        for (; i + 4 <= count; i += 4) {
+            __m128 index = _mm_add_ps(_mm_set1_ps((float)i), offsets);
+            __m128 t = _mm_add_ps(_mm_set1_ps(start), _mm_mul_ps(index, _mm_set1_ps(step)));
+            t = _mm_min_ps(_mm_max_ps(t, zero), one);
+            _mm_storeu_ps(fadeIn + i, gain4(t));
+            _mm_storeu_ps(fadeOut + i, gain4(_mm_sub_ps(one, t)));
+        }
+#endif
+        for (; i < count; ++i) {
+            float t = std::min(std::max(start + (float)i * step, 0.0f), 1.0f);
+            fadeIn[i] = AudioMixer::equalPowerGain(t);
+            fadeOut[i] = AudioMixer::equalPowerGain(1.0f - t);
+        }
+    }
+
+    // out = from * fadeOut + to * fadeIn for count frames of channels channels
+    void mixChunk(const float* from, const float* to, float* out, int channels, size_t count,
+                  const float* fadeOut, const float* fadeIn) {
+        size_t i = 0;
+#ifdef AUDIOMIXER_SSE2
+        if (channels == 1) {
+            for (; i + 4 <= count; i += 4) {
+                __m128 a = _mm_mul_ps(_mm_loadu_ps(from + i), _mm_loadu_ps(fadeOut + i));
+                __m128 b = _mm_mul_ps(_mm_loadu_ps(to + i), _mm_loadu_ps(fadeIn + i));
+                _mm_storeu_ps(out + i, _mm_add_ps(a, b));
+            }
+        } else if (channels == 2) {
+            // Four frames are two vectors of samples: spread each gain over its frame's pair
+            for (; i + 4 <= count; i += 4) {
+                __m128 gOut = _mm_loadu_ps(fadeOut + i);
+                __m128 gIn = _mm_loadu_ps(fadeIn + i);
+                const float* a = from + i * 2;
+                const float* b = to + i * 2;
+                __m128 low = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a), _mm_unpacklo_ps(gOut, gOut)),
+                                        _mm_mul_ps(_mm_loadu_ps(b), _mm_unpacklo_ps(gIn, gIn)));
+                __m128 high = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + 4), _mm_unpackhi_ps(gOut, gOut)),
+                                         _mm_mul_ps(_mm_loadu_ps(b + 4), _mm_unpackhi_ps(gIn, gIn)));
+                _mm_storeu_ps(out + i * 2, low);
+                _mm_storeu_ps(out + i * 2 + 4, high);
+            }
+        }
+#endif
+        for (; i < count; ++i) {
+            for (int c = 0; c < channels; ++c) {
+                size_t s = i * channels + c;
+                out[s] = from[s] * fadeOut[i] + to[s] * fadeIn[i];
+            }
+        }
+    }
+}
+
+float AudioMixer::equalPowerGain(float x) {
+    float x2 = x * x;
+    return x * (C1 + x2 * (C3 + x2 * (C5 + x2 * (C7 + x2 * (C9 + x2 * C11)))));
+}
+
+void AudioMixer::crossfade(const float* from, const float* to, int toChannels, float* out, int channels,
+                           size_t frames, float start, float step, float* scratch) {
+    if (toChannels != channels) {
+        remix(to, toChannels, scratch, channels, frames);
+        to = scratch;
+    }
+
+    alignas(16) float fadeOut[CHUNK];
+    alignas(16) float fadeIn[CHUNK];
+    for (size_t done = 0; done < frames; done += CHUNK) {
+        size_t count = std::min(CHUNK, frames - done);
+        size_t offset = done * channels;
+        rampGains(fadeOut, fadeIn, count, start + (float)done * step, step);
+        mixChunk(from + offset, to + offset, out + offset, channels, count, fadeOut, fadeIn);
+    }
+}
+
+void AudioMixer::remix(const float* in, int inChannels, float* out, int outChannels, size_t frames) {
+    if (inChannels == outChannels) {
+        std::memcpy(out, in, frames * inChannels * sizeof(float));
+    } else if (inChannels == 1) {
+        for (size_t i = 0; i < frames; ++i) {
+            for (int c = 0; c < outChannels; ++c) out[i * outChannels + c] = in[i];
+        }
+    } else if (outChannels == 1) {
+        float scale = 1.0f / inChannels;
+        for (size_t i = 0; i < frames; ++i) {
+            float sum = 0.0f;
+            for (int c = 0; c < inChannels; ++c) sum += in[i * inChannels + c];
+            out[i] = sum * scale;
+        }
+    } else {
+        int shared = std::min(inChannels, outChannels);
+        for (size_t i = 0; i < frames; ++i) {
+            for (int c = 0; c < shared; ++c) out[i * outChannels + c] = in[i * inChannels + c];
+            for (int c = shared; c < outChannels; ++c) out[i * outChannels + c] = 0.0f;
+        }
+    }
+}
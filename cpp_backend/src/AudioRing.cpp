@@ -0,0 +1,17 @@
+#include "AudioRing.hpp"
+
+AudioRing::AudioRing(size_t capacityFrames, size_t frames, int channels)
+    : blockFrames(frames < 1 ? 1 : frames), maxChannels(channels < 1 ? 1 : channels),
+      writeIndex(0), cachedReadIndex(0), readIndex(0), cachedWriteIndex(0) {
+    slots = 1;
+    while (slots * blockFrames < capacityFrames) slots <<= 1;
+    mask = slots - 1;
+
+    // Round slots up to whole cache lines so neighbours never share one
+    size_t perLine = CACHE_LINE / sizeof(float);
+    slotSamples = (blockFrames * maxChannels + perLine - 1) / perLine * perLine;
+    samples.assign(slots * slotSamples + perLine, 0.0f);
+    uintptr_t address = (uintptr_t)samples.data();
+    base = samples.data() + ((CACHE_LINE - address % CACHE_LINE) % CACHE_LINE) / sizeof(float);
+    infos.assign(slots, BlockInfo{0, 0, 0, 0, {0, 0}, 0, false, 0, 0, 0});
+}
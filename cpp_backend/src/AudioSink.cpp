@@ -0,0 +1,171 @@
+#include "AudioSink.hpp"
+#include "AudioMixer.hpp"
+#include "SystemManager.hpp"
+#include <filesystem>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+    void putU16(std::ofstream& out, uint16_t value) {
+        char bytes[2] = {(char)(value & 0xFF), (char)(value >> 8)};
+        out.write(bytes, 2);
+    }
+
+    void putU32(std::ofstream& out, uint32_t value) {
+        char bytes[4] = {(char)(value & 0xFF), (char)((value >> 8) & 0xFF),
+                         (char)((value >> 16) & 0xFF), (char)(value >> 24)};
+        out.write(bytes, 4);
+    }
+}
+
+std::unique_ptr<AudioSink> AudioSink::create(const std::string& spec) {
+    if (spec.empty() || spec == "null") {
+        return std::unique_ptr<AudioSink>(new NullSink(true));
+    }
+    if (spec == "null:fast") {
+        return std::unique_ptr<AudioSink>(new NullSink(false));
+    }
+    if (spec.compare(0, 4, "wav:") == 0 && spec.size() > 4) {
+        return std::unique_ptr<AudioSink>(new WavFileSink(spec.substr(4), false));
+    }
+    if (spec.compare(0, 5, "wavf:") == 0 && spec.size() > 5) {
+        return std::unique_ptr<AudioSink>(new WavFileSink(spec.substr(5), true));
+    }
+    return nullptr;
+}
+
+// ============================================================================
+// NullSink
+// ============================================================================
+
+NullSink::NullSink(bool realTime) : realTime(realTime), format{0, 0} {
+}
+
+bool NullSink::open(const AudioFormat& newFormat) {
+    format = newFormat;
+    deadline = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool NullSink::write(const float*, size_t count) {
+    if (!realTime || format.sampleRate <= 0) return true;
+
+    // Behave like a device without a buffer: return once the frames
+    // would have played. Restart the clock after an idle spell (pause)
+    // instead of racing to catch up.
+    auto now = std::chrono::steady_clock::now();
+    if (deadline < now - std::chrono::milliseconds(100)) {
+        deadline = now;
+    }
+    deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>((double)count / format.sampleRate));
+    std::this_thread::sleep_until(deadline);
+    return true;
+}
+
+// ============================================================================
+// WavFileSink
+// ============================================================================
+
+WavFileSink::WavFileSink(const std::string& path, bool floatSamples)
+    : path(path), floatSamples(floatSamples), format{0, 0}, inputChannels(0), dataBytes(0) {
+}
+
+WavFileSink::~WavFileSink() {
+    close();
+}
+
+bool WavFileSink::open(const AudioFormat& newFormat) {
+    if (file.is_open()) {
+        if (newFormat.sampleRate == format.sampleRate) {
+            // Another channel count is remixed in write()
+            inputChannels = newFormat.channels;
+            return true;
+        }
+        // Starting over would throw the recording away
+        SystemManager::logError("WAV output " + path + " is " + std::to_string(format.sampleRate) + " Hz; set " +
+                                "MUSICPLAYER_OUTPUT_RATE to record tracks of other rates");
+        return false;
+    }
+
+    format = newFormat;
+    inputChannels = newFormat.channels;
+    dataBytes = 0;
+    file.open(std::filesystem::u8path(path), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        SystemManager::logError("Failed to open WAV output: " + path);
+        return false;
+    }
+    writeHeader();
+    return (bool)file;
+}
+
+bool WavFileSink::write(const float* frames, size_t count) {
+    if (!file.is_open()) return false;
+
+    if (inputChannels != format.channels) {
+        if (remixed.size() < count * format.channels) remixed.resize(count * format.channels);
+        AudioMixer::remix(frames, inputChannels, remixed.data(), format.channels, count);
+        frames = remixed.data();
+    }
+
+    size_t samples = count * format.channels;
+    if (floatSamples) {
+        file.write((const char*)frames, samples * sizeof(float));
+        dataBytes += samples * sizeof(float);
+    } else {
+        if (converted.size() < samples) converted.resize(samples);
+        for (size_t i = 0; i < samples; ++i) {
+            float sample = std::max(-1.0f, std::min(1.0f, frames[i]));
+            converted[i] = (int16_t)std::lrint(sample * 32767.0f);
+        }
+        file.write((const char*)converted.data(), samples * sizeof(int16_t));
+        dataBytes += samples * sizeof(int16_t);
+    }
+
+    if (!file) {
+        SystemManager::logError("Failed to write WAV output: " + path);
+        return false;
+    }
+    return true;
+}
+
+void WavFileSink::close() {
+    if (!file.is_open()) return;
+    // Fill in the sizes now that they are known
+    file.seekp(0, std::ios::beg);
+    writeHeader();
+    file.close();
+}
+
+void WavFileSink::writeHeader() {
+    int bytesPerSample = floatSamples ? 4 : 2;
+    int blockAlign = format.channels * bytesPerSample;
+    // RIFF sizes are 32-bit; a longer recording keeps playing back truncated
+    uint32_t dataSize = (uint32_t)std::min<uint64_t>(dataBytes, 0xFFFFFFFF - 64);
+    uint32_t fmtSize = floatSamples ? 18 : 16;
+    uint32_t factSize = floatSamples ? 12 : 0;
+
+    file.write("RIFF", 4);
+    putU32(file, 4 + (8 + fmtSize) + factSize + (8 + dataSize));
+    file.write("WAVE", 4);
+
+    file.write("fmt ", 4);
+    putU32(file, fmtSize);
+    putU16(file, floatSamples ? 3 : 1);
+    putU16(file, (uint16_t)format.channels);
+    putU32(file, (uint32_t)format.sampleRate);
+    putU32(file, (uint32_t)(format.sampleRate * blockAlign));
+    putU16(file, (uint16_t)blockAlign);
+    putU16(file, (uint16_t)(bytesPerSample * 8));
+    if (floatSamples) {
+        putU16(file, 0); // no extension
+        file.write("fact", 4);
+        putU32(file, 4);
+        putU32(file, blockAlign ? dataSize / blockAlign : 0);
+    }
+
+    file.write("data", 4);
+    putU32(file, dataSize);
+}
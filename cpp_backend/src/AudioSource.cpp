@@ -0,0 +1,19 @@
+#include "AudioSource.hpp"
+#include <algorithm>
+#include <cstring>
+
+SilenceSource::SilenceSource(const AudioFormat& format, uint64_t length)
+    : format(format), length(length), position(0) {
+}
+
+size_t SilenceSource::read(float* out, size_t frames) {
+    size_t count = (size_t)std::min<uint64_t>(frames, length - position);
+    std::memset(out, 0, count * format.channels * sizeof(float));
+    position += count;
+    return count;
+}
+
+bool SilenceSource::seek(uint64_t frame) {
+    position = std::min(frame, length);
+    return true;
+}
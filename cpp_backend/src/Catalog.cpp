@@ -0,0 +1,912 @@
+#include "Catalog.hpp"
+#include "TextSearch.hpp"
+#include "TextFold.hpp"
+#include <algorithm>
+#include <queue>
+#include <mutex>
+#include <unordered_set>
+#include <cstdlib>
+#include <cmath>
+
+namespace {
+    bool isWordByte(unsigned char c) {
+        return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80;
+    }
+
+    // Above this many words in a prefix range, filter candidates by text instead
+    const size_t MAX_PREFIX_WORDS = 64;
+
+    // Between the fields of a track / between tracks in the folded text
+    const char FIELD_SEPARATOR = '\x1f';
+    const char TRACK_SEPARATOR = '\n';
+
+    // Galloping search: first position >= id, starting from a cursor that
+    // only moves forward (cheap when the lists are of very different sizes)
+    const Catalog::TrackId* gallop(const Catalog::TrackId* from, const Catalog::TrackId* end, Catalog::TrackId id) {
+        size_t step = 1;
+        const Catalog::TrackId* low = from;
+        while (low + step < end && low[step] < id) {
+            low += step;
+            step *= 2;
+        }
+        const Catalog::TrackId* high = low + step < end ? low + step + 1 : end;
+        return std::lower_bound(low, high, id);
+    }
+
+    // BM25 parameters: term frequency saturation and length normalization
+    const float BM25_K1 = 1.2f;
+    const float BM25_B = 0.75f;
+
+    // For ANY, an artist word is worth less than a title word
+    const float TITLE_WEIGHT = 1.0f;
+    const float ARTIST_WEIGHT = 0.7f;
+
+    // Record words used more than once in a field; returns true if any was
+    bool countRepeats(std::vector<std::string> words, std::unordered_map<std::string, int>& repeats) {
+        std::sort(words.begin(), words.end());
+        bool found = false;
+        for (size_t i = 1, run = 1; i < words.size(); ++i) {
+            run = words[i] == words[i - 1] ? run + 1 : 1;
+            if (run > 1) {
+                int& most = repeats[words[i]];
+                most = std::max(most, (int)run);
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    // Move a cursor to the first id >= id: dense lists usually need a few
+    // steps, sparse ones gallop
+    inline const Catalog::TrackId* advance(const Catalog::TrackId* cursor, const Catalog::TrackId* end, Catalog::TrackId id) {
+        for (int step = 0; step < 4; ++step) {
+            if (cursor == end || *cursor >= id) return cursor;
+            ++cursor;
+        }
+        return gallop(cursor, end, id);
+    }
+
+    // Allowed typos per word: none for very short words, where one edit
+    // turns the word into something unrelated
+    int maxDistanceFor(size_t length) {
+        if (length <= 2) return 0;
+        if (length <= 5) return 1;
+        return 2;
+    }
+
+    // Trigram postings are split by word length (top byte of the key) so
+    // a lookup only scans words whose length is within reach
+    uint32_t trigramKey(uint32_t gram, size_t length) {
+        return gram | ((uint32_t)std::min<size_t>(length, 255) << 24);
+    }
+
+    // Distinct trigrams of "$$word$$"
+    std::vector<uint32_t> trigrams(const std::string& word) {
+        std::string padded = "$$" + word + "$$";
+        std::vector<uint32_t> grams;
+        grams.reserve(padded.size() - 2);
+        for (size_t i = 0; i + 2 < padded.size(); ++i) {
+            grams.push_back(((uint32_t)(unsigned char)padded[i] << 16) |
+                            ((uint32_t)(unsigned char)padded[i + 1] << 8) |
+                            (uint32_t)(unsigned char)padded[i + 2]);
+        }
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+        return grams;
+    }
+
+    // Plain dynamic programming for patterns too long for one machine word
+    int editDistanceDP(const std::string& a, const std::string& b, int maxDistance) {
+        std::vector<int> row(b.size() + 1);
+        for (size_t j = 0; j <= b.size(); ++j) row[j] = (int)j;
+        for (size_t i = 1; i <= a.size(); ++i) {
+            int diagonal = row[0];
+            row[0] = (int)i;
+            int best = row[0];
+            for (size_t j = 1; j <= b.size(); ++j) {
+                int above = row[j];
+                row[j] = std::min(std::min(above, row[j - 1]) + 1, diagonal + (a[i - 1] != b[j - 1]));
+                diagonal = above;
+                best = std::min(best, row[j]);
+            }
+            if (best > maxDistance) return maxDistance + 1;
+        }
+        return std::min(row[b.size()], maxDistance + 1);
+    }
+}
+
+Catalog::Catalog()
+    : titleWordTotal(0), artistWordTotal(0), maxLogPopularity(0.0f) {
+}
+
+Catalog::TrackId Catalog::add(const std::string& title, const std::string& artist, int duration,
+                              long long popularity) {
+    Track track{title, artist, duration, popularity, fold(title), fold(artist)};
+    std::vector<std::string> titleWords = tokenize(track.foldedTitle);
+    std::vector<std::string> artistWords = tokenize(track.foldedArtist);
+
+    TrackStats trackStats;
+    trackStats.titleLength = (uint8_t)std::min<size_t>(titleWords.size(), 255);
+    trackStats.artistLength = (uint8_t)std::min<size_t>(artistWords.size(), 255);
+    trackStats.logPopularity = (float)std::log1p((double)std::max(0LL, popularity));
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    TrackId id = (TrackId)tracks.size();
+    tracks.push_back(std::move(track));
+    trackStats.repeats = (uint8_t)((countRepeats(titleWords, titleRepeats) ? 1 << TITLE : 0) |
+                                   (countRepeats(artistWords, artistRepeats) ? 1 << ARTIST : 0));
+    stats.push_back(trackStats);
+    titleWordTotal += trackStats.titleLength;
+    artistWordTotal += trackStats.artistLength;
+    maxLogPopularity = std::max(maxLogPopularity, trackStats.logPopularity);
+
+    const Track& stored = tracks.back();
+    textOffsets.push_back(foldedText.size());
+    foldedText += stored.foldedTitle;
+    foldedText += FIELD_SEPARATOR;
+    foldedText += stored.foldedArtist;
+    foldedText += TRACK_SEPARATOR;
+
+    indexWords(titleIndex, titleWords, id);
+    indexWords(artistIndex, artistWords, id);
+    for (const auto* words : {&titleWords, &artistWords}) {
+        for (const auto& word : *words) {
+            auto entry = anyIndex.try_emplace(word);
+            appendPosting(entry.first->second, id);
+            if (entry.second) indexVocabulary(entry.first->first);
+        }
+    }
+    return id;
+}
+
+size_t Catalog::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return tracks.size();
+}
+
+void Catalog::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    tracks.clear();
+    stats.clear();
+    titleWordTotal = 0;
+    artistWordTotal = 0;
+    titleRepeats.clear();
+    artistRepeats.clear();
+    maxLogPopularity = 0.0f;
+    foldedText.clear();
+    textOffsets.clear();
+    titleIndex.clear();
+    artistIndex.clear();
+    anyIndex.clear();
+    vocabulary.clear();
+    trigramIndex.clear();
+}
+
+std::vector<Catalog::TrackId> Catalog::search(const std::string& query, Field field, size_t limit) const {
+    std::vector<TrackId> results;
+    std::string folded = fold(query);
+    std::vector<std::string> words = tokenize(folded);
+    if (words.empty() || limit == 0) return results;
+
+    // A trailing space means the last word is complete
+    std::string prefix;
+    if (!folded.empty() && isWordByte((unsigned char)folded.back())) {
+        prefix = words.back();
+        words.pop_back();
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    const Index& index = indexFor(field);
+
+    std::vector<const Postings*> lists;
+    for (const auto& word : words) {
+        auto it = index.find(word);
+        if (it == index.end()) return results;
+        lists.push_back(&it->second);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const Postings* a, const Postings* b) { return a->size() < b->size(); });
+
+    if (lists.empty()) {
+        prefixMerge(index, prefix, limit, results);
+        return results;
+    }
+
+    // A prefix that names a single word is intersected like a full word; one
+    // covering a few rare words drives the intersection with its merged
+    // postings; anything broader is checked against the folded text
+    std::vector<TrackId> prefixIds;
+    bool prefixDriven = false;
+    if (!prefix.empty()) {
+        size_t rangeWords = 0, total = 0;
+        const Postings* only = nullptr;
+        for (auto it = index.lower_bound(prefix);
+             it != index.end() && it->first.compare(0, prefix.size(), prefix) == 0 && rangeWords <= MAX_PREFIX_WORDS;
+             ++it) {
+            rangeWords++;
+            total += it->second.size();
+            only = &it->second;
+        }
+
+        if (rangeWords == 0) return results;
+        if (rangeWords == 1) {
+            lists.push_back(only);
+            std::sort(lists.begin(), lists.end(),
+                      [](const Postings* a, const Postings* b) { return a->size() < b->size(); });
+            prefix.clear();
+        } else if (rangeWords <= MAX_PREFIX_WORDS && total < lists[0]->size() / 4) {
+            prefixMerge(index, prefix, (size_t)-1, prefixIds);
+            prefixDriven = true;
+        }
+    }
+
+    const std::vector<TrackId>& driver = prefixDriven ? prefixIds : static_cast<const std::vector<TrackId>&>(*lists[0]);
+    std::vector<const TrackId*> cursors;
+    for (size_t i = prefixDriven ? 0 : 1; i < lists.size(); ++i) {
+        cursors.push_back(lists[i]->data());
+    }
+    size_t firstOther = prefixDriven ? 0 : 1;
+
+    for (TrackId id : driver) {
+        bool matched = true;
+        for (size_t i = 0; i < cursors.size(); ++i) {
+            const Postings& list = *lists[firstOther + i];
+            const TrackId* end = list.data() + list.size();
+            cursors[i] = gallop(cursors[i], end, id);
+            if (cursors[i] == end) return results; // this list is exhausted
+            if (*cursors[i] != id) {
+                matched = false;
+                break;
+            }
+        }
+        if (!matched) continue;
+
+        if (!prefixDriven && !prefix.empty()) {
+            const Track& track = tracks[id];
+            if (!(field != ARTIST && hasWordWithPrefix(track.foldedTitle, prefix)) &&
+                !(field != TITLE && hasWordWithPrefix(track.foldedArtist, prefix))) {
+                continue;
+            }
+        }
+
+        results.push_back(id);
+        if (results.size() >= limit) break;
+    }
+    return results;
+}
+
+std::vector<Catalog::ScoredMatch> Catalog::rankedSearch(const std::string& query, Field field, size_t limit,
+                                                        float popularityWeight) const {
+    std::vector<ScoredMatch> results;
+    std::vector<std::string> words = tokenize(fold(query));
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    if (words.empty() || limit == 0) return results;
+
+    // One scoring term per (query word, field) that occurs in the catalog
+    struct Term {
+        Field field;
+        const TrackId* begin;
+        const TrackId* cursor;
+        const TrackId* end;
+        const uint8_t* uses;    // parallel to begin
+        float idf;              // includes the field weight
+        float lengthScale;      // k1 * b / average field length
+        float upperBound;       // best score this term can add to any track
+        float byLength[256];    // score at tf = 1, by field length
+        float repeatedBound[256]; // best score in a field with repeated words at least this long
+    };
+
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (tracks.empty()) return results;
+    const float documents = (float)tracks.size();
+
+    // Words the catalog does not have cannot add to any score
+    const Index& index = indexFor(field);
+    const size_t queryWords = words.size();
+    words.erase(std::remove_if(words.begin(), words.end(),
+                               [&](const std::string& word) { return index.find(word) == index.end(); }),
+                words.end());
+    const bool everyWordIndexed = words.size() == queryWords;
+    if (words.empty()) return results;
+
+    std::vector<Term> terms;
+    for (Field termField : {TITLE, ARTIST}) {
+        if (field != ANY && field != termField) continue;
+        const Index& index = termField == TITLE ? titleIndex : artistIndex;
+        const std::unordered_map<std::string, int>& repeats = termField == TITLE ? titleRepeats : artistRepeats;
+        uint64_t wordTotal = termField == TITLE ? titleWordTotal : artistWordTotal;
+        float averageLength = std::max(1.0f, (float)wordTotal / documents);
+        float weight = (field == ANY && termField == ARTIST) ? ARTIST_WEIGHT : TITLE_WEIGHT;
+
+        for (size_t w = 0; w < words.size(); ++w) {
+            const std::string& word = words[w];
+            auto it = index.find(word);
+            if (it == index.end()) continue;
+            const Postings& list = it->second;
+            float df = (float)list.size();
+
+            Term term;
+            term.field = termField;
+            term.begin = list.data();
+            term.cursor = term.begin;
+            term.end = list.data() + list.size();
+            term.uses = list.uses.data();
+            term.idf = weight * std::log(1.0f + (documents - df + 0.5f) / (df + 0.5f));
+            term.lengthScale = BM25_K1 * BM25_B / averageLength;
+
+            // Largest tf of this word at the shortest field that can hold it
+            auto repeat = repeats.find(word);
+            float tf = repeat == repeats.end() ? 1.0f : (float)repeat->second;
+            float norm = BM25_K1 * (1.0f - BM25_B) + term.lengthScale * tf;
+            term.upperBound = term.idf * tf * (BM25_K1 + 1.0f) / (tf + norm);
+            for (int length = 0; length < 256; ++length) {
+                float lengthNorm = BM25_K1 * (1.0f - BM25_B) + term.lengthScale * (float)length;
+                term.byLength[length] = term.idf * (BM25_K1 + 1.0f) / (1.0f + lengthNorm);
+            }
+            // A word cannot occur more often than the field has words, so
+            // short fields with repeats stay well below upperBound
+            float longer = 0.0f;
+            for (int length = 255; length >= 0; --length) {
+                float uses = std::min(tf, (float)std::max(length, 1));
+                float lengthNorm = BM25_K1 * (1.0f - BM25_B) + term.lengthScale * (float)length;
+                longer = std::max(longer, term.idf * uses * (BM25_K1 + 1.0f) / (uses + lengthNorm));
+                term.repeatedBound[length] = longer;
+            }
+            terms.push_back(term);
+        }
+    }
+    if (terms.empty()) return results;
+
+    // The prior is relative to what a query word scores as a one-word
+    // field, so the same weight means the same for common and rare words
+    float wordScore = 0.0f;
+    for (const auto& term : terms) {
+        wordScore = std::max(wordScore, term.byLength[1]);
+    }
+    const float priorBound = (popularityWeight > 0.0f && maxLogPopularity > 0.0f)
+        ? popularityWeight * wordScore : 0.0f;
+    const float priorScale = priorBound > 0.0f ? priorBound / maxLogPopularity : 0.0f;
+
+    // Score of the track the term's cursor is on
+    auto termScore = [&](const Term& term, TrackId id) {
+        const TrackStats& track = stats[id];
+        uint8_t length = term.field == TITLE ? track.titleLength : track.artistLength;
+        uint8_t uses = term.uses[term.cursor - term.begin];
+        if (uses == 1) return term.byLength[length];
+
+        float tf = (float)uses;
+        float norm = BM25_K1 * (1.0f - BM25_B) + term.lengthScale * (float)length;
+        return term.idf * tf * (BM25_K1 + 1.0f) / (tf + norm);
+    };
+
+    // Heap of the best capacity matches, worst on top; ties go to the lower id
+    auto better = [](const ScoredMatch& a, const ScoredMatch& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.id < b.id;
+    };
+    std::vector<ScoredMatch> heap;
+    heap.reserve(std::min(limit, tracks.size()));
+    size_t capacity = limit;
+    float threshold = -1.0f;
+    auto offer = [&](const ScoredMatch& match) {
+        if (heap.size() < capacity) {
+            heap.push_back(match);
+            std::push_heap(heap.begin(), heap.end(), better);
+        } else if (better(match, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.back() = match;
+            std::push_heap(heap.begin(), heap.end(), better);
+        }
+        if (heap.size() == capacity) threshold = heap.front().score;
+    };
+
+    // Cheap bound from the track's field lengths, assuming it has every
+    // word in every field (lets most tracks skip the list probes once the
+    // heap is full). With a single word, uses (from the driving list) caps
+    // how often the track has it
+    auto trackBound = [&](TrackId id, uint8_t uses) {
+        const TrackStats& track = stats[id];
+        float bound = priorScale * track.logPopularity;
+        for (const auto& term : terms) {
+            uint8_t length = term.field == TITLE ? track.titleLength : track.artistLength;
+            float termBound;
+            if (!(track.repeats & (1 << term.field))) {
+                termBound = term.byLength[length];
+            } else if (words.size() == 1) {
+                float tf = (float)uses;
+                float norm = BM25_K1 * (1.0f - BM25_B) + term.lengthScale * (float)length;
+                termBound = term.idf * tf * (BM25_K1 + 1.0f) / (tf + norm);
+            } else {
+                termBound = term.repeatedBound[length];
+            }
+            bound += termBound;
+        }
+        return bound;
+    };
+
+    // The same for a block of the driving list. BM25 is
+    // idf (k1 + 1) / (1 + k1 (1 - b) / tf + (k1 b / average) length / tf),
+    // so the block's most uses and fewest words per use bound the driving
+    // word's score; other words only get the shortest fields
+    auto blockBound = [&](const PostingBlock& block) {
+        float bound = priorScale * block.logPopularity;
+        for (const auto& term : terms) {
+            float termBound;
+            if (words.size() == 1) {
+                float perUse = term.field == TITLE ? block.titlePerUse : block.artistPerUse;
+                termBound = term.idf * (BM25_K1 + 1.0f) /
+                    (1.0f + BM25_K1 * (1.0f - BM25_B) / (float)block.uses + term.lengthScale * perUse);
+            } else {
+                termBound = term.repeatedBound[term.field == TITLE ? block.titleLength : block.artistLength];
+            }
+            bound += termBound;
+        }
+        return bound;
+    };
+
+    // Tracks with every query word come first: intersect the field's
+    // lists (rarest drives) and score only the survivors
+    std::vector<const Postings*> lists;
+    for (const auto& word : words) {
+        lists.push_back(&index.find(word)->second);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const Postings* a, const Postings* b) { return a->size() < b->size(); });
+    const Postings& driver = *lists[0];
+    std::vector<const TrackId*> cursors;
+    for (size_t i = 1; i < lists.size(); ++i) {
+        cursors.push_back(lists[i]->data());
+    }
+
+    bool exhausted = false;
+    for (size_t position = 0; position < driver.size() && !exhausted; ) {
+        // Ids only grow, so a block that cannot beat the k-th best
+        // (ties included) is passed over whole
+        if (position % POSTING_BLOCK == 0 && heap.size() == capacity &&
+            blockBound(driver.blocks[position / POSTING_BLOCK]) <= threshold) {
+            position += POSTING_BLOCK;
+            continue;
+        }
+        TrackId id = driver[position];
+        uint8_t uses = driver.uses[position++];
+
+        bool matched = true;
+        for (size_t i = 0; i < cursors.size(); ++i) {
+            const TrackId* end = lists[i + 1]->data() + lists[i + 1]->size();
+            cursors[i] = advance(cursors[i], end, id);
+            if (cursors[i] == end) {
+                exhausted = true;
+                break;
+            }
+            if (*cursors[i] != id) {
+                matched = false;
+                break;
+            }
+        }
+        if (exhausted || !matched) continue;
+        if (heap.size() == capacity && trackBound(id, uses) <= threshold) continue;
+
+        float score = priorScale * stats[id].logPopularity;
+        for (auto& term : terms) {
+            term.cursor = advance(term.cursor, term.end, id);
+            if (term.cursor != term.end && *term.cursor == id) score += termScore(term, id);
+        }
+        offer(ScoredMatch{id, score, everyWordIndexed});
+    }
+
+    // A heap that is not full holds every track with all the words; a
+    // single-word query has nothing else to find
+    std::sort_heap(heap.begin(), heap.end(), better);
+    results.swap(heap);
+    if (results.size() == limit || words.size() == 1) return results;
+
+    // Fill the remaining slots with partial matches, ranked with MaxScore.
+    // Terms are sorted by upper bound; once the k-th best score beats what
+    // the weakest terms (plus the prior) could reach together, tracks found
+    // only in those lists are skipped and the lists are just probed
+    std::vector<TrackId> complete;
+    for (const auto& match : results) {
+        complete.push_back(match.id);
+    }
+    std::sort(complete.begin(), complete.end());
+    capacity = limit - results.size();
+    threshold = -1.0f;
+
+    for (auto& term : terms) {
+        term.cursor = term.begin;
+    }
+    std::sort(terms.begin(), terms.end(), [](const Term& a, const Term& b) { return a.upperBound < b.upperBound; });
+    std::vector<float> boundSums(terms.size());
+    float sum = 0.0f;
+    for (size_t i = 0; i < terms.size(); ++i) {
+        sum += terms[i].upperBound;
+        boundSums[i] = sum;
+    }
+
+    size_t firstEssential = 0;
+    while (true) {
+        while (firstEssential < terms.size() && boundSums[firstEssential] + priorBound <= threshold) {
+            firstEssential++;
+        }
+        if (firstEssential == terms.size()) break;
+
+        TrackId id = (TrackId)-1;
+        for (size_t i = firstEssential; i < terms.size(); ++i) {
+            if (terms[i].cursor != terms[i].end) id = std::min(id, *terms[i].cursor);
+        }
+        if (id == (TrackId)-1) break;
+
+        float score = priorScale * stats[id].logPopularity;
+        for (size_t i = firstEssential; i < terms.size(); ++i) {
+            Term& term = terms[i];
+            if (term.cursor != term.end && *term.cursor == id) {
+                score += termScore(term, id);
+                ++term.cursor;
+            }
+        }
+        if (std::binary_search(complete.begin(), complete.end(), id)) continue;
+
+        // Non-essential terms, strongest first, while they can still matter
+        for (size_t i = firstEssential; i-- > 0; ) {
+            if (score + boundSums[i] <= threshold) break;
+            Term& term = terms[i];
+            term.cursor = advance(term.cursor, term.end, id);
+            if (term.cursor != term.end && *term.cursor == id) {
+                score += termScore(term, id);
+            }
+        }
+        offer(ScoredMatch{id, score, false});
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), better);
+    results.insert(results.end(), heap.begin(), heap.end());
+    return results;
+}
+
+void Catalog::prefixMerge(const Index& index, const std::string& prefix, size_t limit,
+                          std::vector<TrackId>& results) {
+    // k-way merge of the posting lists of every word in the prefix range
+    typedef std::pair<TrackId, std::pair<const TrackId*, const TrackId*>> Cursor;
+    std::priority_queue<Cursor, std::vector<Cursor>, std::greater<Cursor>> heap;
+    for (auto it = index.lower_bound(prefix);
+         it != index.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+        const Postings& list = it->second;
+        if (!list.empty()) {
+            heap.push(Cursor(list[0], std::make_pair(list.data() + 1, list.data() + list.size())));
+        }
+    }
+
+    while (!heap.empty() && results.size() < limit) {
+        Cursor top = heap.top();
+        heap.pop();
+        if (results.empty() || results.back() != top.first) results.push_back(top.first);
+        if (top.second.first != top.second.second) {
+            heap.push(Cursor(*top.second.first, std::make_pair(top.second.first + 1, top.second.second)));
+        }
+    }
+}
+
+std::vector<Catalog::TrackId> Catalog::substringSearch(const std::string& query, Field field, size_t limit) const {
+    std::vector<TrackId> results;
+    std::string needle = fold(query);
+    size_t first = needle.find_first_not_of(" \t");
+    if (first == std::string::npos || limit == 0) return results;
+    needle = needle.substr(first, needle.find_last_not_of(" \t") - first + 1);
+
+    // Separators never match, so a hit always lies inside one field
+    if (needle.find(FIELD_SEPARATOR) != std::string::npos || needle.find(TRACK_SEPARATOR) != std::string::npos) {
+        return results;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    const char* text = foldedText.data();
+    size_t length = foldedText.size();
+    size_t pos = 0;
+    TrackId id = 0;
+
+    while (pos < length) {
+        size_t hit = TextSearch::find(text + pos, length - pos, needle.data(), needle.size());
+        if (hit == TextSearch::npos) break;
+        hit += pos;
+
+        // Hits only move forward, so the owning track is at or after the last one
+        id = (TrackId)(std::upper_bound(textOffsets.begin() + id, textOffsets.end(), hit) - textOffsets.begin() - 1);
+        size_t separator = textOffsets[id] + tracks[id].foldedTitle.size();
+        size_t next = id + 1 < textOffsets.size() ? textOffsets[id + 1] : length;
+
+        bool inTitle = hit < separator;
+        if (field == ARTIST && inTitle) {
+            pos = separator + 1;    // the artist may still match
+            continue;
+        }
+        if (field != TITLE || inTitle) {
+            results.push_back(id);
+            if (results.size() >= limit) break;
+        }
+        pos = next;
+    }
+    return results;
+}
+
+std::vector<Catalog::FuzzyMatch> Catalog::fuzzySearch(const std::string& query, Field field, size_t limit) const {
+    std::vector<FuzzyMatch> matches;
+    std::vector<std::string> words = tokenize(fold(query));
+    if (words.empty() || limit == 0) return matches;
+
+    // One group per query word: the close words and their posting lists in the field
+    struct Group {
+        std::vector<std::pair<const std::string*, int>> words;
+        std::vector<const Postings*> lists;
+        size_t total;
+    };
+
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    const Index& index = indexFor(field);
+
+    std::vector<Group> groups;
+    for (const auto& word : words) {
+        Group group;
+        group.total = 0;
+        for (const auto& similar : similarWords(word, maxDistanceFor(word.size()))) {
+            auto it = index.find(*similar.first);
+            if (it == index.end()) continue; // close word exists, but only in the other field
+            group.words.push_back(similar);
+            group.lists.push_back(&it->second);
+            group.total += it->second.size();
+        }
+        if (group.lists.empty()) return matches;
+        groups.push_back(std::move(group));
+    }
+    std::sort(groups.begin(), groups.end(), [](const Group& a, const Group& b) { return a.total < b.total; });
+
+    // Candidates from the rarest group: union of its lists, keeping the
+    // smallest distance per track (order does not matter, ranking comes last)
+    thread_local std::vector<uint8_t> bestDistance;
+    if (bestDistance.size() < tracks.size()) bestDistance.resize(tracks.size(), 0xff);
+
+    typedef std::pair<TrackId, int> Candidate;
+    std::vector<Candidate> candidates;
+    for (size_t i = 0; i < groups[0].lists.size(); ++i) {
+        uint8_t distance = (uint8_t)groups[0].words[i].second;
+        for (TrackId id : *groups[0].lists[i]) {
+            if (bestDistance[id] == 0xff) candidates.push_back(Candidate(id, 0));
+            if (distance < bestDistance[id]) bestDistance[id] = distance;
+        }
+    }
+    for (auto& candidate : candidates) {
+        candidate.second = bestDistance[candidate.first];
+        bestDistance[candidate.first] = 0xff;
+    }
+
+    // Other words: mark their tracks the same way and keep candidates that
+    // are marked; when a word's lists dwarf the candidates, scan the
+    // candidates' text for its close words instead
+    auto bestInText = [](const std::string& text, const Group& group, int best) {
+        size_t i = 0;
+        while (i < text.size()) {
+            while (i < text.size() && !isWordByte((unsigned char)text[i])) ++i;
+            size_t start = i;
+            while (i < text.size() && isWordByte((unsigned char)text[i])) ++i;
+            if (i == start) break;
+            for (const auto& close : group.words) {
+                if (close.first->size() == i - start && (best < 0 || close.second < best) &&
+                    text.compare(start, i - start, *close.first) == 0) {
+                    best = close.second;
+                }
+            }
+        }
+        return best;
+    };
+
+    for (size_t g = 1; g < groups.size() && !candidates.empty(); ++g) {
+        const Group& group = groups[g];
+        bool scanText = group.total > candidates.size() * group.words.size() * 4;
+
+        if (!scanText) {
+            for (size_t i = 0; i < group.lists.size(); ++i) {
+                uint8_t distance = (uint8_t)group.words[i].second;
+                for (TrackId id : *group.lists[i]) {
+                    if (distance < bestDistance[id]) bestDistance[id] = distance;
+                }
+            }
+        }
+
+        size_t kept = 0;
+        for (const Candidate& candidate : candidates) {
+            int best = -1;
+            if (!scanText) {
+                if (bestDistance[candidate.first] != 0xff) best = bestDistance[candidate.first];
+            } else {
+                const Track& track = tracks[candidate.first];
+                if (field != ARTIST) best = bestInText(track.foldedTitle, group, best);
+                if (field != TITLE) best = bestInText(track.foldedArtist, group, best);
+            }
+            if (best >= 0) candidates[kept++] = Candidate(candidate.first, candidate.second + best);
+        }
+        candidates.resize(kept);
+
+        if (!scanText) {
+            for (const Postings* list : group.lists) {
+                for (TrackId id : *list) bestDistance[id] = 0xff;
+            }
+        }
+    }
+
+    matches.reserve(candidates.size());
+    for (const Candidate& candidate : candidates) {
+        matches.push_back(FuzzyMatch{candidate.first, candidate.second});
+    }
+
+    auto better = [this](const FuzzyMatch& a, const FuzzyMatch& b) {
+        if (a.distance != b.distance) return a.distance < b.distance;
+        long long popularityA = tracks[a.id].popularity, popularityB = tracks[b.id].popularity;
+        if (popularityA != popularityB) return popularityA > popularityB;
+        return a.id < b.id;
+    };
+    size_t keep = std::min(limit, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + keep, matches.end(), better);
+    matches.resize(keep);
+    return matches;
+}
+
+int Catalog::editDistance(const std::string& a, const std::string& b, int maxDistance) {
+    size_t m = a.size(), n = b.size();
+    if ((size_t)std::abs((long long)m - (long long)n) > (size_t)maxDistance) return maxDistance + 1;
+    if (m == 0) return (int)n;
+    if (m > 64) return editDistanceDP(a, b, maxDistance);
+
+    // Myers / Hyyrö: column j of the DP matrix as vertical +1/-1 delta bit-vectors
+    uint64_t peq[256] = {};
+    for (size_t i = 0; i < m; ++i) {
+        peq[(unsigned char)a[i]] |= 1ULL << i;
+    }
+
+    uint64_t pv = m == 64 ? ~0ULL : (1ULL << m) - 1;
+    uint64_t mv = 0;
+    const uint64_t last = 1ULL << (m - 1);
+    int score = (int)m;
+
+    for (size_t j = 0; j < n; ++j) {
+        uint64_t eq = peq[(unsigned char)b[j]];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+
+        if (ph & last) {
+            score++;
+        } else if (mh & last) {
+            score--;
+        }
+
+        // The score can drop by at most one per remaining character
+        if (score - (int)(n - j - 1) > maxDistance) return maxDistance + 1;
+
+        ph = (ph << 1) | 1; // top row of the matrix grows by one per column
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+    return std::min(score, maxDistance + 1);
+}
+
+Catalog::Track Catalog::get(TrackId id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return tracks.at(id);
+}
+
+Song* Catalog::toSong(TrackId id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    const Track& track = tracks.at(id);
+    return new Song(track.title, track.artist, track.duration);
+}
+
+std::string Catalog::fold(const std::string& text) {
+    return TextFold::fold(text, true);
+}
+
+std::vector<std::string> Catalog::tokenize(const std::string& folded) {
+    std::vector<std::string> words;
+    size_t i = 0;
+    while (i < folded.size()) {
+        while (i < folded.size() && !isWordByte((unsigned char)folded[i])) ++i;
+        size_t start = i;
+        while (i < folded.size() && isWordByte((unsigned char)folded[i])) ++i;
+        if (i > start) words.push_back(folded.substr(start, i - start));
+    }
+    return words;
+}
+
+const Catalog::Index& Catalog::indexFor(Field field) const {
+    if (field == TITLE) return titleIndex;
+    if (field == ARTIST) return artistIndex;
+    return anyIndex;
+}
+
+void Catalog::indexWords(Index& index, const std::vector<std::string>& words, TrackId id) {
+    for (const auto& word : words) {
+        appendPosting(index[word], id);
+    }
+}
+
+void Catalog::appendPosting(Postings& list, TrackId id) {
+    // Repeated words (or a word in both title and artist) are listed once
+    if (!list.empty() && list.back() == id) {
+        if (list.uses.back() < 255) list.uses.back()++;
+    } else {
+        if (list.size() % POSTING_BLOCK == 0) {
+            list.blocks.push_back(PostingBlock{255, 255, 1, 255.0f, 255.0f, 0.0f});
+        }
+        list.push_back(id);
+        list.uses.push_back(1);
+    }
+
+    const TrackStats& track = stats[id];
+    PostingBlock& block = list.blocks.back();
+    float uses = (float)list.uses.back();
+    block.titleLength = std::min(block.titleLength, track.titleLength);
+    block.artistLength = std::min(block.artistLength, track.artistLength);
+    block.uses = std::max(block.uses, list.uses.back());
+    block.titlePerUse = std::min(block.titlePerUse, (float)track.titleLength / uses);
+    block.artistPerUse = std::min(block.artistPerUse, (float)track.artistLength / uses);
+    block.logPopularity = std::max(block.logPopularity, track.logPopularity);
+}
+
+void Catalog::indexVocabulary(const std::string& word) {
+    uint32_t wordId = (uint32_t)vocabulary.size();
+    vocabulary.push_back(&word);
+    for (uint32_t gram : trigrams(word)) {
+        trigramIndex[trigramKey(gram, word.size())].push_back(wordId);
+    }
+}
+
+std::vector<std::pair<const std::string*, int>> Catalog::similarWords(const std::string& word, int maxDistance) const {
+    std::vector<std::pair<const std::string*, int>> similar;
+
+    if (maxDistance == 0) {
+        auto it = anyIndex.find(word);
+        if (it != anyIndex.end()) similar.push_back(std::make_pair(&it->first, 0));
+        return similar;
+    }
+
+    // Count shared trigrams per vocabulary word; each edit destroys at
+    // most three of the query's trigrams, so fewer shared means too far
+    thread_local std::vector<uint8_t> counts;
+    thread_local std::vector<uint32_t> touched;
+    if (counts.size() < vocabulary.size()) counts.resize(vocabulary.size());
+
+    std::vector<uint32_t> grams = trigrams(word);
+    int needed = std::max(1, (int)grams.size() - 3 * maxDistance);
+
+    size_t minLength = word.size() > (size_t)maxDistance ? word.size() - maxDistance : 1;
+    for (size_t length = minLength; length <= word.size() + maxDistance; ++length) {
+        for (uint32_t gram : grams) {
+            auto it = trigramIndex.find(trigramKey(gram, length));
+            if (it == trigramIndex.end()) continue;
+            for (uint32_t wordId : it->second) {
+                if (counts[wordId] == 0) touched.push_back(wordId);
+                if (counts[wordId] < 255) counts[wordId]++;
+            }
+        }
+    }
+
+    for (uint32_t wordId : touched) {
+        if (counts[wordId] >= needed) {
+            int distance = editDistance(word, *vocabulary[wordId], maxDistance);
+            if (distance <= maxDistance) similar.push_back(std::make_pair(vocabulary[wordId], distance));
+        }
+        counts[wordId] = 0;
+    }
+    touched.clear();
+    return similar;
+}
+
+bool Catalog::hasWordWithPrefix(const std::string& folded, const std::string& prefix) {
+    size_t pos = folded.find(prefix);
+    while (pos != std::string::npos) {
+        if (pos == 0 || !isWordByte((unsigned char)folded[pos - 1])) return true;
+        pos = folded.find(prefix, pos + 1);
+    }
+    return false;
+}
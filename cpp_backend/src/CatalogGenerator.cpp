@@ -0,0 +1,630 @@
+#include "CatalogGenerator.hpp"
+#include "SystemManager.hpp"
+#include <algorithm>
+#include <fstream>
+#include <unordered_set>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    // Independent random streams per kind of draw
+    const uint64_t TRACK_STREAM = 0x7472616b;
+    const uint64_t ARTIST_STREAM = 0x61727473;
+    const uint64_t PLAYLIST_STREAM = 0x706c7374;
+
+    // Listeners of the most popular track
+    const double TOP_LISTENERS = 5.0e6;
+
+    // A themed playlist still picks this share from other genres
+    const double OFF_GENRE_SHARE = 0.15;
+
+    // splitmix64: the generator's only source of randomness
+    uint64_t nextRandom(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, 1)
+    double uniform(uint64_t& state) {
+        return (double)(nextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    size_t pick(uint64_t& state, size_t count) {
+        return (size_t)(nextRandom(state) % count);
+    }
+
+    uint64_t streamState(uint64_t seed, uint64_t stream, uint64_t index) {
+        uint64_t state = seed ^ (stream * 0xD6E8FEB86659FD93ULL) ^ (index * 0x9E3779B97F4A7C15ULL);
+        nextRandom(state);
+        return state;
+    }
+
+    template <size_t N>
+    size_t countOf(const char* const (&)[N]) {
+        return N;
+    }
+
+    // Title words, roughly most common first (drawn Zipfian)
+    const char* const ENGLISH_WORDS[] = {
+        "Love", "You", "Me", "My", "Night", "Heart", "Time", "Baby", "Life", "Girl", "World", "Dream",
+        "Home", "Light", "Fire", "Day", "Back", "Man", "Way", "Eyes", "Good", "Blue", "Gone", "Dance",
+        "Tonight", "Forever", "Never", "Little", "Wild", "Sweet", "Summer", "Rain", "Lonely", "Down",
+        "Stay", "Crazy", "Lost", "Free", "Run", "Rock", "Young", "Road", "Soul", "Angel", "Money",
+        "Golden", "Star", "City", "Fall", "Feel", "Midnight", "Shine", "Broken", "Hold", "Sky", "Fly",
+        "Together", "Alone", "Moon", "Kiss", "Boy", "River", "Ocean", "Blood", "Dark", "Gold", "Sun",
+        "Wonder", "Cold", "Water", "Remember", "Fever", "Highway", "Paradise", "Ghost", "Secret",
+        "Electric", "Diamond", "Thunder", "Silver", "Heaven", "Hurricane", "Stranger", "Believer",
+        "Lights", "Story", "Trouble", "Sugar", "Hands", "Song", "Morning", "Wings", "Storm", "Magic",
+        "Tears", "Shadow", "Promise", "Honey", "Velvet", "Echo", "Mirror", "Neon", "Savage", "Rebel",
+        "Lullaby", "Horizon", "Gravity", "Satellite", "Wildfire", "Daylight", "Runaway", "Anthem",
+        "Butterfly", "Champagne", "Sunflower", "Bitter", "Cherry", "Coffee", "Glass", "Kingdom",
+        "Monster", "Oxygen", "Poison", "Riot", "Rose", "Shelter", "Smoke", "Stone", "Tokyo", "Vegas",
+        "Waves", "Wolves", "Youth", "Zero", "Blinding", "Levitating", "Bohemian", "Rhapsody"
+    };
+    const char* const SPANISH_WORDS[] = {
+        "Amor", "Corazón", "Noche", "Vida", "Mi", "Tu", "Te", "Quiero", "Bailar", "Canción", "Sueño",
+        "Mujer", "Cielo", "Fuego", "Besos", "Mañana", "Sol", "Luna", "Siempre", "Nunca", "Tiempo",
+        "Dolor", "Pasión", "Ilusión", "Rumba", "Despacito", "Bonita", "Alegría", "Mar", "Niña",
+        "Camino", "Olvidar", "También", "Así", "Adiós", "Feliz", "Loco", "Bésame", "Mucho", "Año"
+    };
+    const char* const FRENCH_WORDS[] = {
+        "Amour", "Je", "Tu", "Mon", "Cœur", "Été", "Rêve", "Nuit", "Toujours", "Vie", "Belle",
+        "Chanson", "Ciel", "Où", "Là", "Premier", "Fête", "Soleil", "Étoile", "Danse", "Mère",
+        "Ça", "Après", "Dernière", "Liberté", "Lumière", "Papillon", "Frère", "Paris", "Encore",
+        "Très", "Naïve", "Doux", "Voilà", "Déjà", "Mélodie", "Hôtel", "Garçon", "Fenêtre", "Noël"
+    };
+    const char* const GERMAN_WORDS[] = {
+        "Liebe", "Nacht", "Herz", "Ich", "Du", "Für", "Immer", "Zeit", "Träume", "Stadt", "Grün",
+        "Schön", "Über", "Mädchen", "Größer", "Straße", "Feuer", "Himmel", "Lügen", "Tränen",
+        "Müde", "Sehnsucht", "Glück", "Frühling", "König", "Schwarz", "Weiß", "Mond", "Sonne",
+        "Wunder", "Morgen", "Heimat", "Küss", "Mich", "Ohne", "Dich", "Freiheit", "Engel"
+    };
+    const char* const PORTUGUESE_WORDS[] = {
+        "Saudade", "Coração", "Amor", "Você", "Não", "Canção", "Paixão", "Sertão", "Ilusão",
+        "Verão", "Mãe", "Irmão", "Chão", "Sonho", "Noite", "Garota", "Ipanema", "Água", "Beija",
+        "Flor", "Céu", "Alegria", "Só", "Até", "Lá", "Estrela", "Sempre", "Meu", "Bem"
+    };
+    const char* const NORDIC_WORDS[] = {
+        "Hoppípolla", "Ára", "Bátur", "Glósóli", "Sæglópur", "Hjarta", "Kærlighed", "Lys", "Søvn",
+        "Nøkken", "Fjäril", "Sommar", "Vinter", "Höst", "Vår", "Himmel", "Ljós", "Svefn", "Tár",
+        "Drømme", "Havet", "Blåbær", "Ånd", "Måne", "Fjørd", "Stjärna", "Älskar", "Dig", "Øy"
+    };
+    const char* const RUSSIAN_WORDS[] = {
+        "Любовь", "Ночь", "Город", "Звезда", "Небо", "Сердце", "Мама", "Весна", "Лето", "Зима",
+        "Кино", "Группа", "Крови", "Кукушка", "Река", "Море", "Ветер", "Дорога", "Песня", "Солнце",
+        "Огонь", "Ёлка", "Тишина", "Луна", "Дождь", "Танцы", "Мечта", "Сон", "Свет", "Жизнь",
+        "Время", "Перемен", "Последний", "Герой", "Москва", "Снег", "Белый", "Чёрный", "Моя", "Ты"
+    };
+    const char* const GREEK_WORDS[] = {
+        "Αγάπη", "Καρδιά", "Νύχτα", "Θάλασσα", "Ουρανός", "Φως", "Όνειρο", "Ζωή", "Ήλιος",
+        "Φεγγάρι", "Αστέρι", "Καλοκαίρι", "Χορός", "Τραγούδι", "Μάτια", "Δάκρυα", "Σ'αγαπώ",
+        "Πάντα", "Ποτέ", "Απόψε", "Μοναξιά", "Βροχή", "Άνεμος", "Σιωπή", "Ελπίδα"
+    };
+    const char* const JAPANESE_WORDS[] = {
+        "愛", "夢", "夜", "花", "空", "君", "恋", "春", "夏", "心", "紅蓮華", "青", "星",
+        "さくら", "ありがとう", "また", "会いたい", "パプリカ", "レモン", "ドライフラワー",
+        "の", "と", "に", "光", "風", "海", "雨", "キミ", "ハート", "メロディー", "シンデレラ",
+        "東京", "未来", "群青", "夜に駆ける", "怪物", "アイドル", "ミックスナッツ", "前前前世"
+    };
+    const char* const KOREAN_WORDS[] = {
+        "사랑", "너", "나", "밤", "꿈", "봄날", "하늘", "별", "마음", "눈물", "다이너마이트",
+        "버터", "우리", "안녕", "기억", "노래", "여름", "겨울", "바다", "소원", "시간", "처음",
+        "아름다운", "세상", "빛", "그대", "좋아", "보고싶다", "이별", "행복"
+    };
+
+    // Artist names: a given name and a family name built from a head
+    // syllable and one or two tails, so millions of artists rarely share
+    // a name
+    const char* const ENGLISH_GIVEN[] = {
+        "Lana", "Jack", "Emma", "Noah", "Olivia", "Liam", "Ava", "Mason", "Sophia", "Ethan", "Harper", "Lucas",
+        "Chloe", "Miles", "Ruby", "Dylan", "Nina", "Oscar", "Ivy", "Leo", "Grace", "Owen", "Hazel", "Caleb",
+        "Stella", "Jonah", "Violet", "Felix", "Iris", "Eli", "Nora", "Jude", "Clara", "Wyatt", "Maya", "Reid",
+        "Sadie", "Toby", "Willa", "Zane"
+    };
+    const char* const ENGLISH_HEADS[] = {
+        "Ash", "Bar", "Bel", "Black", "Brad", "Brook", "Car", "Chan", "Dal", "Dun", "Ever", "Fair", "Fitz",
+        "Gold", "Green", "Hal", "Hart", "Hol", "Kings", "Lang", "Mar", "Mont", "Nor", "Pem", "Red", "Ros",
+        "Stan", "Thorn", "Wes", "Whit"
+    };
+    const char* const ENGLISH_TAILS[] = {
+        "ton", "ley", "by", "wood", "field", "son", "ford", "well", "er", "man", "ridge", "worth", "more",
+        "ham", "ing", "bury", "ston", "lock", "stead", "ell", "win", "ick", "hurst", "combe", "dale",
+        "brook", "wick", "ard", "en", "sey"
+    };
+    const char* const ENGLISH_ADJECTIVES[] = {
+        "Midnight", "Black", "Electric", "Silver", "Velvet", "Neon", "Wild", "Crystal", "Arctic", "Paper",
+        "Golden", "Lonely", "Royal", "Broken", "Cosmic", "Hollow", "Crimson", "Static", "Atomic", "Glass",
+        "Hidden", "Lunar", "Modern", "Northern", "Polar", "Rusty", "Secret", "Stone", "Sugar", "Young"
+    };
+    const char* const ENGLISH_BANDS[] = {
+        "Owls", "Keys", "Kings", "Wolves", "Strokes", "Killers", "Lions", "Monkeys", "Pilots", "Ghosts",
+        "Tigers", "Sparrows", "Machines", "Engines", "Seasons", "Satellites", "Foxes", "Hearts", "Rivers",
+        "Saints", "Shadows", "Ravens", "Dreamers", "Drifters", "Giants", "Horses", "Lovers", "Mirrors",
+        "Vandals", "Wires"
+    };
+    const char* const BAND_FORMS[] = {"The %s %s", "%s %s", "%s %s Club", "%s %s Collective", "%s %s Orchestra"};
+
+    const char* const SPANISH_GIVEN[] = {
+        "José", "María", "Sofía", "Andrés", "Lucía", "Raúl", "Inés", "Martín", "Ángel", "Julián", "Pilar",
+        "Rocío", "Iván", "Elena", "Ramón", "Begoña"
+    };
+    const char* const SPANISH_HEADS[] = {
+        "Gar", "Mar", "Ro", "Ló", "Pé", "Sán", "Gó", "Nú", "Iba", "Mu", "Her", "Fer", "Ál", "Cas", "Or",
+        "Bel", "Ca", "Do", "Es", "Vi"
+    };
+    const char* const SPANISH_TAILS[] = {
+        "cía", "tínez", "dríguez", "pez", "rez", "chez", "mez", "ñez", "rra", "ñoz", "nández", "nán",
+        "varez", "tillo", "tega", "trán", "rera", "mingo", "teban", "llar"
+    };
+    const char* const FRENCH_GIVEN[] = {
+        "Zoé", "Léa", "Chloé", "Hélène", "Éric", "Jérôme", "Céline", "Noël", "Gaëlle", "François", "Anaïs",
+        "Raphaël", "Mathéo", "Joël", "Maëlle", "Stéphane"
+    };
+    const char* const FRENCH_HEADS[] = {
+        "Le", "Du", "Bé", "Gau", "Mer", "Fou", "Gi", "Ché", "Lé", "Mo", "Ro", "Ber", "Cha", "Fa", "Ma",
+        "Bou", "Da", "Gé", "Pé", "Vi"
+    };
+    const char* const FRENCH_TAILS[] = {
+        "fèvre", "pré", "ranger", "thier", "cier", "nier", "raud", "vesque", "reau", "land", "chet", "rin",
+        "lin", "mont", "ville", "tel", "çon", "court", "vin", "bert"
+    };
+    const char* const GERMAN_GIVEN[] = {
+        "Jürgen", "Jörg", "Lena", "Björn", "Günter", "Käthe", "Lukas", "Mia", "Jonas", "Sören", "Bärbel",
+        "Heike", "Ute", "Götz", "Anja", "Maximilian"
+    };
+    const char* const GERMAN_HEADS[] = {
+        "Mül", "Schrö", "Schä", "Kö", "Bä", "Hoff", "Krü", "Vo", "Wag", "Bek", "Schmi", "Fi", "We", "Mey",
+        "Schul", "Ri", "Ne", "Zim", "Lo", "Hu"
+    };
+    const char* const GERMAN_TAILS[] = {
+        "ler", "der", "fer", "hler", "cker", "mann", "ger", "gel", "ner", "ker", "dt", "scher", "ber", "er",
+        "ze", "chter", "umann", "mer", "renz", "ß"
+    };
+    const char* const PORTUGUESE_GIVEN[] = {
+        "João", "Conceição", "Gonçalo", "Inês", "Sebastião", "Simão", "Marília", "Caetano", "Tomás", "Luísa",
+        "Antônio", "Lúcia", "Vinícius", "Flávia", "Márcio", "Tânia"
+    };
+    const char* const PORTUGUESE_HEADS[] = {
+        "Gon", "Ma", "Con", "Ara", "Si", "Bran", "Fal", "Lei", "Ri", "So", "Pe", "Ca", "Fe", "Mo", "Oli",
+        "Ro", "Va", "Me", "Ba", "Lo"
+    };
+    const char* const PORTUGUESE_TAILS[] = {
+        "çalves", "galhães", "ceição", "újo", "mões", "dão", "cão", "tão", "beiro", "uza", "reira",
+        "rvalho", "rnandes", "ntes", "veira", "cha", "sconcelos", "ndes", "rbosa", "pes"
+    };
+    const char* const NORDIC_GIVEN[] = {
+        "Björk", "Jónsi", "Sigrún", "Ólafur", "Søren", "Åsa", "Øystein", "Þór", "Ásgeir", "Märta", "Ragnhildur",
+        "Björn", "Kåre", "Dagný", "Jörmundur", "Solveig"
+    };
+    const char* const NORDIC_HEADS[] = {
+        "Guð", "Bir", "Arn", "Sø", "Øde", "Å", "Lind", "Jó", "Strö", "Ny", "Berg", "Sig", "Ás", "Þor",
+        "Hall", "Dahl", "Fjeld", "Holm", "Sand", "Vik"
+    };
+    const char* const NORDIC_TAILS[] = {
+        "mundsdóttir", "gisson", "alds", "rensen", "gaard", "berg", "qvist", "hannsson", "m", "ström", "sson",
+        "dóttir", "sen", "lund", "strand", "vik", "heim", "dal", "by", "ås"
+    };
+    const char* const RUSSIAN_GIVEN[] = {
+        "Виктор", "Алла", "Земфира", "Борис", "Анна", "Дмитрий", "Елена", "Сергей", "Юлия", "Пётр",
+        "Наталья", "Алёна", "Максим", "Фёдор", "Ольга", "Артём"
+    };
+    const char* const RUSSIAN_HEADS[] = {
+        "Цо", "Пуга", "Гребен", "Шев", "Ива", "Кузне", "Смир", "По", "Лебе", "Ор", "Соко", "Моро", "Вол",
+        "Ники", "Зай", "Пав", "Семё", "Го", "Вино", "Бело"
+    };
+    const char* const RUSSIAN_TAILS[] = {
+        "й", "чёва", "щиков", "чук", "нова", "цов", "вина", "пов", "дев", "лова", "лов", "зов", "ков",
+        "тин", "цев", "лин", "нов", "лубев", "градов", "усов"
+    };
+    const char* const GREEK_GIVEN[] = {
+        "Γιώργος", "Μαρία", "Νίκος", "Ελένη", "Δημήτρης", "Άννα", "Κώστας", "Σοφία", "Γιάννης", "Δέσποινα",
+        "Χάρης", "Αλέξης", "Ειρήνη", "Σταύρος", "Κατερίνα", "Μάνος"
+    };
+    const char* const GREEK_HEADS[] = {
+        "Παπα", "Νταλά", "Βίσ", "Ρέ", "Αλε", "Γαλά", "Θεοδω", "Χατζι", "Μαρκό", "Πάρι", "Κα", "Σα",
+        "Κωνσταντι", "Μη", "Γεωρ", "Νικο", "Δη", "Βλα", "Πε", "Ζα"
+    };
+    const char* const GREEK_TAILS[] = {
+        "δόπουλος", "ρας", "ση", "μος", "ξίου", "νη", "ράκης", "δάκις", "πουλος", "ος", "ίδης", "κης",
+        "νου", "τζής", "άτος", "λης", "ρίδης", "χος", "ίου", "ίδου"
+    };
+    const char* const JAPANESE_GIVEN[] = {
+        "玄師", "ヒカル", "優里", "花子", "健太", "美咲", "翔", "蓮", "結衣", "陽菜", "大輝", "あいみょん",
+        "由紀", "拓也", "さくら", "亮"
+    };
+    const char* const JAPANESE_HEADS[] = {
+        "佐", "鈴", "高", "田", "渡", "伊", "山", "中", "小", "加", "米", "宇", "松", "井", "木", "林",
+        "清", "森", "池", "石"
+    };
+    const char* const JAPANESE_TAILS[] = {
+        "藤", "木", "橋", "中", "辺", "本", "村", "林", "田", "津", "多田", "川", "上", "野", "水", "口",
+        "原", "島", "崎", "谷"
+    };
+    const char* const KOREAN_GIVEN[] = {
+        "민준", "서연", "지우", "하은", "도윤", "수아", "지호", "예린", "태양", "은비", "정국", "지민",
+        "서준", "하린", "윤서", "시우"
+    };
+    // Korean family names are one syllable
+    const char* const KOREAN_HEADS[] = {
+        "김", "이", "박", "최", "정", "강", "조", "윤", "장", "임", "한", "오", "서", "신", "권", "황"
+    };
+
+    struct Language {
+        const char* const* words;
+        size_t wordCount;
+        const char* const* given;
+        size_t givenCount;
+        const char* const* heads;
+        size_t headCount;
+        const char* const* tails;
+        size_t tailCount;
+        bool spaced;        // words separated by spaces
+        bool familyFirst;   // "Family Given" (Japanese), "FamilyGiven" (Korean)
+        double weight;      // share among the non-English artists
+    };
+
+    const Language LANGUAGES[] = {
+        {ENGLISH_WORDS, countOf(ENGLISH_WORDS),
+         ENGLISH_GIVEN, countOf(ENGLISH_GIVEN),
+         ENGLISH_HEADS, countOf(ENGLISH_HEADS),
+         ENGLISH_TAILS, countOf(ENGLISH_TAILS),
+         true, false, 0.0},
+        {SPANISH_WORDS, countOf(SPANISH_WORDS),
+         SPANISH_GIVEN, countOf(SPANISH_GIVEN),
+         SPANISH_HEADS, countOf(SPANISH_HEADS),
+         SPANISH_TAILS, countOf(SPANISH_TAILS),
+         true, false, 0.24},
+        {FRENCH_WORDS, countOf(FRENCH_WORDS),
+         FRENCH_GIVEN, countOf(FRENCH_GIVEN),
+         FRENCH_HEADS, countOf(FRENCH_HEADS),
+         FRENCH_TAILS, countOf(FRENCH_TAILS),
+         true, false, 0.12},
+        {GERMAN_WORDS, countOf(GERMAN_WORDS),
+         GERMAN_GIVEN, countOf(GERMAN_GIVEN),
+         GERMAN_HEADS, countOf(GERMAN_HEADS),
+         GERMAN_TAILS, countOf(GERMAN_TAILS),
+         true, false, 0.10},
+        {PORTUGUESE_WORDS, countOf(PORTUGUESE_WORDS),
+         PORTUGUESE_GIVEN, countOf(PORTUGUESE_GIVEN),
+         PORTUGUESE_HEADS, countOf(PORTUGUESE_HEADS),
+         PORTUGUESE_TAILS, countOf(PORTUGUESE_TAILS),
+         true, false, 0.10},
+        {NORDIC_WORDS, countOf(NORDIC_WORDS),
+         NORDIC_GIVEN, countOf(NORDIC_GIVEN),
+         NORDIC_HEADS, countOf(NORDIC_HEADS),
+         NORDIC_TAILS, countOf(NORDIC_TAILS),
+         true, false, 0.05},
+        {RUSSIAN_WORDS, countOf(RUSSIAN_WORDS),
+         RUSSIAN_GIVEN, countOf(RUSSIAN_GIVEN),
+         RUSSIAN_HEADS, countOf(RUSSIAN_HEADS),
+         RUSSIAN_TAILS, countOf(RUSSIAN_TAILS),
+         true, false, 0.09},
+        {GREEK_WORDS, countOf(GREEK_WORDS),
+         GREEK_GIVEN, countOf(GREEK_GIVEN),
+         GREEK_HEADS, countOf(GREEK_HEADS),
+         GREEK_TAILS, countOf(GREEK_TAILS),
+         true, false, 0.04},
+        {JAPANESE_WORDS, countOf(JAPANESE_WORDS),
+         JAPANESE_GIVEN, countOf(JAPANESE_GIVEN),
+         JAPANESE_HEADS, countOf(JAPANESE_HEADS),
+         JAPANESE_TAILS, countOf(JAPANESE_TAILS),
+         false, true, 0.14},
+        {KOREAN_WORDS, countOf(KOREAN_WORDS),
+         KOREAN_GIVEN, countOf(KOREAN_GIVEN),
+         KOREAN_HEADS, countOf(KOREAN_HEADS),
+         nullptr, 0,
+         true, true, 0.12}
+    };
+
+    const int ENGLISH = 0;
+    const int JAPANESE = 8;
+    const int KOREAN = 9;
+    const int LANGUAGE_COUNT = (int)(sizeof(LANGUAGES) / sizeof(LANGUAGES[0]));
+
+    // Words per title, 1..8 (weights in percent)
+    const int TITLE_LENGTH_WEIGHTS[] = {18, 28, 22, 14, 8, 5, 3, 2};
+
+    // Share of English artists that are bands rather than people
+    const double BAND_SHARE = 0.1;
+
+    // Title words made up from name syllables instead of the common words
+    const double RARE_WORD_SHARE = 0.2;
+
+    // Chance that an artist sings a title in English anyway
+    const double ENGLISH_TITLE_SHARE = 0.15;
+
+    CatalogGenerator::Options withDefaults(CatalogGenerator::Options options) {
+        if (options.artistCount == 0) {
+            options.artistCount = std::max<size_t>(1, options.trackCount / CatalogGenerator::TRACKS_PER_ARTIST);
+        }
+        if (options.genres < 1) options.genres = 1;
+        return options;
+    }
+
+    void writeJsonTrack(std::ofstream& file, const CatalogGenerator::Track& track, bool last) {
+        file << "    {\n";
+        file << "      \"title\": \"" << track.title << "\",\n";
+        file << "      \"artist\": \"" << track.artist << "\",\n";
+        file << "      \"duration\": " << track.duration << "\n";
+        file << "    }" << (last ? "" : ",") << "\n";
+    }
+
+    void writeM3UTrack(std::ofstream& file, const CatalogGenerator::Track& track) {
+        file << "#EXTINF:" << track.duration << "," << track.artist << " - " << track.title << "\n";
+        file << track.artist << "/" << track.title << ".mp3\n";
+    }
+}
+
+CatalogGenerator::Options::Options()
+    : seed(42), trackCount(1000), artistCount(0), artistSkew(1.0), trackSkew(0.8), unicodeShare(0.2),
+      genres(12) {
+}
+
+CatalogGenerator::CatalogGenerator(const Options& requested)
+    : options(withDefaults(requested)),
+      artists(options.artistCount, options.artistSkew),
+      tracks(std::max<size_t>(1, options.trackCount), options.trackSkew) {
+    for (const auto& language : LANGUAGES) {
+        vocabularies.push_back(ZipfSampler(language.wordCount, 1.0));
+    }
+}
+
+CatalogGenerator::Track CatalogGenerator::track(size_t index) const {
+    uint64_t state = streamState(options.seed, TRACK_STREAM, index);
+    Artist performer = artist(artists.sample(state));
+
+    int language = uniform(state) < ENGLISH_TITLE_SHARE ? ENGLISH : performer.language;
+    Track result;
+    result.title = title(language, state);
+    result.artist = performer.name;
+
+    // Versions and guests, as in real catalogs
+    double extra = uniform(state);
+    if (extra < 0.05) {
+        result.title += " (Remastered " + std::to_string(1965 + (int)pick(state, 55)) + ")";
+    } else if (extra < 0.09) {
+        result.title += " (feat. " + artist(artists.sample(state)).name + ")";
+    } else if (extra < 0.12) {
+        result.title += " - Live";
+    } else if (extra < 0.14) {
+        result.title += " (Acoustic)";
+    } else if (extra < 0.15) {
+        result.title += " [Radio Edit]";
+    }
+
+    // Mostly 2-5 minutes (Irwin-Hall around 215 s), with a tail of long tracks
+    if (uniform(state) < 0.05) {
+        result.duration = 300 + (int)pick(state, 600);
+    } else {
+        double sum = uniform(state) + uniform(state) + uniform(state) + uniform(state);
+        result.duration = 120 + (int)(190.0 * sum / 4.0);
+    }
+
+    result.popularity = std::max(1LL, (long long)std::llround(TOP_LISTENERS / std::pow((double)index + 1.0, options.trackSkew)));
+    return result;
+}
+
+void CatalogGenerator::fillCatalog(Catalog& catalog) const {
+    SystemManager::logInfo("Generating " + std::to_string(options.trackCount) + " synthetic tracks (seed " +
+                           std::to_string(options.seed) + ")...");
+    for (size_t i = 0; i < options.trackCount; ++i) {
+        Track generated = track(i);
+        catalog.add(generated.title, generated.artist, generated.duration, generated.popularity);
+    }
+    SystemManager::logSuccess("Synthetic catalog ready!");
+}
+
+std::vector<size_t> CatalogGenerator::playlistTracks(size_t playlist, size_t length) const {
+    std::vector<size_t> picked;
+    if (options.trackCount == 0) return picked;
+
+    uint64_t state = streamState(options.seed, PLAYLIST_STREAM, playlist);
+    int genre = (int)pick(state, (size_t)options.genres);
+
+    // Popular tracks of the playlist's genre, and a few from elsewhere;
+    // small catalogs may run out, so the attempts are bounded
+    std::unordered_set<size_t> seen;
+    size_t attempts = length * (size_t)options.genres * 20;
+    while (picked.size() < length && picked.size() < options.trackCount && attempts-- > 0) {
+        size_t index = tracks.sample(state) - 1;
+        if (seen.count(index)) continue;
+        bool offGenre = uniform(state) < OFF_GENRE_SHARE;
+        if (!offGenre && artist(artistRank(index)).genre != genre) continue;
+        seen.insert(index);
+        picked.push_back(index);
+    }
+    return picked;
+}
+
+Playlist* CatalogGenerator::buildPlaylist(size_t playlist, size_t length) const {
+    Playlist* result = new Playlist();
+    for (size_t index : playlistTracks(playlist, length)) {
+        Track generated = track(index);
+        result->addLast(new Song(generated.title, generated.artist, generated.duration));
+    }
+    return result;
+}
+
+bool CatalogGenerator::writeJson(const std::string& path, const std::string& name,
+                                 const std::vector<size_t>& indices) const {
+    return write(path, JSON, name, &indices);
+}
+
+bool CatalogGenerator::writeJson(const std::string& path, const std::string& name) const {
+    return write(path, JSON, name, nullptr);
+}
+
+bool CatalogGenerator::writeM3U(const std::string& path, const std::vector<size_t>& indices) const {
+    return write(path, M3U, "", &indices);
+}
+
+bool CatalogGenerator::writeM3U(const std::string& path) const {
+    return write(path, M3U, "", nullptr);
+}
+
+bool CatalogGenerator::parseSpec(const std::string& spec, Options& options) {
+    try {
+        size_t used = 0;
+        unsigned long long count = std::stoull(spec, &used);
+        if (count == 0) return false;
+        options.trackCount = (size_t)count;
+        if (used == spec.size()) return true;
+        if (spec[used] != ':') return false;
+
+        std::string seed = spec.substr(used + 1);
+        options.seed = std::stoull(seed, &used);
+        return used == seed.size();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+CatalogGenerator::Artist CatalogGenerator::artist(size_t rank) const {
+    uint64_t state = streamState(options.seed, ARTIST_STREAM, rank);
+    Artist result;
+    result.genre = (int)pick(state, (size_t)options.genres);
+
+    result.language = ENGLISH;
+    if (uniform(state) < options.unicodeShare) {
+        double draw = uniform(state);
+        for (int i = 1; i < LANGUAGE_COUNT; ++i) {
+            draw -= LANGUAGES[i].weight;
+            result.language = i;
+            if (draw < 0) break;
+        }
+    }
+
+    const Language& language = LANGUAGES[result.language];
+    std::string given = language.given[pick(state, language.givenCount)];
+    std::string family = language.heads[pick(state, language.headCount)];
+    if (language.tailCount > 0) {
+        family += language.tails[pick(state, language.tailCount)];
+        if (uniform(state) < 0.3) family += language.tails[pick(state, language.tailCount)];
+    }
+
+    if (result.language == ENGLISH && uniform(state) < BAND_SHARE) {
+        char band[96];
+        std::snprintf(band, sizeof(band), BAND_FORMS[pick(state, countOf(BAND_FORMS))],
+                      ENGLISH_ADJECTIVES[pick(state, countOf(ENGLISH_ADJECTIVES))],
+                      ENGLISH_BANDS[pick(state, countOf(ENGLISH_BANDS))]);
+        result.name = band;
+    } else if (result.language == KOREAN) {
+        result.name = family + given;
+    } else if (result.language == JAPANESE) {
+        result.name = family + " " + given;
+    } else {
+        result.name = given + " " + family;
+    }
+    return result;
+}
+
+size_t CatalogGenerator::artistRank(size_t index) const {
+    uint64_t state = streamState(options.seed, TRACK_STREAM, index);
+    return artists.sample(state);
+}
+
+bool CatalogGenerator::write(const std::string& path, Format format, const std::string& name,
+                             const std::vector<size_t>* indices) const {
+    try {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            SystemManager::logError("Failed to open file for writing: " + path);
+            return false;
+        }
+
+        size_t count = indices ? indices->size() : options.trackCount;
+        if (format == JSON) {
+            file << "{\n";
+            file << "  \"playlist_name\": \"" << name << "\",\n";
+            file << "  \"created_at\": \"synthetic (seed " << options.seed << ")\",\n";
+            file << "  \"songs\": [\n";
+        } else {
+            file << "#EXTM3U\n";
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            Track generated = track(indices ? (*indices)[i] : i);
+            if (format == JSON) {
+                writeJsonTrack(file, generated, i + 1 == count);
+            } else {
+                writeM3UTrack(file, generated);
+            }
+        }
+
+        if (format == JSON) {
+            file << "  ]\n";
+            file << "}\n";
+        }
+        return file.good();
+    } catch (const std::exception& e) {
+        SystemManager::logError("Failed to write synthetic tracks: " + std::string(e.what()));
+        return false;
+    }
+}
+
+std::string CatalogGenerator::title(int language, uint64_t& state) const {
+    const Language& words = LANGUAGES[language];
+
+    int draw = (int)pick(state, 100);
+    int length = 1;
+    for (int weight : TITLE_LENGTH_WEIGHTS) {
+        draw -= weight;
+        if (draw < 0) break;
+        ++length;
+    }
+    // Unspaced titles read as one or two long words
+    if (!words.spaced) length = (length + 1) / 2;
+
+    std::string result;
+    for (int i = 0; i < length; ++i) {
+        if (i > 0 && words.spaced) result += ' ';
+        if (uniform(state) < RARE_WORD_SHARE) {
+            // Names and places: the long tail of the vocabulary
+            result += words.heads[pick(state, words.headCount)];
+            result += words.tailCount > 0 ? words.tails[pick(state, words.tailCount)]
+                                          : words.given[pick(state, words.givenCount)];
+        } else {
+            result += words.words[vocabularies[language].sample(state) - 1];
+        }
+    }
+    return result;
+}
+
+CatalogGenerator::ZipfSampler::ZipfSampler(size_t count, double exponent)
+    : n((double)std::max<size_t>(1, count)), exponent(exponent) {
+    hIntegralX1 = hIntegral(1.5) - 1.0;
+    hIntegralN = hIntegral(n + 0.5);
+    s = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+}
+
+size_t CatalogGenerator::ZipfSampler::sample(uint64_t& state) const {
+    while (true) {
+        double u = hIntegralN + uniform(state) * (hIntegralX1 - hIntegralN);
+        double x = hIntegralInverse(u);
+        double k = std::floor(x + 0.5);
+        if (k < 1.0) k = 1.0;
+        else if (k > n) k = n;
+        if (k - x <= s || u >= hIntegral(k + 0.5) - h(k)) return (size_t)k;
+    }
+}
+
+double CatalogGenerator::ZipfSampler::h(double x) const {
+    return std::exp(-exponent * std::log(x));
+}
+
+double CatalogGenerator::ZipfSampler::hIntegral(double x) const {
+    // (x^(1 - exponent) - 1) / (1 - exponent), continuous at exponent = 1
+    double logX = std::log(x);
+    double t = (1.0 - exponent) * logX;
+    double ratio = std::fabs(t) > 1e-8 ? std::expm1(t) / t : 1.0 + t * 0.5 * (1.0 + t / 3.0 * (1.0 + 0.25 * t));
+    return ratio * logX;
+}
+
+double CatalogGenerator::ZipfSampler::hIntegralInverse(double x) const {
+    double t = x * (1.0 - exponent);
+    if (t < -1.0) t = -1.0;
+    double ratio = std::fabs(t) > 1e-8 ? std::log1p(t) / t : 1.0 - t * (0.5 - t * (1.0 / 3.0 - 0.25 * t));
+    return std::exp(ratio * x);
+}
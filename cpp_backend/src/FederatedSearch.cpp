@@ -0,0 +1,229 @@
+#include "FederatedSearch.hpp"
+#include "SystemManager.hpp"
+#include <algorithm>
+
+namespace {
+    // Reciprocal rank fusion: a result at rank r (1-based) of a source adds
+    // 1 / (RANK_OFFSET + r); the offset keeps one source's top hit from
+    // outweighing agreement between sources
+    const double RANK_OFFSET = 10.0;
+
+    bool isWordByte(unsigned char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+    }
+}
+
+FederatedSearch::FederatedSearch(const std::string& query, int deadlineMs, UpdateCallback onUpdate)
+    : query(query),
+      deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(0, deadlineMs))),
+      onUpdate(onUpdate) {
+    for (int s = 0; s < SOURCE_COUNT; ++s) {
+        status[s] = PENDING;
+    }
+}
+
+FederatedSearch::~FederatedSearch() {
+    if (cancelHook && !allAnsweredLocked()) {
+        try {
+            cancelHook();
+        } catch (const std::exception& e) {
+            SystemManager::handleException(e);
+        }
+    }
+}
+
+bool FederatedSearch::wait() {
+    bool expired;
+    bool answered;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait_until(lock, deadline, [this] { return allAnsweredLocked(); });
+        expired = expireLocked();
+        answered = allAnsweredLocked();
+        for (int s = 0; s < SOURCE_COUNT; ++s) {
+            if (status[s] == TIMED_OUT) answered = false;
+        }
+    }
+    if (expired) runCancelHook();
+    return answered;
+}
+
+void FederatedSearch::cancel() {
+    bool closed = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int s = 0; s < SOURCE_COUNT; ++s) {
+            if (status[s] == PENDING) {
+                status[s] = TIMED_OUT;
+                errors[s] = "Cancelled";
+                closed = true;
+            }
+        }
+    }
+    changed.notify_all();
+    if (closed) runCancelHook();
+}
+
+bool FederatedSearch::isDone() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return allAnsweredLocked() || std::chrono::steady_clock::now() >= deadline;
+}
+
+std::vector<FederatedSearch::Result> FederatedSearch::getResults(size_t limit) const {
+    std::vector<Entry> ranked;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ranked = entries;
+    }
+
+    size_t count = std::min(limit, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), [](const Entry& a, const Entry& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.arrival < b.arrival;
+    });
+
+    std::vector<Result> results;
+    results.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Entry& entry = ranked[i];
+        results.push_back(Result{entry.title, entry.artist, entry.duration, entry.sources, entry.score});
+    }
+    return results;
+}
+
+FederatedSearch::SourceStatus FederatedSearch::getStatus(Source source) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (status[source] == PENDING && std::chrono::steady_clock::now() >= deadline) return TIMED_OUT;
+    return status[source];
+}
+
+std::string FederatedSearch::getError(Source source) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return errors[source];
+}
+
+void FederatedSearch::deliver(Source source, const std::vector<Song*>& songs) {
+    bool expired = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (status[source] != PENDING) return;
+        if (std::chrono::steady_clock::now() >= deadline) {
+            expired = expireLocked();
+        } else {
+            size_t rank = 0;
+            for (Song* song : songs) {
+                if (!song) continue;
+                ++rank;
+
+                std::string title = song->getTitle();
+                std::string artist = song->getArtist();
+                std::string key = normalize(song->getFoldedTitle()) + '\x1f' + normalize(song->getFoldedArtist());
+
+                auto it = entryIndex.find(key);
+                if (it == entryIndex.end()) {
+                    entryIndex[key] = entries.size();
+                    entries.push_back(Entry{title, artist, song->getDuration(), 0u, 0.0, entries.size()});
+                    it = entryIndex.find(key);
+                }
+
+                // A source lists each song once; a repeat only keeps its best rank
+                Entry& entry = entries[it->second];
+                if (entry.sources & (1u << source)) continue;
+                entry.sources |= 1u << source;
+                entry.score += 1.0 / (RANK_OFFSET + (double)rank);
+                if (entry.duration <= 0) entry.duration = song->getDuration();
+            }
+            status[source] = COMPLETED;
+        }
+    }
+    changed.notify_all();
+
+    if (expired) {
+        runCancelHook();
+        return;
+    }
+    if (onUpdate) {
+        try {
+            onUpdate(*this, source);
+        } catch (const std::exception& e) {
+            SystemManager::handleException(e);
+        }
+    }
+}
+
+void FederatedSearch::fail(Source source, const std::string& message) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (status[source] != PENDING) return;
+        status[source] = FAILED;
+        errors[source] = message;
+    }
+    changed.notify_all();
+
+    if (onUpdate) {
+        try {
+            onUpdate(*this, source);
+        } catch (const std::exception& e) {
+            SystemManager::handleException(e);
+        }
+    }
+}
+
+void FederatedSearch::setCancelHook(std::function<void()> hook) {
+    std::lock_guard<std::mutex> lock(mutex);
+    cancelHook = hook;
+}
+
+std::string FederatedSearch::normalize(const std::string& text) {
+    std::string normalized;
+    normalized.reserve(text.size());
+    bool pendingSpace = false;
+    for (char ch : text) {
+        unsigned char c = (unsigned char)ch;
+        if (!isWordByte(c)) {
+            pendingSpace = !normalized.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            normalized += ' ';
+            pendingSpace = false;
+        }
+        normalized += (char)c;
+    }
+    return normalized;
+}
+
+bool FederatedSearch::allAnsweredLocked() const {
+    for (int s = 0; s < SOURCE_COUNT; ++s) {
+        if (status[s] == PENDING) return false;
+    }
+    return true;
+}
+
+bool FederatedSearch::expireLocked() {
+    if (std::chrono::steady_clock::now() < deadline) return false;
+    bool closed = false;
+    for (int s = 0; s < SOURCE_COUNT; ++s) {
+        if (status[s] == PENDING) {
+            status[s] = TIMED_OUT;
+            errors[s] = "No answer before the deadline";
+            closed = true;
+        }
+    }
+    return closed;
+}
+
+void FederatedSearch::runCancelHook() {
+    std::function<void()> hook;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        hook.swap(cancelHook);
+    }
+    if (hook) {
+        try {
+            hook();
+        } catch (const std::exception& e) {
+            SystemManager::handleException(e);
+        }
+    }
+}
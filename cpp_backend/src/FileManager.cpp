@@ -1,15 +1,57 @@
 #include "FileManager.hpp"
 #include "SystemManager.hpp"
+#include "Recommender.hpp"
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <cstdlib>
 #include <iostream>
 
 namespace fs = std::filesystem;
 
+namespace {
+    // Windows paths are full of backslashes, so file paths are escaped properly
+    std::string escapeJson(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '\\' || c == '"') escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    std::string unescapeJson(const std::string& text) {
+        std::string unescaped;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '\\' && i + 1 < text.size()) ++i;
+            unescaped += text[i];
+        }
+        return unescaped;
+    }
+
+    // <home>\Music\MusicPlayer\<name>; HOME where there is no USERPROFILE (Linux, macOS)
+    std::string musicPlayerDirectory(const char* name) {
+        const char* homeDir = std::getenv("USERPROFILE");
+        if (!homeDir || !*homeDir) homeDir = std::getenv("HOME");
+        fs::path base = homeDir && *homeDir ? fs::path(homeDir) : fs::path(".");
+        return (base / "Music" / "MusicPlayer" / name).string();
+    }
+
+    std::string playlistPath(const std::string& filename) {
+        return (fs::path(FileManager::getPlaylistsDirectory()) / (filename + ".json")).string();
+    }
+}
+
 std::string FileManager::getPlaylistsDirectory() {
-    std::string homeDir = std::getenv("USERPROFILE");
-    return homeDir + "\\Music\\MusicPlayer\\Playlists";
+    return musicPlayerDirectory("Playlists");
+}
+
+std::string FileManager::getCacheDirectory() {
+    return musicPlayerDirectory("Cache");
+}
+
+std::string FileManager::getScrobbleDirectory() {
+    return musicPlayerDirectory("Scrobbles");
 }
 
 void FileManager::ensureDirectoryExists() {
@@ -26,7 +68,7 @@ void FileManager::ensureDirectoryExists() {
 
 bool FileManager::fileExists(const std::string& filename) {
     try {
-        std::string fullPath = getPlaylistsDirectory() + "\\" + filename + ".json";
+        std::string fullPath = playlistPath(filename);
         return fs::exists(fullPath);
     } catch (...) {
         return false;
@@ -37,7 +79,7 @@ bool FileManager::savePlaylist(const Playlist& playlist, const std::string& file
     try {
         ensureDirectoryExists();
         
-        std::string fullPath = getPlaylistsDirectory() + "\\" + filename + ".json";
+        std::string fullPath = playlistPath(filename);
         std::ofstream file(fullPath);
         
         if (!file.is_open()) {
@@ -59,6 +101,9 @@ bool FileManager::savePlaylist(const Playlist& playlist, const std::string& file
                 file << "    {\n";
                 file << "      \"title\": \"" << song->getTitle() << "\",\n";
                 file << "      \"artist\": \"" << song->getArtist() << "\",\n";
+                if (!song->getFilePath().empty()) {
+                    file << "      \"file_path\": \"" << escapeJson(song->getFilePath()) << "\",\n";
+                }
                 file << "      \"duration\": " << song->getDuration() << "\n";
                 file << "    }";
                 
@@ -74,6 +119,8 @@ bool FileManager::savePlaylist(const Playlist& playlist, const std::string& file
         
         file.close();
         SystemManager::logSuccess("Playlist saved to: " + fullPath);
+
+        Recommender::instance().updatePlaylist(filename, playlist);
         return true;
     } catch (const std::exception& e) {
         SystemManager::logError("Failed to save playlist: " + std::string(e.what()));
@@ -83,7 +130,7 @@ bool FileManager::savePlaylist(const Playlist& playlist, const std::string& file
 
 Playlist* FileManager::loadPlaylist(const std::string& filename) {
     try {
-        std::string fullPath = getPlaylistsDirectory() + "\\" + filename + ".json";
+        std::string fullPath = playlistPath(filename);
         
         if (!fileExists(filename)) {
             SystemManager::logWarning("Playlist file not found: " + fullPath);
@@ -98,7 +145,7 @@ Playlist* FileManager::loadPlaylist(const std::string& filename) {
         
         Playlist* playlist = new Playlist();
         std::string line;
-        std::string title, artist;
+        std::string title, artist, filePath;
         int duration;
         
         // Simple JSON parsing (in production use nlohmann/json)
@@ -113,12 +160,18 @@ Playlist* FileManager::loadPlaylist(const std::string& filename) {
                 size_t end = line.rfind("\"");
                 artist = line.substr(start, end - start);
             }
+            else if (line.find("\"file_path\": \"") != std::string::npos) {
+                size_t start = line.find(": \"") + 3;
+                size_t end = line.rfind("\"");
+                filePath = unescapeJson(line.substr(start, end - start));
+            }
             else if (line.find("\"duration\": ") != std::string::npos) {
                 size_t start = line.find(": ") + 2;
                 duration = std::stoi(line.substr(start));
                 
                 // Add song to playlist
-                playlist->addLast(new Song(title, artist, duration));
+                playlist->addLast(new Song(title, artist, duration, filePath));
+                filePath.clear();
             }
         }
         
@@ -133,10 +186,11 @@ Playlist* FileManager::loadPlaylist(const std::string& filename) {
 
 bool FileManager::deleteFile(const std::string& filename) {
     try {
-        std::string fullPath = getPlaylistsDirectory() + "\\" + filename + ".json";
+        std::string fullPath = playlistPath(filename);
         
         if (fs::remove(fullPath)) {
             SystemManager::logSuccess("Playlist deleted: " + fullPath);
+            Recommender::instance().removePlaylist(filename);
             return true;
         } else {
             SystemManager::logWarning("File not found: " + fullPath);
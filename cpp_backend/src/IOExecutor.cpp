@@ -0,0 +1,81 @@
+#include "IOExecutor.hpp"
+#include "SystemManager.hpp"
+
+IOExecutor::IOExecutor(int threads) : threadCount(threads < 1 ? 1 : threads), stopping(false) {
+    for (int i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&IOExecutor::workerLoop, this);
+    }
+}
+
+IOExecutor::~IOExecutor() {
+    shutdown();
+}
+
+bool IOExecutor::submit(Task task, Priority priority, Task onDropped) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return false;
+        (priority == LOW ? lowQueue : queue).push_back(Job{std::move(task), std::move(onDropped)});
+    }
+    wake.notify_one();
+    return true;
+}
+
+void IOExecutor::shutdown() {
+    std::vector<std::thread> stopped;
+    std::deque<Job> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        dropped.swap(queue);
+        for (auto& job : lowQueue) dropped.push_back(std::move(job));
+        lowQueue.clear();
+        stopped.swap(workers);
+    }
+    wake.notify_all();
+
+    // Let the owners of discarded tasks know they will never run
+    for (auto& job : dropped) {
+        if (!job.onDropped) continue;
+        try {
+            job.onDropped();
+        } catch (const std::exception& e) {
+            SystemManager::handleException(e);
+        }
+    }
+
+    for (auto& worker : stopped) {
+        if (worker.get_id() == std::this_thread::get_id()) {
+            worker.detach(); // shutdown requested from inside a task
+        } else if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+size_t IOExecutor::getQueuedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size() + lowQueue.size();
+}
+
+void IOExecutor::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty() || !lowQueue.empty(); });
+            if (stopping) return;
+            std::deque<Job>& source = !queue.empty() ? queue : lowQueue;
+            job = std::move(source.front());
+            source.pop_front();
+        }
+
+        try {
+            job.run();
+        } catch (const std::exception& e) {
+            SystemManager::handleException(e);
+        } catch (...) {
+            SystemManager::logError("Unknown error in I/O worker!");
+        }
+    }
+}
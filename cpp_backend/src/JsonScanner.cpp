@@ -0,0 +1,334 @@
+#include "JsonScanner.hpp"
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define JSONSCANNER_SSE2 1
+#endif
+
+namespace {
+    // Find the next '"' or '\\' in [p, end); returns end if none
+    const char* findQuoteOrBackslash(const char* p, const char* end) {
+#ifdef JSONSCANNER_SSE2
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        while (end - p >= 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                      _mm_cmpeq_epi8(chunk, backslash)));
+            if (mask) return p + __builtin_ctz(mask);
+            p += 16;
+        }
+#endif
+        while (p < end && *p != '"' && *p != '\\') ++p;
+        return p;
+    }
+
+    // Find the next quote or bracket in [p, end); returns end if none
+    const char* findStructural(const char* p, const char* end) {
+#ifdef JSONSCANNER_SSE2
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i openBrace = _mm_set1_epi8('{');
+        const __m128i closeBrace = _mm_set1_epi8('}');
+        const __m128i openBracket = _mm_set1_epi8('[');
+        const __m128i closeBracket = _mm_set1_epi8(']');
+        while (end - p >= 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i hits = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, openBrace)),
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, closeBrace), _mm_cmpeq_epi8(chunk, openBracket)),
+                             _mm_cmpeq_epi8(chunk, closeBracket)));
+            int mask = _mm_movemask_epi8(hits);
+            if (mask) return p + __builtin_ctz(mask);
+            p += 16;
+        }
+#endif
+        while (p < end && *p != '"' && *p != '{' && *p != '}' && *p != '[' && *p != ']') ++p;
+        return p;
+    }
+
+    int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    void appendUtf8(std::string& out, uint32_t codepoint) {
+        if (codepoint < 0x80) {
+            out += (char)codepoint;
+        } else if (codepoint < 0x800) {
+            out += (char)(0xC0 | (codepoint >> 6));
+            out += (char)(0x80 | (codepoint & 0x3F));
+        } else if (codepoint < 0x10000) {
+            out += (char)(0xE0 | (codepoint >> 12));
+            out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+            out += (char)(0x80 | (codepoint & 0x3F));
+        } else {
+            out += (char)(0xF0 | (codepoint >> 18));
+            out += (char)(0x80 | ((codepoint >> 12) & 0x3F));
+            out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+            out += (char)(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    bool parseIntegerText(const char* p, const char* end, long long& out) {
+        bool negative = false;
+        if (p < end && *p == '-') {
+            negative = true;
+            ++p;
+        }
+        if (p >= end || *p < '0' || *p > '9') return false;
+
+        long long value = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value = value * 10 + (*p - '0');
+            ++p;
+        }
+        out = negative ? -value : value;
+        return true;
+    }
+}
+
+JsonScanner::JsonScanner(const char* data, size_t length)
+    : begin(data), cur(data), end(data + length), error(false) {
+}
+
+JsonScanner::JsonScanner(const std::string& json)
+    : JsonScanner(json.data(), json.size()) {
+}
+
+bool JsonScanner::fail() {
+    error = true;
+    cur = end;
+    return false;
+}
+
+void JsonScanner::skipWhitespace() {
+    while (cur < end && (*cur == ' ' || *cur == '\n' || *cur == '\r' || *cur == '\t')) ++cur;
+}
+
+char JsonScanner::peek() {
+    skipWhitespace();
+    return cur < end ? *cur : 0;
+}
+
+bool JsonScanner::enterObject() {
+    if (peek() != '{') return false;
+    ++cur;
+    return true;
+}
+
+bool JsonScanner::enterArray() {
+    if (peek() != '[') return false;
+    ++cur;
+    return true;
+}
+
+bool JsonScanner::nextKey(std::string_view& key) {
+    char c = peek();
+    if (c == '}') {
+        ++cur;
+        return false;
+    }
+    if (c == ',') {
+        ++cur;
+        c = peek();
+    }
+    if (c != '"') return fail();
+
+    const char* start;
+    const char* finish;
+    bool hasEscapes;
+    if (!scanString(start, finish, hasEscapes)) return false;
+
+    if (hasEscapes) {
+        scratch.clear();
+        if (!decodeString(start, finish, scratch)) return fail();
+        key = scratch;
+    } else {
+        key = std::string_view(start, finish - start);
+    }
+
+    if (peek() != ':') return fail();
+    ++cur;
+    return true;
+}
+
+bool JsonScanner::nextElement() {
+    char c = peek();
+    if (c == ']') {
+        ++cur;
+        return false;
+    }
+    if (c == ',') {
+        ++cur;
+        c = peek();
+    }
+    if (c == 0) return fail();
+    return true;
+}
+
+bool JsonScanner::scanString(const char*& contentStart, const char*& contentEnd, bool& hasEscapes) {
+    hasEscapes = false;
+    const char* p = cur + 1;
+    contentStart = p;
+
+    while (true) {
+        p = findQuoteOrBackslash(p, end);
+        if (p >= end) return fail();
+        if (*p == '"') break;
+        hasEscapes = true;
+        p += 2; // skip the escaped character
+    }
+
+    contentEnd = p;
+    cur = p + 1;
+    return true;
+}
+
+bool JsonScanner::decodeString(const char* p, const char* finish, std::string& out) {
+    out.reserve(out.size() + (finish - p));
+    while (p < finish) {
+        const char* next = findQuoteOrBackslash(p, finish);
+        out.append(p, next - p);
+        p = next;
+        if (p >= finish) break;
+
+        // *p == '\\'
+        if (++p >= finish) return false;
+        switch (*p++) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                if (finish - p < 4) return false;
+                uint32_t codepoint = 0;
+                for (int i = 0; i < 4; ++i) {
+                    int digit = hexValue(p[i]);
+                    if (digit < 0) return false;
+                    codepoint = (codepoint << 4) | digit;
+                }
+                p += 4;
+
+                // Surrogate pair for characters outside the BMP
+                if (codepoint >= 0xD800 && codepoint <= 0xDBFF && finish - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                    uint32_t low = 0;
+                    bool valid = true;
+                    for (int i = 0; i < 4; ++i) {
+                        int digit = hexValue(p[2 + i]);
+                        if (digit < 0) valid = false;
+                        low = (low << 4) | (digit & 0xF);
+                    }
+                    if (valid && low >= 0xDC00 && low <= 0xDFFF) {
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                        p += 6;
+                    }
+                }
+                appendUtf8(out, codepoint);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+bool JsonScanner::readString(std::string& out) {
+    if (peek() != '"') {
+        skipValue();
+        return false;
+    }
+
+    const char* start;
+    const char* finish;
+    bool hasEscapes;
+    if (!scanString(start, finish, hasEscapes)) return false;
+
+    out.clear();
+    if (!hasEscapes) {
+        out.assign(start, finish - start);
+        return true;
+    }
+    return decodeString(start, finish, out) || fail();
+}
+
+bool JsonScanner::readInteger(long long& out) {
+    char c = peek();
+    if (c == '"') {
+        const char* start;
+        const char* finish;
+        bool hasEscapes;
+        if (!scanString(start, finish, hasEscapes)) return false;
+        return parseIntegerText(start, finish, out);
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        const char* start = cur;
+        if (!skipNumber()) return false;
+        return parseIntegerText(start, cur, out);
+    }
+    skipValue();
+    return false;
+}
+
+bool JsonScanner::skipNumber() {
+    const char* start = cur;
+    while (cur < end) {
+        char c = *cur;
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+            ++cur;
+        } else {
+            break;
+        }
+    }
+    return cur > start || fail();
+}
+
+bool JsonScanner::skipLiteral() {
+    const char* start = cur;
+    while (cur < end && *cur >= 'a' && *cur <= 'z') ++cur;
+    std::string_view word(start, cur - start);
+    return word == "true" || word == "false" || word == "null" || fail();
+}
+
+bool JsonScanner::skipValue() {
+    char c = peek();
+    if (c == '"') {
+        const char* start;
+        const char* finish;
+        bool hasEscapes;
+        return scanString(start, finish, hasEscapes);
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) return skipNumber();
+    if (c == 't' || c == 'f' || c == 'n') return skipLiteral();
+    if (c != '{' && c != '[') return fail();
+
+    // Containers: only quotes and brackets matter, so jump between them
+    int depth = 0;
+    while (cur < end) {
+        cur = findStructural(cur, end);
+        if (cur >= end) break;
+
+        char s = *cur;
+        if (s == '"') {
+            const char* start;
+            const char* finish;
+            bool hasEscapes;
+            if (!scanString(start, finish, hasEscapes)) return false;
+            continue;
+        }
+        ++cur;
+        if (s == '{' || s == '[') {
+            ++depth;
+        } else if (--depth == 0) {
+            return true;
+        }
+    }
+    return fail();
+}
@@ -0,0 +1,141 @@
+#include "LastFMBatch.hpp"
+#include "SystemManager.hpp"
+
+LastFMBatch::LastFMBatch(const std::vector<std::string>& queries, int deadlineMs, ItemCallback onItem)
+    : nextIndex(0), finishedCount(0), closed(false),
+      deadline(Clock::now() + std::chrono::milliseconds(deadlineMs < 0 ? 0 : deadlineMs)),
+      callback(onItem) {
+    items.reserve(queries.size());
+    for (const auto& query : queries) {
+        items.push_back(Item{query, PENDING, {}, "", 0});
+    }
+}
+
+LastFMBatch::~LastFMBatch() {
+    for (auto& item : items) {
+        for (auto song : item.songs) {
+            delete song;
+        }
+    }
+}
+
+bool LastFMBatch::wait(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(mutex);
+    Clock::time_point until = deadline;
+    if (timeoutMs >= 0) {
+        until = std::min(until, Clock::now() + std::chrono::milliseconds(timeoutMs));
+    }
+
+    progress.wait_until(lock, until, [this] { return closed || finishedCount == items.size(); });
+    checkDeadlineLocked();
+    return finishedCount == items.size();
+}
+
+void LastFMBatch::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!closed) closeLocked(CANCELLED);
+    }
+    progress.notify_all();
+}
+
+bool LastFMBatch::isDone() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return closed || finishedCount == items.size() || Clock::now() >= deadline;
+}
+
+size_t LastFMBatch::size() const {
+    return items.size();
+}
+
+size_t LastFMBatch::getFinishedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return finishedCount;
+}
+
+std::vector<LastFMBatch::Item> LastFMBatch::takeResults() {
+    std::lock_guard<std::mutex> lock(mutex);
+    checkDeadlineLocked();
+
+    std::vector<Item> taken;
+    taken.reserve(items.size());
+    for (auto& item : items) {
+        Item copy{item.query, item.status, {}, item.error, item.elapsedMs};
+        copy.songs.swap(item.songs);
+        if (copy.status == PENDING) copy.status = TIMED_OUT; // still running, result will be dropped
+        taken.push_back(std::move(copy));
+    }
+
+    // Anything finishing from now on has nobody to collect it
+    if (!closed) closeLocked(TIMED_OUT);
+    return taken;
+}
+
+bool LastFMBatch::claimNext(size_t& index, std::string& query) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (checkDeadlineLocked() || nextIndex >= items.size()) return false;
+    index = nextIndex++;
+    query = items[index].query;
+    return true;
+}
+
+void LastFMBatch::complete(size_t index, std::vector<Song*> songs, long long elapsedMs) {
+    finish(index, COMPLETED, songs, "", elapsedMs);
+}
+
+void LastFMBatch::fail(size_t index, const std::string& message, long long elapsedMs) {
+    std::vector<Song*> none;
+    finish(index, FAILED, none, message, elapsedMs);
+}
+
+bool LastFMBatch::checkDeadlineLocked() {
+    if (!closed && Clock::now() >= deadline) {
+        closeLocked(TIMED_OUT);
+        progress.notify_all();
+    }
+    return closed;
+}
+
+void LastFMBatch::closeLocked(ItemStatus reason) {
+    closed = true;
+    for (auto& item : items) {
+        if (item.status == PENDING) item.status = reason;
+    }
+}
+
+void LastFMBatch::finish(size_t index, ItemStatus finalStatus, std::vector<Song*>& songs,
+                         const std::string& message, long long elapsedMs) {
+    bool accepted;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        accepted = index < items.size() && !checkDeadlineLocked() && items[index].status == PENDING;
+    }
+
+    if (accepted && callback) {
+        // Stream the result before publishing it, while this thread still owns the songs
+        Item streamed{items[index].query, finalStatus, songs, message, elapsedMs};
+        try {
+            callback(index, streamed);
+        } catch (const std::exception& e) {
+            SystemManager::handleException(e);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (accepted && !closed) {
+            Item& item = items[index];
+            item.status = finalStatus;
+            item.songs.swap(songs);
+            item.error = message;
+            item.elapsedMs = elapsedMs;
+            finishedCount++;
+        }
+    }
+    progress.notify_all();
+
+    // Late or cancelled - nobody will collect these
+    for (auto song : songs) {
+        delete song;
+    }
+}
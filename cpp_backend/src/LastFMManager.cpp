@@ -1,19 +1,275 @@
 #include "LastFMManager.hpp"
 #include "SystemManager.hpp"
+#include "FileManager.hpp"
+#include "JsonScanner.hpp"
+#include "LastFMStandIn.hpp"
+#include "Md5.hpp"
 #include <sstream>
 #include <algorithm>
 #include <iostream>
+#include <cctype>
+#include <mutex>
+#include <set>
+#include <future>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include <random>
+#include <thread>
+#include <condition_variable>
+#include <cstdlib>
 
 // Static member initialization
 std::string LastFMManager::apiKey = "";
-bool LastFMManager::initialized = false;
+std::string LastFMManager::sessionKey = "";
+std::string LastFMManager::apiSecret = "";
+std::atomic<bool> LastFMManager::initialized(false);
 const std::string LastFMManager::API_BASE_URL = "http://ws.audioscrobbler.com/2.0/?";
 const std::string LastFMManager::API_FORMAT = "json";
 
+namespace {
+    const size_t DEFAULT_CACHE_BYTES = 8 * 1024 * 1024;
+    const int IO_THREADS = 4;
+
+    // Writes go to the bare endpoint as a form POST
+    const char* const API_WRITE_URL = "http://ws.audioscrobbler.com/2.0/";
+
+    // Guards sessionKey / apiSecret (set from the UI, read by the scrobble thread)
+    std::mutex sessionMutex;
+
+    std::mutex executorMutex;
+    IOExecutor* ioExecutor = nullptr;
+    bool executorStopped = false;
+
+    // Keys currently being refreshed in the background
+    std::mutex revalidatingMutex;
+    std::set<std::string> revalidating;
+
+    std::string normalizeParam(const std::string& value) {
+        size_t start = value.find_first_not_of(" \t\r\n");
+        if (start == std::string::npos) return "";
+        size_t end = value.find_last_not_of(" \t\r\n");
+
+        std::string result;
+        result.reserve(end - start + 1);
+        for (size_t i = start; i <= end; ++i) {
+            char c = value[i];
+            if (c == '\n' || c == '\r') c = ' ';
+            result += (char)std::tolower((unsigned char)c);
+        }
+        return result;
+    }
+
+    // Track lookups currently in flight, keyed on the canonical request
+    typedef std::shared_ptr<const std::vector<Song>> TrackList;
+    std::mutex inFlightMutex;
+    std::unordered_map<std::string, std::shared_future<TrackList>> inFlight;
+
+    std::atomic<uint64_t> trackRequests(0);
+    std::atomic<uint64_t> upstreamCalls(0);
+    std::atomic<uint64_t> coalescedCalls(0);
+
+    // Retry / hedging
+    std::mutex retryPolicyMutex;
+    LastFMManager::RetryPolicy retryPolicy{3, 250, 4000, 0};
+
+    std::atomic<uint64_t> requestAttempts(0);
+    std::atomic<uint64_t> requestRetries(0);
+    std::atomic<uint64_t> requestFailures(0);
+    std::atomic<uint64_t> throttledResponses(0);
+    std::atomic<uint64_t> hedgesFired(0);
+    std::atomic<uint64_t> hedgesWon(0);
+
+    // Speculative prefetch
+    const int DEFAULT_PREFETCH_PER_MINUTE = 30;
+    const int MAX_PENDING_PREFETCHES = 8;
+
+    std::atomic<int> prefetchPerMinute(DEFAULT_PREFETCH_PER_MINUTE);
+    std::atomic<int> pendingPrefetches(0);
+    RateLimiter prefetchBudget(DEFAULT_PREFETCH_PER_MINUTE / 60.0, DEFAULT_PREFETCH_PER_MINUTE);
+
+    std::atomic<uint64_t> prefetchRequested(0);
+    std::atomic<uint64_t> prefetchIssued(0);
+    std::atomic<uint64_t> prefetchCached(0);
+    std::atomic<uint64_t> prefetchOverBudget(0);
+    std::atomic<uint64_t> prefetchRateLimited(0);
+    std::atomic<uint64_t> prefetchFailed(0);
+
+    // Last.fm reports some failures as JSON error codes rather than HTTP statuses
+    int lastFmErrorCode(const std::string& body) {
+        if (body.find("\"error\"") == std::string::npos) return 0;
+
+        JsonScanner scanner(body);
+        if (!scanner.enterObject()) return 0;
+        std::string_view key;
+        long long code;
+        while (scanner.nextKey(key)) {
+            if (key == "error" && scanner.readInteger(code)) return (int)code;
+            scanner.skipValue();
+        }
+        return 0;
+    }
+
+    bool isThrottled(const LastFMManager::HttpResponse& response) {
+        return response.status == 429 || lastFmErrorCode(response.body) == 29;
+    }
+
+    bool isRetriable(const LastFMManager::HttpResponse& response) {
+        if (response.status == 0 || response.status == 429 || response.status >= 500) return true;
+        int code = lastFmErrorCode(response.body);
+        return code == 29 || code == 11 || code == 16; // rate limited / service offline / temporary error
+    }
+
+    // Problems with the key or session rather than the request: fixed by signing in again
+    bool isAuthFailure(const LastFMManager::HttpResponse& response) {
+        if (response.status == 401 || response.status == 403) return true;
+        int code = lastFmErrorCode(response.body);
+        return code == 4 || code == 9 || code == 10 || code == 13 || code == 14 || code == 15 || code == 26;
+    }
+
+    // application/x-www-form-urlencoded value (UTF-8 bytes percent-encoded)
+    std::string formEncode(const std::string& value) {
+        static const char DIGITS[] = "0123456789ABCDEF";
+        std::string encoded;
+        encoded.reserve(value.size());
+        for (unsigned char c : value) {
+            if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+                encoded += (char)c;
+            } else {
+                encoded += '%';
+                encoded += DIGITS[c >> 4];
+                encoded += DIGITS[c & 15];
+            }
+        }
+        return encoded;
+    }
+
+    int backoffDelayMs(const LastFMManager::RetryPolicy& policy, int retry) {
+        static thread_local std::mt19937 rng(std::random_device{}());
+        long long cap = policy.baseDelayMs;
+        for (int i = 1; i < retry && cap < policy.maxDelayMs; ++i) cap *= 2;
+        if (cap > policy.maxDelayMs) cap = policy.maxDelayMs;
+        if (cap <= 0) return 0;
+        return std::uniform_int_distribution<int>(0, (int)cap)(rng); // full jitter
+    }
+
+    void readArtistName(JsonScanner& scanner, std::string& artist) {
+        char c = scanner.peek();
+        if (c == '"') {
+            scanner.readString(artist); // track.search sends the artist as a plain string
+            return;
+        }
+        if (!scanner.enterObject()) {
+            scanner.skipValue();
+            return;
+        }
+
+        std::string_view key;
+        while (scanner.nextKey(key)) {
+            if (key == "name" || key == "#text") {
+                scanner.readString(artist);
+            } else {
+                scanner.skipValue();
+            }
+        }
+    }
+
+    void readTrack(JsonScanner& scanner, LastFMTrack& track) {
+        track = LastFMTrack{"", "", "", 0, 0};
+        scanner.enterObject();
+
+        std::string_view key;
+        long long number;
+        while (scanner.nextKey(key)) {
+            if (key == "name") {
+                scanner.readString(track.title);
+            } else if (key == "artist") {
+                readArtistName(scanner, track.artist);
+            } else if (key == "duration") {
+                if (scanner.readInteger(number)) track.duration = (int)number;
+            } else if (key == "listeners") {
+                if (scanner.readInteger(number)) track.listeners = number;
+            } else if (key == "mbid") {
+                scanner.readString(track.mbid);
+            } else {
+                scanner.skipValue();
+            }
+        }
+    }
+
+    void readTrackList(JsonScanner& scanner, std::vector<LastFMTrack>& tracks,
+                       std::unordered_set<std::string>& seen) {
+        LastFMTrack track;
+        std::string identity;
+
+        auto add = [&] {
+            if (track.title.empty() || track.artist.empty()) return;
+            identity.assign(track.title).append(1, '\x1f').append(track.artist);
+            if (seen.insert(identity).second) {
+                tracks.push_back(std::move(track));
+            }
+        };
+
+        // A single result comes back as an object instead of a one-element array
+        if (scanner.peek() == '{') {
+            readTrack(scanner, track);
+            add();
+            return;
+        }
+        if (!scanner.enterArray()) {
+            scanner.skipValue();
+            return;
+        }
+
+        while (scanner.nextElement()) {
+            if (scanner.peek() == '{') {
+                readTrack(scanner, track);
+                add();
+            } else {
+                scanner.skipValue();
+            }
+        }
+    }
+
+    // Descend through wrapper objects until a "track" member is found
+    void findTrackLists(JsonScanner& scanner, std::vector<LastFMTrack>& tracks,
+                        std::unordered_set<std::string>& seen) {
+        if (!scanner.enterObject()) {
+            scanner.skipValue();
+            return;
+        }
+
+        std::string_view key;
+        while (scanner.nextKey(key)) {
+            if (key == "track") {
+                readTrackList(scanner, tracks, seen);
+            } else if (scanner.peek() == '{') {
+                findTrackLists(scanner, tracks, seen);
+            } else {
+                scanner.skipValue();
+            }
+        }
+    }
+
+    // Only a top-level "error" code counts: a track or artist called "error" is a valid answer
+    bool isErrorResponse(const std::string& body) {
+        return body.empty() || lastFmErrorCode(body) != 0;
+    }
+}
+
 void LastFMManager::initialize(const std::string& key) {
     apiKey = key;
+    {
+        std::lock_guard<std::mutex> lock(executorMutex);
+        executorStopped = false;
+    }
     initialized = true;
     SystemManager::logSuccess("Last.fm API initialized!");
+
+    const char* standIn = std::getenv("MUSICPLAYER_LASTFM_STANDIN");
+    if (standIn && *standIn && !LastFMStandIn::isEnabled()) {
+        LastFMStandIn::enable(standIn);
+    }
 }
 
 bool LastFMManager::isInitialized() {
@@ -31,7 +287,503 @@ std::string LastFMManager::buildApiUrl(const std::map<std::string, std::string>&
     return url;
 }
 
-std::string LastFMManager::makeRequest(const std::string& url) {
+std::string LastFMManager::buildCacheKey(const std::map<std::string, std::string>& params) {
+    std::string key;
+    auto method = params.find("method");
+    key += method != params.end() ? normalizeParam(method->second) : "";
+
+    // std::map keeps params sorted, so equal requests build equal keys
+    for (const auto& pair : params) {
+        if (pair.first == "method" || pair.first == "api_key" || pair.first == "format") continue;
+        key += "&" + pair.first + "=" + normalizeParam(pair.second);
+    }
+    return key;
+}
+
+ResponseCache& LastFMManager::cache() {
+    static ResponseCache instance(DEFAULT_CACHE_BYTES, FileManager::getCacheDirectory());
+    static std::once_flag policiesSet;
+    std::call_once(policiesSet, [] {
+        // Charts move slowly; searches are cheap to redo but hit hardest by typing
+        instance.setPolicy("chart.gettoptracks", 10 * 60, 6 * 60 * 60);
+        instance.setPolicy("geo.gettoptracks", 10 * 60, 6 * 60 * 60);
+        instance.setPolicy("artist.gettoptracks", 60 * 60, 24 * 60 * 60);
+        instance.setPolicy("track.getsimilar", 24 * 60 * 60, 7 * 24 * 60 * 60);
+        instance.setPolicy("track.getinfo", 60 * 60, 24 * 60 * 60);
+        instance.setPolicy("track.search", 5 * 60, 60 * 60);
+    });
+    return instance;
+}
+
+void LastFMManager::setCachePolicy(const std::string& method, int ttlSeconds, int staleSeconds) {
+    cache().setPolicy(method, ttlSeconds, staleSeconds);
+}
+
+void LastFMManager::setCacheMemoryLimit(size_t maxBytes) {
+    cache().setMaxMemoryBytes(maxBytes);
+}
+
+void LastFMManager::clearCache() {
+    cache().clear();
+    SystemManager::logInfo("Last.fm response cache cleared");
+}
+
+ResponseCache::Stats LastFMManager::getCacheStats() {
+    return cache().getStats();
+}
+
+std::string LastFMManager::fetch(const std::map<std::string, std::string>& params) {
+    auto method = params.find("method");
+    std::string methodName = method != params.end() ? method->second : "";
+    std::string key = buildCacheKey(params);
+
+    ResponseCache::Lookup hit = cache().get(methodName, key);
+    if (hit.freshness == ResponseCache::FRESH) {
+        return hit.body;
+    }
+    if (hit.freshness == ResponseCache::STALE) {
+        revalidate(params, key);
+        return hit.body;
+    }
+
+    std::string response = executeRequest(buildApiUrl(params));
+    if (!isErrorResponse(response)) {
+        cache().put(key, response);
+    }
+    return response;
+}
+
+LastFMManager::CoalescingStats LastFMManager::getCoalescingStats() {
+    return CoalescingStats{trackRequests.load(), upstreamCalls.load(), coalescedCalls.load()};
+}
+
+std::shared_ptr<const std::vector<Song>> LastFMManager::fetchTracks(const std::map<std::string, std::string>& params) {
+    std::string key = buildCacheKey(params);
+    trackRequests++;
+
+    std::promise<TrackList> promise;
+    {
+        std::unique_lock<std::mutex> lock(inFlightMutex);
+        auto it = inFlight.find(key);
+        if (it != inFlight.end()) {
+            std::shared_future<TrackList> pending = it->second;
+            lock.unlock();
+            coalescedCalls++;
+            return pending.get();
+        }
+        inFlight.emplace(key, promise.get_future().share());
+    }
+
+    upstreamCalls++;
+    try {
+        std::vector<LastFMTrack> parsed = parseTracksFromJson(fetch(params));
+        auto tracks = std::make_shared<std::vector<Song>>();
+        tracks->reserve(parsed.size());
+        for (const LastFMTrack& track : parsed) {
+            tracks->push_back(Song(track.title, track.artist, track.duration));
+        }
+        promise.set_value(tracks);
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+
+    std::shared_future<TrackList> result;
+    {
+        std::lock_guard<std::mutex> lock(inFlightMutex);
+        auto it = inFlight.find(key);
+        result = it->second;
+        inFlight.erase(it);
+    }
+    return result.get(); // rethrows for the leader as well
+}
+
+std::vector<Song*> LastFMManager::toSongs(const std::shared_ptr<const std::vector<Song>>& tracks) {
+    std::vector<Song*> songs;
+    if (!tracks) return songs;
+    songs.reserve(tracks->size());
+    for (const Song& song : *tracks) {
+        songs.push_back(new Song(song));
+    }
+    return songs;
+}
+
+void LastFMManager::revalidate(const std::map<std::string, std::string>& params, const std::string& key) {
+    {
+        std::lock_guard<std::mutex> lock(revalidatingMutex);
+        if (!revalidating.insert(key).second) return; // refresh already under way
+    }
+
+    auto release = [key] {
+        std::lock_guard<std::mutex> lock(revalidatingMutex);
+        revalidating.erase(key);
+    };
+
+    std::string url = buildApiUrl(params);
+    bool queued = submitIO([url, key, release] {
+        std::string response = executeRequest(url);
+        if (!isErrorResponse(response)) {
+            cache().put(key, response);
+        }
+        release();
+    }, IOExecutor::NORMAL, release);
+
+    if (!queued) release();
+}
+
+bool LastFMManager::submitIO(IOExecutor::Task task, IOExecutor::Priority priority, IOExecutor::Task onDropped) {
+    std::lock_guard<std::mutex> lock(executorMutex);
+    if (executorStopped) return false;
+    if (!ioExecutor) {
+        ioExecutor = new IOExecutor(IO_THREADS);
+    }
+    return ioExecutor->submit(std::move(task), priority, std::move(onDropped));
+}
+
+void LastFMManager::shutdown() {
+    IOExecutor* stopping;
+    {
+        std::lock_guard<std::mutex> lock(executorMutex);
+        stopping = ioExecutor;
+        ioExecutor = nullptr;
+        executorStopped = true;
+    }
+    // So the next InitBackend (or MusicPlayer) calls initialize() and re-arms the executor
+    initialized = false;
+    // Outside the lock: dropped-task callbacks and finishing tasks may submit (and be refused)
+    delete stopping;
+}
+
+void LastFMManager::prefetchRelated(const std::string& trackName, const std::string& artistName) {
+    if (!isInitialized() || trackName.empty() || artistName.empty()) return;
+
+    // Params must match getSimilarTracks / getTracksByArtist so the cache keys line up
+    std::map<std::string, std::string> similar;
+    similar["method"] = "track.getsimilar";
+    similar["track"] = trackName;
+    similar["artist"] = artistName;
+    similar["limit"] = "5";
+    prefetch(similar);
+
+    std::map<std::string, std::string> byArtist;
+    byArtist["method"] = "artist.gettoptracks";
+    byArtist["artist"] = artistName;
+    byArtist["limit"] = "10";
+    prefetch(byArtist);
+}
+
+void LastFMManager::prefetch(const std::map<std::string, std::string>& params) {
+    if (prefetchPerMinute.load() <= 0) return;
+    prefetchRequested++;
+
+    if (pendingPrefetches.fetch_add(1) >= MAX_PENDING_PREFETCHES) {
+        pendingPrefetches--;
+        prefetchOverBudget++;
+        return;
+    }
+
+    bool queued = submitIO([params] {
+        pendingPrefetches--;
+
+        std::string key = buildCacheKey(params);
+        if (cache().peek(params.at("method"), key) == ResponseCache::FRESH) {
+            prefetchCached++;
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(inFlightMutex);
+            if (inFlight.count(key)) {
+                prefetchCached++;
+                return;
+            }
+        }
+
+        if (!prefetchBudget.tryAcquire()) {
+            prefetchOverBudget++;
+            return;
+        }
+        // Foreground requests own the rate limit; only use spare tokens
+        if (!limiter().tryAcquire()) {
+            prefetchRateLimited++;
+            return;
+        }
+
+        prefetchIssued++;
+        HttpResponse response = makeRequest(buildApiUrl(params));
+        if (response.status == 200 && !isErrorResponse(response.body)) {
+            cache().put(key, response.body);
+        } else {
+            prefetchFailed++;
+        }
+    }, IOExecutor::LOW, [] { pendingPrefetches--; });
+
+    if (!queued) pendingPrefetches--;
+}
+
+void LastFMManager::setPrefetchBudget(int requestsPerMinute) {
+    if (requestsPerMinute < 0) requestsPerMinute = 0;
+    prefetchPerMinute = requestsPerMinute;
+    if (requestsPerMinute > 0) {
+        prefetchBudget.configure(requestsPerMinute / 60.0, requestsPerMinute);
+    }
+}
+
+LastFMManager::PrefetchStats LastFMManager::getPrefetchStats() {
+    return PrefetchStats{prefetchRequested.load(), prefetchIssued.load(), prefetchCached.load(),
+                         prefetchOverBudget.load(), prefetchRateLimited.load(), prefetchFailed.load()};
+}
+
+LastFMManager::RequestHandle LastFMManager::runAsync(std::function<std::vector<Song*>()> work,
+                                                     LastFMRequest::Callback onDone) {
+    RequestHandle request = std::make_shared<LastFMRequest>(onDone);
+
+    bool queued = submitIO([request, work] {
+        if (request->isCancelled()) return;
+        try {
+            request->complete(work());
+        } catch (const std::exception& e) {
+            request->fail(e.what());
+        }
+    }, IOExecutor::NORMAL, [request] { request->fail("Last.fm executor shut down before the lookup ran"); });
+
+    if (!queued) {
+        request->fail("Last.fm executor is shut down");
+    }
+    return request;
+}
+
+LastFMManager::RequestHandle LastFMManager::searchTracksAsync(const std::string& trackName,
+                                                              LastFMRequest::Callback onDone) {
+    return runAsync([trackName] { return searchTracks(trackName); }, onDone);
+}
+
+LastFMManager::RequestHandle LastFMManager::getTopTracksAsync(int limit, LastFMRequest::Callback onDone) {
+    return runAsync([limit] { return getTopTracks(limit); }, onDone);
+}
+
+LastFMManager::RequestHandle LastFMManager::getTopTracksByCountryAsync(const std::string& country, int limit,
+                                                                       LastFMRequest::Callback onDone) {
+    return runAsync([country, limit] { return getTopTracksByCountry(country, limit); }, onDone);
+}
+
+LastFMManager::RequestHandle LastFMManager::getTracksByArtistAsync(const std::string& artistName, int limit,
+                                                                   LastFMRequest::Callback onDone) {
+    return runAsync([artistName, limit] { return getTracksByArtist(artistName, limit); }, onDone);
+}
+
+LastFMManager::RequestHandle LastFMManager::getSimilarTracksAsync(const std::string& trackName,
+                                                                  const std::string& artistName,
+                                                                  LastFMRequest::Callback onDone) {
+    return runAsync([trackName, artistName] { return getSimilarTracks(trackName, artistName); }, onDone);
+}
+
+LastFMManager::BatchHandle LastFMManager::getTopTracksByCountries(const std::vector<std::string>& countries,
+                                                                  int limit, int deadlineMs, int maxConcurrency,
+                                                                  LastFMBatch::ItemCallback onItem) {
+    return runBatch(countries, [limit](const std::string& country) {
+        return getTopTracksByCountry(country, limit);
+    }, deadlineMs, maxConcurrency, onItem);
+}
+
+LastFMManager::BatchHandle LastFMManager::getTracksByArtists(const std::vector<std::string>& artistNames,
+                                                             int limit, int deadlineMs, int maxConcurrency,
+                                                             LastFMBatch::ItemCallback onItem) {
+    return runBatch(artistNames, [limit](const std::string& artist) {
+        return getTracksByArtist(artist, limit);
+    }, deadlineMs, maxConcurrency, onItem);
+}
+
+LastFMManager::BatchHandle LastFMManager::searchTracksBatch(const std::vector<std::string>& trackNames,
+                                                            int deadlineMs, int maxConcurrency,
+                                                            LastFMBatch::ItemCallback onItem) {
+    return runBatch(trackNames, [](const std::string& track) {
+        return searchTracks(track);
+    }, deadlineMs, maxConcurrency, onItem);
+}
+
+LastFMManager::BatchHandle LastFMManager::runBatch(const std::vector<std::string>& queries, BatchWork work,
+                                                   int deadlineMs, int maxConcurrency,
+                                                   LastFMBatch::ItemCallback onItem) {
+    BatchHandle batch = std::make_shared<LastFMBatch>(queries, deadlineMs, onItem);
+
+    // Lanes beyond the worker count would only sit in the queue
+    int lanes = std::min(maxConcurrency, IO_THREADS);
+    lanes = std::max(1, std::min(lanes, (int)queries.size()));
+
+    SystemManager::logInfo("Fanning out " + std::to_string(queries.size()) + " Last.fm lookups (" +
+                           std::to_string(lanes) + " at a time)");
+
+    for (int i = 0; i < lanes; ++i) {
+        if (!submitIO([batch, work] { runBatchStep(batch, work); }, IOExecutor::NORMAL,
+                      [batch] { batch->cancel(); })) {
+            batch->cancel();
+            break;
+        }
+    }
+    return batch;
+}
+
+void LastFMManager::runBatchStep(const BatchHandle& batch, const BatchWork& work) {
+    size_t index;
+    std::string query;
+    if (!batch->claimNext(index, query)) return;
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&start] {
+        return (long long)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    };
+
+    try {
+        std::vector<Song*> songs = work(query);
+        batch->complete(index, std::move(songs), elapsedMs());
+    } catch (const std::exception& e) {
+        batch->fail(index, e.what(), elapsedMs());
+    }
+
+    // Requeue the lane; once shutdown() has run nothing else will pick it up
+    BatchHandle next = batch;
+    BatchWork nextWork = work;
+    if (!submitIO([next, nextWork] { runBatchStep(next, nextWork); }, IOExecutor::NORMAL,
+                  [next] { next->cancel(); })) {
+        batch->cancel();
+    }
+}
+
+RateLimiter& LastFMManager::limiter() {
+    static RateLimiter instance(5.0, 5.0);
+    return instance;
+}
+
+bool LastFMManager::setRateLimit(double requestsPerSecond, double burst) {
+    if (!limiter().configure(requestsPerSecond, burst)) {
+        SystemManager::logError("Invalid Last.fm rate limit: " + std::to_string(requestsPerSecond) +
+                                " requests/s, burst " + std::to_string(burst));
+        return false;
+    }
+    return true;
+}
+
+void LastFMManager::setRetryPolicy(const RetryPolicy& policy) {
+    std::lock_guard<std::mutex> lock(retryPolicyMutex);
+    retryPolicy = policy;
+}
+
+LastFMManager::RetryPolicy LastFMManager::getRetryPolicy() {
+    std::lock_guard<std::mutex> lock(retryPolicyMutex);
+    return retryPolicy;
+}
+
+LastFMManager::RequestMetrics LastFMManager::getRequestMetrics() {
+    return RequestMetrics{limiter().getStats(), requestAttempts.load(), requestRetries.load(),
+                          requestFailures.load(), throttledResponses.load(), hedgesFired.load(), hedgesWon.load()};
+}
+
+std::string LastFMManager::executeRequest(const std::string& url) {
+    RetryPolicy policy = getRetryPolicy();
+    int maxAttempts = policy.maxAttempts < 1 ? 1 : policy.maxAttempts;
+    HttpResponse response{0, ""};
+
+    for (int attempt = 1; attempt <= maxAttempts; ++attempt) {
+        if (attempt > 1) {
+            requestRetries++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(backoffDelayMs(policy, attempt - 1)));
+        }
+
+        limiter().acquire();
+        requestAttempts++;
+        response = attemptRequest(url, policy);
+
+        if (!isRetriable(response)) {
+            return response.body;
+        }
+
+        if (isThrottled(response)) {
+            // Back the whole client off, not just this caller
+            throttledResponses++;
+            limiter().penalize(backoffDelayMs(policy, attempt) + policy.baseDelayMs);
+        }
+        SystemManager::logWarning("Last.fm request failed (status " + std::to_string(response.status) +
+                                  "), attempt " + std::to_string(attempt) + "/" + std::to_string(maxAttempts));
+    }
+
+    requestFailures++;
+    SystemManager::logError("Last.fm request gave up after " + std::to_string(maxAttempts) + " attempts");
+    return response.status == 200 ? response.body : "";
+}
+
+LastFMManager::HttpResponse LastFMManager::executeWrite(const std::string& body) {
+    // No retry loop and no hedge: after a timeout or 5xx the write may
+    // already have been applied, so a blind resend could count it twice
+    limiter().acquire();
+    requestAttempts++;
+    HttpResponse response = makeRequest(API_WRITE_URL, body);
+
+    if (isThrottled(response)) {
+        throttledResponses++;
+        RetryPolicy policy = getRetryPolicy();
+        limiter().penalize(backoffDelayMs(policy, 1) + policy.baseDelayMs);
+    }
+    if (response.status != 200) {
+        requestFailures++;
+    }
+    return response;
+}
+
+LastFMManager::HttpResponse LastFMManager::attemptRequest(const std::string& url, const RetryPolicy& policy) {
+    if (policy.hedgeAfterMs <= 0) {
+        return makeRequest(url);
+    }
+
+    // Race the original against a late second copy; the first usable answer wins
+    struct Race {
+        std::mutex mutex;
+        std::condition_variable done;
+        int launched = 0;
+        int finished = 0;
+        int winner = -1;
+        HttpResponse result{0, ""};
+    };
+    auto race = std::make_shared<Race>();
+
+    auto launch = [race, url](int id) {
+        {
+            std::lock_guard<std::mutex> lock(race->mutex);
+            race->launched++;
+        }
+        std::thread([race, url, id] {
+            HttpResponse response = makeRequest(url);
+            std::lock_guard<std::mutex> lock(race->mutex);
+            race->finished++;
+            // Take a failure only if nothing else is still running
+            if (race->winner < 0 && (!isRetriable(response) || race->finished == race->launched)) {
+                race->winner = id;
+                race->result = std::move(response);
+            }
+            race->done.notify_all();
+        }).detach();
+    };
+
+    launch(0);
+
+    std::unique_lock<std::mutex> lock(race->mutex);
+    bool answered = race->done.wait_for(lock, std::chrono::milliseconds(policy.hedgeAfterMs),
+                                        [&race] { return race->winner >= 0; });
+    if (!answered) {
+        lock.unlock();
+        // Hedges spend a token too, but never wait for one
+        if (limiter().tryAcquire()) {
+            hedgesFired++;
+            launch(1);
+        }
+        lock.lock();
+        race->done.wait(lock, [&race] { return race->winner >= 0; });
+    }
+
+    if (race->winner == 1) hedgesWon++;
+    return race->result;
+}
+
+LastFMManager::HttpResponse LastFMManager::makeRequest(const std::string& url, const std::string& postBody) {
     try {
         // Mock implementation - returns JSON-like data
         // In production, use actual curl library:
@@ -39,11 +791,23 @@ std::string LastFMManager::makeRequest(const std::string& url) {
         // curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
         // etc...
         
-        SystemManager::logInfo("API Request: " + url);
+        // The body of a write carries the session key, so it is not logged
+        SystemManager::logInfo(std::string("API Request: ") + (postBody.empty() ? "" : "POST ") + url);
+
+        // Offline stand-in (fixtures, injected latency and faults)
+        if (LastFMStandIn::isEnabled()) {
+            return LastFMStandIn::serve(url, postBody);
+        }
+
+        // The mock transport cannot deliver writes; report them as not sent
+        if (!postBody.empty()) {
+            SystemManager::logWarning("No HTTP transport, write request not sent");
+            return HttpResponse{0, ""};
+        }
         
         // For now, return mock data
         // This demonstrates the structure
-        return R"({
+        HttpResponse response{200, R"({
             "tracks": {
                 "track": [
                     {
@@ -62,69 +826,47 @@ std::string LastFMManager::makeRequest(const std::string& url) {
                     }
                 ]
             }
-        })";
+        })"};
+
+        if (LastFMStandIn::isRecording()) {
+            LastFMStandIn::record(url, response);
+        }
+        return response;
     } catch (const std::exception& e) {
         SystemManager::logError("API request failed: " + std::string(e.what()));
-        return "";
+        return HttpResponse{0, ""};
     }
 }
 
-std::vector<Song*> LastFMManager::parseTracksFromJson(const std::string& jsonResponse) {
-    std::vector<Song*> songs;
+std::vector<LastFMTrack> LastFMManager::parseTracksFromJson(const std::string& jsonResponse) {
+    std::vector<LastFMTrack> tracks;
     
     try {
         if (jsonResponse.empty()) {
             SystemManager::logWarning("Empty JSON response!");
-            return songs;
+            return tracks;
         }
 
-        // Simple JSON parsing (production would use nlohmann/json)
-        size_t pos = 0;
-        
-        // Look for track objects
-        while ((pos = jsonResponse.find("\"name\"", pos)) != std::string::npos) {
-            // Extract track name
-            size_t nameStart = jsonResponse.find("\"", pos + 7) + 1;
-            size_t nameEnd = jsonResponse.find("\"", nameStart);
-            std::string trackName = jsonResponse.substr(nameStart, nameEnd - nameStart);
-            
-            // Extract artist (simple parse)
-            size_t artistPos = jsonResponse.find("\"artist\"", pos);
-            size_t artistNameStart = jsonResponse.find("\"name\"", artistPos) + 7;
-            size_t artistNameBegin = jsonResponse.find("\"", artistNameStart) + 1;
-            size_t artistNameEnd = jsonResponse.find("\"", artistNameBegin);
-            std::string artistName = jsonResponse.substr(artistNameBegin, artistNameEnd - artistNameBegin);
-            
-            // Default duration
-            int duration = 200;
-            
-            // Avoid duplicates
-            bool isDuplicate = false;
-            for (auto* s : songs) {
-                if (s->getTitle() == trackName) {
-                    isDuplicate = true;
-                    break;
-                }
-            }
-            
-            if (!isDuplicate && !trackName.empty() && !artistName.empty()) {
-                songs.push_back(new Song(trackName, artistName, duration));
-            }
-            
-            pos = nameEnd;
+        JsonScanner scanner(jsonResponse);
+        std::unordered_set<std::string> seen;
+        findTrackLists(scanner, tracks, seen);
+
+        if (scanner.failed()) {
+            SystemManager::logWarning("Malformed JSON near byte " + std::to_string(scanner.position()) +
+                                      ", keeping " + std::to_string(tracks.size()) + " tracks parsed so far");
         }
         
-        if (songs.empty()) {
+        if (tracks.empty()) {
             SystemManager::logWarning("No tracks parsed from response!");
         } else {
-            SystemManager::logSuccess("Parsed " + std::to_string(songs.size()) + " tracks from API!");
+            SystemManager::logSuccess("Parsed " + std::to_string(tracks.size()) + " tracks from API!");
         }
         
     } catch (const std::exception& e) {
         SystemManager::logError("JSON parsing error: " + std::string(e.what()));
     }
     
-    return songs;
+    return tracks;
 }
 
 std::string LastFMManager::extractJsonValue(const std::string& json, const std::string& key) {
@@ -149,10 +891,7 @@ std::vector<Song*> LastFMManager::searchTracks(const std::string& trackName) {
         params["track"] = trackName;
         params["limit"] = "10";
         
-        std::string url = buildApiUrl(params);
-        std::string response = makeRequest(url);
-        
-        return parseTracksFromJson(response);
+        return toSongs(fetchTracks(params));
     } catch (const std::exception& e) {
         SystemManager::handleException(e);
         return std::vector<Song*>();
@@ -170,12 +909,9 @@ std::vector<Song*> LastFMManager::getTopTracks(int limit) {
         params["method"] = "chart.gettoptracks";
         params["limit"] = std::to_string(limit);
         
-        std::string url = buildApiUrl(params);
-        std::string response = makeRequest(url);
-        
         SystemManager::logInfo("Fetching top " + std::to_string(limit) + " tracks globally...");
         
-        return parseTracksFromJson(response);
+        return toSongs(fetchTracks(params));
     } catch (const std::exception& e) {
         SystemManager::handleException(e);
         return std::vector<Song*>();
@@ -194,12 +930,9 @@ std::vector<Song*> LastFMManager::getTopTracksByCountry(const std::string& count
         params["country"] = country;
         params["limit"] = std::to_string(limit);
         
-        std::string url = buildApiUrl(params);
-        std::string response = makeRequest(url);
-        
         SystemManager::logInfo("Fetching top tracks from " + country + "...");
         
-        return parseTracksFromJson(response);
+        return toSongs(fetchTracks(params));
     } catch (const std::exception& e) {
         SystemManager::handleException(e);
         return std::vector<Song*>();
@@ -218,12 +951,9 @@ std::vector<Song*> LastFMManager::getTracksByArtist(const std::string& artistNam
         params["artist"] = artistName;
         params["limit"] = std::to_string(limit);
         
-        std::string url = buildApiUrl(params);
-        std::string response = makeRequest(url);
-        
         SystemManager::logInfo("Fetching top tracks by " + artistName + "...");
         
-        return parseTracksFromJson(response);
+        return toSongs(fetchTracks(params));
     } catch (const std::exception& e) {
         SystemManager::handleException(e);
         return std::vector<Song*>();
@@ -243,12 +973,9 @@ std::vector<Song*> LastFMManager::getSimilarTracks(const std::string& trackName,
         params["artist"] = artistName;
         params["limit"] = "5";
         
-        std::string url = buildApiUrl(params);
-        std::string response = makeRequest(url);
-        
         SystemManager::logInfo("Fetching similar tracks to " + trackName + "...");
         
-        return parseTracksFromJson(response);
+        return toSongs(fetchTracks(params));
     } catch (const std::exception& e) {
         SystemManager::handleException(e);
         return std::vector<Song*>();
@@ -265,6 +992,83 @@ std::vector<Song*> LastFMManager::getTrendingTracks(int limit) {
     }
 }
 
+void LastFMManager::setSessionKey(const std::string& key) {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    sessionKey = key;
+}
+
+void LastFMManager::setApiSecret(const std::string& secret) {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    apiSecret = secret;
+}
+
+bool LastFMManager::hasSession() {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    return !sessionKey.empty() && !apiSecret.empty();
+}
+
+bool LastFMManager::buildSignedBody(std::map<std::string, std::string> params, std::string& body) {
+    std::string secret;
+    {
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        if (sessionKey.empty() || apiSecret.empty()) return false;
+        params["sk"] = sessionKey;
+        secret = apiSecret;
+    }
+    params["api_key"] = apiKey;
+
+    // api_sig = md5(name1 value1 name2 value2 ... secret), names sorted, format left out
+    std::string signature;
+    body.clear();
+    for (const auto& pair : params) {
+        signature += pair.first + pair.second;
+        body += formEncode(pair.first) + "=" + formEncode(pair.second) + "&";
+    }
+    body += "api_sig=" + Md5::hex(signature + secret) + "&format=" + API_FORMAT;
+    return true;
+}
+
+LastFMManager::SubmitResult LastFMManager::submitScrobbles(const std::vector<Scrobble>& batch) {
+    try {
+        if (!isInitialized()) {
+            SystemManager::logError("Last.fm API not initialized!");
+            return SUBMIT_FAILED;
+        }
+        if (batch.empty()) return SUBMIT_ACCEPTED;
+
+        // Indexed array params, oldest first; never cached
+        std::map<std::string, std::string> params;
+        params["method"] = "track.scrobble";
+        for (size_t i = 0; i < batch.size() && i < 50; ++i) {
+            std::string index = "[" + std::to_string(i) + "]";
+            params["artist" + index] = batch[i].artist;
+            params["track" + index] = batch[i].track;
+            params["timestamp" + index] = std::to_string(batch[i].timestamp);
+            if (batch[i].duration > 0) params["duration" + index] = std::to_string(batch[i].duration);
+        }
+
+        std::string body;
+        if (!buildSignedBody(params, body)) {
+            SystemManager::logWarning("No Last.fm session, keeping " + std::to_string(batch.size()) +
+                                      " scrobbles for later");
+            return SUBMIT_FAILED;
+        }
+
+        HttpResponse response = executeWrite(body);
+        if (response.status == 200 && lastFmErrorCode(response.body) == 0) return SUBMIT_ACCEPTED;
+
+        bool permanent = !isRetriable(response) && !isAuthFailure(response);
+        SystemManager::logWarning("Last.fm " + std::string(permanent ? "rejected" : "did not take") +
+                                  " scrobble batch of " + std::to_string(batch.size()) +
+                                  " (status " + std::to_string(response.status) +
+                                  ", error " + std::to_string(lastFmErrorCode(response.body)) + ")");
+        return permanent ? SUBMIT_REJECTED : SUBMIT_FAILED;
+    } catch (const std::exception& e) {
+        SystemManager::handleException(e);
+        return SUBMIT_FAILED;
+    }
+}
+
 std::string LastFMManager::getTrackInfo(const std::string& trackName, const std::string& artistName) {
     try {
         if (!isInitialized()) {
@@ -276,8 +1080,7 @@ std::string LastFMManager::getTrackInfo(const std::string& trackName, const std:
         params["track"] = trackName;
         params["artist"] = artistName;
         
-        std::string url = buildApiUrl(params);
-        std::string response = makeRequest(url);
+        std::string response = fetch(params);
         
         // Extract play count and listeners
         std::string playCount = extractJsonValue(response, "playcount");
@@ -0,0 +1,85 @@
+#include "LastFMRequest.hpp"
+#include "SystemManager.hpp"
+#include <chrono>
+
+LastFMRequest::LastFMRequest(Callback onDone) : status(PENDING), callback(onDone) {
+}
+
+LastFMRequest::~LastFMRequest() {
+    for (auto song : results) {
+        delete song;
+    }
+}
+
+LastFMRequest::Status LastFMRequest::getStatus() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return status;
+}
+
+bool LastFMRequest::isDone() const {
+    return getStatus() != PENDING;
+}
+
+bool LastFMRequest::isCancelled() const {
+    return getStatus() == CANCELLED;
+}
+
+bool LastFMRequest::wait(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (timeoutMs < 0) {
+        done.wait(lock, [this] { return status != PENDING; });
+        return true;
+    }
+    return done.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return status != PENDING; });
+}
+
+void LastFMRequest::cancel() {
+    finish(CANCELLED, nullptr, "");
+}
+
+std::vector<Song*> LastFMRequest::takeResults() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Song*> taken;
+    taken.swap(results);
+    return taken;
+}
+
+std::string LastFMRequest::getError() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return error;
+}
+
+void LastFMRequest::complete(std::vector<Song*> songs) {
+    if (!finish(COMPLETED, &songs, "")) {
+        // Cancelled (or already finished) - nobody will collect these
+        for (auto song : songs) {
+            delete song;
+        }
+    }
+}
+
+void LastFMRequest::fail(const std::string& message) {
+    finish(FAILED, nullptr, message);
+}
+
+bool LastFMRequest::finish(Status finalStatus, std::vector<Song*>* songs, const std::string& message) {
+    Callback onDone;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (status != PENDING) return false;
+        status = finalStatus;
+        error = message;
+        if (songs) results.swap(*songs);
+        onDone.swap(callback);
+    }
+    done.notify_all();
+
+    if (onDone) {
+        try {
+            onDone(*this);
+        } catch (const std::exception& e) {
+            SystemManager::handleException(e);
+        }
+    }
+    return true;
+}
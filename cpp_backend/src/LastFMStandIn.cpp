@@ -0,0 +1,433 @@
+#include "LastFMStandIn.hpp"
+#include "SystemManager.hpp"
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <unordered_map>
+#include <algorithm>
+#include <cctype>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char* const FIXTURE_MAGIC = "MPFIXTURE1";
+    const int DEFAULT_PAGE_SIZE = 50;
+    const int MAX_PAGE_SIZE = 1000;
+
+    std::mutex configMutex;
+    std::atomic<bool> enabled(false);
+    std::atomic<bool> recording(false);
+    std::string fixtureDirectory;
+    std::string recordDirectory;
+    LastFMStandIn::LatencyProfile defaultLatency{LastFMStandIn::NONE, 0, 0, 0, 0.0};
+    std::map<std::string, LastFMStandIn::LatencyProfile> methodLatency;
+    LastFMStandIn::FaultProfile faults{0.0, 0.0, 0.0, 0.0};
+    bool synthesizeMissing = true;
+    uint64_t seed = 0x5eed;
+
+    // Per-key request counters, so the n-th call for a key always draws the same values
+    std::unordered_map<std::string, uint64_t> sequences;
+
+    std::atomic<uint64_t> requestCount(0);
+    std::atomic<uint64_t> fixtureHits(0);
+    std::atomic<uint64_t> synthesizedCount(0);
+    std::atomic<uint64_t> notFoundCount(0);
+    std::atomic<uint64_t> recordedCount(0);
+    std::atomic<uint64_t> throttledCount(0);
+    std::atomic<uint64_t> serverErrorCount(0);
+    std::atomic<uint64_t> timeoutCount(0);
+    std::atomic<uint64_t> truncatedCount(0);
+    std::atomic<uint64_t> totalLatencyMs(0);
+
+    uint64_t hashKey(const std::string& key) {
+        uint64_t hash = 1469598103934665603ULL;
+        for (unsigned char c : key) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // splitmix64: small, fast and good enough for test draws
+    uint64_t nextRandom(uint64_t& state) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    double nextUnit(uint64_t& state) {
+        return (nextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    std::string jsonEscape(const std::string& value) {
+        std::string escaped;
+        escaped.reserve(value.size());
+        for (char c : value) {
+            if (c == '"' || c == '\\') escaped += '\\';
+            if ((unsigned char)c < 0x20) continue;
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    std::string param(const std::map<std::string, std::string>& params, const std::string& name) {
+        auto it = params.find(name);
+        return it != params.end() ? it->second : "";
+    }
+}
+
+void LastFMStandIn::enable(const std::string& directory) {
+    {
+        std::lock_guard<std::mutex> lock(configMutex);
+        fixtureDirectory = directory;
+    }
+    enabled = true;
+    SystemManager::logInfo("Last.fm stand-in enabled (fixtures: " + directory + ")");
+}
+
+void LastFMStandIn::disable() {
+    enabled = false;
+}
+
+bool LastFMStandIn::isEnabled() {
+    return enabled.load();
+}
+
+void LastFMStandIn::setRecording(bool record, const std::string& directory) {
+    if (record) {
+        try {
+            fs::create_directories(directory);
+        } catch (const std::exception& e) {
+            SystemManager::logError("Cannot record fixtures: " + std::string(e.what()));
+            return;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(configMutex);
+        recordDirectory = directory;
+    }
+    recording = record;
+}
+
+bool LastFMStandIn::isRecording() {
+    return recording.load();
+}
+
+void LastFMStandIn::setLatency(const LatencyProfile& profile) {
+    std::lock_guard<std::mutex> lock(configMutex);
+    defaultLatency = profile;
+}
+
+void LastFMStandIn::setMethodLatency(const std::string& method, const LatencyProfile& profile) {
+    std::lock_guard<std::mutex> lock(configMutex);
+    methodLatency[method] = profile;
+}
+
+void LastFMStandIn::setFaults(const FaultProfile& profile) {
+    std::lock_guard<std::mutex> lock(configMutex);
+    faults = profile;
+}
+
+void LastFMStandIn::setSynthesizeMissing(bool synthesize) {
+    std::lock_guard<std::mutex> lock(configMutex);
+    synthesizeMissing = synthesize;
+}
+
+void LastFMStandIn::setSeed(uint64_t value) {
+    std::lock_guard<std::mutex> lock(configMutex);
+    seed = value;
+    sequences.clear();
+}
+
+LastFMManager::HttpResponse LastFMStandIn::serve(const std::string& url, const std::string& postBody) {
+    std::map<std::string, std::string> params = parseUrl(url);
+    if (!postBody.empty()) {
+        for (const auto& pair : parseForm(postBody)) params[pair.first] = pair.second;
+    }
+    std::string key = LastFMManager::buildCacheKey(params);
+    std::string method = param(params, "method");
+
+    LatencyProfile latency;
+    FaultProfile injected;
+    bool generate;
+    uint64_t state;
+    {
+        std::lock_guard<std::mutex> lock(configMutex);
+        auto it = methodLatency.find(method);
+        latency = it != methodLatency.end() ? it->second : defaultLatency;
+        injected = faults;
+        generate = synthesizeMissing;
+        state = seed ^ hashKey(key) ^ (sequences[key]++ * 0xd1b54a32d192ed03ULL);
+    }
+    requestCount++;
+
+    int delayMs = drawLatency(latency, state);
+    if (delayMs > 0) {
+        totalLatencyMs += delayMs;
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+    }
+
+    // Faults are drawn in a fixed order so each rate is independent of the others
+    double throttleDraw = nextUnit(state);
+    double serverDraw = nextUnit(state);
+    double timeoutDraw = nextUnit(state);
+    double truncateDraw = nextUnit(state);
+
+    if (throttleDraw < injected.throttleRate) {
+        throttledCount++;
+        return LastFMManager::HttpResponse{429, R"({"error":29,"message":"Rate Limit Exceeded"})"};
+    }
+    if (serverDraw < injected.serverErrorRate) {
+        serverErrorCount++;
+        return LastFMManager::HttpResponse{503, ""};
+    }
+    if (timeoutDraw < injected.timeoutRate) {
+        timeoutCount++;
+        return LastFMManager::HttpResponse{0, ""};
+    }
+
+    // Writes must be authenticated POSTs (checking api_sig needs the secret, so only its presence is)
+    if (method == "track.scrobble") {
+        if (postBody.empty()) {
+            return LastFMManager::HttpResponse{405, R"({"error":3,"message":"Invalid Method - write requests must be POSTed"})"};
+        }
+        if (param(params, "sk").empty()) {
+            return LastFMManager::HttpResponse{403, R"({"error":9,"message":"Invalid session key"})"};
+        }
+        if (param(params, "api_sig").size() != 32) {
+            return LastFMManager::HttpResponse{403, R"({"error":13,"message":"Invalid method signature supplied"})"};
+        }
+        for (int i = 0; params.count("artist[" + std::to_string(i) + "]"); ++i) {
+            std::string timestamp = param(params, "timestamp[" + std::to_string(i) + "]");
+            if (timestamp.empty() || timestamp.find_first_not_of("0123456789") != std::string::npos) {
+                return LastFMManager::HttpResponse{400, R"({"error":6,"message":"Invalid parameters - timestamp must be a UNIX time"})"};
+            }
+        }
+    }
+
+    LastFMManager::HttpResponse response{200, ""};
+    if (loadFixture(key, method, response)) {
+        fixtureHits++;
+    } else if (generate) {
+        response.body = synthesize(params, state);
+        synthesizedCount++;
+    } else {
+        notFoundCount++;
+        return LastFMManager::HttpResponse{404, R"({"error":6,"message":"No fixture for request"})"};
+    }
+
+    if (truncateDraw < injected.truncateRate && response.body.size() > 1) {
+        truncatedCount++;
+        response.body.resize(nextRandom(state) % response.body.size());
+    }
+    return response;
+}
+
+void LastFMStandIn::record(const std::string& url, const LastFMManager::HttpResponse& response) {
+    if (response.status != 200 || response.body.empty()) return;
+
+    std::string directory;
+    {
+        std::lock_guard<std::mutex> lock(configMutex);
+        directory = recordDirectory;
+    }
+    if (directory.empty()) return;
+
+    std::string key = LastFMManager::buildCacheKey(parseUrl(url));
+    std::string path = fixturePath(directory, key);
+    std::string tempPath = path + ".tmp";
+    try {
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return;
+            file << FIXTURE_MAGIC << "\n" << key << "\n" << response.status << "\n" << response.body;
+        }
+        fs::rename(tempPath, path);
+        recordedCount++;
+    } catch (const std::exception& e) {
+        SystemManager::logWarning("Failed to record fixture: " + std::string(e.what()));
+    }
+}
+
+LastFMStandIn::Stats LastFMStandIn::getStats() {
+    return Stats{requestCount.load(), fixtureHits.load(), synthesizedCount.load(), notFoundCount.load(),
+                 recordedCount.load(), throttledCount.load(), serverErrorCount.load(), timeoutCount.load(),
+                 truncatedCount.load(), totalLatencyMs.load()};
+}
+
+void LastFMStandIn::resetStats() {
+    requestCount = 0;
+    fixtureHits = 0;
+    synthesizedCount = 0;
+    notFoundCount = 0;
+    recordedCount = 0;
+    throttledCount = 0;
+    serverErrorCount = 0;
+    timeoutCount = 0;
+    truncatedCount = 0;
+    totalLatencyMs = 0;
+}
+
+std::map<std::string, std::string> LastFMStandIn::parseUrl(const std::string& url) {
+    std::map<std::string, std::string> params;
+    size_t start = url.find('?');
+    start = start == std::string::npos ? 0 : start + 1;
+
+    while (start < url.size()) {
+        size_t end = url.find('&', start);
+        if (end == std::string::npos) end = url.size();
+        size_t equals = url.find('=', start);
+        if (equals != std::string::npos && equals < end) {
+            params[url.substr(start, equals - start)] = url.substr(equals + 1, end - equals - 1);
+        }
+        start = end + 1;
+    }
+    return params;
+}
+
+std::map<std::string, std::string> LastFMStandIn::parseForm(const std::string& body) {
+    auto decode = [](const std::string& text) {
+        std::string decoded;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '%' && i + 2 < text.size() && std::isxdigit((unsigned char)text[i + 1]) &&
+                std::isxdigit((unsigned char)text[i + 2])) {
+                decoded += (char)std::stoi(text.substr(i + 1, 2), nullptr, 16);
+                i += 2;
+            } else {
+                decoded += text[i] == '+' ? ' ' : text[i];
+            }
+        }
+        return decoded;
+    };
+
+    std::map<std::string, std::string> params;
+    for (const auto& pair : parseUrl("?" + body)) {
+        params[decode(pair.first)] = decode(pair.second);
+    }
+    return params;
+}
+
+std::string LastFMStandIn::fixturePath(const std::string& directory, const std::string& key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.fixture", (unsigned long long)hashKey(key));
+    return (fs::path(directory) / name).string();
+}
+
+bool LastFMStandIn::loadFixture(const std::string& key, const std::string& method,
+                                LastFMManager::HttpResponse& response) {
+    std::string directory;
+    {
+        std::lock_guard<std::mutex> lock(configMutex);
+        directory = fixtureDirectory;
+    }
+    if (directory.empty()) return false;
+
+    // Exact recording first
+    std::ifstream file(fixturePath(directory, key), std::ios::binary);
+    if (file.is_open()) {
+        std::string magic, storedKey, status;
+        if (std::getline(file, magic) && magic == FIXTURE_MAGIC &&
+            std::getline(file, storedKey) && storedKey == key && std::getline(file, status)) {
+            std::ostringstream content;
+            content << file.rdbuf();
+            response.status = std::atoi(status.c_str());
+            response.body = content.str();
+            return true;
+        }
+    }
+
+    // Then a hand-written body shared by every request of the method
+    std::ifstream shared((fs::path(directory) / (method + ".json")).string(), std::ios::binary);
+    if (shared.is_open()) {
+        std::ostringstream content;
+        content << shared.rdbuf();
+        response.status = 200;
+        response.body = content.str();
+        return true;
+    }
+    return false;
+}
+
+std::string LastFMStandIn::synthesize(const std::map<std::string, std::string>& params, uint64_t state) {
+    std::string method = param(params, "method");
+    std::string artist = jsonEscape(param(params, "artist"));
+    std::string track = jsonEscape(param(params, "track"));
+
+    if (method == "track.scrobble") {
+        int accepted = 0;
+        while (params.count("artist[" + std::to_string(accepted) + "]")) accepted++;
+        return "{\"scrobbles\":{\"@attr\":{\"accepted\":" + std::to_string(accepted) + ",\"ignored\":0}}}";
+    }
+
+    if (method == "track.getinfo") {
+        uint64_t listeners = 1000 + nextRandom(state) % 5000000;
+        return "{\"track\":{\"name\":\"" + track + "\",\"artist\":{\"name\":\"" + artist + "\"},"
+               "\"duration\":\"" + std::to_string(120000 + nextRandom(state) % 240000) + "\","
+               "\"listeners\":\"" + std::to_string(listeners) + "\","
+               "\"playcount\":\"" + std::to_string(listeners * (2 + nextRandom(state) % 20)) + "\"}}";
+    }
+
+    int limit = DEFAULT_PAGE_SIZE;
+    std::string limitParam = param(params, "limit");
+    if (!limitParam.empty()) limit = std::max(1, std::min(MAX_PAGE_SIZE, std::atoi(limitParam.c_str())));
+
+    std::string wrapper = "tracks";
+    std::string titlePrefix = "Track";
+    if (method == "artist.gettoptracks") {
+        wrapper = "toptracks";
+    } else if (method == "track.getsimilar") {
+        wrapper = "similartracks";
+        titlePrefix = "Similar to " + track;
+    } else if (method == "track.search") {
+        titlePrefix = track;
+    }
+
+    std::string body;
+    body.reserve(limit * 160);
+    body += method == "track.search" ? "{\"results\":{\"trackmatches\":{\"track\":[" : "{\"" + wrapper + "\":{\"track\":[";
+
+    uint64_t listeners = 2000000 + nextRandom(state) % 1000000;
+    for (int i = 0; i < limit; ++i) {
+        std::string trackArtist = (method == "artist.gettoptracks" && !artist.empty())
+            ? artist : "Artist " + std::to_string(nextRandom(state) % 997);
+        listeners -= listeners / 20;
+
+        if (i > 0) body += ',';
+        body += "{\"name\":\"" + titlePrefix + " #" + std::to_string(i + 1) + "\","
+                "\"duration\":\"" + std::to_string(120 + nextRandom(state) % 240) + "\","
+                "\"listeners\":\"" + std::to_string(listeners) + "\","
+                "\"mbid\":\"\",\"artist\":{\"name\":\"" + trackArtist + "\"}}";
+    }
+
+    body += method == "track.search" ? "]}}}" : "]}}";
+    return body;
+}
+
+int LastFMStandIn::drawLatency(const LatencyProfile& profile, uint64_t& state) {
+    switch (profile.distribution) {
+        case FIXED:
+            return profile.medianMs;
+        case UNIFORM: {
+            int span = std::max(0, profile.maxMs - profile.minMs);
+            return profile.minMs + (int)(nextUnit(state) * (span + 1));
+        }
+        case LOG_NORMAL: {
+            // Box-Muller; 1 - u keeps the log argument above zero
+            double u1 = 1.0 - nextUnit(state);
+            double u2 = nextUnit(state);
+            double normal = std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+            double ms = std::max(1, profile.medianMs) * std::exp(profile.sigma * normal);
+            if (profile.maxMs > 0) ms = std::min(ms, (double)profile.maxMs);
+            return std::max(profile.minMs, (int)ms);
+        }
+        default:
+            return 0;
+    }
+}
@@ -1,14 +1,19 @@
 #include "MusicPlayer.hpp"
 #include "UI.hpp"
 #include "SystemManager.hpp"
+#include "ScrobbleQueue.hpp"
 #include <iostream>
 
 MusicPlayer::MusicPlayer() : running(true) {
     // Constructor: Initialize with empty playlist
+    ScrobbleQueue::instance().start(FileManager::getScrobbleDirectory());
+    player.setPlaylist(&playlist);
 }
 
 MusicPlayer::~MusicPlayer() {
     // Destructor: Cleanup happens automatically through Playlist destructor
+    ScrobbleQueue::instance().stop();
+    LastFMManager::shutdown();
 }
 
 void MusicPlayer::run() {
@@ -309,7 +314,7 @@ void MusicPlayer::displayEnhancedMenu() {
     std::cout << "[8] Get Song at Position\n";
     std::cout << "[9] Clear Playlist\n";
     std::cout << "\n--- DISCOVERY (API) ---\n";
-    std::cout << "[10] Search Songs\n";
+    std::cout << "[10] Search Songs (Playlist, Catalog, Last.fm)\n";
     std::cout << "[11] Browse Trending\n";
     std::cout << "[12] Get Recommendations\n";
     std::cout << "\n--- LAST.FM (REAL MUSIC DATA) ---\n";
@@ -331,19 +336,42 @@ void MusicPlayer::searchSongsFromAPI() {
     UI::displayHeader();
     
     try {
-        std::string query = SystemManager::getSafeString("Enter song title to search: ");
-        auto results = APIManager::searchSongs(query);
+        std::string query = SystemManager::getSafeString("Enter song title or artist to search: ");
+        auto search = APIManager::federatedSearch(query, playlist);
+        
+        // Local matches are already in; show them while Last.fm answers
+        auto results = search->getResults();
+        if (!results.empty()) {
+            UI::displayMessage("Library and catalog matches:");
+            for (size_t i = 0; i < results.size() && i < 5; ++i) {
+                std::cout << "  " << results[i].title << " - " << results[i].artist << "\n";
+            }
+        }
+        
+        if (search->getStatus(FederatedSearch::LASTFM) == FederatedSearch::PENDING) {
+            UI::displayMessage("Waiting for Last.fm...");
+        }
+        search->wait();
+        if (search->getStatus(FederatedSearch::LASTFM) == FederatedSearch::TIMED_OUT) {
+            SystemManager::logWarning("Last.fm did not answer in time, showing local results only");
+        }
         
+        results = search->getResults();
         if (results.empty()) {
             UI::displayError("No songs found!");
             return;
         }
         
-        UI::displayMessage("Search Results:");
+        UI::displayMessage("Search Results for '" + query + "':");
         UI::displaySeparator();
         
         for (size_t i = 0; i < results.size(); ++i) {
-            std::cout << (i + 1) << ". " << results[i]->toString() << "\n";
+            const FederatedSearch::Result& result = results[i];
+            std::string sources;
+            if (result.sources & (1u << FederatedSearch::LIBRARY)) sources += "[Playlist]";
+            if (result.sources & (1u << FederatedSearch::CATALOG)) sources += "[Catalog]";
+            if (result.sources & (1u << FederatedSearch::LASTFM)) sources += "[Last.fm]";
+            std::cout << (i + 1) << ". " << result.title << " - " << result.artist << " " << sources << "\n";
         }
         
         UI::displaySeparator();
@@ -351,14 +379,10 @@ void MusicPlayer::searchSongsFromAPI() {
         int choice = SystemManager::getSafeInteger(0, results.size());
         
         if (choice > 0 && choice <= (int)results.size()) {
-            Song* selected = results[choice - 1];
-            playlist.addLast(new Song(selected->getTitle(), selected->getArtist(), selected->getDuration()));
+            const FederatedSearch::Result& selected = results[choice - 1];
+            playlist.addLast(new Song(selected.title, selected.artist, selected.duration));
             UI::displaySuccess("Song added to playlist!");
         }
-        
-        for (auto s : results) {
-            delete s;
-        }
     } catch (const std::exception& e) {
         SystemManager::handleException(e);
     }
@@ -373,7 +397,9 @@ void MusicPlayer::browseTrendingSongs() {
     UI::displayHeader();
     
     try {
-        auto trending = APIManager::getTrendingSongs();
+        std::cout << "Trending over the last [1] Hour [2] Day [3] Week: ";
+        int window = SystemManager::getSafeInteger(1, 3);
+        auto trending = APIManager::getTrendingSongs((TrendingTracker::Window)(window - 1));
         
         if (trending.empty()) {
             UI::displayError("No trending songs available!");
@@ -414,15 +440,29 @@ void MusicPlayer::browseRecommendations() {
     UI::displayHeader();
     
     try {
-        std::string genre = SystemManager::getSafeString("Enter genre (Pop/Rock/Jazz/etc): ");
-        auto recommendations = APIManager::getRecommendations(genre);
+        std::vector<Song*> recommendations;
+        std::string basis = "your playlist";
+        int seed = 0;
+        
+        if (!playlist.isEmpty()) {
+            std::cout << "Recommend for the whole playlist (0) or for song number (1-" << playlist.getSize() << "): ";
+            seed = SystemManager::getSafeInteger(0, playlist.getSize());
+        }
+        
+        if (seed > 0) {
+            Song* song = playlist.getAt(seed - 1);
+            basis = "'" + song->getTitle() + "'";
+            recommendations = APIManager::getSimilarSongs(song->getTitle(), song->getArtist());
+        } else {
+            recommendations = APIManager::getRecommendations(playlist);
+        }
         
         if (recommendations.empty()) {
             UI::displayError("No recommendations available!");
             return;
         }
         
-        UI::displayMessage("Recommendations for '" + genre + "':");
+        UI::displayMessage("Recommendations for " + basis + ":");
         UI::displaySeparator();
         
         for (size_t i = 0; i < recommendations.size(); ++i) {
@@ -491,7 +531,7 @@ void MusicPlayer::loadPlaylist() {
             for (int i = 0; i < size; ++i) {
                 Song* song = loaded->getAt(i);
                 if (song) {
-                    playlist.addLast(new Song(song->getTitle(), song->getArtist(), song->getDuration()));
+                    playlist.addLast(new Song(*song));
                 }
             }
             
@@ -561,6 +601,7 @@ void MusicPlayer::playSong() {
 
 void MusicPlayer::showNowPlaying() {
     UI::clearScreen();
+    player.update();
     player.displayNowPlaying();
 }
 
@@ -592,6 +633,7 @@ void MusicPlayer::searchFromLastFM() {
             Song* selected = results[choice - 1];
             playlist.addLast(new Song(selected->getTitle(), selected->getArtist(), selected->getDuration()));
             UI::displaySuccess("Song added from Last.fm!");
+            LastFMManager::prefetchRelated(selected->getTitle(), selected->getArtist());
         }
         
         for (auto s : results) {
@@ -633,6 +675,7 @@ void MusicPlayer::browseLastFMTop() {
             Song* selected = topTracks[choice - 1];
             playlist.addLast(new Song(selected->getTitle(), selected->getArtist(), selected->getDuration()));
             UI::displaySuccess("Track added to your playlist!");
+            LastFMManager::prefetchRelated(selected->getTitle(), selected->getArtist());
         }
         
         for (auto s : topTracks) {
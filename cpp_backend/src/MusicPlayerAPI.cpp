@@ -1,12 +1,101 @@
 #include "MusicPlayerAPI.hpp"
 #include "MusicPlayer.hpp"
 #include "LastFMManager.hpp"
+#include "APIManager.hpp"
+#include "SuggestIndex.hpp"
+#include "DefaultCatalog.hpp"
+#include "WavDecoder.hpp"
+#include "ScrobbleQueue.hpp"
 #include <cstring>
 #include <vector>
+#include <map>
+#include <mutex>
+#include <future>
 
 // Global instances
 static MusicPlayer* g_musicPlayer = nullptr;
 
+// Outstanding asynchronous Last.fm requests, keyed by the handle given to C#
+static std::mutex g_requestsMutex;
+static std::map<int, LastFMManager::RequestHandle> g_requests;
+static int g_nextRequestHandle = 1;
+
+static int registerRequest(const LastFMManager::RequestHandle& request)
+{
+    std::lock_guard<std::mutex> lock(g_requestsMutex);
+    int handle = g_nextRequestHandle++;
+    g_requests[handle] = request;
+    return handle;
+}
+
+static LastFMManager::RequestHandle findRequest(int handle)
+{
+    std::lock_guard<std::mutex> lock(g_requestsMutex);
+    auto it = g_requests.find(handle);
+    return it != g_requests.end() ? it->second : nullptr;
+}
+
+static void releaseRequest(int handle)
+{
+    std::lock_guard<std::mutex> lock(g_requestsMutex);
+    g_requests.erase(handle);
+}
+
+// Type-ahead indexes, swapped in atomically so Suggest never blocks.
+// The catalog never changes, so its index is built once, off the calling
+// thread; only the small playlist index is rebuilt when the playlist
+// changes. Suggest merges the two top-k lists, playlist songs first.
+static std::shared_ptr<const SuggestIndex> g_catalogSuggestions;
+static std::shared_ptr<const SuggestIndex> g_playlistSuggestions;
+static std::future<void> g_catalogIndexer; // waits for the build if destroyed early
+
+static void buildCatalogSuggestions()
+{
+    if (g_catalogIndexer.valid() || std::atomic_load(&g_catalogSuggestions)) return;
+
+    g_catalogIndexer = std::async(std::launch::async, [] {
+        try
+        {
+            Catalog& catalog = APIManager::catalog();
+            std::vector<SuggestIndex::Entry> entries;
+            entries.reserve(catalog.size());
+            for (size_t id = 0; id < catalog.size(); id++)
+            {
+                Catalog::Track track = catalog.get((Catalog::TrackId)id);
+                entries.push_back(SuggestIndex::Entry{track.title, track.artist, track.duration, track.popularity});
+            }
+            std::atomic_store(&g_catalogSuggestions,
+                              std::shared_ptr<const SuggestIndex>(std::make_shared<SuggestIndex>(entries)));
+        }
+        catch (const std::exception& e)
+        {
+            SystemManager::handleException(e);
+        }
+    });
+}
+
+static void refreshSuggestions()
+{
+    std::vector<SuggestIndex::Entry> entries;
+
+    if (g_musicPlayer)
+    {
+        // Equal popularity: playlist order breaks the tie
+        Playlist* playlist = g_musicPlayer->getPlaylist();
+        for (int i = 0; i < playlist->getSize(); i++)
+        {
+            Song* song = playlist->getAt(i);
+            if (song)
+            {
+                entries.push_back(SuggestIndex::Entry{song->getTitle(), song->getArtist(), song->getDuration(), 0});
+            }
+        }
+    }
+
+    std::atomic_store(&g_playlistSuggestions,
+                      std::shared_ptr<const SuggestIndex>(std::make_shared<SuggestIndex>(entries)));
+}
+
 namespace MusicPlayerAPI
 {
     void InitBackend()
@@ -14,18 +103,15 @@ namespace MusicPlayerAPI
         if (!g_musicPlayer)
         {
             g_musicPlayer = new MusicPlayer();
-            // Initialize mock songs
-            Song* song1 = new Song("Blinding Lights", "The Weeknd", 200);
-            Song* song2 = new Song("Shape of You", "Ed Sheeran", 233);
-            Song* song3 = new Song("Someone Like You", "Adele", 285);
-            Song* song4 = new Song("Bad Guy", "Billie Eilish", 194);
-            Song* song5 = new Song("Perfect", "Ed Sheeran", 263);
-            
-            g_musicPlayer->getPlaylist()->addLast(song1);
-            g_musicPlayer->getPlaylist()->addLast(song2);
-            g_musicPlayer->getPlaylist()->addLast(song3);
-            g_musicPlayer->getPlaylist()->addLast(song4);
-            g_musicPlayer->getPlaylist()->addLast(song5);
+            // Start with the built-in songs marked for the library
+            for (const auto& entry : DefaultCatalog::ENTRIES)
+            {
+                if (!entry.inLibrary) continue;
+                g_musicPlayer->getPlaylist()->addLast(
+                    new Song(std::string(entry.title), std::string(entry.artist), entry.duration));
+            }
+            refreshSuggestions();
+            buildCatalogSuggestions();
         }
     }
 
@@ -41,6 +127,21 @@ namespace MusicPlayerAPI
         
         Song* newSong = new Song(title, artist, duration);
         g_musicPlayer->getPlaylist()->addLast(newSong);
+        refreshSuggestions();
+        return GetPlaylistSize();
+    }
+
+    int AddSongFileToPlaylist(const char* title, const char* artist, const char* filePath)
+    {
+        if (!title || !artist || !filePath) return -1;
+        if (!g_musicPlayer) InitBackend();
+
+        std::unique_ptr<WavDecoder> decoder = WavDecoder::open(filePath);
+        if (!decoder) return -1;
+        int duration = (int)((decoder->getLength() + decoder->getFormat().sampleRate / 2) / decoder->getFormat().sampleRate);
+
+        g_musicPlayer->getPlaylist()->addLast(new Song(title, artist, duration, filePath));
+        refreshSuggestions();
         return GetPlaylistSize();
     }
 
@@ -49,6 +150,7 @@ namespace MusicPlayerAPI
         if (!g_musicPlayer) InitBackend();
         
         g_musicPlayer->getPlaylist()->removeIndex(index);
+        refreshSuggestions();
         return GetPlaylistSize();
     }
 
@@ -70,6 +172,7 @@ namespace MusicPlayerAPI
     {
         if (!g_musicPlayer) InitBackend();
         g_musicPlayer->getPlaylist()->clear();
+        refreshSuggestions();
     }
 
     int GetAllSongs(SongData* outArray, int maxSize)
@@ -125,10 +228,17 @@ namespace MusicPlayerAPI
         g_musicPlayer->getPlayer()->stop();
     }
 
+    void NotifyTrackFinished()
+    {
+        if (!g_musicPlayer) InitBackend();
+        g_musicPlayer->getPlayer()->finish();
+    }
+
     int GetCurrentSongIndex()
     {
         if (!g_musicPlayer) InitBackend();
         
+        g_musicPlayer->getPlayer()->update();
         Song* current = g_musicPlayer->getPlayer()->getCurrentSong();
         if (!current) return -1;
         
@@ -144,20 +254,52 @@ namespace MusicPlayerAPI
     int GetPlaybackState()
     {
         if (!g_musicPlayer) InitBackend();
+        g_musicPlayer->getPlayer()->update();
         return (int)g_musicPlayer->getPlayer()->getState();
     }
 
     float GetProgress()
     {
         if (!g_musicPlayer) InitBackend();
+        g_musicPlayer->getPlayer()->update();
         return g_musicPlayer->getPlayer()->getProgress();
     }
 
+    void SetCrossfade(float seconds)
+    {
+        if (!g_musicPlayer) InitBackend();
+        g_musicPlayer->getPlayer()->getEngine().setCrossfade(seconds);
+    }
+
+    float GetCrossfade()
+    {
+        if (!g_musicPlayer) InitBackend();
+        return (float)g_musicPlayer->getPlayer()->getEngine().getCrossfade();
+    }
+
+    void SetOutputRate(int sampleRate)
+    {
+        if (!g_musicPlayer) InitBackend();
+        g_musicPlayer->getPlayer()->getEngine().setOutputRate(sampleRate);
+    }
+
+    void SetPlaybackSpeed(float speed)
+    {
+        if (!g_musicPlayer) InitBackend();
+        g_musicPlayer->getPlayer()->getEngine().setSpeed(speed);
+    }
+
+    float GetPlaybackSpeed()
+    {
+        if (!g_musicPlayer) InitBackend();
+        return (float)g_musicPlayer->getPlayer()->getEngine().getSpeed();
+    }
+
     int SearchFromLastFM(const char* query, SongData* outArray, int maxResults)
     {
         if (!query || !outArray) return 0;
         
-        LastFMManager::initialize("mock_api_key");
+        if (!LastFMManager::isInitialized()) LastFMManager::initialize("mock_api_key");
         std::vector<Song*> results = LastFMManager::searchTracks(query);
         
         int count = 0;
@@ -182,7 +324,7 @@ namespace MusicPlayerAPI
     {
         if (!outArray) return 0;
         
-        LastFMManager::initialize("mock_api_key");
+        if (!LastFMManager::isInitialized()) LastFMManager::initialize("mock_api_key");
         std::vector<Song*> results = LastFMManager::getTopTracks(maxResults);
         
         int count = 0;
@@ -203,6 +345,78 @@ namespace MusicPlayerAPI
         return count;
     }
 
+    int BeginSearchFromLastFM(const char* query)
+    {
+        if (!query) return -1;
+        if (!LastFMManager::isInitialized()) LastFMManager::initialize("mock_api_key");
+        return registerRequest(LastFMManager::searchTracksAsync(query));
+    }
+
+    int BeginGetTopTracks(int maxResults)
+    {
+        if (maxResults <= 0) return -1;
+        if (!LastFMManager::isInitialized()) LastFMManager::initialize("mock_api_key");
+        return registerRequest(LastFMManager::getTopTracksAsync(maxResults));
+    }
+
+    int GetRequestStatus(int handle)
+    {
+        LastFMManager::RequestHandle request = findRequest(handle);
+        if (!request) return -1;
+        return (int)request->getStatus();
+    }
+
+    int CollectRequestResults(int handle, SongData* outArray, int maxResults)
+    {
+        LastFMManager::RequestHandle request = findRequest(handle);
+        if (!request) return 0;
+        if (!request->isDone()) return -1;
+
+        std::vector<Song*> results = request->takeResults();
+        releaseRequest(handle);
+
+        int count = 0;
+        for (const auto& song : results)
+        {
+            if (outArray && count < maxResults)
+            {
+                strncpy_s(outArray[count].title, sizeof(outArray[count].title), 
+                    song->getTitle().c_str(), _TRUNCATE);
+                strncpy_s(outArray[count].artist, sizeof(outArray[count].artist), 
+                    song->getArtist().c_str(), _TRUNCATE);
+                outArray[count].duration = song->getDuration();
+                count++;
+            }
+            delete song;
+        }
+        
+        return count;
+    }
+
+    void CancelRequest(int handle)
+    {
+        LastFMManager::RequestHandle request = findRequest(handle);
+        if (!request) return;
+        request->cancel();
+        releaseRequest(handle);
+    }
+
+    void PrefetchRelatedTracks(const char* title, const char* artist)
+    {
+        if (!title || !artist) return;
+        if (!LastFMManager::isInitialized()) LastFMManager::initialize("mock_api_key");
+        LastFMManager::prefetchRelated(title, artist);
+    }
+
+    void SetLastFMSession(const char* apiSecret, const char* sessionKey)
+    {
+        if (!apiSecret || !sessionKey) return;
+        if (!LastFMManager::isInitialized()) LastFMManager::initialize("mock_api_key");
+        LastFMManager::setApiSecret(apiSecret);
+        LastFMManager::setSessionKey(sessionKey);
+        ScrobbleQueue::instance().flush(); // send what piled up while signed out
+    }
+
     int SavePlaylist(const char* filename)
     {
         if (!g_musicPlayer || !filename) return -1;
@@ -223,23 +437,84 @@ namespace MusicPlayerAPI
                 Song* song = loaded->getAt(i);
                 if (song)
                 {
-                    g_musicPlayer->getPlaylist()->addLast(
-                        new Song(song->getTitle(), song->getArtist(), song->getDuration())
-                    );
+                    g_musicPlayer->getPlaylist()->addLast(new Song(*song));
                 }
             }
             delete loaded;
+            refreshSuggestions();
             return 0;
         }
         return -1;
     }
 
+    int Suggest(const char* prefix, int k, SongData* outArray)
+    {
+        if (!prefix || !outArray || k <= 0) return 0;
+
+        if (k > SuggestIndex::MAX_K) k = SuggestIndex::MAX_K;
+
+        std::shared_ptr<const SuggestIndex> playlistIndex = std::atomic_load(&g_playlistSuggestions);
+        if (!playlistIndex)
+        {
+            InitBackend();
+            playlistIndex = std::atomic_load(&g_playlistSuggestions);
+        }
+        // Null until the background build finishes: playlist suggestions only
+        std::shared_ptr<const SuggestIndex> catalogIndex = std::atomic_load(&g_catalogSuggestions);
+
+        uint32_t ids[SuggestIndex::MAX_K];
+        const SuggestIndex::Entry* picked[SuggestIndex::MAX_K];
+        int count = 0;
+
+        if (playlistIndex)
+        {
+            int found = playlistIndex->suggest(prefix, k, ids);
+            for (int i = 0; i < found; i++) picked[count++] = &playlistIndex->getEntry(ids[i]);
+        }
+
+        // Fill up from the catalog, skipping songs already listed from the
+        // playlist (at most one per listed song, so MAX_K candidates suffice)
+        int fromPlaylist = count;
+        if (catalogIndex && count < k)
+        {
+            int found = catalogIndex->suggest(prefix, SuggestIndex::MAX_K, ids);
+            for (int i = 0; i < found && count < k; i++)
+            {
+                const SuggestIndex::Entry& entry = catalogIndex->getEntry(ids[i]);
+                bool listed = false;
+                for (int j = 0; j < fromPlaylist && !listed; j++) listed = SuggestIndex::sameSong(*picked[j], entry);
+                if (!listed) picked[count++] = &entry;
+            }
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            strncpy_s(outArray[i].title, sizeof(outArray[i].title), picked[i]->title.c_str(), _TRUNCATE);
+            strncpy_s(outArray[i].artist, sizeof(outArray[i].artist), picked[i]->artist.c_str(), _TRUNCATE);
+            outArray[i].duration = picked[i]->duration;
+        }
+        return count;
+    }
+
     void ShutdownBackend()
     {
+        {
+            std::lock_guard<std::mutex> lock(g_requestsMutex);
+            for (auto& pair : g_requests)
+            {
+                pair.second->cancel();
+            }
+            g_requests.clear();
+        }
+        LastFMManager::shutdown();
+
         if (g_musicPlayer)
         {
             delete g_musicPlayer;
             g_musicPlayer = nullptr;
         }
+        std::atomic_store(&g_playlistSuggestions, std::shared_ptr<const SuggestIndex>());
+        // The catalog index is kept for a later InitBackend; just let its build finish
+        if (g_catalogIndexer.valid()) g_catalogIndexer.wait();
     }
 }
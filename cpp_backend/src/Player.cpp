@@ -1,10 +1,18 @@
 #include "Player.hpp"
 #include "SystemManager.hpp"
+#include "ScrobbleQueue.hpp"
+#include "TrendingTracker.hpp"
+#include "WavDecoder.hpp"
 #include <iostream>
 #include <iomanip>
+#include <chrono>
+#include <algorithm>
+
+// Songs without an audio file play this much silence per second of duration
+static const AudioFormat SILENCE_FORMAT = {44100, 2};
 
 Player::Player() 
-    : currentSong(nullptr), state(STOPPED), elapsedSeconds(0), wasPaused(false), pausedTime(0) {
+    : playlist(nullptr), currentSong(nullptr), queuedSong(nullptr), queuedTrack(0), startedAt(0) {
     // Constructor
 }
 
@@ -18,41 +26,147 @@ void Player::play(Song* song) {
         return;
     }
     
+    scrobbleCurrent(getElapsedTime());
+
+    queuedSong = nullptr;
+    queuedTrack = 0;
+    if (!engine.play(openSource(song))) {
+        SystemManager::logError("Cannot play: " + song->getTitle());
+        engine.stop();
+        currentSong = nullptr;
+        return;
+    }
+
+    startSong(song);
+    update(); // queue the song after it
+}
+
+void Player::startSong(Song* song) {
     currentSong = song;
-    state = PLAYING;
-    elapsedSeconds = 0;
-    startTime = std::chrono::steady_clock::now();
-    wasPaused = false;
+    startedAt = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    TrendingTracker::instance().record(song->getTitle(), song->getArtist(), song->getDuration(), startedAt);
     
     SystemManager::logSuccess("▶️  Now playing: " + song->getTitle() + " - " + song->getArtist());
 }
 
+void Player::setPlaylist(Playlist* newPlaylist) {
+    playlist = newPlaylist;
+}
+
+Song* Player::predictNext() const {
+    if (playlist == nullptr || currentSong == nullptr) return nullptr;
+    for (int i = 0; i < playlist->getSize(); i++) {
+        if (playlist->getAt(i) == currentSong) return playlist->getAt(i + 1);
+    }
+    return nullptr;
+}
+
+bool Player::inPlaylist(const Song* song) const {
+    if (playlist == nullptr) return false;
+    for (int i = 0; i < playlist->getSize(); i++) {
+        if (playlist->getAt(i) == song) return true;
+    }
+    return false;
+}
+
+void Player::update() {
+    if (currentSong == nullptr) return;
+
+    if (queuedTrack != 0 && engine.getTrack() == queuedTrack) {
+        // The engine moved on to the queued song without a gap
+        scrobbleCurrent(currentSong->getDuration());
+        Song* song = queuedSong;
+        queuedSong = nullptr;
+        queuedTrack = 0;
+        if (inPlaylist(song)) {
+            startSong(song);
+        } else {
+            // Removed (and deleted) since it was queued
+            engine.stop();
+            currentSong = nullptr;
+            return;
+        }
+    }
+
+    Song* upcoming = predictNext();
+    if (engine.getState() == AudioEngine::ENDED) {
+        // Ran out before the next song could be queued (e.g. a very short
+        // track): start it the ordinary way
+        if (upcoming) play(upcoming);
+        return;
+    }
+
+    // Queue (or, if the playlist changed, re-queue) the song after this one.
+    // When it is too late for this track, try again on the next call.
+    if (upcoming != queuedSong) {
+        queuedTrack = engine.queueNext(upcoming ? openSource(upcoming) : nullptr);
+        queuedSong = queuedTrack != 0 ? upcoming : nullptr;
+    }
+}
+
+std::unique_ptr<AudioSource> Player::openSource(Song* song) const {
+    if (!song->getFilePath().empty()) {
+        std::unique_ptr<AudioSource> decoder = WavDecoder::open(song->getFilePath());
+        if (decoder) return decoder;
+        SystemManager::logWarning("Playing " + song->getTitle() + " without audio");
+    }
+    uint64_t frames = (uint64_t)std::max(0, song->getDuration()) * SILENCE_FORMAT.sampleRate;
+    return std::unique_ptr<AudioSource>(new SilenceSource(SILENCE_FORMAT, frames));
+}
+
 void Player::pause() {
-    if (state == PLAYING) {
-        state = PAUSED;
-        pausedTime = elapsedSeconds;
-        wasPaused = true;
+    update();
+    if (getState() == PLAYING) {
+        engine.pause();
         SystemManager::logInfo("⏸️  Paused: " + currentSong->getTitle());
     }
 }
 
 void Player::resume() {
-    if (state == PAUSED) {
-        state = PLAYING;
-        startTime = std::chrono::steady_clock::now();
+    update();
+    if (getState() == PAUSED) {
+        engine.resume();
         SystemManager::logInfo("▶️  Resumed: " + currentSong->getTitle());
     }
 }
 
 void Player::stop() {
-    state = STOPPED;
+    update();
+    scrobbleCurrent(getElapsedTime());
+    engine.stop();
     currentSong = nullptr;
-    elapsedSeconds = 0;
+    queuedSong = nullptr;
+    queuedTrack = 0;
     SystemManager::logInfo("⏹️  Stopped playback");
 }
 
+void Player::finish() {
+    update();
+    if (currentSong == nullptr) return;
+    // Count the whole track even if rendering lagged behind (the frontend
+    // may have played the audio itself)
+    engine.seek(engine.getLength());
+    stop();
+}
+
+void Player::scrobbleCurrent(int played) {
+    if (currentSong == nullptr) return;
+
+    int duration = currentSong->getDuration();
+    if (duration <= 30) return;
+    if (played * 2 < duration && played < 240) return;
+
+    ScrobbleQueue::instance().enqueue(currentSong->getArtist(), currentSong->getTitle(), startedAt, duration);
+}
+
 Player::PlaybackState Player::getState() const {
-    return state;
+    if (currentSong == nullptr) return STOPPED;
+    switch (engine.getState()) {
+    case AudioEngine::PLAYING: return PLAYING;
+    case AudioEngine::PAUSED:  return PAUSED;
+    default:                   return STOPPED; // includes running off the end
+    }
 }
 
 Song* Player::getCurrentSong() const {
@@ -60,38 +174,39 @@ Song* Player::getCurrentSong() const {
 }
 
 int Player::getElapsedTime() const {
-    if (state == STOPPED) return 0;
-    if (state == PAUSED) return pausedTime;
-    
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - startTime);
-    return pausedTime + static_cast<int>(elapsed.count());
+    if (currentSong == nullptr) return 0;
+    return static_cast<int>(engine.getPositionSeconds());
+}
+
+int Player::getTotalTime() const {
+    if (currentSong == nullptr) return 0;
+    if (engine.getLength() > 0) return static_cast<int>(engine.getLengthSeconds() + 0.5);
+    return currentSong->getDuration();
 }
 
 int Player::getRemainingTime() const {
     if (currentSong == nullptr) return 0;
-    int total = currentSong->getDuration();
-    return total - getElapsedTime();
+    return getTotalTime() - getElapsedTime();
 }
 
 void Player::setProgress(int percentage) {
+    update();
     if (currentSong != nullptr && percentage >= 0 && percentage <= 100) {
-        elapsedSeconds = (currentSong->getDuration() * percentage) / 100;
-        pausedTime = elapsedSeconds;
+        engine.seek(engine.getLength() * percentage / 100);
     }
 }
 
 int Player::getProgress() const {
-    if (currentSong == nullptr || currentSong->getDuration() == 0) return 0;
-    int total = currentSong->getDuration();
-    int elapsed = getElapsedTime();
+    uint64_t length = engine.getLength();
+    if (currentSong == nullptr || length == 0) return 0;
+    uint64_t position = engine.getPosition();
     
-    if (elapsed >= total) return 100;
-    return (elapsed * 100) / total;
+    if (position >= length) return 100;
+    return static_cast<int>(position * 100 / length);
 }
 
 bool Player::isPlaying() const {
-    return state == PLAYING;
+    return getState() == PLAYING;
 }
 
 std::string Player::formatTime(int seconds) const {
@@ -111,10 +226,11 @@ std::string Player::getFormattedCurrentTime() const {
 
 std::string Player::getFormattedTotalTime() const {
     if (currentSong == nullptr) return "00:00";
-    return formatTime(currentSong->getDuration());
+    return formatTime(getTotalTime());
 }
 
 void Player::displayNowPlaying() const {
+    PlaybackState state = getState();
     if (state == STOPPED) {
         std::cout << "\n[STOPPED] No song playing\n";
         return;
@@ -0,0 +1,105 @@
+#include "RateLimiter.hpp"
+#include <thread>
+#include <algorithm>
+
+RateLimiter::RateLimiter(double ratePerSecond, double burst)
+    : rate(ratePerSecond > 0.0 ? ratePerSecond : 1.0), capacity(burst >= 1.0 ? burst : 1.0), tokens(capacity),
+      lastRefill(Clock::now()), blockedUntil(Clock::now()), stats{} {
+}
+
+void RateLimiter::refillLocked(Clock::time_point now) {
+    if (now <= lastRefill) return;
+    double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+    tokens = std::min(capacity, tokens + elapsed * rate);
+    lastRefill = now;
+}
+
+RateLimiter::Clock::duration RateLimiter::waitTimeLocked(Clock::time_point now) const {
+    Clock::duration wait = Clock::duration::zero();
+    if (blockedUntil > now) wait = blockedUntil - now;
+    if (tokens < 1.0) {
+        double seconds = rate > 0 ? (1.0 - tokens) / rate : 1.0;
+        wait = std::max(wait, std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds)));
+    }
+    return wait;
+}
+
+bool RateLimiter::acquire(int timeoutMs) {
+    Clock::time_point start = Clock::now();
+    bool waited = false;
+
+    while (true) {
+        Clock::duration wait;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Clock::time_point now = Clock::now();
+            refillLocked(now);
+            wait = waitTimeLocked(now);
+
+            if (wait == Clock::duration::zero()) {
+                tokens -= 1.0;
+                stats.acquired++;
+                if (waited) {
+                    stats.throttled++;
+                    stats.totalWaitMs += std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count();
+                }
+                return true;
+            }
+
+            if (timeoutMs >= 0 && now + wait > start + std::chrono::milliseconds(timeoutMs)) {
+                stats.rejected++;
+                return false;
+            }
+        }
+
+        // Sleep outside the lock; another thread may take the token first, so loop
+        waited = true;
+        std::this_thread::sleep_for(wait);
+    }
+}
+
+bool RateLimiter::tryAcquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+    refillLocked(now);
+    if (waitTimeLocked(now) != Clock::duration::zero()) {
+        stats.rejected++;
+        return false;
+    }
+    tokens -= 1.0;
+    stats.acquired++;
+    return true;
+}
+
+void RateLimiter::penalize(int milliseconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point until = Clock::now() + std::chrono::milliseconds(milliseconds);
+    if (until > blockedUntil) blockedUntil = until;
+    tokens = std::min(tokens, 0.0);
+}
+
+bool RateLimiter::configure(double ratePerSecond, double burst) {
+    // Written so NaN fails too; tokens could never reach 1 otherwise and acquire() would wait forever
+    if (!(ratePerSecond > 0.0) || !(burst >= 1.0)) return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    refillLocked(Clock::now());
+    rate = ratePerSecond;
+    capacity = burst;
+    tokens = std::min(tokens, capacity);
+    return true;
+}
+
+RateLimiter::Stats RateLimiter::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+    double elapsed = now > lastRefill ? std::chrono::duration<double>(now - lastRefill).count() : 0.0;
+
+    Stats copy = stats;
+    copy.tokensAvailable = std::min(capacity, tokens + elapsed * rate);
+    copy.ratePerSecond = rate;
+    copy.burst = capacity;
+    copy.penaltyRemainingMs = blockedUntil > now
+        ? std::chrono::duration_cast<std::chrono::milliseconds>(blockedUntil - now).count() : 0;
+    return copy;
+}
@@ -0,0 +1,256 @@
+#include "Recommender.hpp"
+#include "Catalog.hpp"
+#include "FileManager.hpp"
+#include "SystemManager.hpp"
+#include <algorithm>
+#include <mutex>
+#include <cmath>
+
+namespace {
+    struct BySimilarity {
+        template <typename T>
+        bool operator()(const T& a, const T& b) const {
+            if (a.similarity != b.similarity) return a.similarity > b.similarity;
+            return a.id < b.id;
+        }
+    };
+}
+
+Recommender& Recommender::instance() {
+    static Recommender recommender;
+    static std::once_flag loaded;
+    std::call_once(loaded, [] { recommender.loadSavedPlaylists(); });
+    return recommender;
+}
+
+Recommender::Recommender() {
+}
+
+void Recommender::loadSavedPlaylists() {
+    try {
+        std::vector<TrackId> dirty;
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        for (const auto& name : FileManager::listPlaylists()) {
+            Playlist* playlist = FileManager::loadPlaylist(name);
+            if (!playlist) continue;
+            applyPlaylist(name, internPlaylist(*playlist), dirty);
+            delete playlist;
+        }
+        refresh(dirty);
+        SystemManager::logInfo("Recommendations built from " + std::to_string(playlists.size()) +
+                               " playlists (" + std::to_string(tracks.size()) + " tracks)");
+    } catch (const std::exception& e) {
+        SystemManager::logError("Failed to build recommendations: " + std::string(e.what()));
+    }
+}
+
+void Recommender::updatePlaylist(const std::string& name, const Playlist& playlist) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    std::vector<TrackId> dirty;
+    applyPlaylist(name, internPlaylist(playlist), dirty);
+    refresh(dirty);
+}
+
+void Recommender::removePlaylist(const std::string& name) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    std::vector<TrackId> dirty;
+    applyPlaylist(name, std::vector<TrackId>(), dirty);
+    playlists.erase(name);
+    refresh(dirty);
+}
+
+std::vector<Recommender::Recommendation> Recommender::recommendForTrack(const std::string& title,
+                                                                        const std::string& artist,
+                                                                        size_t limit) const {
+    std::vector<Recommendation> results;
+    std::shared_lock<std::shared_mutex> lock(mutex);
+
+    TrackId id;
+    if (!findTrack(title, artist, id)) return results;
+
+    for (const auto& neighbour : neighbours[id]) {
+        if (results.size() >= limit) break;
+        results.push_back(Recommendation{tracks[neighbour.id], neighbour.similarity});
+    }
+    return results;
+}
+
+std::vector<Recommender::Recommendation> Recommender::recommendForPlaylist(const Playlist& playlist,
+                                                                           size_t limit) const {
+    std::vector<Recommendation> results;
+    std::shared_lock<std::shared_mutex> lock(mutex);
+
+    std::vector<TrackId> seeds;
+    for (int i = 0; i < playlist.getSize(); ++i) {
+        Song* song = playlist.getAt(i);
+        TrackId id;
+        if (song && findTrack(song->getTitle(), song->getArtist(), id)) seeds.push_back(id);
+    }
+    std::sort(seeds.begin(), seeds.end());
+    seeds.erase(std::unique(seeds.begin(), seeds.end()), seeds.end());
+    if (seeds.empty()) return results;
+
+    // Sum the precomputed neighbour lists into a dense score array
+    thread_local std::vector<float> scores;
+    thread_local std::vector<TrackId> touched;
+    if (scores.size() < tracks.size()) scores.resize(tracks.size(), 0.0f);
+
+    for (auto seed : seeds) {
+        for (const auto& neighbour : neighbours[seed]) {
+            if (scores[neighbour.id] == 0.0f) touched.push_back(neighbour.id);
+            scores[neighbour.id] += neighbour.similarity;
+        }
+    }
+
+    std::vector<Neighbour> ranked;
+    ranked.reserve(touched.size());
+    for (auto id : touched) {
+        if (!std::binary_search(seeds.begin(), seeds.end(), id)) {
+            ranked.push_back(Neighbour{id, scores[id]});
+        }
+        scores[id] = 0.0f;
+    }
+    touched.clear();
+
+    size_t count = std::min(limit, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), BySimilarity());
+    for (size_t i = 0; i < count; ++i) {
+        results.push_back(Recommendation{tracks[ranked[i].id], ranked[i].similarity});
+    }
+    return results;
+}
+
+size_t Recommender::getTrackCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return tracks.size();
+}
+
+size_t Recommender::getPlaylistCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return playlists.size();
+}
+
+std::string Recommender::keyOf(const std::string& title, const std::string& artist) {
+    return Catalog::fold(title) + '\x1f' + Catalog::fold(artist);
+}
+
+bool Recommender::findTrack(const std::string& title, const std::string& artist, TrackId& id) const {
+    auto it = ids.find(keyOf(title, artist));
+    if (it == ids.end()) return false;
+    id = it->second;
+    return true;
+}
+
+std::vector<Recommender::TrackId> Recommender::internPlaylist(const Playlist& playlist) {
+    std::vector<TrackId> trackIds;
+    trackIds.reserve(playlist.getSize());
+    for (int i = 0; i < playlist.getSize(); ++i) {
+        Song* song = playlist.getAt(i);
+        if (!song) continue;
+
+        std::string key = keyOf(song->getTitle(), song->getArtist());
+        auto it = ids.find(key);
+        if (it != ids.end()) {
+            trackIds.push_back(it->second);
+            continue;
+        }
+
+        TrackId id = (TrackId)tracks.size();
+        ids[key] = id;
+        tracks.push_back(Track{song->getTitle(), song->getArtist(), song->getDuration()});
+        occurrences.push_back(0);
+        inverseNorms.push_back(0.0f);
+        coCounts.emplace_back();
+        neighbours.emplace_back();
+        trackIds.push_back(id);
+    }
+    std::sort(trackIds.begin(), trackIds.end());
+    trackIds.erase(std::unique(trackIds.begin(), trackIds.end()), trackIds.end());
+    return trackIds;
+}
+
+void Recommender::applyPlaylist(const std::string& name, std::vector<TrackId> trackIds,
+                                std::vector<TrackId>& dirty) {
+    std::vector<TrackId>& current = playlists[name];
+    if (current == trackIds) return;
+
+    // Removing the old set and adding the new one leaves shared pairs unchanged
+    countPairs(current, -1);
+    countPairs(trackIds, +1);
+
+    dirty.insert(dirty.end(), current.begin(), current.end());
+    dirty.insert(dirty.end(), trackIds.begin(), trackIds.end());
+    current.swap(trackIds);
+}
+
+void Recommender::countPairs(const std::vector<TrackId>& trackIds, int delta) {
+    for (size_t i = 0; i < trackIds.size(); ++i) {
+        TrackId a = trackIds[i];
+        occurrences[a] += delta;
+        inverseNorms[a] = occurrences[a] > 0 ? 1.0f / std::sqrt((float)occurrences[a]) : 0.0f;
+
+        for (size_t j = i + 1; j < trackIds.size(); ++j) {
+            TrackId b = trackIds[j];
+            uint32_t& ab = coCounts[a][b];
+            ab += delta;
+            if (ab == 0) {
+                coCounts[a].erase(b);
+                coCounts[b].erase(a);
+            } else {
+                coCounts[b][a] = ab;
+            }
+        }
+    }
+}
+
+void Recommender::rebuildNeighbours(TrackId id) {
+    std::vector<Neighbour>& list = neighbours[id];
+    list.clear();
+    const auto& row = coCounts[id];
+    if (row.empty()) return;
+
+    // Gather the row into flat arrays, then scale in one pass:
+    // cosine(i, j) = dot(i, j) * invNorm(i) * invNorm(j)
+    thread_local std::vector<TrackId> others;
+    thread_local std::vector<float> similarities;
+    others.clear();
+    similarities.clear();
+    for (const auto& entry : row) {
+        others.push_back(entry.first);
+        similarities.push_back((float)entry.second * inverseNorms[entry.first]);
+    }
+    const float scale = inverseNorms[id];
+    float* values = similarities.data();
+    for (size_t k = 0; k < similarities.size(); ++k) {
+        values[k] *= scale;
+    }
+
+    list.reserve(std::min(NEIGHBOURS, others.size()));
+    for (size_t k = 0; k < others.size(); ++k) {
+        list.push_back(Neighbour{others[k], values[k]});
+    }
+    if (list.size() > NEIGHBOURS) {
+        std::nth_element(list.begin(), list.begin() + NEIGHBOURS, list.end(), BySimilarity());
+        list.resize(NEIGHBOURS);
+    }
+    std::sort(list.begin(), list.end(), BySimilarity());
+    list.shrink_to_fit();
+}
+
+void Recommender::refresh(std::vector<TrackId>& dirty) {
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    std::vector<TrackId> affected(dirty);
+    for (auto id : dirty) {
+        for (const auto& entry : coCounts[id]) {
+            affected.push_back(entry.first);
+        }
+    }
+    std::sort(affected.begin(), affected.end());
+    affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+
+    for (auto id : affected) {
+        rebuildNeighbours(id);
+    }
+}
@@ -0,0 +1,372 @@
+#include "Resampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RESAMPLER_SSE2 1
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define RESAMPLER_AVX2 1
+#endif
+
+struct Resampler::FilterTable {
+    int phases;                       // fractional offsets per source frame
+    int taps;                         // per row, a multiple of 8
+    std::vector<float> coefficients;  // row r: offset r / phases (arbitrary mode has phases + 1 rows)
+};
+
+namespace {
+    // Taps at full bandwidth; a lower cutoff stretches the filter by as much.
+    // With the Kaiser window below that is a ~0.09 * Nyquist transition band
+    // centred on the cutoff and ~85 dB of stopband attenuation
+    const int BASE_TAPS = 128;
+    const double CUTOFF = 0.95;       // of the lower Nyquist frequency
+    const double KAISER_BETA = 8.6;
+
+    // Source frames read per refill
+    const size_t CHUNK = 4096;
+
+    const double PI = 3.14159265358979323846;
+
+    // Zeroth order modified Bessel function of the first kind
+    double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 50; ++k) {
+            term *= (x / (2 * k)) * (x / (2 * k));
+            sum += term;
+            if (term < sum * 1e-12) break;
+        }
+        return sum;
+    }
+
+    std::shared_ptr<const Resampler::FilterTable> buildTable(int phases, int rows, double bandwidth) {
+        std::shared_ptr<Resampler::FilterTable> table = std::make_shared<Resampler::FilterTable>();
+        int taps = (int)std::ceil(BASE_TAPS / bandwidth);
+        taps = (taps + 7) / 8 * 8;
+        table->phases = phases;
+        table->taps = taps;
+        table->coefficients.resize((size_t)rows * taps);
+
+        double cutoff = CUTOFF * bandwidth;   // relative to the source's Nyquist frequency
+        double half = taps / 2.0;
+        double windowScale = 1.0 / besselI0(KAISER_BETA);
+        for (int r = 0; r < rows; ++r) {
+            double offset = (double)r / phases;
+            float* row = &table->coefficients[(size_t)r * taps];
+            double sum = 0.0;
+            std::vector<double> h(taps);
+            for (int k = 0; k < taps; ++k) {
+                double d = (k - (half - 1)) - offset;    // distance from the output instant
+                double x = PI * cutoff * d;
+                double sinc = std::fabs(x) < 1e-12 ? 1.0 : std::sin(x) / x;
+                double w = d / half;
+                double window = std::fabs(w) >= 1.0 ? 0.0 : besselI0(KAISER_BETA * std::sqrt(1.0 - w * w)) * windowScale;
+                h[k] = sinc * window;
+                sum += h[k];
+            }
+            // Unity gain at DC for every phase, so no phase adds its own ripple
+            for (int k = 0; k < taps; ++k) row[k] = (float)(h[k] / sum);
+        }
+        return table;
+    }
+
+    // Tables are shared between all resamplers with the same parameters
+    std::shared_ptr<const Resampler::FilterTable> getTable(int phases, int rows, double bandwidth) {
+        static std::mutex mutex;
+        static std::map<std::tuple<int, int, long>, std::shared_ptr<const Resampler::FilterTable>> tables;
+
+        std::tuple<int, int, long> key(phases, rows, std::lround(bandwidth * 1e6));
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<const Resampler::FilterTable>& table = tables[key];
+        if (!table) table = buildTable(phases, rows, bandwidth);
+        return table;
+    }
+
+#ifdef RESAMPLER_SSE2
+    float dotSse2(const float* x, const float* h, int n) {
+        __m128 a = _mm_setzero_ps();
+        __m128 b = _mm_setzero_ps();
+        for (int i = 0; i < n; i += 8) {
+            a = _mm_add_ps(a, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(h + i)));
+            b = _mm_add_ps(b, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(h + i + 4)));
+        }
+        a = _mm_add_ps(a, b);
+        a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+        a = _mm_add_ss(a, _mm_shuffle_ps(a, a, 1));
+        return _mm_cvtss_f32(a);
+    }
+#else
+    float dotPlain(const float* x, const float* h, int n) {
+        float sum = 0.0f;
+        for (int i = 0; i < n; ++i) sum += x[i] * h[i];
+        return sum;
+    }
+#endif
+
+#ifdef RESAMPLER_AVX2
+    __attribute__((target("avx2,fma")))
+    float dotAvx2(const float* x, const float* h, int n) {
+        __m256 a = _mm256_setzero_ps();
+        __m256 b = _mm256_setzero_ps();
+        int i = 0;
+        for (; i + 16 <= n; i += 16) {
+            a = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(h + i), a);
+            b = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(h + i + 8), b);
+        }
+        if (i < n) a = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(h + i), a);
+        a = _mm256_add_ps(a, b);
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        return _mm_cvtss_f32(s);
+    }
+#endif
+
+    typedef float (*DotFunction)(const float*, const float*, int);
+
+    DotFunction chooseDot() {
+#ifdef RESAMPLER_AVX2
+        __builtin_cpu_init();   // runs during static initialisation
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return dotAvx2;
+#endif
+#ifdef RESAMPLER_SSE2
+        return dotSse2;
+#else
+        return dotPlain;
+#endif
+    }
+
+    // Taps are a multiple of 8, which every version relies on
+    const DotFunction dot = chooseDot();
+}
+
+Resampler::Resampler(std::unique_ptr<AudioSource> wrapped, int rate)
+    : source(std::move(wrapped)), sourceRate(source->getFormat().sampleRate),
+      outputRate(rate > 0 ? rate : sourceRate), channels(source->getFormat().channels),
+      speed(1.0), mode(PASS_THROUGH), up(1), step(1), increment(1.0),
+      inIndex(0), phase(0), fraction(0.0), position(0),
+      capacity(0), bufferStart(0), bufferFrames(0), sourceFrames((int64_t)source->getLength()), sourceEnded(false) {
+    configure();
+    if (mode != PASS_THROUGH) moveTo(0);
+}
+
+void Resampler::configure() {
+    if (speed == 1.0 && sourceRate == outputRate) {
+        mode = PASS_THROUGH;
+        table.reset();
+        return;
+    }
+
+    increment = sourceRate * speed / outputRate;
+    // Downsampling: keep the band below the output's Nyquist frequency
+    double bandwidth = std::min(1.0, 1.0 / increment);
+
+    uint64_t divisor = std::gcd((uint64_t)outputRate, (uint64_t)sourceRate);
+    if (speed == 1.0 && outputRate / divisor <= (uint64_t)MAX_RATIONAL_PHASES) {
+        mode = RATIONAL;
+        up = outputRate / divisor;
+        step = sourceRate / divisor;
+        table = getTable((int)up, (int)up, bandwidth);
+    } else {
+        mode = ARBITRARY;
+        // Speeds are continuous; round the bandwidth down to 1/64 so tables can be shared
+        bandwidth = std::max(1.0, std::floor(bandwidth * 64)) / 64;
+        table = getTable(ARBITRARY_PHASES, ARBITRARY_PHASES + 1, bandwidth);
+    }
+
+    size_t needed = table->taps + CHUNK;
+    if (capacity < needed) {
+        capacity = needed;
+        planes.assign(capacity * channels, 0.0f);
+        interleaved.assign(CHUNK * channels, 0.0f);
+    }
+}
+
+double Resampler::sourceTime() const {
+    switch (mode) {
+    case RATIONAL:  return inIndex + (double)phase / up;
+    case ARBITRARY: return inIndex + fraction;
+    default:        return (double)inIndex;
+    }
+}
+
+void Resampler::moveTo(int64_t index) {
+    inIndex = index;
+    sourceFrames = (int64_t)source->getLength();
+    sourceEnded = false;
+    bufferStart = index - (table->taps / 2 - 1);
+    bufferFrames = 0;
+    source->seek((uint64_t)std::max<int64_t>(0, bufferStart));
+}
+
+void Resampler::fill(int64_t first, int64_t end) {
+    // Drop what the filter has moved past
+    if (first > bufferStart) {
+        size_t drop = (size_t)std::min<int64_t>(first - bufferStart, bufferFrames);
+        size_t keep = bufferFrames - drop;
+        for (int c = 0; c < channels; ++c) {
+            float* plane = &planes[c * capacity];
+            std::memmove(plane, plane + drop, keep * sizeof(float));
+        }
+        bufferStart += drop;
+        bufferFrames = keep;
+        if (bufferStart < first) {
+            // Stepped past the whole buffer (very fast varispeed)
+            bufferStart = first;
+            if (first >= 0 && !sourceEnded) source->seek((uint64_t)first);
+        }
+    }
+
+    while (bufferStart + (int64_t)bufferFrames < end) {
+        int64_t at = bufferStart + bufferFrames;
+        size_t room = std::min(capacity - bufferFrames, CHUNK);
+        size_t count;
+        if (at < 0 || sourceEnded) {
+            // Silence before the start and after the end
+            count = at < 0 ? (size_t)std::min<int64_t>(room, -at) : room;
+            for (int c = 0; c < channels; ++c) {
+                std::fill_n(&planes[c * capacity + bufferFrames], count, 0.0f);
+            }
+        } else {
+            count = source->read(interleaved.data(), room);
+            if (count == 0) {
+                sourceEnded = true;
+                sourceFrames = std::min(sourceFrames, at);
+                continue;
+            }
+            for (int c = 0; c < channels; ++c) {
+                float* plane = &planes[c * capacity + bufferFrames];
+                for (size_t i = 0; i < count; ++i) plane[i] = interleaved[i * channels + c];
+            }
+        }
+        bufferFrames += count;
+    }
+}
+
+size_t Resampler::read(float* out, size_t frames) {
+    if (mode == PASS_THROUGH) {
+        size_t count = source->read(out, frames);
+        inIndex += count;
+        position += count;
+        return count;
+    }
+
+    const int taps = table->taps;
+    const int reach = taps / 2 - 1;   // taps before the output instant
+    const float* coefficients = table->coefficients.data();
+    size_t count = 0;
+    while (count < frames && inIndex < sourceFrames) {
+        int64_t first = inIndex - reach;
+        if (first + taps > bufferStart + (int64_t)bufferFrames) {
+            fill(first, first + taps);
+            if (inIndex >= sourceFrames) break;   // the source ended early
+        }
+        size_t offset = (size_t)(first - bufferStart);
+        float* frame = out + count * channels;
+
+        if (mode == RATIONAL) {
+            const float* h = coefficients + phase * taps;
+            for (int c = 0; c < channels; ++c) {
+                frame[c] = dot(&planes[c * capacity + offset], h, taps);
+            }
+            phase += step;
+            inIndex += (int64_t)(phase / up);
+            phase %= up;
+        } else {
+            double at = fraction * ARBITRARY_PHASES;
+            int row = (int)at;
+            float blend = (float)(at - row);
+            const float* h0 = coefficients + (size_t)row * taps;
+            const float* h1 = h0 + taps;
+            for (int c = 0; c < channels; ++c) {
+                const float* x = &planes[c * capacity + offset];
+                float y0 = dot(x, h0, taps);
+                float y1 = dot(x, h1, taps);
+                frame[c] = y0 + blend * (y1 - y0);
+            }
+            fraction += increment;
+            double whole = std::floor(fraction);
+            inIndex += (int64_t)whole;
+            fraction -= whole;
+        }
+        ++count;
+    }
+    position += count;
+    return count;
+}
+
+uint64_t Resampler::getLength() const {
+    if (mode == PASS_THROUGH) {
+        // position may differ from inIndex after a varispeed spell
+        uint64_t total = source->getLength();
+        return position + (total - std::min<uint64_t>((uint64_t)inIndex, total));
+    }
+    if (inIndex >= sourceFrames) return position;
+
+    uint64_t left;
+    if (mode == RATIONAL) {
+        // Output frames whose time (inIndex + phase / up) is still inside the source
+        uint64_t span = (uint64_t)(sourceFrames - inIndex) * up - phase;
+        left = (span + step - 1) / step;
+    } else {
+        left = (uint64_t)std::ceil((sourceFrames - inIndex - fraction) / increment);
+    }
+    return position + left;
+}
+
+bool Resampler::seek(uint64_t frame) {
+    if (mode == PASS_THROUGH) {
+        bool moved = source->seek(frame);
+        inIndex = (int64_t)std::min<uint64_t>(frame, source->getLength());
+        position = (uint64_t)inIndex;
+        return moved;
+    }
+
+    // Measured from the start at the current speed
+    sourceFrames = (int64_t)source->getLength();
+    if (mode == RATIONAL) {
+        uint64_t length = ((uint64_t)sourceFrames * up + step - 1) / step;
+        position = std::min(frame, length);
+        uint64_t time = position * step;
+        phase = time % up;
+        moveTo((int64_t)(time / up));
+    } else {
+        uint64_t length = (uint64_t)std::ceil(sourceFrames / increment);
+        position = std::min(frame, length);
+        double time = position * increment;
+        double whole = std::floor(time);
+        fraction = time - whole;
+        moveTo((int64_t)whole);
+    }
+    return true;
+}
+
+void Resampler::setSpeed(double newSpeed) {
+    newSpeed = std::min(std::max(newSpeed, 0.5), 2.0);
+    if (newSpeed == speed) return;
+
+    double time = sourceTime();
+    speed = newSpeed;
+    configure();
+
+    double whole = std::floor(time);
+    if (mode == PASS_THROUGH) {
+        inIndex = (int64_t)std::llround(time);
+        source->seek((uint64_t)inIndex);
+    } else if (mode == RATIONAL) {
+        uint64_t next = (uint64_t)std::llround((time - whole) * up);
+        phase = next % up;
+        moveTo((int64_t)whole + (int64_t)(next / up));
+    } else {
+        fraction = time - whole;
+        moveTo((int64_t)whole);
+    }
+}
@@ -0,0 +1,338 @@
+#include "ResponseCache.hpp"
+#include "SystemManager.hpp"
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <chrono>
+#include <cstdio>
+#include <atomic>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char* const DISK_MAGIC = "MPCACHE1";
+
+    // FNV-1a, used only to turn a request key into a file name
+    uint64_t hashKey(const std::string& key) {
+        uint64_t hash = 1469598103934665603ULL;
+        for (unsigned char c : key) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // Temp files are unique per write, so concurrent stores of one key
+    // (a revalidation racing a foreground fetch) never share one
+    std::string tempSuffix() {
+        static const uint64_t processNonce = std::random_device{}();
+        static std::atomic<uint64_t> counter(0);
+        char suffix[48];
+        std::snprintf(suffix, sizeof(suffix), ".%08llx-%llu.tmp", (unsigned long long)processNonce,
+                      (unsigned long long)++counter);
+        return suffix;
+    }
+
+    // A temp file this old belongs to a write that never finished
+    const auto ABANDONED_TEMP_AGE = std::chrono::minutes(10);
+}
+
+ResponseCache::ResponseCache(size_t maxMemoryBytes, const std::string& dir, size_t maxDisk)
+    : defaultPolicy{300, 3600}, maxBytes(maxMemoryBytes), usedBytes(0), directory(dir), stats{},
+      maxDiskBytes(maxDisk), diskBytes(0) {
+    if (!directory.empty()) {
+        try {
+            fs::create_directories(directory);
+        } catch (const std::exception& e) {
+            SystemManager::logWarning("Response cache disk tier disabled: " + std::string(e.what()));
+            directory.clear();
+        }
+    }
+    if (!directory.empty()) {
+        std::lock_guard<std::mutex> lock(diskMutex);
+        trimDiskLocked();
+    }
+}
+
+void ResponseCache::setPolicy(const std::string& method, int ttlSeconds, int staleSeconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    policies[method] = Policy{ttlSeconds, staleSeconds};
+}
+
+void ResponseCache::setDefaultPolicy(int ttlSeconds, int staleSeconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    defaultPolicy = Policy{ttlSeconds, staleSeconds};
+}
+
+ResponseCache::Policy ResponseCache::getPolicy(const std::string& method) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = policies.find(method);
+    return it != policies.end() ? it->second : defaultPolicy;
+}
+
+ResponseCache::Freshness ResponseCache::classify(int64_t storedAt, const Policy& policy) {
+    int64_t age = now() - storedAt;
+    if (age < 0) age = 0; // clock went backwards; trust the entry
+    if (age <= policy.ttlSeconds) return FRESH;
+    if (age <= (int64_t)policy.ttlSeconds + policy.staleSeconds) return STALE;
+    return MISS;
+}
+
+ResponseCache::Lookup ResponseCache::get(const std::string& method, const std::string& key) {
+    Policy policy = getPolicy(method);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            Freshness freshness = classify(it->second->storedAt, policy);
+            if (freshness != MISS) {
+                lru.splice(lru.begin(), lru, it->second);
+                stats.memoryHits++;
+                if (freshness == STALE) stats.staleHits++;
+                return Lookup{freshness, it->second->body};
+            }
+            // Past the stale window: drop it and fall through to disk/miss
+            usedBytes -= it->second->key.size() + it->second->body.size();
+            lru.erase(it->second);
+            index.erase(it);
+        }
+    }
+
+    std::string body;
+    int64_t storedAt = 0;
+    if (readFromDisk(key, body, storedAt)) {
+        Freshness freshness = classify(storedAt, policy);
+        if (freshness != MISS) {
+            std::lock_guard<std::mutex> lock(mutex);
+            insertLocked(key, body, storedAt);
+            stats.diskHits++;
+            if (freshness == STALE) stats.staleHits++;
+            return Lookup{freshness, body};
+        }
+        removeFromDisk(key);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.misses++;
+    return Lookup{MISS, ""};
+}
+
+ResponseCache::Freshness ResponseCache::peek(const std::string& method, const std::string& key) const {
+    Policy policy = getPolicy(method);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) return classify(it->second->storedAt, policy);
+    }
+
+    std::string body;
+    int64_t storedAt = 0;
+    if (readFromDisk(key, body, storedAt)) return classify(storedAt, policy);
+    return MISS;
+}
+
+void ResponseCache::put(const std::string& key, const std::string& body) {
+    int64_t storedAt = now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        insertLocked(key, body, storedAt);
+    }
+    writeToDisk(key, body, storedAt);
+}
+
+void ResponseCache::insertLocked(const std::string& key, const std::string& body, int64_t storedAt) {
+    auto it = index.find(key);
+    if (it != index.end()) {
+        usedBytes -= it->second->key.size() + it->second->body.size();
+        lru.erase(it->second);
+        index.erase(it);
+    }
+
+    size_t size = key.size() + body.size();
+    if (size > maxBytes) return; // too large for memory; disk tier still has it
+
+    lru.push_front(Entry{key, body, storedAt});
+    index[key] = lru.begin();
+    usedBytes += size;
+    evictLocked();
+}
+
+void ResponseCache::evictLocked() {
+    while (usedBytes > maxBytes && !lru.empty()) {
+        Entry& victim = lru.back();
+        usedBytes -= victim.key.size() + victim.body.size();
+        index.erase(victim.key);
+        lru.pop_back();
+    }
+}
+
+void ResponseCache::clear() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        lru.clear();
+        index.clear();
+        usedBytes = 0;
+    }
+
+    if (directory.empty()) return;
+    std::lock_guard<std::mutex> lock(diskMutex);
+    try {
+        for (const auto& entry : fs::directory_iterator(directory)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".cache") {
+                fs::remove(entry.path());
+            }
+        }
+        diskBytes = 0;
+    } catch (const std::exception& e) {
+        SystemManager::logError("Failed to clear response cache: " + std::string(e.what()));
+    }
+}
+
+void ResponseCache::setMaxMemoryBytes(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxBytes = bytes;
+    evictLocked();
+}
+
+void ResponseCache::setMaxDiskBytes(size_t bytes) {
+    std::lock_guard<std::mutex> lock(diskMutex);
+    maxDiskBytes = bytes;
+    if (!directory.empty() && diskBytes > maxDiskBytes) trimDiskLocked();
+}
+
+ResponseCache::Stats ResponseCache::getStats() const {
+    Stats copy;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        copy = stats;
+        copy.entries = lru.size();
+        copy.bytes = usedBytes;
+    }
+    std::lock_guard<std::mutex> lock(diskMutex);
+    copy.diskBytes = diskBytes;
+    return copy;
+}
+
+std::string ResponseCache::pathFor(const std::string& key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.cache", (unsigned long long)hashKey(key));
+    return (fs::path(directory) / name).string();
+}
+
+bool ResponseCache::readFromDisk(const std::string& key, std::string& body, int64_t& storedAt) const {
+    if (directory.empty()) return false;
+
+    std::ifstream file(pathFor(key), std::ios::binary);
+    if (!file.is_open()) return false;
+
+    std::string magic, storedKey, timestamp;
+    if (!std::getline(file, magic) || magic != DISK_MAGIC) return false;
+    if (!std::getline(file, timestamp) || !std::getline(file, storedKey)) return false;
+    if (storedKey != key) return false; // hash collision
+
+    try {
+        storedAt = std::stoll(timestamp);
+    } catch (...) {
+        return false;
+    }
+
+    std::ostringstream content;
+    content << file.rdbuf();
+    body = content.str();
+    return true;
+}
+
+void ResponseCache::writeToDisk(const std::string& key, const std::string& body, int64_t storedAt) {
+    if (directory.empty()) return;
+
+    // Write to a temp file and rename so readers never see a torn entry
+    std::string path = pathFor(key);
+    std::string tempPath = path + tempSuffix();
+    try {
+        size_t written;
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return;
+            file << DISK_MAGIC << "\n" << storedAt << "\n" << key << "\n" << body;
+            written = (size_t)file.tellp();
+            if (!file) throw SystemException("write failed");
+        }
+
+        std::error_code ec;
+        uintmax_t replaced = fs::file_size(path, ec);
+        if (ec) replaced = 0;
+        fs::rename(tempPath, path);
+
+        std::lock_guard<std::mutex> lock(diskMutex);
+        diskBytes = diskBytes + written - std::min<size_t>((size_t)replaced, diskBytes + written);
+        if (diskBytes > maxDiskBytes) trimDiskLocked();
+    } catch (const std::exception& e) {
+        SystemManager::logWarning("Failed to persist cache entry: " + std::string(e.what()));
+        std::error_code ec;
+        fs::remove(tempPath, ec);
+    }
+}
+
+void ResponseCache::removeFromDisk(const std::string& key) {
+    if (directory.empty()) return;
+    std::string path = pathFor(key);
+    std::error_code ec;
+    uintmax_t size = fs::file_size(path, ec);
+    if (!ec && fs::remove(path, ec)) {
+        std::lock_guard<std::mutex> lock(diskMutex);
+        diskBytes -= std::min<size_t>((size_t)size, diskBytes);
+    }
+}
+
+void ResponseCache::trimDiskLocked() {
+    struct File {
+        fs::path path;
+        fs::file_time_type written;
+        uintmax_t size;
+    };
+    std::vector<File> files;
+    uintmax_t total = 0;
+
+    try {
+        auto abandoned = fs::file_time_type::clock::now() - ABANDONED_TEMP_AGE;
+        for (const auto& entry : fs::directory_iterator(directory)) {
+            std::error_code ec;
+            if (!entry.is_regular_file(ec)) continue;
+            fs::file_time_type written = entry.last_write_time(ec);
+            if (ec) continue;
+            std::string extension = entry.path().extension().string();
+            if (extension == ".tmp") {
+                if (written < abandoned) fs::remove(entry.path(), ec);
+            } else if (extension == ".cache") {
+                uintmax_t size = entry.file_size(ec);
+                if (ec) continue;
+                files.push_back(File{entry.path(), written, size});
+                total += size;
+            }
+        }
+    } catch (const std::exception& e) {
+        SystemManager::logWarning("Failed to scan response cache: " + std::string(e.what()));
+        return;
+    }
+
+    if (total > maxDiskBytes) {
+        // Oldest first, down to 3/4 of the cap so the next few writes do not rescan
+        std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.written < b.written; });
+        uintmax_t target = maxDiskBytes / 4 * 3;
+        for (const File& file : files) {
+            if (total <= target) break;
+            std::error_code ec;
+            if (fs::remove(file.path, ec)) total -= file.size;
+        }
+    }
+    diskBytes = (size_t)total;
+}
+
+int64_t ResponseCache::now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
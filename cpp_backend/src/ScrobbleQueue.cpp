@@ -0,0 +1,317 @@
+#include "ScrobbleQueue.hpp"
+#include "LastFMManager.hpp"
+#include "SystemManager.hpp"
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <cstring>
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const int MIN_RETRY_SECONDS = 30;
+    const int MAX_RETRY_SECONDS = 15 * 60;
+    const int FLUSH_INTERVAL_SECONDS = 5 * 60; // submit a partial batch at least this often
+
+    // Copy into a fixed field, replacing the journal's separators
+    void copyField(char* dest, const std::string& src, size_t size) {
+        size_t length = std::min(src.size(), size - 1);
+        for (size_t i = 0; i < length; ++i) {
+            char c = src[i];
+            dest[i] = (c == '\t' || c == '\n' || c == '\r') ? ' ' : c;
+        }
+        dest[length] = '\0';
+    }
+
+    // Journal line: timestamp \t duration \t artist \t track
+    bool parseLine(const std::string& line, Scrobble& out) {
+        size_t a = line.find('\t');
+        size_t b = a == std::string::npos ? a : line.find('\t', a + 1);
+        size_t c = b == std::string::npos ? b : line.find('\t', b + 1);
+        if (c == std::string::npos) return false;
+
+        try {
+            out.timestamp = std::stoll(line.substr(0, a));
+            out.duration = std::stoi(line.substr(a + 1, b - a - 1));
+        } catch (...) {
+            return false;
+        }
+        out.artist = line.substr(b + 1, c - b - 1);
+        out.track = line.substr(c + 1);
+        return !out.artist.empty() && !out.track.empty();
+    }
+}
+
+ScrobbleQueue& ScrobbleQueue::instance() {
+    static ScrobbleQueue queue;
+    return queue;
+}
+
+ScrobbleQueue::ScrobbleQueue()
+    : enqueuePos(0), dequeuePos(0), running(false), flushRequested(false), retryDelaySeconds(0),
+      enqueuedCount(0), droppedCount(0), journaledCount(0), submittedCount(0),
+      batchesSent(0), batchesFailed(0), rejectedCount(0), pendingCount(0) {
+    for (size_t i = 0; i < RING_CAPACITY; ++i) {
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+ScrobbleQueue::~ScrobbleQueue() {
+    // Normally stopped by MusicPlayer; never join from a static destructor
+    if (worker.joinable()) worker.detach();
+}
+
+void ScrobbleQueue::start(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) return;
+
+    try {
+        fs::create_directories(directory);
+    } catch (const std::exception& e) {
+        SystemManager::logError("Scrobbling disabled, cannot create journal directory: " + std::string(e.what()));
+        return;
+    }
+
+    journalPath = (fs::path(directory) / "scrobbles.journal").string();
+    cursorPath = (fs::path(directory) / "scrobbles.cursor").string();
+    rejectedPath = (fs::path(directory) / "scrobbles.rejected").string();
+    recountPending();
+
+    running = true;
+    retryDelaySeconds = 0;
+    nextAttempt = std::chrono::steady_clock::now();
+    lastSubmit = std::chrono::steady_clock::time_point();  // submit any backlog right away
+    worker = std::thread(&ScrobbleQueue::run, this);
+}
+
+void ScrobbleQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return;
+        running = false;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+bool ScrobbleQueue::enqueue(const std::string& artist, const std::string& track, int64_t startedAt, int duration) {
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+        cell = &ring[pos & (RING_CAPACITY - 1)];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            droppedCount++; // ring full: the writer thread is stalled
+            return false;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    copyField(cell->entry.artist, artist, FIELD_SIZE);
+    copyField(cell->entry.track, track, FIELD_SIZE);
+    cell->entry.timestamp = startedAt;
+    cell->entry.duration = duration;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+
+    enqueuedCount++;
+    wake.notify_one();
+    return true;
+}
+
+bool ScrobbleQueue::tryPop(Entry& out) {
+    Cell& cell = ring[dequeuePos & (RING_CAPACITY - 1)];
+    size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if ((intptr_t)sequence - (intptr_t)(dequeuePos + 1) < 0) return false;
+
+    out = cell.entry;
+    cell.sequence.store(dequeuePos + RING_CAPACITY, std::memory_order_release);
+    dequeuePos++;
+    return true;
+}
+
+void ScrobbleQueue::flush() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        flushRequested = true;
+    }
+    wake.notify_all();
+}
+
+ScrobbleQueue::Stats ScrobbleQueue::getStats() const {
+    return Stats{enqueuedCount.load(), droppedCount.load(), journaledCount.load(), submittedCount.load(),
+                 batchesSent.load(), batchesFailed.load(), rejectedCount.load(), pendingCount.load()};
+}
+
+void ScrobbleQueue::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        wake.wait_for(lock, std::chrono::seconds(1));
+        bool forced = flushRequested;
+        flushRequested = false;
+        lock.unlock();
+
+        drainToJournal();
+
+        auto now = std::chrono::steady_clock::now();
+        bool due = pendingCount.load() >= (uint64_t)BATCH_SIZE ||
+                   now - lastSubmit >= std::chrono::seconds(FLUSH_INTERVAL_SECONDS);
+        // Without a session nothing could be accepted: keep the journal as is (not a failure)
+        bool ready = pendingCount.load() > 0 && LastFMManager::hasSession();
+        if (ready && (forced || (due && now >= nextAttempt))) {
+            lastSubmit = now;
+            if (submitPending()) {
+                retryDelaySeconds = 0;
+            } else {
+                // Offline, throttled or signed out: keep everything and try again later
+                retryDelaySeconds = std::min(MAX_RETRY_SECONDS, std::max(MIN_RETRY_SECONDS, retryDelaySeconds * 2));
+                nextAttempt = now + std::chrono::seconds(retryDelaySeconds);
+                SystemManager::logWarning("Scrobble submission failed, retrying in " +
+                                          std::to_string(retryDelaySeconds) + "s");
+            }
+        }
+
+        lock.lock();
+    }
+    lock.unlock();
+
+    drainToJournal();
+}
+
+void ScrobbleQueue::drainToJournal() {
+    Entry entry;
+    if (!tryPop(entry)) return;
+
+    std::ofstream journal(journalPath, std::ios::binary | std::ios::app);
+    if (!journal.is_open()) {
+        SystemManager::logError("Failed to open scrobble journal: " + journalPath);
+        droppedCount++;
+        return;
+    }
+
+    do {
+        journal << entry.timestamp << '\t' << entry.duration << '\t'
+                << entry.artist << '\t' << entry.track << '\n';
+        journaledCount++;
+        pendingCount++;
+    } while (tryPop(entry));
+
+    journal.flush();
+}
+
+bool ScrobbleQueue::submitPending() {
+    uint64_t cursor = readCursor();
+
+    {
+        std::ifstream journal(journalPath, std::ios::binary);
+        if (!journal.is_open()) return true;
+        journal.seekg((std::streamoff)cursor);
+
+        std::string line;
+        while (true) {
+            std::vector<Scrobble> batch;
+            std::string lines;
+            uint64_t consumed = 0;
+            Scrobble scrobble;
+
+            while ((int)batch.size() < BATCH_SIZE && std::getline(journal, line)) {
+                if (journal.eof()) break; // torn last line without '\n'; leave it for later
+                consumed += line.size() + 1;
+                if (parseLine(line, scrobble)) {
+                    batch.push_back(scrobble);
+                    lines += line + '\n';
+                }
+            }
+
+            if (consumed == 0) break;
+
+            if (!batch.empty()) {
+                LastFMManager::SubmitResult result = LastFMManager::submitScrobbles(batch);
+                if (result == LastFMManager::SUBMIT_FAILED) {
+                    batchesFailed++;
+                    return false;
+                }
+                if (result == LastFMManager::SUBMIT_REJECTED) {
+                    // Resending would fail the same way forever and block every later play
+                    std::ofstream rejected(rejectedPath, std::ios::binary | std::ios::app);
+                    rejected << lines;
+                    rejected.flush();
+                    if (!rejected) {
+                        SystemManager::logError("Failed to write rejected scrobbles: " + rejectedPath);
+                        batchesFailed++;
+                        return false;
+                    }
+                    SystemManager::logError("Last.fm rejected " + std::to_string(batch.size()) +
+                                            " scrobbles, moved to " + rejectedPath);
+                    rejectedCount += batch.size();
+                } else {
+                    batchesSent++;
+                    submittedCount += batch.size();
+                }
+            }
+
+            cursor += consumed;
+            writeCursor(cursor);
+            uint64_t pending = pendingCount.load();
+            pendingCount = pending > batch.size() ? pending - batch.size() : 0;
+        }
+    }
+
+    // Everything submitted: compact the journal
+    std::error_code ec;
+    if (cursor > 0 && cursor >= (uint64_t)fs::file_size(journalPath, ec) && !ec) {
+        std::ofstream truncate(journalPath, std::ios::binary | std::ios::trunc);
+        writeCursor(0);
+        pendingCount = 0;
+    }
+    return true;
+}
+
+uint64_t ScrobbleQueue::readCursor() const {
+    uint64_t offset = 0;
+    {
+        std::ifstream file(cursorPath);
+        if (file.is_open()) file >> offset;
+    }
+    if (offset == 0) return 0;
+
+    // Seeking past the end would read nothing, compact away new plays and
+    // later start parsing mid-line once the journal grew past the cursor
+    std::error_code ec;
+    uint64_t size = (uint64_t)fs::file_size(journalPath, ec);
+    if (ec) size = 0;
+    if (offset > size) {
+        SystemManager::logWarning("Scrobble cursor is past the end of the journal, starting from its beginning");
+        writeCursor(0);
+        return 0;
+    }
+    return offset;
+}
+
+void ScrobbleQueue::writeCursor(uint64_t offset) const {
+    std::string tempPath = cursorPath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (!file.is_open()) return;
+        file << offset << '\n';
+    }
+    std::error_code ec;
+    fs::rename(tempPath, cursorPath, ec);
+}
+
+void ScrobbleQueue::recountPending() {
+    uint64_t count = 0;
+    std::ifstream journal(journalPath, std::ios::binary);
+    if (journal.is_open()) {
+        journal.seekg((std::streamoff)readCursor());
+        std::string line;
+        while (std::getline(journal, line) && !journal.eof()) {
+            count++;
+        }
+    }
+    pendingCount = count;
+}
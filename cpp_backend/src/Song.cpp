@@ -1,20 +1,26 @@
 #include "Song.hpp"
+#include "Catalog.hpp"
 
-Song::Song(std::string title, std::string artist, int duration)
+Song::Song(std::string title, std::string artist, int duration, std::string filePath)
 {
     this->title = title;
     this->artist = artist;
+    this->foldedTitle = Catalog::fold(title);
+    this->foldedArtist = Catalog::fold(artist);
     this->duration = duration;
+    this->filePath = filePath;
 }
 
 void Song::setTitle(std::string title)
 {
     this->title = title;
+    this->foldedTitle = Catalog::fold(title);
 }
 
 void Song::setArtist(std::string artist)
 {
     this->artist = artist;
+    this->foldedArtist = Catalog::fold(artist);
 }
 
 void Song::setDuration(int duration)
@@ -22,6 +28,11 @@ void Song::setDuration(int duration)
     this->duration = duration;
 }
 
+void Song::setFilePath(std::string filePath)
+{
+    this->filePath = filePath;
+}
+
 std::string Song::getTitle()
 {
     return title;
@@ -37,6 +48,21 @@ int Song::getDuration()
     return duration;
 }
 
+const std::string& Song::getFilePath()
+{
+    return filePath;
+}
+
+const std::string& Song::getFoldedTitle()
+{
+    return foldedTitle;
+}
+
+const std::string& Song::getFoldedArtist()
+{
+    return foldedArtist;
+}
+
 std::string Song::toString()
 {
     std::ostringstream info;
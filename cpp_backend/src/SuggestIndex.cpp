@@ -0,0 +1,189 @@
+#include "SuggestIndex.hpp"
+#include "TextFold.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+    bool isWordByte(unsigned char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+    }
+}
+
+SuggestIndex::SuggestIndex(const std::vector<Entry>& source) {
+    char buffer[MAX_KEY_LENGTH + 1];
+
+    // One entry per title + artist, keeping the most popular copy
+    std::unordered_map<std::string, uint32_t> seen;
+    for (const auto& entry : source) {
+        std::string identity(buffer, normalize(entry.title.c_str(), buffer));
+        identity += '\x1f';
+        identity.append(buffer, normalize(entry.artist.c_str(), buffer));
+
+        auto it = seen.find(identity);
+        if (it == seen.end()) {
+            seen[identity] = (uint32_t)entries.size();
+            entries.push_back(entry);
+        } else if (entry.popularity > entries[it->second].popularity) {
+            entries[it->second] = entry;
+        }
+    }
+
+    // Key every entry by "title artist" and by each later word onwards
+    std::vector<Key> keys;
+    for (uint32_t i = 0; i < entries.size(); ++i) {
+        std::string text = entries[i].title + " " + entries[i].artist;
+        for (size_t start = 0; start < text.size(); ) {
+            while (start < text.size() && !isWordByte((unsigned char)text[start])) ++start;
+            if (start >= text.size()) break;
+            size_t length = normalize(text.c_str() + start, buffer);
+            if (length > 0) keys.push_back(Key(std::string(buffer, length), i));
+            while (start < text.size() && isWordByte((unsigned char)text[start])) ++start;
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    nodes.push_back(Node{0, 0, 0, 0, 0, 0});
+    if (!keys.empty()) {
+        buildNode(0, keys, 0, keys.size(), 0);
+    }
+    nodes.shrink_to_fit();
+    tops.shrink_to_fit();
+}
+
+int SuggestIndex::suggest(const char* prefix, int k, uint32_t* out) const {
+    if (!prefix || !out || k <= 0 || entries.empty()) return 0;
+    if (k > MAX_K) k = MAX_K;
+
+    char query[MAX_KEY_LENGTH + 1];
+    size_t length = normalize(prefix, query);
+
+    // Keep a trailing separator: "blinding " should not match "blindingly"
+    size_t raw = 0;
+    while (prefix[raw]) ++raw;
+    if (length > 0 && length < MAX_KEY_LENGTH && raw > 0 && !isWordByte((unsigned char)prefix[raw - 1])) {
+        query[length++] = ' ';
+    }
+
+    uint32_t current = 0;
+    size_t pos = 0;
+    while (true) {
+        const Node& node = nodes[current];
+        for (uint32_t i = 0; i < node.labelLength && pos < length; ++i, ++pos) {
+            if (labels[node.labelStart + i] != query[pos]) return 0;
+        }
+        if (pos >= length) {
+            int count = std::min<int>(k, (int)node.topCount);
+            for (int i = 0; i < count; ++i) {
+                out[i] = tops[node.topStart + i];
+            }
+            return count;
+        }
+
+        // Children are sorted by their first label byte
+        uint32_t lo = node.firstChild, hi = node.firstChild + node.childCount;
+        char next = query[pos];
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) / 2;
+            if (labels[nodes[mid].labelStart] < next) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo == node.firstChild + node.childCount || labels[nodes[lo].labelStart] != next) return 0;
+        current = lo;
+    }
+}
+
+bool SuggestIndex::sameSong(const Entry& a, const Entry& b) {
+    char left[MAX_KEY_LENGTH + 1];
+    char right[MAX_KEY_LENGTH + 1];
+    size_t length = normalize(a.title.c_str(), left);
+    if (normalize(b.title.c_str(), right) != length || std::char_traits<char>::compare(left, right, length) != 0) {
+        return false;
+    }
+    length = normalize(a.artist.c_str(), left);
+    return normalize(b.artist.c_str(), right) == length && std::char_traits<char>::compare(left, right, length) == 0;
+}
+
+size_t SuggestIndex::normalize(const char* text, char* out) {
+    // Folding can shrink text (stripped accents, fullwidth letters), so
+    // fold a few times the key length, cut at a character boundary
+    const size_t window = MAX_KEY_LENGTH * 4;
+    size_t raw = 0;
+    while (raw < window && text[raw]) ++raw;
+    if (raw == window) {
+        while (raw > 0 && ((unsigned char)text[raw] & 0xC0) == 0x80) --raw;
+    }
+    char folded[window + 1];
+    folded[TextFold::fold(text, raw, folded, window, true)] = '\0';
+
+    size_t length = 0;
+    bool pendingSpace = false;
+    for (const char* p = folded; *p && length < MAX_KEY_LENGTH; ++p) {
+        unsigned char c = (unsigned char)*p;
+        if (!isWordByte(c)) {
+            pendingSpace = length > 0;
+            continue;
+        }
+        if (pendingSpace) {
+            out[length++] = ' ';
+            pendingSpace = false;
+            if (length >= MAX_KEY_LENGTH) break;
+        }
+        out[length++] = (char)c;
+    }
+    out[length] = '\0';
+    return length;
+}
+
+void SuggestIndex::buildNode(uint32_t index, const std::vector<Key>& keys, size_t lo, size_t hi, size_t depth) {
+    // Sorted range: the common prefix of the first and last key is shared by all
+    const std::string& first = keys[lo].first;
+    const std::string& last = keys[hi - 1].first;
+    size_t common = depth;
+    while (common < first.size() && common < last.size() && first[common] == last[common]) ++common;
+
+    nodes[index].labelStart = (uint32_t)labels.size();
+    nodes[index].labelLength = (uint32_t)(common - depth);
+    labels.append(first, depth, common - depth);
+
+    // Keys ending here sort before the longer ones
+    std::vector<uint32_t> candidates;
+    size_t split = lo;
+    while (split < hi && keys[split].first.size() == common) {
+        candidates.push_back(keys[split].second);
+        ++split;
+    }
+
+    // One child per distinct next byte
+    std::vector<std::pair<size_t, size_t>> groups;
+    for (size_t i = split; i < hi; ) {
+        size_t j = i + 1;
+        while (j < hi && keys[j].first[common] == keys[i].first[common]) ++j;
+        groups.push_back(std::make_pair(i, j));
+        i = j;
+    }
+
+    uint32_t firstChild = (uint32_t)nodes.size();
+    nodes[index].firstChild = firstChild;
+    nodes[index].childCount = (uint32_t)groups.size();
+    nodes.resize(nodes.size() + groups.size(), Node{0, 0, 0, 0, 0, 0});
+
+    for (size_t g = 0; g < groups.size(); ++g) {
+        buildNode(firstChild + (uint32_t)g, keys, groups[g].first, groups[g].second, common);
+        const Node& child = nodes[firstChild + g];
+        candidates.insert(candidates.end(), tops.begin() + child.topStart,
+                          tops.begin() + child.topStart + child.topCount);
+    }
+
+    // Top-k of the subtree = best of this node's own keys and the children's top-k
+    std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b) {
+        if (entries[a].popularity != entries[b].popularity) return entries[a].popularity > entries[b].popularity;
+        return a < b;
+    });
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    if (candidates.size() > (size_t)MAX_K) candidates.resize(MAX_K);
+
+    nodes[index].topStart = (uint32_t)tops.size();
+    nodes[index].topCount = (uint32_t)candidates.size();
+    tops.insert(tops.end(), candidates.begin(), candidates.end());
+}
@@ -0,0 +1,638 @@
+#include "TextFold.hpp"
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <cstdint>
+
+namespace {
+    // Single code points whose folded form is one code point: first..last
+    // (every stride-th code point) maps to code point + delta
+    struct FoldRun {
+        uint16_t first;
+        uint16_t last;
+        uint8_t stride;
+        int32_t delta;
+    };
+
+    // Code points whose folded form is several code points (or none)
+    struct FoldExpansion {
+        uint16_t codePoint;
+        const char* folded;     // UTF-8
+    };
+
+    // Canonical pairs: composed = base + mark; composes is false for the
+    // composition exclusions (decomposed, never recomposed)
+    struct Decomposition {
+        uint16_t composed;
+        uint16_t base;
+        uint16_t mark;
+        bool composes;
+    };
+
+    // Generated from the Unicode 14.0 data (NFKC_Casefold, canonical
+    // decompositions of the folded Latin, Greek, Cyrillic and kana letters)
+    const FoldRun FOLD_RUNS[] = {
+        {0x00A0, 0x00A0, 1, -128}, {0x00AA, 0x00AA, 1, -73}, {0x00B2, 0x00B3, 1, -128}, {0x00B5, 0x00B5, 1, 775},
+        {0x00B9, 0x00B9, 1, -136}, {0x00BA, 0x00BA, 1, -75}, {0x00C0, 0x00D6, 1, 32}, {0x00D8, 0x00DE, 1, 32},
+        {0x0100, 0x012E, 2, 1}, {0x0134, 0x0136, 2, 1}, {0x0139, 0x013D, 2, 1}, {0x0141, 0x0147, 2, 1},
+        {0x014A, 0x0176, 2, 1}, {0x0178, 0x0178, 1, -121}, {0x0179, 0x017D, 2, 1}, {0x017F, 0x017F, 1, -268},
+        {0x0181, 0x0181, 1, 210}, {0x0182, 0x0184, 2, 1}, {0x0186, 0x0186, 1, 206}, {0x0187, 0x0187, 1, 1},
+        {0x0189, 0x018A, 1, 205}, {0x018B, 0x018B, 1, 1}, {0x018E, 0x018E, 1, 79}, {0x018F, 0x018F, 1, 202},
+        {0x0190, 0x0190, 1, 203}, {0x0191, 0x0191, 1, 1}, {0x0193, 0x0193, 1, 205}, {0x0194, 0x0194, 1, 207},
+        {0x0196, 0x0196, 1, 211}, {0x0197, 0x0197, 1, 209}, {0x0198, 0x0198, 1, 1}, {0x019C, 0x019C, 1, 211},
+        {0x019D, 0x019D, 1, 213}, {0x019F, 0x019F, 1, 214}, {0x01A0, 0x01A4, 2, 1}, {0x01A6, 0x01A6, 1, 218},
+        {0x01A7, 0x01A7, 1, 1}, {0x01A9, 0x01A9, 1, 218}, {0x01AC, 0x01AC, 1, 1}, {0x01AE, 0x01AE, 1, 218},
+        {0x01AF, 0x01AF, 1, 1}, {0x01B1, 0x01B2, 1, 217}, {0x01B3, 0x01B5, 2, 1}, {0x01B7, 0x01B7, 1, 219},
+        {0x01B8, 0x01B8, 1, 1}, {0x01BC, 0x01BC, 1, 1}, {0x01CD, 0x01DB, 2, 1}, {0x01DE, 0x01EE, 2, 1},
+        {0x01F4, 0x01F4, 1, 1}, {0x01F6, 0x01F6, 1, -97}, {0x01F7, 0x01F7, 1, -56}, {0x01F8, 0x021E, 2, 1},
+        {0x0220, 0x0220, 1, -130}, {0x0222, 0x0232, 2, 1}, {0x023A, 0x023A, 1, 10795}, {0x023B, 0x023B, 1, 1},
+        {0x023D, 0x023D, 1, -163}, {0x023E, 0x023E, 1, 10792}, {0x0241, 0x0241, 1, 1}, {0x0243, 0x0243, 1, -195},
+        {0x0244, 0x0244, 1, 69}, {0x0245, 0x0245, 1, 71}, {0x0246, 0x024E, 2, 1}, {0x02B0, 0x02B0, 1, -584},
+        {0x02B1, 0x02B1, 1, -75}, {0x02B2, 0x02B2, 1, -584}, {0x02B3, 0x02B3, 1, -577}, {0x02B4, 0x02B4, 1, -59},
+        {0x02B5, 0x02B5, 1, -58}, {0x02B6, 0x02B6, 1, -53}, {0x02B7, 0x02B7, 1, -576}, {0x02B8, 0x02B8, 1, -575},
+        {0x02E0, 0x02E0, 1, -125}, {0x02E1, 0x02E1, 1, -629}, {0x02E2, 0x02E2, 1, -623}, {0x02E3, 0x02E3, 1, -619},
+        {0x02E4, 0x02E4, 1, -79}, {0x0340, 0x0341, 1, -64}, {0x0343, 0x0343, 1, -48}, {0x0345, 0x0345, 1, 116},
+        {0x0370, 0x0372, 2, 1}, {0x0374, 0x0374, 1, -187}, {0x0376, 0x0376, 1, 1}, {0x037E, 0x037E, 1, -835},
+        {0x037F, 0x037F, 1, 116}, {0x0386, 0x0386, 1, 38}, {0x0387, 0x0387, 1, -720}, {0x0388, 0x038A, 1, 37},
+        {0x038C, 0x038C, 1, 64}, {0x038E, 0x038F, 1, 63}, {0x0391, 0x03A1, 1, 32}, {0x03A3, 0x03AB, 1, 32},
+        {0x03C2, 0x03C2, 1, 1}, {0x03CF, 0x03CF, 1, 8}, {0x03D0, 0x03D0, 1, -30}, {0x03D1, 0x03D1, 1, -25},
+        {0x03D2, 0x03D2, 1, -13}, {0x03D3, 0x03D3, 1, -6}, {0x03D4, 0x03D4, 1, -9}, {0x03D5, 0x03D5, 1, -15},
+        {0x03D6, 0x03D6, 1, -22}, {0x03D8, 0x03EE, 2, 1}, {0x03F0, 0x03F0, 1, -54}, {0x03F1, 0x03F1, 1, -48},
+        {0x03F2, 0x03F2, 1, -47}, {0x03F4, 0x03F4, 1, -60}, {0x03F5, 0x03F5, 1, -64}, {0x03F7, 0x03F7, 1, 1},
+        {0x03F9, 0x03F9, 1, -54}, {0x03FA, 0x03FA, 1, 1}, {0x03FD, 0x03FF, 1, -130}, {0x0400, 0x040F, 1, 80},
+        {0x0410, 0x042F, 1, 32}, {0x0460, 0x0480, 2, 1}, {0x048A, 0x04BE, 2, 1}, {0x04C0, 0x04C0, 1, 15},
+        {0x04C1, 0x04CD, 2, 1}, {0x04D0, 0x052E, 2, 1}, {0x0531, 0x0556, 1, 48}, {0x10A0, 0x10C5, 1, 7264},
+        {0x10C7, 0x10C7, 1, 7264}, {0x10CD, 0x10CD, 1, 7264}, {0x10FC, 0x10FC, 1, -32}, {0x13F8, 0x13FD, 1, -8},
+        {0x1C80, 0x1C80, 1, -6222}, {0x1C81, 0x1C81, 1, -6221}, {0x1C82, 0x1C82, 1, -6212}, {0x1C83, 0x1C84, 1, -6210},
+        {0x1C85, 0x1C85, 1, -6211}, {0x1C86, 0x1C86, 1, -6204}, {0x1C87, 0x1C87, 1, -6180}, {0x1C88, 0x1C88, 1, 35267},
+        {0x1C90, 0x1CBA, 1, -3008}, {0x1CBD, 0x1CBF, 1, -3008}, {0x1E00, 0x1E94, 2, 1}, {0x1E9B, 0x1E9B, 1, -58},
+        {0x1EA0, 0x1EFE, 2, 1}, {0x1F08, 0x1F0F, 1, -8}, {0x1F18, 0x1F1D, 1, -8}, {0x1F28, 0x1F2F, 1, -8},
+        {0x1F38, 0x1F3F, 1, -8}, {0x1F48, 0x1F4D, 1, -8}, {0x1F59, 0x1F5F, 2, -8}, {0x1F68, 0x1F6F, 1, -8},
+        {0x1F71, 0x1F71, 1, -7109}, {0x1F73, 0x1F73, 1, -7110}, {0x1F75, 0x1F75, 1, -7111}, {0x1F77, 0x1F77, 1, -7112},
+        {0x1F79, 0x1F79, 1, -7085}, {0x1F7B, 0x1F7B, 1, -7086}, {0x1F7D, 0x1F7D, 1, -7087}, {0x1FB8, 0x1FB9, 1, -8},
+        {0x1FBA, 0x1FBA, 1, -74}, {0x1FBB, 0x1FBB, 1, -7183}, {0x1FBE, 0x1FBE, 1, -7173}, {0x1FC8, 0x1FC8, 1, -86},
+        {0x1FC9, 0x1FC9, 1, -7196}, {0x1FCA, 0x1FCA, 1, -86}, {0x1FCB, 0x1FCB, 1, -7197}, {0x1FD3, 0x1FD3, 1, -7235},
+        {0x1FD8, 0x1FD9, 1, -8}, {0x1FDA, 0x1FDA, 1, -100}, {0x1FDB, 0x1FDB, 1, -7212}, {0x1FE3, 0x1FE3, 1, -7219},
+        {0x1FE8, 0x1FE9, 1, -8}, {0x1FEA, 0x1FEA, 1, -112}, {0x1FEB, 0x1FEB, 1, -7198}, {0x1FEC, 0x1FEC, 1, -7},
+        {0x1FEF, 0x1FEF, 1, -8079}, {0x1FF8, 0x1FF8, 1, -128}, {0x1FF9, 0x1FF9, 1, -7213}, {0x1FFA, 0x1FFA, 1, -126},
+        {0x1FFB, 0x1FFB, 1, -7213}, {0x2000, 0x2000, 1, -8160}, {0x2001, 0x2001, 1, -8161}, {0x2002, 0x2002, 1, -8162},
+        {0x2003, 0x2003, 1, -8163}, {0x2004, 0x2004, 1, -8164}, {0x2005, 0x2005, 1, -8165}, {0x2006, 0x2006, 1, -8166},
+        {0x2007, 0x2007, 1, -8167}, {0x2008, 0x2008, 1, -8168}, {0x2009, 0x2009, 1, -8169}, {0x200A, 0x200A, 1, -8170},
+        {0x2010, 0x2010, 1, -8163}, {0x2011, 0x2011, 1, -8164}, {0x2012, 0x2012, 1, -8165}, {0x2013, 0x2013, 1, -8166},
+        {0x2014, 0x2014, 1, -8167}, {0x2015, 0x2015, 1, -8168}, {0x2018, 0x2018, 1, -8177}, {0x2019, 0x2019, 1, -8178},
+        {0x201B, 0x201B, 1, -8180}, {0x201C, 0x201C, 1, -8186}, {0x201D, 0x201D, 1, -8187}, {0x201F, 0x201F, 1, -8189},
+        {0x2024, 0x2024, 1, -8182}, {0x202F, 0x202F, 1, -8207}, {0x2032, 0x2032, 1, -8203}, {0x2033, 0x2033, 1, -8209},
+        {0x205F, 0x205F, 1, -8255}, {0x2070, 0x2070, 1, -8256}, {0x2071, 0x2071, 1, -8200}, {0x2074, 0x2079, 1, -8256},
+        {0x207A, 0x207A, 1, -8271}, {0x207B, 0x207B, 1, 407}, {0x207C, 0x207C, 1, -8255}, {0x207D, 0x207E, 1, -8277},
+        {0x207F, 0x207F, 1, -8209}, {0x2080, 0x2089, 1, -8272}, {0x208A, 0x208A, 1, -8287}, {0x208B, 0x208B, 1, 391},
+        {0x208C, 0x208C, 1, -8271}, {0x208D, 0x208E, 1, -8293}, {0x2090, 0x2090, 1, -8239}, {0x2091, 0x2091, 1, -8236},
+        {0x2092, 0x2092, 1, -8227}, {0x2093, 0x2093, 1, -8219}, {0x2094, 0x2094, 1, -7739}, {0x2095, 0x2095, 1, -8237},
+        {0x2096, 0x2099, 1, -8235}, {0x209A, 0x209A, 1, -8234}, {0x209B, 0x209C, 1, -8232}, {0x2102, 0x2102, 1, -8351},
+        {0x2107, 0x2107, 1, -7852}, {0x210A, 0x210B, 1, -8355}, {0x210C, 0x210C, 1, -8356}, {0x210D, 0x210D, 1, -8357},
+        {0x210E, 0x210E, 1, -8358}, {0x210F, 0x210F, 1, -8168}, {0x2110, 0x2110, 1, -8359}, {0x2111, 0x2111, 1, -8360},
+        {0x2112, 0x2112, 1, -8358}, {0x2113, 0x2115, 2, -8359}, {0x2119, 0x211B, 1, -8361}, {0x211C, 0x211C, 1, -8362},
+        {0x211D, 0x211D, 1, -8363}, {0x2124, 0x2124, 1, -8362}, {0x2126, 0x2126, 1, -7517}, {0x2128, 0x2128, 1, -8366},
+        {0x212A, 0x212A, 1, -8383}, {0x212B, 0x212B, 1, -8262}, {0x212C, 0x212D, 1, -8394}, {0x212F, 0x212F, 1, -8394},
+        {0x2130, 0x2131, 1, -8395}, {0x2132, 0x2132, 1, 28}, {0x2133, 0x2133, 1, -8390}, {0x2134, 0x2134, 1, -8389},
+        {0x2135, 0x2138, 1, -7013}, {0x2139, 0x2139, 1, -8400}, {0x213C, 0x213C, 1, -7548}, {0x213D, 0x213D, 1, -7562},
+        {0x213E, 0x213E, 1, -7563}, {0x213F, 0x213F, 1, -7551}, {0x2140, 0x2140, 1, 209}, {0x2145, 0x2145, 1, -8417},
+        {0x2146, 0x2147, 1, -8418}, {0x2148, 0x2149, 1, -8415}, {0x2160, 0x2160, 1, -8439}, {0x2164, 0x2164, 1, -8430},
+        {0x2169, 0x2169, 1, -8433}, {0x216C, 0x216C, 1, -8448}, {0x216D, 0x216E, 1, -8458}, {0x216F, 0x216F, 1, -8450},
+        {0x2170, 0x2170, 1, -8455}, {0x2174, 0x2174, 1, -8446}, {0x2179, 0x2179, 1, -8449}, {0x217C, 0x217C, 1, -8464},
+        {0x217D, 0x217E, 1, -8474}, {0x217F, 0x217F, 1, -8466}, {0x2183, 0x2183, 1, 1}, {0x2460, 0x2468, 1, -9263},
+        {0x24B6, 0x24CF, 1, -9301}, {0x24D0, 0x24E9, 1, -9327}, {0x24EA, 0x24EA, 1, -9402}, {0x2C00, 0x2C2F, 1, 48},
+        {0x2C60, 0x2C60, 1, 1}, {0x2C62, 0x2C62, 1, -10743}, {0x2C63, 0x2C63, 1, -3814}, {0x2C64, 0x2C64, 1, -10727},
+        {0x2C67, 0x2C6B, 2, 1}, {0x2C6D, 0x2C6D, 1, -10780}, {0x2C6E, 0x2C6E, 1, -10749}, {0x2C6F, 0x2C6F, 1, -10783},
+        {0x2C70, 0x2C70, 1, -10782}, {0x2C72, 0x2C72, 1, 1}, {0x2C75, 0x2C75, 1, 1}, {0x2C7C, 0x2C7C, 1, -11282},
+        {0x2C7D, 0x2C7D, 1, -11271}, {0x2C7E, 0x2C7F, 1, -10815}, {0x2C80, 0x2CE2, 2, 1}, {0x2CEB, 0x2CED, 2, 1},
+        {0x2CF2, 0x2CF2, 1, 1}, {0x3000, 0x3000, 1, -12256}, {0xA640, 0xA66C, 2, 1}, {0xA680, 0xA69A, 2, 1},
+        {0xA69C, 0xA69C, 1, -41554}, {0xA69D, 0xA69D, 1, -41553}, {0xA722, 0xA72E, 2, 1}, {0xA732, 0xA76E, 2, 1},
+        {0xA770, 0xA770, 1, -1}, {0xA779, 0xA77B, 2, 1}, {0xA77D, 0xA77D, 1, -35332}, {0xA77E, 0xA786, 2, 1},
+        {0xA78B, 0xA78B, 1, 1}, {0xA78D, 0xA78D, 1, -42280}, {0xA790, 0xA792, 2, 1}, {0xA796, 0xA7A8, 2, 1},
+        {0xA7AA, 0xA7AA, 1, -42308}, {0xA7AB, 0xA7AB, 1, -42319}, {0xA7AC, 0xA7AC, 1, -42315}, {0xA7AD, 0xA7AD, 1, -42305},
+        {0xA7AE, 0xA7AE, 1, -42308}, {0xA7B0, 0xA7B0, 1, -42258}, {0xA7B1, 0xA7B1, 1, -42282}, {0xA7B2, 0xA7B2, 1, -42261},
+        {0xA7B3, 0xA7B3, 1, 928}, {0xA7B4, 0xA7C2, 2, 1}, {0xA7C4, 0xA7C4, 1, -48}, {0xA7C5, 0xA7C5, 1, -42307},
+        {0xA7C6, 0xA7C6, 1, -35384}, {0xA7C7, 0xA7C9, 2, 1}, {0xA7D0, 0xA7D0, 1, 1}, {0xA7D6, 0xA7D8, 2, 1},
+        {0xA7F2, 0xA7F2, 1, -42895}, {0xA7F3, 0xA7F3, 1, -42893}, {0xA7F4, 0xA7F4, 1, -42883}, {0xA7F5, 0xA7F5, 1, 1},
+        {0xA7F8, 0xA7F8, 1, -42705}, {0xA7F9, 0xA7F9, 1, -42662}, {0xAB70, 0xABBF, 1, -38864}, {0xFF01, 0xFF20, 1, -65248},
+        {0xFF21, 0xFF3A, 1, -65216}, {0xFF3B, 0xFF5E, 1, -65248}, {0xFF5F, 0xFF60, 1, -54746}, {0xFF61, 0xFF61, 1, -53087},
+        {0xFF62, 0xFF63, 1, -53078}, {0xFF64, 0xFF64, 1, -53091}, {0xFF65, 0xFF65, 1, -52842}, {0xFF66, 0xFF66, 1, -52852},
+        {0xFF67, 0xFF67, 1, -52934}, {0xFF68, 0xFF68, 1, -52933}, {0xFF69, 0xFF69, 1, -52932}, {0xFF6A, 0xFF6A, 1, -52931},
+        {0xFF6B, 0xFF6B, 1, -52930}, {0xFF6C, 0xFF6C, 1, -52873}, {0xFF6D, 0xFF6D, 1, -52872}, {0xFF6E, 0xFF6E, 1, -52871},
+        {0xFF6F, 0xFF6F, 1, -52908}, {0xFF70, 0xFF70, 1, -52852}, {0xFF71, 0xFF71, 1, -52943}, {0xFF72, 0xFF72, 1, -52942},
+        {0xFF73, 0xFF73, 1, -52941}, {0xFF74, 0xFF74, 1, -52940}, {0xFF75, 0xFF76, 1, -52939}, {0xFF77, 0xFF77, 1, -52938},
+        {0xFF78, 0xFF78, 1, -52937}, {0xFF79, 0xFF79, 1, -52936}, {0xFF7A, 0xFF7A, 1, -52935}, {0xFF7B, 0xFF7B, 1, -52934},
+        {0xFF7C, 0xFF7C, 1, -52933}, {0xFF7D, 0xFF7D, 1, -52932}, {0xFF7E, 0xFF7E, 1, -52931}, {0xFF7F, 0xFF7F, 1, -52930},
+        {0xFF80, 0xFF80, 1, -52929}, {0xFF81, 0xFF81, 1, -52928}, {0xFF82, 0xFF82, 1, -52926}, {0xFF83, 0xFF83, 1, -52925},
+        {0xFF84, 0xFF84, 1, -52924}, {0xFF85, 0xFF8A, 1, -52923}, {0xFF8B, 0xFF8B, 1, -52921}, {0xFF8C, 0xFF8C, 1, -52919},
+        {0xFF8D, 0xFF8D, 1, -52917}, {0xFF8E, 0xFF8E, 1, -52915}, {0xFF8F, 0xFF93, 1, -52913}, {0xFF94, 0xFF94, 1, -52912},
+        {0xFF95, 0xFF95, 1, -52911}, {0xFF96, 0xFF9B, 1, -52910}, {0xFF9C, 0xFF9C, 1, -52909}, {0xFF9D, 0xFF9D, 1, -52906},
+        {0xFF9E, 0xFF9F, 1, -52997}, {0xFFA0, 0xFFA0, 1, -60992}, {0xFFA1, 0xFFA2, 1, -61089}, {0xFFA3, 0xFFA3, 1, -60921},
+        {0xFFA4, 0xFFA4, 1, -61090}, {0xFFA5, 0xFFA6, 1, -60921}, {0xFFA7, 0xFFA9, 1, -61092}, {0xFFAA, 0xFFAF, 1, -60922},
+        {0xFFB0, 0xFFB0, 1, -61078}, {0xFFB1, 0xFFB3, 1, -61099}, {0xFFB4, 0xFFB4, 1, -61075}, {0xFFB5, 0xFFBE, 1, -61100},
+        {0xFFC2, 0xFFC7, 1, -61025}, {0xFFCA, 0xFFCF, 1, -61027}, {0xFFD2, 0xFFD7, 1, -61029}, {0xFFDA, 0xFFDC, 1, -61031},
+        {0xFFE0, 0xFFE1, 1, -65342}, {0xFFE2, 0xFFE2, 1, -65334}, {0xFFE4, 0xFFE4, 1, -65342}, {0xFFE5, 0xFFE5, 1, -65344},
+        {0xFFE6, 0xFFE6, 1, -57149}, {0xFFE8, 0xFFE8, 1, -56038}, {0xFFE9, 0xFFEC, 1, -56921}, {0xFFED, 0xFFED, 1, -55885},
+        {0xFFEE, 0xFFEE, 1, -55843},
+    };
+
+    const FoldExpansion FOLD_EXPANSIONS[] = {
+        {0x00A8, " \xcc\x88"}, {0x00AF, " \xcc\x84"}, {0x00B4, " \xcc\x81"}, {0x00B8, " \xcc\xa7"},
+        {0x00BC, "1\xe2\x81\x84" "4"}, {0x00BD, "1\xe2\x81\x84" "2"}, {0x00BE, "3\xe2\x81\x84" "4"}, {0x00DF, "ss"},
+        {0x0130, "i\xcc\x87"}, {0x0132, "ij"}, {0x0133, "ij"}, {0x013F, "l\xc2\xb7"},
+        {0x0140, "l\xc2\xb7"}, {0x0149, "\xca\xbcn"}, {0x01C4, "d\xc5\xbe"}, {0x01C5, "d\xc5\xbe"},
+        {0x01C6, "d\xc5\xbe"}, {0x01C7, "lj"}, {0x01C8, "lj"}, {0x01C9, "lj"},
+        {0x01CA, "nj"}, {0x01CB, "nj"}, {0x01CC, "nj"}, {0x01F1, "dz"},
+        {0x01F2, "dz"}, {0x01F3, "dz"}, {0x02D8, " \xcc\x86"}, {0x02D9, " \xcc\x87"},
+        {0x02DA, " \xcc\x8a"}, {0x02DB, " \xcc\xa8"}, {0x02DC, " \xcc\x83"}, {0x02DD, " \xcc\x8b"},
+        {0x0344, "\xcc\x88\xcc\x81"}, {0x037A, " \xce\xb9"}, {0x0384, " \xcc\x81"}, {0x0385, " \xcc\x88\xcc\x81"},
+        {0x0587, "\xd5\xa5\xd6\x82"}, {0x1E9A, "a\xca\xbe"}, {0x1E9E, "ss"}, {0x1F80, "\xe1\xbc\x80\xce\xb9"},
+        {0x1F81, "\xe1\xbc\x81\xce\xb9"}, {0x1F82, "\xe1\xbc\x82\xce\xb9"}, {0x1F83, "\xe1\xbc\x83\xce\xb9"}, {0x1F84, "\xe1\xbc\x84\xce\xb9"},
+        {0x1F85, "\xe1\xbc\x85\xce\xb9"}, {0x1F86, "\xe1\xbc\x86\xce\xb9"}, {0x1F87, "\xe1\xbc\x87\xce\xb9"}, {0x1F88, "\xe1\xbc\x80\xce\xb9"},
+        {0x1F89, "\xe1\xbc\x81\xce\xb9"}, {0x1F8A, "\xe1\xbc\x82\xce\xb9"}, {0x1F8B, "\xe1\xbc\x83\xce\xb9"}, {0x1F8C, "\xe1\xbc\x84\xce\xb9"},
+        {0x1F8D, "\xe1\xbc\x85\xce\xb9"}, {0x1F8E, "\xe1\xbc\x86\xce\xb9"}, {0x1F8F, "\xe1\xbc\x87\xce\xb9"}, {0x1F90, "\xe1\xbc\xa0\xce\xb9"},
+        {0x1F91, "\xe1\xbc\xa1\xce\xb9"}, {0x1F92, "\xe1\xbc\xa2\xce\xb9"}, {0x1F93, "\xe1\xbc\xa3\xce\xb9"}, {0x1F94, "\xe1\xbc\xa4\xce\xb9"},
+        {0x1F95, "\xe1\xbc\xa5\xce\xb9"}, {0x1F96, "\xe1\xbc\xa6\xce\xb9"}, {0x1F97, "\xe1\xbc\xa7\xce\xb9"}, {0x1F98, "\xe1\xbc\xa0\xce\xb9"},
+        {0x1F99, "\xe1\xbc\xa1\xce\xb9"}, {0x1F9A, "\xe1\xbc\xa2\xce\xb9"}, {0x1F9B, "\xe1\xbc\xa3\xce\xb9"}, {0x1F9C, "\xe1\xbc\xa4\xce\xb9"},
+        {0x1F9D, "\xe1\xbc\xa5\xce\xb9"}, {0x1F9E, "\xe1\xbc\xa6\xce\xb9"}, {0x1F9F, "\xe1\xbc\xa7\xce\xb9"}, {0x1FA0, "\xe1\xbd\xa0\xce\xb9"},
+        {0x1FA1, "\xe1\xbd\xa1\xce\xb9"}, {0x1FA2, "\xe1\xbd\xa2\xce\xb9"}, {0x1FA3, "\xe1\xbd\xa3\xce\xb9"}, {0x1FA4, "\xe1\xbd\xa4\xce\xb9"},
+        {0x1FA5, "\xe1\xbd\xa5\xce\xb9"}, {0x1FA6, "\xe1\xbd\xa6\xce\xb9"}, {0x1FA7, "\xe1\xbd\xa7\xce\xb9"}, {0x1FA8, "\xe1\xbd\xa0\xce\xb9"},
+        {0x1FA9, "\xe1\xbd\xa1\xce\xb9"}, {0x1FAA, "\xe1\xbd\xa2\xce\xb9"}, {0x1FAB, "\xe1\xbd\xa3\xce\xb9"}, {0x1FAC, "\xe1\xbd\xa4\xce\xb9"},
+        {0x1FAD, "\xe1\xbd\xa5\xce\xb9"}, {0x1FAE, "\xe1\xbd\xa6\xce\xb9"}, {0x1FAF, "\xe1\xbd\xa7\xce\xb9"}, {0x1FB2, "\xe1\xbd\xb0\xce\xb9"},
+        {0x1FB3, "\xce\xb1\xce\xb9"}, {0x1FB4, "\xce\xac\xce\xb9"}, {0x1FB7, "\xe1\xbe\xb6\xce\xb9"}, {0x1FBC, "\xce\xb1\xce\xb9"},
+        {0x1FBD, " \xcc\x93"}, {0x1FBF, " \xcc\x93"}, {0x1FC0, " \xcd\x82"}, {0x1FC1, " \xcc\x88\xcd\x82"},
+        {0x1FC2, "\xe1\xbd\xb4\xce\xb9"}, {0x1FC3, "\xce\xb7\xce\xb9"}, {0x1FC4, "\xce\xae\xce\xb9"}, {0x1FC7, "\xe1\xbf\x86\xce\xb9"},
+        {0x1FCC, "\xce\xb7\xce\xb9"}, {0x1FCD, " \xcc\x93\xcc\x80"}, {0x1FCE, " \xcc\x93\xcc\x81"}, {0x1FCF, " \xcc\x93\xcd\x82"},
+        {0x1FDD, " \xcc\x94\xcc\x80"}, {0x1FDE, " \xcc\x94\xcc\x81"}, {0x1FDF, " \xcc\x94\xcd\x82"}, {0x1FED, " \xcc\x88\xcc\x80"},
+        {0x1FEE, " \xcc\x88\xcc\x81"}, {0x1FF2, "\xe1\xbd\xbc\xce\xb9"}, {0x1FF3, "\xcf\x89\xce\xb9"}, {0x1FF4, "\xcf\x8e\xce\xb9"},
+        {0x1FF7, "\xe1\xbf\xb6\xce\xb9"}, {0x1FFC, "\xcf\x89\xce\xb9"}, {0x1FFD, " \xcc\x81"}, {0x1FFE, " \xcc\x94"},
+        {0x2017, " \xcc\xb3"}, {0x2025, ".."}, {0x2026, "..."}, {0x2034, "'''"},
+        {0x2036, "\xe2\x80\xb5\xe2\x80\xb5"}, {0x2037, "\xe2\x80\xb5\xe2\x80\xb5\xe2\x80\xb5"}, {0x203C, "!!"}, {0x203E, " \xcc\x85"},
+        {0x2047, "??"}, {0x2048, "?!"}, {0x2049, "!?"}, {0x2057, "''''"},
+        {0x2100, "a/c"}, {0x2101, "a/s"}, {0x2103, "\xc2\xb0" "c"}, {0x2105, "c/o"},
+        {0x2106, "c/u"}, {0x2109, "\xc2\xb0" "f"}, {0x2116, "no"}, {0x2120, "sm"},
+        {0x2121, "tel"}, {0x2122, "tm"}, {0x213B, "fax"}, {0x2150, "1\xe2\x81\x84" "7"},
+        {0x2151, "1\xe2\x81\x84" "9"}, {0x2152, "1\xe2\x81\x84" "10"}, {0x2153, "1\xe2\x81\x84" "3"}, {0x2154, "2\xe2\x81\x84" "3"},
+        {0x2155, "1\xe2\x81\x84" "5"}, {0x2156, "2\xe2\x81\x84" "5"}, {0x2157, "3\xe2\x81\x84" "5"}, {0x2158, "4\xe2\x81\x84" "5"},
+        {0x2159, "1\xe2\x81\x84" "6"}, {0x215A, "5\xe2\x81\x84" "6"}, {0x215B, "1\xe2\x81\x84" "8"}, {0x215C, "3\xe2\x81\x84" "8"},
+        {0x215D, "5\xe2\x81\x84" "8"}, {0x215E, "7\xe2\x81\x84" "8"}, {0x215F, "1\xe2\x81\x84"}, {0x2161, "ii"},
+        {0x2162, "iii"}, {0x2163, "iv"}, {0x2165, "vi"}, {0x2166, "vii"},
+        {0x2167, "viii"}, {0x2168, "ix"}, {0x216A, "xi"}, {0x216B, "xii"},
+        {0x2171, "ii"}, {0x2172, "iii"}, {0x2173, "iv"}, {0x2175, "vi"},
+        {0x2176, "vii"}, {0x2177, "viii"}, {0x2178, "ix"}, {0x217A, "xi"},
+        {0x217B, "xii"}, {0x2189, "0\xe2\x81\x84" "3"}, {0x2469, "10"}, {0x246A, "11"},
+        {0x246B, "12"}, {0x246C, "13"}, {0x246D, "14"}, {0x246E, "15"},
+        {0x246F, "16"}, {0x2470, "17"}, {0x2471, "18"}, {0x2472, "19"},
+        {0x2473, "20"}, {0x2474, "(1)"}, {0x2475, "(2)"}, {0x2476, "(3)"},
+        {0x2477, "(4)"}, {0x2478, "(5)"}, {0x2479, "(6)"}, {0x247A, "(7)"},
+        {0x247B, "(8)"}, {0x247C, "(9)"}, {0x247D, "(10)"}, {0x247E, "(11)"},
+        {0x247F, "(12)"}, {0x2480, "(13)"}, {0x2481, "(14)"}, {0x2482, "(15)"},
+        {0x2483, "(16)"}, {0x2484, "(17)"}, {0x2485, "(18)"}, {0x2486, "(19)"},
+        {0x2487, "(20)"}, {0x2488, "1."}, {0x2489, "2."}, {0x248A, "3."},
+        {0x248B, "4."}, {0x248C, "5."}, {0x248D, "6."}, {0x248E, "7."},
+        {0x248F, "8."}, {0x2490, "9."}, {0x2491, "10."}, {0x2492, "11."},
+        {0x2493, "12."}, {0x2494, "13."}, {0x2495, "14."}, {0x2496, "15."},
+        {0x2497, "16."}, {0x2498, "17."}, {0x2499, "18."}, {0x249A, "19."},
+        {0x249B, "20."}, {0x249C, "(a)"}, {0x249D, "(b)"}, {0x249E, "(c)"},
+        {0x249F, "(d)"}, {0x24A0, "(e)"}, {0x24A1, "(f)"}, {0x24A2, "(g)"},
+        {0x24A3, "(h)"}, {0x24A4, "(i)"}, {0x24A5, "(j)"}, {0x24A6, "(k)"},
+        {0x24A7, "(l)"}, {0x24A8, "(m)"}, {0x24A9, "(n)"}, {0x24AA, "(o)"},
+        {0x24AB, "(p)"}, {0x24AC, "(q)"}, {0x24AD, "(r)"}, {0x24AE, "(s)"},
+        {0x24AF, "(t)"}, {0x24B0, "(u)"}, {0x24B1, "(v)"}, {0x24B2, "(w)"},
+        {0x24B3, "(x)"}, {0x24B4, "(y)"}, {0x24B5, "(z)"}, {0xFB00, "ff"},
+        {0xFB01, "fi"}, {0xFB02, "fl"}, {0xFB03, "ffi"}, {0xFB04, "ffl"},
+        {0xFB05, "st"}, {0xFB06, "st"}, {0xFB13, "\xd5\xb4\xd5\xb6"}, {0xFB14, "\xd5\xb4\xd5\xa5"},
+        {0xFB15, "\xd5\xb4\xd5\xab"}, {0xFB16, "\xd5\xbe\xd5\xb6"}, {0xFB17, "\xd5\xb4\xd5\xad"}, {0xFFE3, " \xcc\x84"},
+    };
+
+    const Decomposition DECOMPOSITIONS[] = {
+        {0x00E0, 0x0061, 0x0300, true}, {0x00E1, 0x0061, 0x0301, true}, {0x00E2, 0x0061, 0x0302, true},
+        {0x00E3, 0x0061, 0x0303, true}, {0x00E4, 0x0061, 0x0308, true}, {0x00E5, 0x0061, 0x030A, true},
+        {0x00E7, 0x0063, 0x0327, true}, {0x00E8, 0x0065, 0x0300, true}, {0x00E9, 0x0065, 0x0301, true},
+        {0x00EA, 0x0065, 0x0302, true}, {0x00EB, 0x0065, 0x0308, true}, {0x00EC, 0x0069, 0x0300, true},
+        {0x00ED, 0x0069, 0x0301, true}, {0x00EE, 0x0069, 0x0302, true}, {0x00EF, 0x0069, 0x0308, true},
+        {0x00F1, 0x006E, 0x0303, true}, {0x00F2, 0x006F, 0x0300, true}, {0x00F3, 0x006F, 0x0301, true},
+        {0x00F4, 0x006F, 0x0302, true}, {0x00F5, 0x006F, 0x0303, true}, {0x00F6, 0x006F, 0x0308, true},
+        {0x00F9, 0x0075, 0x0300, true}, {0x00FA, 0x0075, 0x0301, true}, {0x00FB, 0x0075, 0x0302, true},
+        {0x00FC, 0x0075, 0x0308, true}, {0x00FD, 0x0079, 0x0301, true}, {0x00FF, 0x0079, 0x0308, true},
+        {0x0101, 0x0061, 0x0304, true}, {0x0103, 0x0061, 0x0306, true}, {0x0105, 0x0061, 0x0328, true},
+        {0x0107, 0x0063, 0x0301, true}, {0x0109, 0x0063, 0x0302, true}, {0x010B, 0x0063, 0x0307, true},
+        {0x010D, 0x0063, 0x030C, true}, {0x010F, 0x0064, 0x030C, true}, {0x0113, 0x0065, 0x0304, true},
+        {0x0115, 0x0065, 0x0306, true}, {0x0117, 0x0065, 0x0307, true}, {0x0119, 0x0065, 0x0328, true},
+        {0x011B, 0x0065, 0x030C, true}, {0x011D, 0x0067, 0x0302, true}, {0x011F, 0x0067, 0x0306, true},
+        {0x0121, 0x0067, 0x0307, true}, {0x0123, 0x0067, 0x0327, true}, {0x0125, 0x0068, 0x0302, true},
+        {0x0129, 0x0069, 0x0303, true}, {0x012B, 0x0069, 0x0304, true}, {0x012D, 0x0069, 0x0306, true},
+        {0x012F, 0x0069, 0x0328, true}, {0x0135, 0x006A, 0x0302, true}, {0x0137, 0x006B, 0x0327, true},
+        {0x013A, 0x006C, 0x0301, true}, {0x013C, 0x006C, 0x0327, true}, {0x013E, 0x006C, 0x030C, true},
+        {0x0144, 0x006E, 0x0301, true}, {0x0146, 0x006E, 0x0327, true}, {0x0148, 0x006E, 0x030C, true},
+        {0x014D, 0x006F, 0x0304, true}, {0x014F, 0x006F, 0x0306, true}, {0x0151, 0x006F, 0x030B, true},
+        {0x0155, 0x0072, 0x0301, true}, {0x0157, 0x0072, 0x0327, true}, {0x0159, 0x0072, 0x030C, true},
+        {0x015B, 0x0073, 0x0301, true}, {0x015D, 0x0073, 0x0302, true}, {0x015F, 0x0073, 0x0327, true},
+        {0x0161, 0x0073, 0x030C, true}, {0x0163, 0x0074, 0x0327, true}, {0x0165, 0x0074, 0x030C, true},
+        {0x0169, 0x0075, 0x0303, true}, {0x016B, 0x0075, 0x0304, true}, {0x016D, 0x0075, 0x0306, true},
+        {0x016F, 0x0075, 0x030A, true}, {0x0171, 0x0075, 0x030B, true}, {0x0173, 0x0075, 0x0328, true},
+        {0x0175, 0x0077, 0x0302, true}, {0x0177, 0x0079, 0x0302, true}, {0x017A, 0x007A, 0x0301, true},
+        {0x017C, 0x007A, 0x0307, true}, {0x017E, 0x007A, 0x030C, true}, {0x01A1, 0x006F, 0x031B, true},
+        {0x01B0, 0x0075, 0x031B, true}, {0x01CE, 0x0061, 0x030C, true}, {0x01D0, 0x0069, 0x030C, true},
+        {0x01D2, 0x006F, 0x030C, true}, {0x01D4, 0x0075, 0x030C, true}, {0x01D6, 0x00FC, 0x0304, true},
+        {0x01D8, 0x00FC, 0x0301, true}, {0x01DA, 0x00FC, 0x030C, true}, {0x01DC, 0x00FC, 0x0300, true},
+        {0x01DF, 0x00E4, 0x0304, true}, {0x01E1, 0x0227, 0x0304, true}, {0x01E3, 0x00E6, 0x0304, true},
+        {0x01E7, 0x0067, 0x030C, true}, {0x01E9, 0x006B, 0x030C, true}, {0x01EB, 0x006F, 0x0328, true},
+        {0x01ED, 0x01EB, 0x0304, true}, {0x01EF, 0x0292, 0x030C, true}, {0x01F0, 0x006A, 0x030C, true},
+        {0x01F5, 0x0067, 0x0301, true}, {0x01F9, 0x006E, 0x0300, true}, {0x01FB, 0x00E5, 0x0301, true},
+        {0x01FD, 0x00E6, 0x0301, true}, {0x01FF, 0x00F8, 0x0301, true}, {0x0201, 0x0061, 0x030F, true},
+        {0x0203, 0x0061, 0x0311, true}, {0x0205, 0x0065, 0x030F, true}, {0x0207, 0x0065, 0x0311, true},
+        {0x0209, 0x0069, 0x030F, true}, {0x020B, 0x0069, 0x0311, true}, {0x020D, 0x006F, 0x030F, true},
+        {0x020F, 0x006F, 0x0311, true}, {0x0211, 0x0072, 0x030F, true}, {0x0213, 0x0072, 0x0311, true},
+        {0x0215, 0x0075, 0x030F, true}, {0x0217, 0x0075, 0x0311, true}, {0x0219, 0x0073, 0x0326, true},
+        {0x021B, 0x0074, 0x0326, true}, {0x021F, 0x0068, 0x030C, true}, {0x0227, 0x0061, 0x0307, true},
+        {0x0229, 0x0065, 0x0327, true}, {0x022B, 0x00F6, 0x0304, true}, {0x022D, 0x00F5, 0x0304, true},
+        {0x022F, 0x006F, 0x0307, true}, {0x0231, 0x022F, 0x0304, true}, {0x0233, 0x0079, 0x0304, true},
+        {0x0390, 0x03CA, 0x0301, true}, {0x03AC, 0x03B1, 0x0301, true}, {0x03AD, 0x03B5, 0x0301, true},
+        {0x03AE, 0x03B7, 0x0301, true}, {0x03AF, 0x03B9, 0x0301, true}, {0x03B0, 0x03CB, 0x0301, true},
+        {0x03CA, 0x03B9, 0x0308, true}, {0x03CB, 0x03C5, 0x0308, true}, {0x03CC, 0x03BF, 0x0301, true},
+        {0x03CD, 0x03C5, 0x0301, true}, {0x03CE, 0x03C9, 0x0301, true}, {0x0439, 0x0438, 0x0306, true},
+        {0x0450, 0x0435, 0x0300, true}, {0x0451, 0x0435, 0x0308, true}, {0x0453, 0x0433, 0x0301, true},
+        {0x0457, 0x0456, 0x0308, true}, {0x045C, 0x043A, 0x0301, true}, {0x045D, 0x0438, 0x0300, true},
+        {0x045E, 0x0443, 0x0306, true}, {0x0477, 0x0475, 0x030F, true}, {0x04C2, 0x0436, 0x0306, true},
+        {0x04D1, 0x0430, 0x0306, true}, {0x04D3, 0x0430, 0x0308, true}, {0x04D7, 0x0435, 0x0306, true},
+        {0x04DB, 0x04D9, 0x0308, true}, {0x04DD, 0x0436, 0x0308, true}, {0x04DF, 0x0437, 0x0308, true},
+        {0x04E3, 0x0438, 0x0304, true}, {0x04E5, 0x0438, 0x0308, true}, {0x04E7, 0x043E, 0x0308, true},
+        {0x04EB, 0x04E9, 0x0308, true}, {0x04ED, 0x044D, 0x0308, true}, {0x04EF, 0x0443, 0x0304, true},
+        {0x04F1, 0x0443, 0x0308, true}, {0x04F3, 0x0443, 0x030B, true}, {0x04F5, 0x0447, 0x0308, true},
+        {0x04F9, 0x044B, 0x0308, true}, {0x1E01, 0x0061, 0x0325, true}, {0x1E03, 0x0062, 0x0307, true},
+        {0x1E05, 0x0062, 0x0323, true}, {0x1E07, 0x0062, 0x0331, true}, {0x1E09, 0x00E7, 0x0301, true},
+        {0x1E0B, 0x0064, 0x0307, true}, {0x1E0D, 0x0064, 0x0323, true}, {0x1E0F, 0x0064, 0x0331, true},
+        {0x1E11, 0x0064, 0x0327, true}, {0x1E13, 0x0064, 0x032D, true}, {0x1E15, 0x0113, 0x0300, true},
+        {0x1E17, 0x0113, 0x0301, true}, {0x1E19, 0x0065, 0x032D, true}, {0x1E1B, 0x0065, 0x0330, true},
+        {0x1E1D, 0x0229, 0x0306, true}, {0x1E1F, 0x0066, 0x0307, true}, {0x1E21, 0x0067, 0x0304, true},
+        {0x1E23, 0x0068, 0x0307, true}, {0x1E25, 0x0068, 0x0323, true}, {0x1E27, 0x0068, 0x0308, true},
+        {0x1E29, 0x0068, 0x0327, true}, {0x1E2B, 0x0068, 0x032E, true}, {0x1E2D, 0x0069, 0x0330, true},
+        {0x1E2F, 0x00EF, 0x0301, true}, {0x1E31, 0x006B, 0x0301, true}, {0x1E33, 0x006B, 0x0323, true},
+        {0x1E35, 0x006B, 0x0331, true}, {0x1E37, 0x006C, 0x0323, true}, {0x1E39, 0x1E37, 0x0304, true},
+        {0x1E3B, 0x006C, 0x0331, true}, {0x1E3D, 0x006C, 0x032D, true}, {0x1E3F, 0x006D, 0x0301, true},
+        {0x1E41, 0x006D, 0x0307, true}, {0x1E43, 0x006D, 0x0323, true}, {0x1E45, 0x006E, 0x0307, true},
+        {0x1E47, 0x006E, 0x0323, true}, {0x1E49, 0x006E, 0x0331, true}, {0x1E4B, 0x006E, 0x032D, true},
+        {0x1E4D, 0x00F5, 0x0301, true}, {0x1E4F, 0x00F5, 0x0308, true}, {0x1E51, 0x014D, 0x0300, true},
+        {0x1E53, 0x014D, 0x0301, true}, {0x1E55, 0x0070, 0x0301, true}, {0x1E57, 0x0070, 0x0307, true},
+        {0x1E59, 0x0072, 0x0307, true}, {0x1E5B, 0x0072, 0x0323, true}, {0x1E5D, 0x1E5B, 0x0304, true},
+        {0x1E5F, 0x0072, 0x0331, true}, {0x1E61, 0x0073, 0x0307, true}, {0x1E63, 0x0073, 0x0323, true},
+        {0x1E65, 0x015B, 0x0307, true}, {0x1E67, 0x0161, 0x0307, true}, {0x1E69, 0x1E63, 0x0307, true},
+        {0x1E6B, 0x0074, 0x0307, true}, {0x1E6D, 0x0074, 0x0323, true}, {0x1E6F, 0x0074, 0x0331, true},
+        {0x1E71, 0x0074, 0x032D, true}, {0x1E73, 0x0075, 0x0324, true}, {0x1E75, 0x0075, 0x0330, true},
+        {0x1E77, 0x0075, 0x032D, true}, {0x1E79, 0x0169, 0x0301, true}, {0x1E7B, 0x016B, 0x0308, true},
+        {0x1E7D, 0x0076, 0x0303, true}, {0x1E7F, 0x0076, 0x0323, true}, {0x1E81, 0x0077, 0x0300, true},
+        {0x1E83, 0x0077, 0x0301, true}, {0x1E85, 0x0077, 0x0308, true}, {0x1E87, 0x0077, 0x0307, true},
+        {0x1E89, 0x0077, 0x0323, true}, {0x1E8B, 0x0078, 0x0307, true}, {0x1E8D, 0x0078, 0x0308, true},
+        {0x1E8F, 0x0079, 0x0307, true}, {0x1E91, 0x007A, 0x0302, true}, {0x1E93, 0x007A, 0x0323, true},
+        {0x1E95, 0x007A, 0x0331, true}, {0x1E96, 0x0068, 0x0331, true}, {0x1E97, 0x0074, 0x0308, true},
+        {0x1E98, 0x0077, 0x030A, true}, {0x1E99, 0x0079, 0x030A, true}, {0x1EA1, 0x0061, 0x0323, true},
+        {0x1EA3, 0x0061, 0x0309, true}, {0x1EA5, 0x00E2, 0x0301, true}, {0x1EA7, 0x00E2, 0x0300, true},
+        {0x1EA9, 0x00E2, 0x0309, true}, {0x1EAB, 0x00E2, 0x0303, true}, {0x1EAD, 0x1EA1, 0x0302, true},
+        {0x1EAF, 0x0103, 0x0301, true}, {0x1EB1, 0x0103, 0x0300, true}, {0x1EB3, 0x0103, 0x0309, true},
+        {0x1EB5, 0x0103, 0x0303, true}, {0x1EB7, 0x1EA1, 0x0306, true}, {0x1EB9, 0x0065, 0x0323, true},
+        {0x1EBB, 0x0065, 0x0309, true}, {0x1EBD, 0x0065, 0x0303, true}, {0x1EBF, 0x00EA, 0x0301, true},
+        {0x1EC1, 0x00EA, 0x0300, true}, {0x1EC3, 0x00EA, 0x0309, true}, {0x1EC5, 0x00EA, 0x0303, true},
+        {0x1EC7, 0x1EB9, 0x0302, true}, {0x1EC9, 0x0069, 0x0309, true}, {0x1ECB, 0x0069, 0x0323, true},
+        {0x1ECD, 0x006F, 0x0323, true}, {0x1ECF, 0x006F, 0x0309, true}, {0x1ED1, 0x00F4, 0x0301, true},
+        {0x1ED3, 0x00F4, 0x0300, true}, {0x1ED5, 0x00F4, 0x0309, true}, {0x1ED7, 0x00F4, 0x0303, true},
+        {0x1ED9, 0x1ECD, 0x0302, true}, {0x1EDB, 0x01A1, 0x0301, true}, {0x1EDD, 0x01A1, 0x0300, true},
+        {0x1EDF, 0x01A1, 0x0309, true}, {0x1EE1, 0x01A1, 0x0303, true}, {0x1EE3, 0x01A1, 0x0323, true},
+        {0x1EE5, 0x0075, 0x0323, true}, {0x1EE7, 0x0075, 0x0309, true}, {0x1EE9, 0x01B0, 0x0301, true},
+        {0x1EEB, 0x01B0, 0x0300, true}, {0x1EED, 0x01B0, 0x0309, true}, {0x1EEF, 0x01B0, 0x0303, true},
+        {0x1EF1, 0x01B0, 0x0323, true}, {0x1EF3, 0x0079, 0x0300, true}, {0x1EF5, 0x0079, 0x0323, true},
+        {0x1EF7, 0x0079, 0x0309, true}, {0x1EF9, 0x0079, 0x0303, true}, {0x1F00, 0x03B1, 0x0313, true},
+        {0x1F01, 0x03B1, 0x0314, true}, {0x1F02, 0x1F00, 0x0300, true}, {0x1F03, 0x1F01, 0x0300, true},
+        {0x1F04, 0x1F00, 0x0301, true}, {0x1F05, 0x1F01, 0x0301, true}, {0x1F06, 0x1F00, 0x0342, true},
+        {0x1F07, 0x1F01, 0x0342, true}, {0x1F10, 0x03B5, 0x0313, true}, {0x1F11, 0x03B5, 0x0314, true},
+        {0x1F12, 0x1F10, 0x0300, true}, {0x1F13, 0x1F11, 0x0300, true}, {0x1F14, 0x1F10, 0x0301, true},
+        {0x1F15, 0x1F11, 0x0301, true}, {0x1F20, 0x03B7, 0x0313, true}, {0x1F21, 0x03B7, 0x0314, true},
+        {0x1F22, 0x1F20, 0x0300, true}, {0x1F23, 0x1F21, 0x0300, true}, {0x1F24, 0x1F20, 0x0301, true},
+        {0x1F25, 0x1F21, 0x0301, true}, {0x1F26, 0x1F20, 0x0342, true}, {0x1F27, 0x1F21, 0x0342, true},
+        {0x1F30, 0x03B9, 0x0313, true}, {0x1F31, 0x03B9, 0x0314, true}, {0x1F32, 0x1F30, 0x0300, true},
+        {0x1F33, 0x1F31, 0x0300, true}, {0x1F34, 0x1F30, 0x0301, true}, {0x1F35, 0x1F31, 0x0301, true},
+        {0x1F36, 0x1F30, 0x0342, true}, {0x1F37, 0x1F31, 0x0342, true}, {0x1F40, 0x03BF, 0x0313, true},
+        {0x1F41, 0x03BF, 0x0314, true}, {0x1F42, 0x1F40, 0x0300, true}, {0x1F43, 0x1F41, 0x0300, true},
+        {0x1F44, 0x1F40, 0x0301, true}, {0x1F45, 0x1F41, 0x0301, true}, {0x1F50, 0x03C5, 0x0313, true},
+        {0x1F51, 0x03C5, 0x0314, true}, {0x1F52, 0x1F50, 0x0300, true}, {0x1F53, 0x1F51, 0x0300, true},
+        {0x1F54, 0x1F50, 0x0301, true}, {0x1F55, 0x1F51, 0x0301, true}, {0x1F56, 0x1F50, 0x0342, true},
+        {0x1F57, 0x1F51, 0x0342, true}, {0x1F60, 0x03C9, 0x0313, true}, {0x1F61, 0x03C9, 0x0314, true},
+        {0x1F62, 0x1F60, 0x0300, true}, {0x1F63, 0x1F61, 0x0300, true}, {0x1F64, 0x1F60, 0x0301, true},
+        {0x1F65, 0x1F61, 0x0301, true}, {0x1F66, 0x1F60, 0x0342, true}, {0x1F67, 0x1F61, 0x0342, true},
+        {0x1F70, 0x03B1, 0x0300, true}, {0x1F72, 0x03B5, 0x0300, true}, {0x1F74, 0x03B7, 0x0300, true},
+        {0x1F76, 0x03B9, 0x0300, true}, {0x1F78, 0x03BF, 0x0300, true}, {0x1F7A, 0x03C5, 0x0300, true},
+        {0x1F7C, 0x03C9, 0x0300, true}, {0x1FB0, 0x03B1, 0x0306, true}, {0x1FB1, 0x03B1, 0x0304, true},
+        {0x1FB6, 0x03B1, 0x0342, true}, {0x1FC6, 0x03B7, 0x0342, true}, {0x1FD0, 0x03B9, 0x0306, true},
+        {0x1FD1, 0x03B9, 0x0304, true}, {0x1FD2, 0x03CA, 0x0300, true}, {0x1FD6, 0x03B9, 0x0342, true},
+        {0x1FD7, 0x03CA, 0x0342, true}, {0x1FE0, 0x03C5, 0x0306, true}, {0x1FE1, 0x03C5, 0x0304, true},
+        {0x1FE2, 0x03CB, 0x0300, true}, {0x1FE4, 0x03C1, 0x0313, true}, {0x1FE5, 0x03C1, 0x0314, true},
+        {0x1FE6, 0x03C5, 0x0342, true}, {0x1FE7, 0x03CB, 0x0342, true}, {0x1FF6, 0x03C9, 0x0342, true},
+        {0x304C, 0x304B, 0x3099, true}, {0x304E, 0x304D, 0x3099, true}, {0x3050, 0x304F, 0x3099, true},
+        {0x3052, 0x3051, 0x3099, true}, {0x3054, 0x3053, 0x3099, true}, {0x3056, 0x3055, 0x3099, true},
+        {0x3058, 0x3057, 0x3099, true}, {0x305A, 0x3059, 0x3099, true}, {0x305C, 0x305B, 0x3099, true},
+        {0x305E, 0x305D, 0x3099, true}, {0x3060, 0x305F, 0x3099, true}, {0x3062, 0x3061, 0x3099, true},
+        {0x3065, 0x3064, 0x3099, true}, {0x3067, 0x3066, 0x3099, true}, {0x3069, 0x3068, 0x3099, true},
+        {0x3070, 0x306F, 0x3099, true}, {0x3071, 0x306F, 0x309A, true}, {0x3073, 0x3072, 0x3099, true},
+        {0x3074, 0x3072, 0x309A, true}, {0x3076, 0x3075, 0x3099, true}, {0x3077, 0x3075, 0x309A, true},
+        {0x3079, 0x3078, 0x3099, true}, {0x307A, 0x3078, 0x309A, true}, {0x307C, 0x307B, 0x3099, true},
+        {0x307D, 0x307B, 0x309A, true}, {0x3094, 0x3046, 0x3099, true}, {0x309E, 0x309D, 0x3099, true},
+        {0x30AC, 0x30AB, 0x3099, true}, {0x30AE, 0x30AD, 0x3099, true}, {0x30B0, 0x30AF, 0x3099, true},
+        {0x30B2, 0x30B1, 0x3099, true}, {0x30B4, 0x30B3, 0x3099, true}, {0x30B6, 0x30B5, 0x3099, true},
+        {0x30B8, 0x30B7, 0x3099, true}, {0x30BA, 0x30B9, 0x3099, true}, {0x30BC, 0x30BB, 0x3099, true},
+        {0x30BE, 0x30BD, 0x3099, true}, {0x30C0, 0x30BF, 0x3099, true}, {0x30C2, 0x30C1, 0x3099, true},
+        {0x30C5, 0x30C4, 0x3099, true}, {0x30C7, 0x30C6, 0x3099, true}, {0x30C9, 0x30C8, 0x3099, true},
+        {0x30D0, 0x30CF, 0x3099, true}, {0x30D1, 0x30CF, 0x309A, true}, {0x30D3, 0x30D2, 0x3099, true},
+        {0x30D4, 0x30D2, 0x309A, true}, {0x30D6, 0x30D5, 0x3099, true}, {0x30D7, 0x30D5, 0x309A, true},
+        {0x30D9, 0x30D8, 0x3099, true}, {0x30DA, 0x30D8, 0x309A, true}, {0x30DC, 0x30DB, 0x3099, true},
+        {0x30DD, 0x30DB, 0x309A, true}, {0x30F4, 0x30A6, 0x3099, true}, {0x30F7, 0x30EF, 0x3099, true},
+        {0x30F8, 0x30F0, 0x3099, true}, {0x30F9, 0x30F1, 0x3099, true}, {0x30FA, 0x30F2, 0x3099, true},
+        {0x30FE, 0x30FD, 0x3099, true},
+    };
+
+    // Combining marks that can join the preceding letter
+    bool isCombining(uint32_t cp) {
+        return (cp >= 0x0300 && cp <= 0x036F) || cp == 0x3099 || cp == 0x309A;
+    }
+
+    // Marks dropped when stripping diacritics (the kana voicing marks change
+    // the sound, not the accent, and stay)
+    bool isDiacritic(uint32_t cp) {
+        return (cp >= 0x0300 && cp <= 0x036F) || (cp >= 0x1AB0 && cp <= 0x1AFF) ||
+               (cp >= 0x1DC0 && cp <= 0x1DFF) || (cp >= 0x20D0 && cp <= 0x20FF) ||
+               (cp >= 0xFE20 && cp <= 0xFE2F);
+    }
+
+    bool isKana(uint32_t cp) {
+        return cp >= 0x3040 && cp <= 0x30FF;
+    }
+
+    const FoldExpansion* findExpansion(uint32_t cp) {
+        auto it = std::lower_bound(std::begin(FOLD_EXPANSIONS), std::end(FOLD_EXPANSIONS), cp,
+                                   [](const FoldExpansion& e, uint32_t c) { return e.codePoint < c; });
+        return it != std::end(FOLD_EXPANSIONS) && it->codePoint == cp ? it : nullptr;
+    }
+
+    uint32_t foldSingle(uint32_t cp) {
+        auto it = std::upper_bound(std::begin(FOLD_RUNS), std::end(FOLD_RUNS), cp,
+                                   [](uint32_t c, const FoldRun& run) { return c < run.first; });
+        if (it == std::begin(FOLD_RUNS)) return cp;
+        --it;
+        if (cp > it->last || (cp - it->first) % it->stride != 0) return cp;
+        return (uint32_t)((int32_t)cp + it->delta);
+    }
+
+    const Decomposition* findDecomposition(uint32_t cp) {
+        auto it = std::lower_bound(std::begin(DECOMPOSITIONS), std::end(DECOMPOSITIONS), cp,
+                                   [](const Decomposition& d, uint32_t c) { return d.composed < c; });
+        return it != std::end(DECOMPOSITIONS) && it->composed == cp ? it : nullptr;
+    }
+
+    // Composed letter for base + mark, or 0
+    uint32_t compose(uint32_t base, uint32_t mark) {
+        static const std::vector<std::pair<uint32_t, uint16_t>> pairs = [] {
+            std::vector<std::pair<uint32_t, uint16_t>> built;
+            for (const auto& d : DECOMPOSITIONS) {
+                if (d.composes) built.push_back(std::make_pair(((uint32_t)d.base << 16) | d.mark, d.composed));
+            }
+            std::sort(built.begin(), built.end());
+            return built;
+        }();
+
+        if (base > 0xFFFF || mark > 0xFFFF) return 0;
+        uint32_t key = (base << 16) | mark;
+        auto it = std::lower_bound(pairs.begin(), pairs.end(), key,
+                                   [](const std::pair<uint32_t, uint16_t>& p, uint32_t k) { return p.first < k; });
+        return it != pairs.end() && it->first == key ? it->second : 0;
+    }
+
+    // Hangul syllables compose algorithmically: leading + vowel jamo, then
+    // an optional trailing jamo (the halfwidth jamo fold to these)
+    uint32_t composeHangul(uint32_t first, uint32_t second) {
+        const uint32_t SYLLABLE_BASE = 0xAC00, LEADING_BASE = 0x1100, VOWEL_BASE = 0x1161, TRAILING_BASE = 0x11A7;
+        const uint32_t VOWELS = 21, TRAILINGS = 28, SYLLABLES = 11172;
+        if (first >= LEADING_BASE && first < LEADING_BASE + 19 && second >= VOWEL_BASE && second < VOWEL_BASE + VOWELS) {
+            return SYLLABLE_BASE + ((first - LEADING_BASE) * VOWELS + (second - VOWEL_BASE)) * TRAILINGS;
+        }
+        if (first >= SYLLABLE_BASE && first < SYLLABLE_BASE + SYLLABLES && (first - SYLLABLE_BASE) % TRAILINGS == 0 &&
+            second > TRAILING_BASE && second < TRAILING_BASE + TRAILINGS) {
+            return first + (second - TRAILING_BASE);
+        }
+        return 0;
+    }
+
+    // Decode one UTF-8 sequence; returns its length, or 0 if invalid
+    size_t decode(const unsigned char* p, size_t available, uint32_t& cp) {
+        unsigned char lead = p[0];
+        size_t length;
+        uint32_t minimum;
+        if (lead < 0x80) {
+            cp = lead;
+            return 1;
+        } else if ((lead & 0xE0) == 0xC0) {
+            length = 2;
+            cp = lead & 0x1F;
+            minimum = 0x80;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 3;
+            cp = lead & 0x0F;
+            minimum = 0x800;
+        } else if ((lead & 0xF8) == 0xF0) {
+            length = 4;
+            cp = lead & 0x07;
+            minimum = 0x10000;
+        } else {
+            return 0;
+        }
+
+        if (length > available) return 0;
+        for (size_t i = 1; i < length; ++i) {
+            if ((p[i] & 0xC0) != 0x80) return 0;
+            cp = (cp << 6) | (p[i] & 0x3F);
+        }
+        if (cp < minimum || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return 0;
+        return length;
+    }
+
+    size_t encode(uint32_t cp, char* out) {
+        if (cp < 0x80) {
+            out[0] = (char)cp;
+            return 1;
+        }
+        if (cp < 0x800) {
+            out[0] = (char)(0xC0 | (cp >> 6));
+            out[1] = (char)(0x80 | (cp & 0x3F));
+            return 2;
+        }
+        if (cp < 0x10000) {
+            out[0] = (char)(0xE0 | (cp >> 12));
+            out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+            out[2] = (char)(0x80 | (cp & 0x3F));
+            return 3;
+        }
+        out[0] = (char)(0xF0 | (cp >> 18));
+        out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (cp & 0x3F));
+        return 4;
+    }
+
+    struct StringSink {
+        std::string& out;
+
+        bool write(const char* bytes, size_t count) {
+            out.append(bytes, count);
+            return true;
+        }
+    };
+
+    struct BufferSink {
+        char* out;
+        size_t capacity;
+        size_t length;
+
+        bool write(const char* bytes, size_t count) {
+            if (count > capacity - length) return false;
+            std::copy(bytes, bytes + count, out + length);
+            length += count;
+            return true;
+        }
+    };
+
+    // Streams code points through folding, optional stripping and
+    // composition; a letter is held back until the marks after it are seen
+    template <typename Sink>
+    class Folder {
+    public:
+        Folder(Sink& sink, bool stripDiacritics)
+            : sink(sink), stripDiacritics(stripDiacritics), starter(0), hasStarter(false), markCount(0), full(false) {
+        }
+
+        void feed(const char* text, size_t length) {
+            const unsigned char* p = (const unsigned char*)text;
+            size_t i = 0;
+            while (i < length && !full) {
+                uint32_t cp;
+                size_t size = decode(p + i, length - i, cp);
+                if (size == 0) {
+                    flush();
+                    if (!full && !sink.write(text + i, 1)) full = true;
+                    ++i;
+                    continue;
+                }
+                i += size;
+
+                if (cp < 0x80) {
+                    push(cp >= 'A' && cp <= 'Z' ? cp - 'A' + 'a' : cp);
+                } else if (const FoldExpansion* expansion = findExpansion(cp)) {
+                    const unsigned char* folded = (const unsigned char*)expansion->folded;
+                    size_t remaining = std::char_traits<char>::length(expansion->folded);
+                    while (remaining > 0) {
+                        uint32_t part;
+                        size_t partSize = decode(folded, remaining, part);
+                        push(part);
+                        folded += partSize;
+                        remaining -= partSize;
+                    }
+                } else {
+                    push(foldSingle(cp));
+                }
+            }
+            flush();
+        }
+
+    private:
+        static const size_t MAX_MARKS = 8;
+
+        Sink& sink;
+        bool stripDiacritics;
+        uint32_t starter;
+        bool hasStarter;
+        uint32_t marks[MAX_MARKS];
+        size_t markCount;
+        bool full;
+
+        // Marks are composed in the order given (no canonical reordering of
+        // stacked marks); real text puts them in order
+        void push(uint32_t cp) {
+            if (stripDiacritics) {
+                if (isDiacritic(cp)) return;
+                if (!isKana(cp)) {
+                    while (const Decomposition* d = findDecomposition(cp)) cp = d->base;
+                }
+            }
+
+            if (isCombining(cp) && hasStarter) {
+                // Only a mark right after the letter joins it; later marks
+                // could be blocked and are kept as they are
+                if (markCount == 0) {
+                    uint32_t composed = compose(starter, cp);
+                    if (composed) {
+                        starter = composed;
+                        return;
+                    }
+                }
+                if (markCount == MAX_MARKS) flush();
+                marks[markCount++] = cp;
+                return;
+            }
+
+            if (hasStarter && markCount == 0) {
+                uint32_t syllable = composeHangul(starter, cp);
+                if (syllable) {
+                    starter = syllable;
+                    return;
+                }
+            }
+
+            flush();
+            starter = cp;
+            hasStarter = true;
+        }
+
+        void flush() {
+            if (hasStarter) emit(starter);
+            for (size_t i = 0; i < markCount; ++i) emit(marks[i]);
+            hasStarter = false;
+            markCount = 0;
+        }
+
+        void emit(uint32_t cp) {
+            if (full) return;
+            char bytes[4];
+            if (!sink.write(bytes, encode(cp, bytes))) full = true;
+        }
+    };
+}
+
+std::string TextFold::fold(const std::string& text, bool stripDiacritics) {
+    std::string folded;
+    folded.reserve(text.size());
+
+    // Plain ASCII only needs lowercasing
+    bool ascii = true;
+    for (char c : text) {
+        if ((unsigned char)c >= 0x80) {
+            ascii = false;
+            break;
+        }
+    }
+    if (ascii) {
+        for (char c : text) {
+            folded += (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+        }
+        return folded;
+    }
+
+    StringSink sink{folded};
+    Folder<StringSink> folder(sink, stripDiacritics);
+    folder.feed(text.data(), text.size());
+    return folded;
+}
+
+size_t TextFold::fold(const char* text, size_t length, char* out, size_t capacity, bool stripDiacritics) {
+    if (!text || !out) return 0;
+    BufferSink sink{out, capacity, 0};
+    Folder<BufferSink> folder(sink, stripDiacritics);
+    folder.feed(text, length);
+    return sink.length;
+}
@@ -0,0 +1,112 @@
+#include "TextSearch.hpp"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TEXTSEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    typedef size_t (*Kernel)(const char*, size_t, const char*, size_t);
+
+    // Candidates come from first/last byte matches; check the bytes between
+    inline bool matchesAt(const char* at, const char* needle, size_t needleLength) {
+        return needleLength <= 2 || std::memcmp(at + 1, needle + 1, needleLength - 2) == 0;
+    }
+
+    size_t scalarFrom(const char* haystack, size_t length, size_t start, const char* needle, size_t needleLength) {
+        const char first = needle[0];
+        const char last = needle[needleLength - 1];
+        for (size_t i = start; i + needleLength <= length; ++i) {
+            const void* hit = std::memchr(haystack + i, first, length - needleLength + 1 - i);
+            if (!hit) return TextSearch::npos;
+            i = (size_t)((const char*)hit - haystack);
+            if (haystack[i + needleLength - 1] == last && matchesAt(haystack + i, needle, needleLength)) return i;
+        }
+        return TextSearch::npos;
+    }
+
+    size_t scalarKernel(const char* haystack, size_t length, const char* needle, size_t needleLength) {
+        return scalarFrom(haystack, length, 0, needle, needleLength);
+    }
+
+#ifdef TEXTSEARCH_X86
+    size_t sse2Kernel(const char* haystack, size_t length, const char* needle, size_t needleLength) {
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[needleLength - 1]);
+
+        size_t i = 0;
+        for (; i + needleLength - 1 + 16 <= length; i += 16) {
+            __m128i blockFirst = _mm_loadu_si128((const __m128i*)(haystack + i));
+            __m128i blockLast = _mm_loadu_si128((const __m128i*)(haystack + i + needleLength - 1));
+            unsigned mask = (unsigned)_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last)));
+            while (mask) {
+                unsigned bit = (unsigned)__builtin_ctz(mask);
+                if (matchesAt(haystack + i + bit, needle, needleLength)) return i + bit;
+                mask &= mask - 1;
+            }
+        }
+        return scalarFrom(haystack, length, i, needle, needleLength);
+    }
+
+    __attribute__((target("avx2")))
+    size_t avx2Kernel(const char* haystack, size_t length, const char* needle, size_t needleLength) {
+        const __m256i first = _mm256_set1_epi8(needle[0]);
+        const __m256i last = _mm256_set1_epi8(needle[needleLength - 1]);
+
+        size_t i = 0;
+        for (; i + needleLength - 1 + 32 <= length; i += 32) {
+            __m256i blockFirst = _mm256_loadu_si256((const __m256i*)(haystack + i));
+            __m256i blockLast = _mm256_loadu_si256((const __m256i*)(haystack + i + needleLength - 1));
+            unsigned mask = (unsigned)_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last)));
+            while (mask) {
+                unsigned bit = (unsigned)__builtin_ctz(mask);
+                if (matchesAt(haystack + i + bit, needle, needleLength)) return i + bit;
+                mask &= mask - 1;
+            }
+        }
+        return scalarFrom(haystack, length, i, needle, needleLength);
+    }
+#endif
+
+    struct Selection {
+        Kernel kernel;
+        const char* name;
+    };
+
+    Selection select() {
+#ifdef TEXTSEARCH_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return Selection{avx2Kernel, "avx2"};
+        if (__builtin_cpu_supports("sse2")) return Selection{sse2Kernel, "sse2"};
+#endif
+        return Selection{scalarKernel, "scalar"};
+    }
+
+    const Selection& selected() {
+        static const Selection selection = select();
+        return selection;
+    }
+}
+
+size_t TextSearch::find(const char* haystack, size_t length, const char* needle, size_t needleLength) {
+    if (needleLength == 0) return 0;
+    if (needleLength > length) return npos;
+    if (needleLength == 1) {
+        const void* hit = std::memchr(haystack, needle[0], length);
+        return hit ? (size_t)((const char*)hit - haystack) : npos;
+    }
+    return selected().kernel(haystack, length, needle, needleLength);
+}
+
+size_t TextSearch::findScalar(const char* haystack, size_t length, const char* needle, size_t needleLength) {
+    if (needleLength == 0) return 0;
+    if (needleLength > length) return npos;
+    return scalarKernel(haystack, length, needle, needleLength);
+}
+
+const char* TextSearch::kernelName() {
+    return selected().name;
+}
@@ -0,0 +1,235 @@
+#include "TrendingTracker.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    const double WINDOW_SECONDS[TrendingTracker::WINDOW_COUNT] = {
+        60.0 * 60.0,
+        24.0 * 60.0 * 60.0,
+        7.0 * 24.0 * 60.0 * 60.0
+    };
+
+    // Rescale a summary once its newest weights reach e^RESCALE_AFTER
+    const double RESCALE_AFTER = 200.0;
+
+    char foldByte(char c) {
+        return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+    }
+
+    // Compare a stored (truncated) field with its source string
+    bool sameField(const char* stored, const std::string& text) {
+        size_t length = std::min(text.size(), (size_t)TrendingTracker::FIELD_SIZE - 1);
+        for (size_t i = 0; i < length; ++i) {
+            if (stored[i] == '\0' || foldByte(stored[i]) != foldByte(text[i])) return false;
+        }
+        return stored[length] == '\0';
+    }
+
+    void copyField(char* dest, const std::string& src) {
+        size_t length = std::min(src.size(), (size_t)TrendingTracker::FIELD_SIZE - 1);
+        std::memcpy(dest, src.data(), length);
+        dest[length] = '\0';
+    }
+
+    // FNV-1a over the folded bytes
+    uint64_t hashField(uint64_t hash, const std::string& text) {
+        size_t length = std::min(text.size(), (size_t)TrendingTracker::FIELD_SIZE - 1);
+        for (size_t i = 0; i < length; ++i) {
+            hash ^= (unsigned char)foldByte(text[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
+TrendingTracker& TrendingTracker::instance() {
+    static TrendingTracker tracker;
+    return tracker;
+}
+
+TrendingTracker::TrendingTracker() : plays(0) {
+    for (int w = 0; w < WINDOW_COUNT; ++w) {
+        summaries[w].lifetime = WINDOW_SECONDS[w];
+        reset(summaries[w]);
+    }
+}
+
+void TrendingTracker::reset(Summary& summary) {
+    summary.landmark = 0;
+    summary.used = 0;
+    std::fill(summary.table, summary.table + TABLE_SIZE, -1);
+}
+
+void TrendingTracker::record(const std::string& title, const std::string& artist, int duration, int64_t timestamp) {
+    if (title.empty()) return;
+    uint64_t hash = hashOf(title, artist);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int w = 0; w < WINDOW_COUNT; ++w) {
+        add(summaries[w], title, artist, duration, hash, timestamp);
+    }
+    ++plays;
+}
+
+std::vector<TrendingTracker::Entry> TrendingTracker::top(Window window, size_t limit, int64_t now) const {
+    std::vector<Entry> entries;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const Summary& summary = summaries[window];
+    double scale = std::exp(-(double)(now - summary.landmark) / summary.lifetime);
+
+    entries.reserve(summary.used);
+    for (int i = 0; i < summary.used; ++i) {
+        const Counter& counter = summary.counters[i];
+        entries.push_back(Entry{counter.title, counter.artist, counter.duration,
+                                counter.count * scale, counter.error * scale});
+    }
+
+    size_t count = std::min(limit, entries.size());
+    std::partial_sort(entries.begin(), entries.begin() + count, entries.end(), [](const Entry& a, const Entry& b) {
+        return a.plays > b.plays;
+    });
+    entries.resize(count);
+    return entries;
+}
+
+uint64_t TrendingTracker::getPlayCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return plays;
+}
+
+void TrendingTracker::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int w = 0; w < WINDOW_COUNT; ++w) {
+        reset(summaries[w]);
+    }
+    plays = 0;
+}
+
+uint64_t TrendingTracker::hashOf(const std::string& title, const std::string& artist) {
+    uint64_t hash = hashField(14695981039346656037ULL, title);
+    hash ^= 0x1f;
+    hash *= 1099511628211ULL;
+    return hashField(hash, artist);
+}
+
+int TrendingTracker::find(const Summary& summary, uint64_t hash, const std::string& title, const std::string& artist) {
+    for (size_t i = hash & (TABLE_SIZE - 1); ; i = (i + 1) & (TABLE_SIZE - 1)) {
+        int slot = summary.table[i];
+        if (slot < 0) return -1;
+        const Counter& counter = summary.counters[slot];
+        if (counter.hash == hash && sameField(counter.title, title) && sameField(counter.artist, artist)) {
+            return slot;
+        }
+    }
+}
+
+void TrendingTracker::tableInsert(Summary& summary, int slot) {
+    size_t i = summary.counters[slot].hash & (TABLE_SIZE - 1);
+    while (summary.table[i] >= 0) {
+        i = (i + 1) & (TABLE_SIZE - 1);
+    }
+    summary.table[i] = slot;
+}
+
+void TrendingTracker::tableErase(Summary& summary, int slot) {
+    size_t hole = summary.counters[slot].hash & (TABLE_SIZE - 1);
+    while (summary.table[hole] != slot) {
+        hole = (hole + 1) & (TABLE_SIZE - 1);
+    }
+
+    // Backward shift: pull later entries of the probe run into the hole
+    // unless their home position lies cyclically after it
+    for (size_t next = (hole + 1) & (TABLE_SIZE - 1); summary.table[next] >= 0;
+         next = (next + 1) & (TABLE_SIZE - 1)) {
+        size_t home = summary.counters[summary.table[next]].hash & (TABLE_SIZE - 1);
+        size_t fromHome = (next - home) & (TABLE_SIZE - 1);
+        size_t fromHole = (next - hole) & (TABLE_SIZE - 1);
+        if (fromHome >= fromHole) {
+            summary.table[hole] = summary.table[next];
+            hole = next;
+        }
+    }
+    summary.table[hole] = -1;
+}
+
+void TrendingTracker::siftDown(Summary& summary, int i) {
+    int* heap = summary.heap;
+    const Counter* counters = summary.counters;
+    while (true) {
+        int smallest = i;
+        int left = 2 * i + 1, right = left + 1;
+        if (left < summary.used && counters[heap[left]].count < counters[heap[smallest]].count) smallest = left;
+        if (right < summary.used && counters[heap[right]].count < counters[heap[smallest]].count) smallest = right;
+        if (smallest == i) return;
+        std::swap(heap[i], heap[smallest]);
+        summary.position[heap[i]] = i;
+        summary.position[heap[smallest]] = smallest;
+        i = smallest;
+    }
+}
+
+void TrendingTracker::siftUp(Summary& summary, int i) {
+    int* heap = summary.heap;
+    const Counter* counters = summary.counters;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (counters[heap[parent]].count <= counters[heap[i]].count) return;
+        std::swap(heap[i], heap[parent]);
+        summary.position[heap[i]] = i;
+        summary.position[heap[parent]] = parent;
+        i = parent;
+    }
+}
+
+void TrendingTracker::add(Summary& summary, const std::string& title, const std::string& artist, int duration,
+                          uint64_t hash, int64_t timestamp) {
+    if (summary.used == 0) {
+        summary.landmark = timestamp;
+    }
+
+    // Keep weights finite: move the landmark forward, scaling every counter
+    double age = (double)(timestamp - summary.landmark) / summary.lifetime;
+    if (age > RESCALE_AFTER) {
+        double scale = std::exp(-age);
+        for (int i = 0; i < summary.used; ++i) {
+            summary.counters[i].count *= scale;
+            summary.counters[i].error *= scale;
+        }
+        summary.landmark = timestamp;
+        age = 0.0;
+    }
+    double weight = std::exp(age);
+
+    int slot = find(summary, hash, title, artist);
+    if (slot >= 0) {
+        summary.counters[slot].count += weight;
+        siftDown(summary, summary.position[slot]);
+        return;
+    }
+
+    double inherited = 0.0;
+    if (summary.used < CAPACITY) {
+        slot = summary.used++;
+        summary.heap[slot] = slot;
+        summary.position[slot] = slot;
+    } else {
+        // Replace the least played track; its count becomes our error bound
+        slot = summary.heap[0];
+        inherited = summary.counters[slot].count;
+        tableErase(summary, slot);
+    }
+
+    Counter& counter = summary.counters[slot];
+    copyField(counter.title, title);
+    copyField(counter.artist, artist);
+    counter.duration = duration;
+    counter.hash = hash;
+    counter.count = inherited + weight;
+    counter.error = inherited;
+    tableInsert(summary, slot);
+
+    siftUp(summary, summary.position[slot]);
+    siftDown(summary, summary.position[slot]);
+}
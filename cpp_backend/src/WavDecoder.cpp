@@ -0,0 +1,267 @@
+#include "WavDecoder.hpp"
+#include "SystemManager.hpp"
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <cstdlib>
+
+namespace {
+    const uint16_t FORMAT_PCM = 0x0001;
+    const uint16_t FORMAT_IEEE_FLOAT = 0x0003;
+    const uint16_t FORMAT_EXTENSIBLE = 0xFFFE;
+
+    uint16_t readU16(const unsigned char* p) {
+        return (uint16_t)(p[0] | (p[1] << 8));
+    }
+
+    uint32_t readU32(const unsigned char* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    // ID3v2 sizes are big endian, and "synchsafe" (7 bits per byte) in v2.4
+    uint32_t readU32BE(const unsigned char* p) {
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+    }
+
+    uint32_t readSynchsafe(const unsigned char* p) {
+        return ((uint32_t)(p[0] & 0x7F) << 21) | ((uint32_t)(p[1] & 0x7F) << 14) |
+               ((uint32_t)(p[2] & 0x7F) << 7) | (uint32_t)(p[3] & 0x7F);
+    }
+
+    // ID3 text as ASCII (the tag we want is hex digits); UTF-16 is narrowed
+    std::string id3Text(const unsigned char* p, size_t n, int encoding) {
+        if (encoding == 0 || encoding == 3) return std::string((const char*)p, n);
+
+        std::string text;
+        bool bigEndian = encoding == 2;
+        for (size_t i = 0; i + 1 < n; i += 2) {
+            unsigned unit = bigEndian ? (p[i] << 8 | p[i + 1]) : (p[i] | p[i + 1] << 8);
+            if (unit == 0xFEFF) continue;                               // byte order mark
+            if (unit == 0xFFFE) { bigEndian = !bigEndian; continue; }   // mark in the other order
+            text += unit < 0x80 ? (char)unit : '?';
+        }
+        return text;
+    }
+
+    // Tags with cover art can be large; the gapless comment never is
+    const uint32_t MAX_TAG_BYTES = 4 << 20;
+}
+
+WavDecoder::WavDecoder()
+    : format{0, 0}, encoding(INTEGER), bitsPerSample(0), blockAlign(0),
+      dataOffset(0), delay(0), padding(0), length(0), position(0) {
+}
+
+std::unique_ptr<WavDecoder> WavDecoder::open(const std::string& path) {
+    std::unique_ptr<WavDecoder> decoder(new WavDecoder());
+    decoder->path = path;
+    try {
+        decoder->parse();
+        return decoder;
+    } catch (const std::exception& e) {
+        SystemManager::logError("Cannot decode " + path + ": " + e.what());
+        return nullptr;
+    }
+}
+
+void WavDecoder::parse() {
+    file.open(std::filesystem::u8path(path), std::ios::binary);
+    if (!file.is_open()) {
+        throw SystemException("cannot open file");
+    }
+    file.seekg(0, std::ios::end);
+    uint64_t fileSize = (uint64_t)file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    unsigned char header[12];
+    if (!file.read((char*)header, sizeof(header)) ||
+        std::memcmp(header, "RIFF", 4) != 0 || std::memcmp(header + 8, "WAVE", 4) != 0) {
+        throw SystemException("not a RIFF/WAVE file");
+    }
+
+    bool haveFormat = false;
+    bool haveData = false;
+    uint64_t dataSize = 0;
+    std::vector<unsigned char> tag;
+    unsigned char chunk[8];
+    // Read every chunk: tags often come after the sample data
+    while (file.read((char*)chunk, sizeof(chunk))) {
+        uint32_t size = readU32(chunk + 4);
+        uint64_t start = (uint64_t)file.tellg();
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            unsigned char fmt[40] = {};
+            if (size < 16 || !file.read((char*)fmt, std::min<uint32_t>(size, sizeof(fmt)))) {
+                throw SystemException("truncated fmt chunk");
+            }
+            uint16_t formatTag = readU16(fmt);
+            if (formatTag == FORMAT_EXTENSIBLE && size >= 40) {
+                formatTag = readU16(fmt + 24); // first two bytes of the sub-format GUID
+            }
+            format.channels = readU16(fmt + 2);
+            format.sampleRate = (int)readU32(fmt + 4);
+            blockAlign = readU16(fmt + 12);
+            bitsPerSample = readU16(fmt + 14);
+
+            if (formatTag == FORMAT_PCM && bitsPerSample >= 8 && bitsPerSample <= 32 && bitsPerSample % 8 == 0) {
+                encoding = INTEGER;
+            } else if (formatTag == FORMAT_IEEE_FLOAT && (bitsPerSample == 32 || bitsPerSample == 64)) {
+                encoding = FLOAT;
+            } else {
+                throw SystemException("unsupported encoding (format " + std::to_string(formatTag) +
+                                      ", " + std::to_string(bitsPerSample) + " bits)");
+            }
+            if (format.channels < 1 || format.sampleRate < 1 ||
+                blockAlign != format.channels * (bitsPerSample / 8)) {
+                throw SystemException("inconsistent fmt chunk");
+            }
+            haveFormat = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            dataOffset = start;
+            haveData = true;
+            // Streaming writers leave the size at 0 or 0xFFFFFFFF: the samples
+            // run to the end of the file, and reading on would take sample
+            // bytes for chunk headers (a stray "fmt " or "id3 ")
+            if (size == 0 || size == 0xFFFFFFFF || start + size > fileSize) {
+                dataSize = fileSize - start;
+                break;
+            }
+            dataSize = size;
+        } else if ((std::memcmp(chunk, "id3 ", 4) == 0 || std::memcmp(chunk, "ID3 ", 4) == 0) &&
+                   size <= MAX_TAG_BYTES) {
+            tag.resize(size);
+            if (!file.read((char*)tag.data(), size)) tag.clear();
+        }
+
+        // Chunks are word aligned
+        file.clear();
+        file.seekg((std::streamoff)(start + size + (size & 1)), std::ios::beg);
+    }
+
+    if (!haveFormat) throw SystemException("missing fmt chunk");
+    if (!haveData) throw SystemException("missing data chunk");
+
+    uint64_t frames = dataSize / blockAlign;
+    parseGaplessTag(tag, frames);
+    length = frames - delay - padding;
+    seek(0);
+}
+
+void WavDecoder::parseGaplessTag(const std::vector<unsigned char>& tag, uint64_t frames) {
+    if (tag.size() < 10 || std::memcmp(tag.data(), "ID3", 3) != 0) return;
+    int version = tag[3];
+    if (version != 3 && version != 4) return;
+
+    size_t end = std::min<size_t>(tag.size(), 10 + (size_t)readSynchsafe(&tag[6]));
+    size_t at = 10;
+    if (tag[5] & 0x40) { // extended header
+        if (at + 4 > end) return;
+        at += version == 4 ? readSynchsafe(&tag[at]) : readU32BE(&tag[at]) + 4;
+    }
+
+    while (at + 10 <= end && tag[at] != 0) {
+        size_t size = version == 4 ? readSynchsafe(&tag[at + 4]) : readU32BE(&tag[at + 4]);
+        if (size > end - at - 10) break;
+        const unsigned char* body = &tag[at + 10];
+
+        // COMM: encoding, language, description \0 text
+        if (std::memcmp(&tag[at], "COMM", 4) == 0 && size > 4) {
+            std::string text = id3Text(body + 4, size - 4, body[0]);
+            size_t split = text.find('\0');
+            if (split != std::string::npos && text.compare(0, split, "iTunSMPB") == 0) {
+                std::istringstream fields(text.substr(split + 1));
+                std::string zero, delayHex, paddingHex, originalHex;
+                fields >> zero >> delayHex >> paddingHex >> originalHex;
+                uint64_t tagDelay = std::strtoull(delayHex.c_str(), nullptr, 16);
+                uint64_t tagPadding = std::strtoull(paddingHex.c_str(), nullptr, 16);
+                uint64_t original = std::strtoull(originalHex.c_str(), nullptr, 16);
+                if (tagDelay + tagPadding < frames) {
+                    delay = tagDelay;
+                    padding = tagPadding;
+                    // The original length is exact where padding is sometimes rounded
+                    if (original > 0 && delay + original <= frames) padding = frames - delay - original;
+                }
+                return;
+            }
+        }
+        at += 10 + size;
+    }
+}
+
+void WavDecoder::prefetch() {
+    std::ifstream ahead(std::filesystem::u8path(path), std::ios::binary);
+    if (!ahead.is_open()) return;
+    ahead.seekg((std::streamoff)(dataOffset + (delay + position) * blockAlign), std::ios::beg);
+
+    std::vector<char> buffer(64 * 1024);
+    size_t total = 0;
+    while (total < PREFETCH_BYTES && ahead.read(buffer.data(), buffer.size())) {
+        total += buffer.size();
+    }
+}
+
+size_t WavDecoder::read(float* out, size_t frames) {
+    frames = (size_t)std::min<uint64_t>(frames, length - position);
+    if (frames == 0) return 0;
+
+    size_t bytes = frames * blockAlign;
+    if (raw.size() < bytes) raw.resize(bytes);
+    file.read((char*)raw.data(), bytes);
+
+    size_t got = (size_t)file.gcount() / blockAlign;
+    if (got < frames) {
+        // File is shorter than its header claimed
+        length = position + got;
+    }
+    convert(raw.data(), out, got * format.channels);
+    position += got;
+    return got;
+}
+
+bool WavDecoder::seek(uint64_t frame) {
+    position = std::min(frame, length);
+    file.clear();
+    file.seekg((std::streamoff)(dataOffset + (delay + position) * blockAlign), std::ios::beg);
+    return (bool)file;
+}
+
+void WavDecoder::convert(const unsigned char* in, float* out, size_t count) const {
+    if (encoding == FLOAT) {
+        if (bitsPerSample == 32) {
+            std::memcpy(out, in, count * sizeof(float));
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                double sample;
+                std::memcpy(&sample, in + i * 8, sizeof(sample));
+                out[i] = (float)sample;
+            }
+        }
+        return;
+    }
+
+    switch (bitsPerSample) {
+    case 8: // unsigned
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = ((int)in[i] - 128) * (1.0f / 128);
+        }
+        break;
+    case 16:
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = (int16_t)readU16(in + i * 2) * (1.0f / 32768);
+        }
+        break;
+    case 24:
+        for (size_t i = 0; i < count; ++i) {
+            const unsigned char* p = in + i * 3;
+            int32_t sample = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8;
+            out[i] = sample * (1.0f / 8388608);
+        }
+        break;
+    case 32:
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = (int32_t)readU32(in + i * 4) * (1.0f / 2147483648.0f);
+        }
+        break;
+    }
+}
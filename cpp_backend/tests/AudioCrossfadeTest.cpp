@@ -0,0 +1,147 @@
+#include "Test.hpp"
+#include "AudioEngine.hpp"
+#include "AudioMixer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * AudioCrossfadeTest - Crossfades render sample-exact
+ * A track queued on time fades over the full crossfade; one queued after
+ * the fade should have started fades over what is left of the outgoing
+ * track, with the incoming one from its first frame and both gains
+ * starting where they stood (no skipped frames, no step).
+ */
+
+namespace {
+    const int RATE = 48000;
+    const int CHANNELS = 2;
+
+    // Deterministic samples, different per track
+    float sampleOf(int seed, uint64_t frame, int channel) {
+        return (float)(((frame * 2 + channel) * 7919 + seed * 104729) % 60000) / 30000.0f - 1.0f;
+    }
+
+    class PatternSource : public AudioSource {
+    public:
+        PatternSource(int seed, uint64_t length) : seed(seed), length(length), position(0) {}
+
+        AudioFormat getFormat() const override { return {RATE, CHANNELS}; }
+        uint64_t getLength() const override { return length; }
+
+        size_t read(float* out, size_t frames) override {
+            size_t count = (size_t)std::min<uint64_t>(frames, length - position);
+            for (size_t i = 0; i < count; ++i) {
+                for (int c = 0; c < CHANNELS; ++c) out[i * CHANNELS + c] = sampleOf(seed, position + i, c);
+            }
+            position += count;
+            return count;
+        }
+
+        bool seek(uint64_t frame) override {
+            position = std::min(frame, length);
+            return true;
+        }
+
+    private:
+        int seed;
+        uint64_t length;
+        uint64_t position;
+    };
+
+    // Keeps every frame; write() holds back once allowance frames are in
+    class GatedSink : public AudioSink {
+    public:
+        std::atomic<uint64_t> allowance{0};
+
+        bool open(const AudioFormat&) override { return true; }
+        void close() override {}
+
+        bool write(const float* frames, size_t count) override {
+            while (received() >= allowance.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            samples.insert(samples.end(), frames, frames + count * CHANNELS);
+            return true;
+        }
+
+        uint64_t received() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return samples.size() / CHANNELS;
+        }
+
+        std::vector<float> take() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return samples;
+        }
+
+    private:
+        std::mutex mutex;
+        std::vector<float> samples;
+    };
+
+    /**
+     * Play a track of outgoing frames, queue one of incoming frames once
+     * queueAt frames have been rendered, and check the output against a
+     * crossfade of at most fade frames that starts no earlier than
+     * outgoing - fade. Returns the frame the fade started at (0 on failure)
+     */
+    uint64_t crossfade(uint64_t outgoing, uint64_t incoming, uint64_t fade, uint64_t queueAt) {
+        GatedSink* sink = new GatedSink();
+        sink->allowance = queueAt;
+        AudioEngine engine{std::unique_ptr<AudioSink>(sink)};
+        engine.setCrossfade((double)fade / RATE);
+        engine.play(std::unique_ptr<AudioSource>(new PatternSource(1, outgoing)));
+        bool queued = Test::waitFor([sink, queueAt] { return sink->received() >= queueAt; }, 5000) &&
+                      engine.queueNext(std::unique_ptr<AudioSource>(new PatternSource(2, incoming)));
+        sink->allowance = (uint64_t)-1;
+        CHECK(queued);
+        if (!queued || !Test::waitFor([&engine] { return engine.getState() == AudioEngine::ENDED; }, 10000)) return 0;
+
+        // The overlap is what the output is short of both tracks back to back
+        std::vector<float> out = sink->take();
+        uint64_t frames = out.size() / CHANNELS;
+        CHECK(frames < outgoing + incoming && frames >= outgoing + incoming - fade);
+        if (frames >= outgoing + incoming || frames < outgoing + incoming - fade) return 0;
+        uint64_t length = outgoing + incoming - frames;
+        uint64_t start = outgoing - length;
+
+        double worst = 0.0;
+        for (uint64_t frame = 0; frame < frames; ++frame) {
+            for (int c = 0; c < CHANNELS; ++c) {
+                double expected;
+                if (frame < start) {
+                    expected = sampleOf(1, frame, c);
+                } else if (frame < outgoing) {
+                    uint64_t into = frame - start;
+                    float t = (float)into / (float)length;
+                    expected = sampleOf(1, frame, c) * AudioMixer::equalPowerGain(1.0f - t) +
+                               sampleOf(2, into, c) * AudioMixer::equalPowerGain(t);
+                } else {
+                    expected = sampleOf(2, frame - start, c);
+                }
+                worst = std::max(worst, std::fabs(expected - out[frame * CHANNELS + c]));
+            }
+        }
+        CHECK(worst < 1e-4);
+        return start;
+    }
+}
+
+int main() {
+    // Queued early: the fade takes the whole 1 s before the end
+    CHECK(crossfade(3 * RATE, 2 * RATE, RATE, RATE / 2) == 2 * (uint64_t)RATE);
+
+    // Queued at 1.8 s of a 3 s track with a 2 s fade: the decoder is past
+    // the 1 s mark already, so the fade covers what is left from there
+    uint64_t late = crossfade(3 * RATE, 2 * RATE, 2 * RATE, RATE * 18 / 10);
+    CHECK(late > (uint64_t)RATE && late < 3 * (uint64_t)RATE);
+
+    return Test::finish("AudioCrossfadeTest");
+}
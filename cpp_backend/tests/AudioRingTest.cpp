@@ -0,0 +1,181 @@
+#include "Test.hpp"
+#include "AudioRing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * AudioRingTest - The decoder-to-render ring under load
+ * Blocks must come out whole and in order while both sides back off at
+ * random and other threads contend for locks and memory, and neither
+ * side may ever wait for the other: with the peer stalled mid-block,
+ * calls keep returning (null when full or empty) straight away.
+ */
+
+namespace {
+    const size_t STRESS_BLOCKS = 200000;
+    const size_t BLOCK_FRAMES = 64;
+    const int CHANNELS = 2;
+
+    float sampleFor(uint64_t block, size_t index) {
+        return (float)((block * BLOCK_FRAMES * CHANNELS + index) % 1000003);
+    }
+
+    AudioRing::BlockInfo infoFor(uint64_t block) {
+        return AudioRing::BlockInfo{block, block / 1000, block * BLOCK_FRAMES, STRESS_BLOCKS * BLOCK_FRAMES,
+                                    {48000, CHANNELS}, (uint32_t)BLOCK_FRAMES, false, 0, 0, 0};
+    }
+
+    // Sometimes yield or sleep a little, the way a busy decoder or device would
+    void backOff(std::mt19937& rng) {
+        unsigned roll = rng() % 64;
+        if (roll == 0) std::this_thread::sleep_for(std::chrono::microseconds(rng() % 200));
+        else if (roll < 8) std::this_thread::yield();
+    }
+
+    // Longest single call of fn over calls calls, in microseconds
+    template <typename Fn>
+    double longestCall(Fn fn, int calls) {
+        double longest = 0.0;
+        for (int i = 0; i < calls; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            longest = std::max(longest, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        return longest;
+    }
+}
+
+int main() {
+    // Sizing and the empty / full edges
+    {
+        AudioRing ring(1000, 256, 2);
+        CHECK(ring.getBlockCount() == 4);
+        CHECK(ring.getCapacityFrames() == 1024);
+
+        AudioRing::BlockInfo info;
+        CHECK(ring.beginRead(info) == nullptr);
+        for (uint64_t i = 0; i < ring.getBlockCount(); ++i) {
+            float* slot = ring.beginWrite();
+            CHECK(slot != nullptr);
+            CHECK((uintptr_t)slot % AudioRing::CACHE_LINE == 0);
+            if (slot) ring.commitWrite(infoFor(i));
+        }
+        CHECK(ring.beginWrite() == nullptr);
+        CHECK(ring.size() == 4);
+
+        CHECK(ring.beginRead(info) != nullptr && info.track == 0);
+        ring.commitRead();
+        CHECK(ring.beginWrite() != nullptr);
+    }
+
+    // Producer and consumer at their own irregular pace, every sample checked,
+    // while other threads fight over a lock and the allocator
+    {
+        AudioRing ring(4096, BLOCK_FRAMES, CHANNELS);
+        std::atomic<bool> done(false);
+        std::vector<std::thread> noise;
+        std::mutex contended;
+        for (int i = 0; i < 2; ++i) {
+            noise.emplace_back([&done, &contended, i] {
+                std::mt19937 rng(10 + i);
+                while (!done.load(std::memory_order_relaxed)) {
+                    {
+                        std::lock_guard<std::mutex> lock(contended);
+                        std::string garbage(4096 + rng() % 65536, 'x');
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(rng() % 100));
+                }
+            });
+        }
+
+        std::thread producer([&ring] {
+            std::mt19937 rng(1);
+            for (uint64_t block = 0; block < STRESS_BLOCKS; ) {
+                float* slot = ring.beginWrite();
+                if (!slot) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (size_t i = 0; i < BLOCK_FRAMES * CHANNELS; ++i) slot[i] = sampleFor(block, i);
+                ring.commitWrite(infoFor(block));
+                block++;
+                backOff(rng);
+            }
+        });
+
+        std::mt19937 rng(2);
+        size_t corrupt = 0, outOfOrder = 0;
+        for (uint64_t block = 0; block < STRESS_BLOCKS; ) {
+            AudioRing::BlockInfo info;
+            const float* slot = ring.beginRead(info);
+            if (!slot) {
+                std::this_thread::yield();
+                continue;
+            }
+            AudioRing::BlockInfo expected = infoFor(block);
+            if (info.track != expected.track || info.epoch != expected.epoch ||
+                info.position != expected.position || info.frames != expected.frames) {
+                outOfOrder++;
+            }
+            for (size_t i = 0; i < BLOCK_FRAMES * CHANNELS; ++i) {
+                if (slot[i] != sampleFor(block, i)) corrupt++;
+            }
+            ring.commitRead();
+            block++;
+            backOff(rng);
+        }
+        producer.join();
+        done = true;
+        for (auto& thread : noise) thread.join();
+
+        CHECK(corrupt == 0);
+        CHECK(outOfOrder == 0);
+        CHECK(ring.size() == 0);
+    }
+
+    // A stalled consumer (holding a block) never blocks the producer, and a
+    // stalled producer (holding a slot) never blocks the consumer. Calls are
+    // timed one by one; 50 ms leaves room for preemption on a loaded machine
+    {
+        AudioRing ring(1024, BLOCK_FRAMES, CHANNELS);
+        std::atomic<int> phase(0);
+        std::thread consumer([&ring, &phase] {
+            AudioRing::BlockInfo info;
+            while (!ring.beginRead(info)) std::this_thread::yield();
+            phase = 1;      // holds the block without releasing it
+            while (phase.load() != 2) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            ring.commitRead();
+        });
+
+        CHECK(ring.beginWrite() != nullptr);
+        ring.commitWrite(infoFor(0));
+        while (phase.load() != 1) std::this_thread::yield();
+        uint64_t next = 1;
+        double producerLongest = longestCall([&ring, &next] {
+            if (ring.beginWrite()) ring.commitWrite(infoFor(next++));
+        }, 200000);
+        CHECK(ring.beginWrite() == nullptr);    // full, and said so instead of waiting
+        CHECK(producerLongest < 50000.0);
+        phase = 2;
+        consumer.join();
+
+        // Drain, then the consumer polls an empty ring while the producer sits on a slot
+        AudioRing::BlockInfo info;
+        while (ring.beginRead(info)) ring.commitRead();
+        CHECK(ring.beginWrite() != nullptr);
+        double consumerLongest = longestCall([&ring, &info] {
+            if (ring.beginRead(info)) ring.commitRead();
+        }, 200000);
+        CHECK(ring.beginRead(info) == nullptr);
+        CHECK(consumerLongest < 50000.0);
+        std::printf("longest call with the other side stalled: producer %.1f us, consumer %.1f us\n",
+                    producerLongest, consumerLongest);
+    }
+
+    return Test::finish("AudioRingTest");
+}
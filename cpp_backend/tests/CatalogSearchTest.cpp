@@ -0,0 +1,84 @@
+#include "Test.hpp"
+#include "Catalog.hpp"
+#include "CatalogGenerator.hpp"
+#include <cmath>
+#include <string>
+#include <vector>
+
+/**
+ * CatalogSearchTest - Ranked search order and pruning
+ * The popularity prior may only break near-ties, partial matches fill
+ * what all-word matches leave of the limit (and are flagged as such), and skipping tracks or
+ * blocks by their bounds never changes the result.
+ */
+
+namespace {
+    std::vector<std::string> titles(const Catalog& catalog, const std::vector<Catalog::ScoredMatch>& matches) {
+        std::vector<std::string> result;
+        for (const auto& match : matches) {
+            result.push_back(catalog.get(match.id).title);
+        }
+        return result;
+    }
+
+    // A small limit prunes with the heap threshold; a huge one scores everything
+    bool samePruned(const Catalog& catalog, const std::string& query, Catalog::Field field, size_t limit) {
+        std::vector<Catalog::ScoredMatch> pruned = catalog.rankedSearch(query, field, limit, Catalog::POPULARITY_PRIOR);
+        std::vector<Catalog::ScoredMatch> full = catalog.rankedSearch(query, field, (size_t)-1, Catalog::POPULARITY_PRIOR);
+        if (full.size() > limit) full.resize(limit);
+        if (pruned.size() != full.size()) return false;
+        for (size_t i = 0; i < pruned.size(); ++i) {
+            // Terms may be added up in a different order, so allow rounding
+            if (std::fabs(pruned[i].score - full[i].score) > 1e-4f) return false;
+        }
+        return true;
+    }
+}
+
+int main() {
+    // The exact title wins over more popular longer ones
+    Catalog love;
+    love.add("Love", "Artist A", 200, 5);
+    love.add("Love Story", "Artist B", 200, 50);
+    love.add("Crazy in Love", "Artist C", 200, 90);
+    CHECK((titles(love, love.rankedSearch("love", Catalog::ANY, 10, Catalog::POPULARITY_PRIOR)) ==
+           std::vector<std::string>{"Love", "Love Story", "Crazy in Love"}));
+
+    // ...but popularity still decides between equal matches
+    Catalog halo;
+    halo.add("Halo", "Cover Band", 200, 10);
+    halo.add("Halo", "Beyonce", 200, 100000);
+    std::vector<Catalog::ScoredMatch> halos = halo.rankedSearch("halo", Catalog::ANY, 10, Catalog::POPULARITY_PRIOR);
+    CHECK(halos.size() == 2 && halo.get(halos[0].id).artist == "Beyonce");
+
+    // Tracks with every word first, then the rest of the limit from partial matches
+    Catalog night;
+    night.add("Night Moves", "Bob Seger", 200, 0);
+    night.add("Love Song", "The Cure", 200, 0);
+    night.add("Night Love", "Artist D", 200, 0);
+    night.add("Morning", "Artist E", 200, 0);
+    std::vector<std::string> found = titles(night, night.rankedSearch("night love", Catalog::ANY, 10));
+    CHECK(found.size() == 3 && found[0] == "Night Love");
+    CHECK(titles(night, night.rankedSearch("night love", Catalog::ANY, 1)) == std::vector<std::string>{"Night Love"});
+    std::vector<Catalog::ScoredMatch> both = night.rankedSearch("night love", Catalog::ANY, 10);
+    CHECK(both.size() == 3 && both[0].allWords && !both[1].allWords && !both[2].allWords);
+    // A word the catalog lacks does not stop the others from matching, but
+    // nothing counts as having every word (callers try typo matching then)
+    std::vector<Catalog::ScoredMatch> missing = night.rankedSearch("night zzz", Catalog::ANY, 10);
+    CHECK(missing.size() == 2 && !missing[0].allWords && !missing[1].allWords);
+
+    CatalogGenerator::Options options;
+    options.trackCount = 20000;
+    Catalog generated;
+    CatalogGenerator(options).fillCatalog(generated);
+    const char* queries[] = {"love", "baby", "night love", "the night", "love love", "me you", "zzz love"};
+    for (const char* query : queries) {
+        for (Catalog::Field field : {Catalog::ANY, Catalog::TITLE, Catalog::ARTIST}) {
+            for (size_t limit : {1, 10, 50}) {
+                CHECK(samePruned(generated, query, field, limit));
+            }
+        }
+    }
+
+    return Test::finish("CatalogSearchTest");
+}
@@ -0,0 +1,121 @@
+#include "Test.hpp"
+#include "ScrobbleQueue.hpp"
+#include "LastFMManager.hpp"
+#include "LastFMStandIn.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+/**
+ * ScrobbleQueueTest - Scrobbles survive until a session can sign them
+ * Plays recorded while signed out must stay in the journal (across a
+ * restart too) and go out as signed POSTs once a session is set. A stale
+ * cursor from a crash mid-compaction must not lose new plays, and a batch
+ * Last.fm refuses must be set aside rather than block later ones.
+ */
+
+namespace fs = std::filesystem;
+
+namespace {
+    const int PLAYS = 120; // three batches: 50 + 50 + 20
+
+    size_t journalLines(const fs::path& directory) {
+        std::ifstream journal(directory / "scrobbles.journal");
+        size_t lines = 0;
+        std::string line;
+        while (std::getline(journal, line)) lines++;
+        return lines;
+    }
+}
+
+int main() {
+    fs::path directory = fs::temp_directory_path() / "musicplayer-scrobble-test";
+    fs::remove_all(directory);
+
+    LastFMStandIn::enable((directory / "fixtures").string());
+    LastFMManager::initialize("test_api_key");
+    LastFMManager::setSessionKey("");
+    LastFMManager::setApiSecret("");
+
+    ScrobbleQueue& queue = ScrobbleQueue::instance();
+    queue.start(directory.string());
+
+    for (int i = 0; i < PLAYS; ++i) {
+        CHECK(queue.enqueue("Artist " + std::to_string(i % 7), "Track " + std::to_string(i), 1700000000 + i * 240, 200));
+    }
+    queue.flush();
+    CHECK(Test::waitFor([&queue] { return queue.getStats().journaled == (uint64_t)PLAYS; }, 5000));
+
+    // Signed out: forced flushes must neither submit nor count as failures
+    queue.flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    ScrobbleQueue::Stats held = queue.getStats();
+    CHECK(held.submitted == 0);
+    CHECK(held.batchesSent == 0);
+    CHECK(held.batchesFailed == 0);
+    CHECK(held.pending == (uint64_t)PLAYS);
+    CHECK(LastFMStandIn::getStats().requests == 0);
+
+    // A direct submission without a session is refused too
+    CHECK(LastFMManager::submitScrobbles({Scrobble{"Artist", "Track", 1700000000, 200}}) ==
+          LastFMManager::SUBMIT_FAILED);
+    CHECK(LastFMStandIn::getStats().requests == 0);
+
+    // Round trip through the journal: restart and recount
+    queue.stop();
+    CHECK(journalLines(directory) == (size_t)PLAYS);
+    queue.start(directory.string());
+    CHECK(queue.getStats().pending == (uint64_t)PLAYS);
+
+    // Signed in: everything goes out in order, as signed POSTs the stand-in accepts
+    LastFMManager::setApiSecret("test_secret");
+    LastFMManager::setSessionKey("test_session");
+    CHECK(LastFMManager::hasSession());
+    queue.flush();
+    CHECK(Test::waitFor([&queue] { return queue.getStats().submitted == (uint64_t)PLAYS; }, 10000));
+
+    ScrobbleQueue::Stats sent = queue.getStats();
+    CHECK(sent.batchesSent == 3);
+    CHECK(sent.batchesFailed == 0);
+    CHECK(sent.pending == 0);
+    CHECK(LastFMStandIn::getStats().requests == 3);
+    queue.stop();
+    CHECK(journalLines(directory) == 0);
+
+    // Crash after compacting the journal but before the cursor was reset
+    {
+        std::ofstream cursor(directory / "scrobbles.cursor");
+        cursor << 123456 << '\n';
+    }
+    queue.start(directory.string());
+    CHECK(queue.getStats().pending == 0);
+    for (int i = 0; i < 3; ++i) {
+        CHECK(queue.enqueue("Artist", "After crash " + std::to_string(i), 1700100000 + i * 240, 200));
+    }
+    queue.flush();
+    CHECK(Test::waitFor([&queue] { return queue.getStats().submitted == (uint64_t)PLAYS + 3; }, 10000));
+    CHECK(LastFMStandIn::getStats().requests == 4);
+
+    // Last.fm refuses a timestamp outright; the batch is moved aside and later plays still go out
+    CHECK(queue.enqueue("Artist", "Bad timestamp", -1, 200));
+    queue.flush();
+    CHECK(Test::waitFor([&queue] { return queue.getStats().rejected == 1; }, 10000));
+    CHECK(queue.enqueue("Artist", "After rejection", 1700200000, 200));
+    queue.flush();
+    CHECK(Test::waitFor([&queue] { return queue.getStats().submitted == (uint64_t)PLAYS + 4; }, 10000));
+    ScrobbleQueue::Stats afterRejection = queue.getStats();
+    CHECK(afterRejection.batchesFailed == 0);
+    CHECK(afterRejection.pending == 0);
+    queue.stop();
+    {
+        std::ifstream rejected(directory / "scrobbles.rejected");
+        std::string line;
+        CHECK(std::getline(rejected, line) && line.find("Bad timestamp") != std::string::npos);
+        CHECK(!std::getline(rejected, line));
+    }
+
+    LastFMManager::shutdown();
+    LastFMStandIn::disable();
+    fs::remove_all(directory);
+    return Test::finish("ScrobbleQueueTest");
+}
@@ -0,0 +1,53 @@
+#ifndef TEST_HPP
+#define TEST_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+/**
+ * Test - Minimal checks shared by the programs in tests/
+ * Each test is a standalone program built and run by
+ * `build.ps1 -Target tests`; it exits non-zero if any check failed.
+ */
+namespace Test {
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline void check(bool passed, const char* expression, const char* file, int line) {
+        if (passed) return;
+        std::printf("CHECK FAILED: %s (%s:%d)\n", expression, file, line);
+        failures()++;
+    }
+
+    /**
+     * Poll condition every 10 ms until it holds or timeoutMs passes
+     */
+    template <typename Condition>
+    bool waitFor(Condition condition, int timeoutMs) {
+        auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() >= until) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+
+    /**
+     * Print the summary and return main()'s exit code
+     */
+    inline int finish(const char* name) {
+        if (failures()) {
+            std::printf("%s: %d check(s) failed\n", name, failures());
+            return 1;
+        }
+        std::printf("%s: all checks passed\n", name);
+        return 0;
+    }
+}
+
+#define CHECK(expression) Test::check((expression), #expression, __FILE__, __LINE__)
+
+#endif // TEST_HPP
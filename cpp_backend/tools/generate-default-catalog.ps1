@@ -0,0 +1,83 @@
+#!/usr/bin/env pwsh
+<#
+.SYNOPSIS
+    Generate headers\DefaultCatalog.hpp from data\default_catalog.csv
+
+.DESCRIPTION
+    The built-in catalog is compiled in as constexpr tables of string_views,
+    so it costs no heap until the catalog is first used. Rows are in
+    popularity order (most popular first); columns:
+        title, artist, duration (seconds), library (1 = in the starting playlist)
+    build.ps1 runs this before compiling; the header is only rewritten
+    when its contents change.
+#>
+
+param(
+    [string]$Source = (Join-Path $PSScriptRoot "..\data\default_catalog.csv"),
+    [string]$Output = (Join-Path $PSScriptRoot "..\headers\DefaultCatalog.hpp")
+)
+
+$ErrorActionPreference = "Stop"
+
+# C++ string literal: escape backslashes and quotes, keep UTF-8 as is
+function ConvertTo-CppLiteral {
+    param([string]$Text)
+    return '"' + $Text.Replace('\', '\\').Replace('"', '\"') + '"'
+}
+
+$rows = Import-Csv -Path $Source -Encoding UTF8
+if ($rows.Count -eq 0) {
+    throw "No rows in $Source"
+}
+
+$entries = @()
+$line = 1
+foreach ($row in $rows) {
+    $line++
+    $duration = 0
+    if (-not $row.title -or -not $row.artist -or -not [int]::TryParse($row.duration, [ref]$duration) -or $duration -le 0) {
+        throw "${Source}:${line}: expected title,artist,duration,library"
+    }
+    $library = if ($row.library -eq "1") { "true" } else { "false" }
+    $entries += "        {$(ConvertTo-CppLiteral $row.title.Trim()), $(ConvertTo-CppLiteral $row.artist.Trim()), $duration, $library},"
+}
+
+$header = @(
+    "// Generated by tools/generate-default-catalog.ps1 from data/default_catalog.csv."
+    "// Do not edit; change the CSV and rebuild."
+    "#ifndef DEFAULTCATALOG_HPP"
+    "#define DEFAULTCATALOG_HPP"
+    ""
+    "#include <string_view>"
+    "#include <cstddef>"
+    ""
+    "/**"
+    " * DefaultCatalog - Built-in songs, most popular first"
+    " * Constant tables in read-only data: nothing is constructed or"
+    " * allocated until a caller copies an entry out."
+    " */"
+    "namespace DefaultCatalog {"
+    "    struct Entry {"
+    "        std::string_view title;"
+    "        std::string_view artist;"
+    "        int duration;       // seconds"
+    "        bool inLibrary;     // part of the starting playlist"
+    "    };"
+    ""
+    "    inline constexpr Entry ENTRIES[] = {"
+) + $entries + @(
+    "    };"
+    ""
+    "    inline constexpr size_t SIZE = sizeof(ENTRIES) / sizeof(ENTRIES[0]);"
+    "}"
+    ""
+    "#endif // DEFAULTCATALOG_HPP"
+)
+$text = ($header -join "`n") + "`n"
+
+# Leave the file (and its timestamp) alone when nothing changed
+if ((Test-Path $Output) -and ([System.IO.File]::ReadAllText($Output) -eq $text)) {
+    return
+}
+[System.IO.File]::WriteAllText($Output, $text, (New-Object System.Text.UTF8Encoding($false)))
+Write-Host "Generated $Output ($($rows.Count) songs)"
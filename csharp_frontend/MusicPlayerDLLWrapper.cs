@@ -1,6 +1,7 @@
 using System;
 using System.Runtime.InteropServices;
 using System.Collections.Generic;
+using System.Text;
 
 namespace MusicPlayerUI
 {
@@ -11,16 +12,27 @@ namespace MusicPlayerUI
     {
         private const string DLL_NAME = "MusicPlayerDLL.dll";
 
-        [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+        // Strings cross the boundary as UTF-8 (what the backend stores and matches on)
+        [StructLayout(LayoutKind.Sequential)]
         public struct SongData
         {
-            [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 256)]
-            public string title;
+            [MarshalAs(UnmanagedType.ByValArray, SizeConst = 256)]
+            private byte[] titleBytes; // NUL-terminated UTF-8
 
-            [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 256)]
-            public string artist;
+            [MarshalAs(UnmanagedType.ByValArray, SizeConst = 256)]
+            private byte[] artistBytes;
 
             public int duration;
+
+            public string title => DecodeUtf8(titleBytes);
+            public string artist => DecodeUtf8(artistBytes);
+
+            private static string DecodeUtf8(byte[] bytes)
+            {
+                if (bytes == null) return "";
+                int length = Array.IndexOf(bytes, (byte)0);
+                return Encoding.UTF8.GetString(bytes, 0, length < 0 ? bytes.Length : length);
+            }
         }
 
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
@@ -30,19 +42,24 @@ namespace MusicPlayerUI
         public static extern int GetPlaylistSize();
 
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
-        public static extern int AddSongToPlaylist(string title, string artist, int duration);
+        public static extern int AddSongToPlaylist([MarshalAs(UnmanagedType.LPUTF8Str)] string title,
+            [MarshalAs(UnmanagedType.LPUTF8Str)] string artist, int duration);
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int AddSongFileToPlaylist([MarshalAs(UnmanagedType.LPUTF8Str)] string title,
+            [MarshalAs(UnmanagedType.LPUTF8Str)] string artist, [MarshalAs(UnmanagedType.LPUTF8Str)] string filePath); // -1 if not a readable WAV file
 
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern int RemoveSongFromPlaylist(int index);
 
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
-        public static extern int GetPlaylistSong(int index, ref SongData outSong);
+        public static extern int GetPlaylistSong(int index, out SongData outSong);
 
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern void ClearPlaylist();
 
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
-        public static extern int GetAllSongs(SongData[] outArray, int maxSize);
+        public static extern int GetAllSongs([Out] SongData[] outArray, int maxSize);
 
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern void PlaySong(int index);
@@ -56,6 +73,9 @@ namespace MusicPlayerUI
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern void StopSong();
 
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void NotifyTrackFinished();
+
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern int GetCurrentSongIndex();
 
@@ -66,10 +86,52 @@ namespace MusicPlayerUI
         public static extern float GetProgress();
 
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
-        public static extern int SearchFromLastFM(string query, SongData[] outArray, int maxResults);
+        public static extern void SetCrossfade(float seconds); // 0 - 12, 0 = gapless
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern float GetCrossfade();
 
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
-        public static extern int GetTopTracks(SongData[] outArray, int maxResults);
+        public static extern void SetOutputRate(int sampleRate); // 0 = each song's own rate
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetPlaybackSpeed(float speed); // 0.5 - 2.0
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern float GetPlaybackSpeed();
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SearchFromLastFM([MarshalAs(UnmanagedType.LPUTF8Str)] string query,
+            [Out] SongData[] outArray, int maxResults);
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetTopTracks([Out] SongData[] outArray, int maxResults);
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int BeginSearchFromLastFM([MarshalAs(UnmanagedType.LPUTF8Str)] string query);
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int BeginGetTopTracks(int maxResults);
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetRequestStatus(int handle); // 0=PENDING, 1=COMPLETED, 2=CANCELLED, 3=FAILED, -1=unknown
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int CollectRequestResults(int handle, [Out] SongData[] outArray, int maxResults);
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void CancelRequest(int handle);
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void PrefetchRelatedTracks([MarshalAs(UnmanagedType.LPUTF8Str)] string title,
+            [MarshalAs(UnmanagedType.LPUTF8Str)] string artist);
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetLastFMSession([MarshalAs(UnmanagedType.LPUTF8Str)] string apiSecret,
+            [MarshalAs(UnmanagedType.LPUTF8Str)] string sessionKey);
+
+        [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int Suggest([MarshalAs(UnmanagedType.LPUTF8Str)] string prefix, int k, [Out] SongData[] outArray);
 
         [DllImport(DLL_NAME, CallingConvention = CallingConvention.Cdecl)]
         public static extern int SavePlaylist(string filename);
@@ -93,8 +155,7 @@ namespace MusicPlayerUI
 
             for (int i = 0; i < size; i++)
             {
-                var songData = new MusicPlayerDLL.SongData();
-                if (MusicPlayerDLL.GetPlaylistSong(i, ref songData) == 0)
+                if (MusicPlayerDLL.GetPlaylistSong(i, out var songData) == 0)
                 {
                     playlist.Add(new Song
                     {
@@ -148,14 +209,85 @@ namespace MusicPlayerUI
             return songs;
         }
 
+        // Reused between keystrokes; Suggest returns at most 10 entries
+        private static readonly MusicPlayerDLL.SongData[] suggestionBuffer = new MusicPlayerDLL.SongData[10];
+
+        /// <summary>
+        /// Type-ahead suggestions for the text typed so far (call on every keystroke)
+        /// </summary>
+        public static List<Song> Suggest(string prefix, int k = 8)
+        {
+            var songs = new List<Song>();
+            int count = MusicPlayerDLL.Suggest(prefix, Math.Min(k, suggestionBuffer.Length), suggestionBuffer);
+
+            for (int i = 0; i < count; i++)
+            {
+                songs.Add(new Song
+                {
+                    Title = suggestionBuffer[i].title,
+                    Artist = suggestionBuffer[i].artist,
+                    Duration = suggestionBuffer[i].duration
+                });
+            }
+
+            return songs;
+        }
+
+        /// <summary>
+        /// Start a Last.fm search without blocking; poll with TryCollect
+        /// </summary>
+        public static int BeginSearchLastFM(string query) => MusicPlayerDLL.BeginSearchFromLastFM(query);
+
+        public static RequestStatus GetRequestStatus(int handle) => (RequestStatus)MusicPlayerDLL.GetRequestStatus(handle);
+
+        /// <summary>
+        /// Returns null while the request is still pending (e.g. call from a UI timer)
+        /// </summary>
+        public static List<Song> TryCollect(int handle, int maxResults = 20)
+        {
+            var resultsArray = new MusicPlayerDLL.SongData[maxResults];
+            int count = MusicPlayerDLL.CollectRequestResults(handle, resultsArray, maxResults);
+            if (count < 0) return null;
+
+            var songs = new List<Song>();
+            for (int i = 0; i < count; i++)
+            {
+                songs.Add(new Song
+                {
+                    Title = resultsArray[i].title,
+                    Artist = resultsArray[i].artist,
+                    Duration = resultsArray[i].duration
+                });
+            }
+
+            return songs;
+        }
+
+        public static void CancelRequest(int handle) => MusicPlayerDLL.CancelRequest(handle);
+
+        public static void PrefetchRelated(string title, string artist)
+            => MusicPlayerDLL.PrefetchRelatedTracks(title, artist);
+
+        /// <summary>
+        /// Enable scrobbling; until then plays wait in the backend's journal
+        /// </summary>
+        public static void SetLastFMSession(string apiSecret, string sessionKey)
+            => MusicPlayerDLL.SetLastFMSession(apiSecret, sessionKey);
+
         public static void PlaySong(int index) => MusicPlayerDLL.PlaySong(index);
         public static void PauseSong() => MusicPlayerDLL.PauseSong();
         public static void ResumeSong() => MusicPlayerDLL.ResumeSong();
         public static void StopSong() => MusicPlayerDLL.StopSong();
+        public static void NotifyTrackFinished() => MusicPlayerDLL.NotifyTrackFinished();
 
         public static int GetCurrentSongIndex() => MusicPlayerDLL.GetCurrentSongIndex();
         public static PlaybackState GetPlaybackState() => (PlaybackState)MusicPlayerDLL.GetPlaybackState();
         public static float GetProgress() => MusicPlayerDLL.GetProgress();
+        public static void SetCrossfade(float seconds) => MusicPlayerDLL.SetCrossfade(seconds);
+        public static float GetCrossfade() => MusicPlayerDLL.GetCrossfade();
+        public static void SetOutputRate(int sampleRate) => MusicPlayerDLL.SetOutputRate(sampleRate);
+        public static void SetPlaybackSpeed(float speed) => MusicPlayerDLL.SetPlaybackSpeed(speed);
+        public static float GetPlaybackSpeed() => MusicPlayerDLL.GetPlaybackSpeed();
 
         public static int AddSong(string title, string artist, int duration)
             => MusicPlayerDLL.AddSongToPlaylist(title, artist, duration);
@@ -170,6 +302,15 @@ namespace MusicPlayerUI
             => MusicPlayerDLL.LoadPlaylist(filename);
     }
 
+    public enum RequestStatus
+    {
+        UNKNOWN = -1,
+        PENDING = 0,
+        COMPLETED = 1,
+        CANCELLED = 2,
+        FAILED = 3
+    }
+
     public enum PlaybackState
     {
         STOPPED = 0,